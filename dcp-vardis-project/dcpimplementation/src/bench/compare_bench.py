@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2025 Andreas Willig, University of Canterbury
+#
+# SPDX-License-Identifier: LGPL-3.0-or-later
+#
+# Compares two JSON result files of dcp-bench (Google Benchmark
+# format, e.g. produced by the dcp-bench-json target) and reports the
+# relative change of the time per iteration for every benchmark
+# present in both. With repetitions, the median aggregate is used,
+# otherwise the single run.
+#
+# Exits with status 1 when at least one benchmark got slower by more
+# than the threshold, so that it can be used in scripts.
+#
+# Usage: compare_bench.py [--threshold PERCENT] [--filter REGEX] baseline.json contender.json
+
+
+import argparse
+import json
+import re
+import sys
+
+
+def load_results(filename):
+    with open(filename) as f:
+        data = json.load(f)
+    results = {}
+    for b in data.get("benchmarks", []):
+        if b.get("error_occurred"):
+            continue
+        name = b.get("run_name", b["name"])
+        if b.get("run_type") == "aggregate":
+            if b.get("aggregate_name") != "median":
+                continue
+        elif name in results:
+            # single repetitions are only used when there is no median
+            continue
+        # benchmarks registered with UseRealTime() carry a /real_time suffix
+        t = b["real_time"] if name.endswith("/real_time") else b["cpu_time"]
+        results[name] = (t, b["time_unit"])
+    return data.get("context", {}), results
+
+
+def to_ns(value, unit):
+    return value * {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}[unit]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two dcp-bench JSON result files")
+    parser.add_argument("baseline")
+    parser.add_argument("contender")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="slowdown in percent regarded as regression (default 10)")
+    parser.add_argument("--filter", default=".*", help="only compare benchmarks matching this regex")
+    args = parser.parse_args()
+
+    ctx_old, old = load_results(args.baseline)
+    ctx_new, new = load_results(args.contender)
+    pattern = re.compile(args.filter)
+
+    for key in ("host_name", "num_cpus", "mhz_per_cpu", "library_build_type"):
+        if ctx_old.get(key) != ctx_new.get(key):
+            print(f"warning: {key} differs ({ctx_old.get(key)} vs {ctx_new.get(key)})")
+
+    names = [n for n in old if n in new and pattern.search(n)]
+    if not names:
+        print("no common benchmarks")
+        return 0
+
+    width = max(len(n) for n in names)
+    print(f"{'benchmark':<{width}}  {'baseline ns':>14}  {'contender ns':>14}  {'change':>8}")
+    regressions = []
+    for n in names:
+        t_old = to_ns(*old[n])
+        t_new = to_ns(*new[n])
+        change = (t_new - t_old) / t_old * 100.0 if t_old > 0 else 0.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  REGRESSION"
+            regressions.append(n)
+        elif change < -args.threshold:
+            flag = "  improved"
+        print(f"{n:<{width}}  {t_old:>14.1f}  {t_new:>14.1f}  {change:>+7.1f}%{flag}")
+
+    only_old = sorted(n for n in set(old) - set(new) if pattern.search(n))
+    only_new = sorted(n for n in set(new) - set(old) if pattern.search(n))
+    if only_old:
+        print(f"only in baseline: {', '.join(only_old)}")
+    if only_new:
+        print(f"only in contender: {', '.join(only_new)}")
+
+    if regressions:
+        print(f"{len(regressions)} regression(s) above {args.threshold}%")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
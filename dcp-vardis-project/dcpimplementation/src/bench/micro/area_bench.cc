@@ -0,0 +1,139 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+
+/**
+ * @brief Microbenchmarks for the Area classes: serializing and
+ *        deserializing integers and byte blocks of different sizes.
+ *        An area is constructed for every payload, as the protocol
+ *        code does.
+ */
+
+
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <dcp/common/area.h>
+#include "bench_helpers.h"
+
+using dcp::byte;
+using dcp::ByteVectorAssemblyArea;
+using dcp::MemoryChunkAssemblyArea;
+using dcp::MemoryChunkDisassemblyArea;
+
+
+/**
+ * @brief Serializes the given number of 32 bit integers
+ */
+static void BM_Area_SerializeUint32 (benchmark::State& state)
+{
+  const size_t number = state.range(0);
+  std::vector<byte> buffer (4 * number);
+  for (auto _ : state)
+    {
+      MemoryChunkAssemblyArea area ("bench", buffer.size(), buffer.data());
+      for (size_t i = 0; i < number; i++)
+	area.serialize_uint32_n ((uint32_t) i);
+      benchmark::ClobberMemory ();
+    }
+  state.SetItemsProcessed (state.iterations() * number);
+  state.SetBytesProcessed (state.iterations() * buffer.size());
+}
+
+
+/**
+ * @brief Deserializes the given number of 32 bit integers
+ */
+static void BM_Area_DeserializeUint32 (benchmark::State& state)
+{
+  const size_t number = state.range(0);
+  std::vector<byte> buffer = dcp::bench::random_bytes (4 * number);
+  for (auto _ : state)
+    {
+      MemoryChunkDisassemblyArea area ("bench", buffer.size(), buffer.data());
+      uint32_t sum = 0, val;
+      for (size_t i = 0; i < number; i++)
+	{
+	  area.deserialize_uint32_n (val);
+	  sum += val;
+	}
+      benchmark::DoNotOptimize (sum);
+    }
+  state.SetItemsProcessed (state.iterations() * number);
+  state.SetBytesProcessed (state.iterations() * buffer.size());
+}
+
+
+/**
+ * @brief Serializes one byte block of the given size, into a
+ *        memory chunk and into a byte vector
+ */
+static void BM_Area_SerializeBlock (benchmark::State& state)
+{
+  const size_t size = state.range(0);
+  std::vector<byte> data = dcp::bench::random_bytes (size);
+  std::vector<byte> buffer (size);
+  for (auto _ : state)
+    {
+      MemoryChunkAssemblyArea area ("bench", buffer.size(), buffer.data());
+      area.serialize_byte_block (size, data.data());
+      benchmark::ClobberMemory ();
+    }
+  state.SetBytesProcessed (state.iterations() * size);
+}
+
+
+static void BM_Area_SerializeBlockByteVector (benchmark::State& state)
+{
+  const size_t size = state.range(0);
+  std::vector<byte> data = dcp::bench::random_bytes (size);
+  std::vector<byte> buffer (size);
+  for (auto _ : state)
+    {
+      ByteVectorAssemblyArea area ("bench", buffer.size(), buffer);
+      area.serialize_byte_block (size, data.data());
+      benchmark::ClobberMemory ();
+    }
+  state.SetBytesProcessed (state.iterations() * size);
+}
+
+
+/**
+ * @brief Deserializes one byte block of the given size
+ */
+static void BM_Area_DeserializeBlock (benchmark::State& state)
+{
+  const size_t size = state.range(0);
+  std::vector<byte> data = dcp::bench::random_bytes (size);
+  std::vector<byte> buffer (size);
+  for (auto _ : state)
+    {
+      MemoryChunkDisassemblyArea area ("bench", data.size(), data.data());
+      area.deserialize_byte_block (size, buffer.data());
+      benchmark::ClobberMemory ();
+    }
+  state.SetBytesProcessed (state.iterations() * size);
+}
+
+
+BENCHMARK(BM_Area_SerializeUint32)->Arg(4)->Arg(64)->Arg(256);
+BENCHMARK(BM_Area_DeserializeUint32)->Arg(4)->Arg(64)->Arg(256);
+BENCHMARK(BM_Area_SerializeBlock)->Arg(16)->Arg(256)->Arg(1024);
+BENCHMARK(BM_Area_SerializeBlockByteVector)->Arg(16)->Arg(256)->Arg(1024);
+BENCHMARK(BM_Area_DeserializeBlock)->Arg(16)->Arg(256)->Arg(1024);
@@ -0,0 +1,123 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+/**
+ * @brief Microbenchmarks for FixedMemAVLTree: insert, lookup and
+ *        remove, with trees of different sizes (the array size is
+ *        the number of elements)
+ */
+
+
+#include <memory>
+#include <benchmark/benchmark.h>
+#include <dcp/common/fixedmem_avl_tree.h>
+#include "bench_helpers.h"
+
+using dcp::FixedMemAVLTree;
+
+
+template <uint64_t numberElements>
+using BenchTree = FixedMemAVLTree<uint64_t, uint64_t, numberElements>;
+
+
+template <uint64_t numberElements>
+void fill_tree (BenchTree<numberElements>& tree, const std::vector<uint64_t>& keys)
+{
+  for (auto k : keys)
+    {
+      uint64_t data = k;
+      tree.insert (k, data);
+    }
+}
+
+
+/**
+ * @brief Clears the tree and inserts all keys in random order. The
+ *        clearing is part of the measurement, it is linear in the
+ *        tree size like the inserts.
+ */
+template <uint64_t numberElements>
+static void BM_AVLTree_Insert (benchmark::State& state)
+{
+  auto tree = std::make_unique<BenchTree<numberElements>> ();
+  auto keys = dcp::bench::random_keys (numberElements);
+  for (auto _ : state)
+    {
+      tree->clear ();
+      fill_tree<numberElements> (*tree, keys);
+      benchmark::ClobberMemory ();
+    }
+  state.SetItemsProcessed (state.iterations() * numberElements);
+}
+
+
+/**
+ * @brief Looks up keys of a full tree in random order
+ */
+template <uint64_t numberElements>
+static void BM_AVLTree_Lookup (benchmark::State& state)
+{
+  auto tree = std::make_unique<BenchTree<numberElements>> ();
+  auto keys = dcp::bench::random_keys (numberElements);
+  fill_tree<numberElements> (*tree, keys);
+  auto order = dcp::bench::random_permutation (numberElements, 2);
+  size_t i = 0;
+  for (auto _ : state)
+    {
+      benchmark::DoNotOptimize (tree->lookup (keys[order[i]]));
+      if (++i == numberElements) i = 0;
+    }
+  state.SetItemsProcessed (state.iterations());
+}
+
+
+/**
+ * @brief Removes all keys of a full tree in random order, refilling
+ *        the tree is not measured
+ */
+template <uint64_t numberElements>
+static void BM_AVLTree_Remove (benchmark::State& state)
+{
+  auto tree   = std::make_unique<BenchTree<numberElements>> ();
+  auto keys   = dcp::bench::random_keys (numberElements);
+  auto order  = dcp::bench::random_permutation (numberElements, 2);
+  for (auto _ : state)
+    {
+      state.PauseTiming ();
+      tree->clear ();
+      fill_tree<numberElements> (*tree, keys);
+      state.ResumeTiming ();
+      for (auto o : order)
+	tree->remove (keys[o]);
+      benchmark::ClobberMemory ();
+    }
+  state.SetItemsProcessed (state.iterations() * numberElements);
+}
+
+
+BENCHMARK_TEMPLATE(BM_AVLTree_Insert, 64);
+BENCHMARK_TEMPLATE(BM_AVLTree_Insert, 1024);
+BENCHMARK_TEMPLATE(BM_AVLTree_Insert, 16384);
+BENCHMARK_TEMPLATE(BM_AVLTree_Lookup, 64);
+BENCHMARK_TEMPLATE(BM_AVLTree_Lookup, 1024);
+BENCHMARK_TEMPLATE(BM_AVLTree_Lookup, 16384);
+BENCHMARK_TEMPLATE(BM_AVLTree_Remove, 64);
+BENCHMARK_TEMPLATE(BM_AVLTree_Remove, 1024);
+BENCHMARK_TEMPLATE(BM_AVLTree_Remove, 16384);
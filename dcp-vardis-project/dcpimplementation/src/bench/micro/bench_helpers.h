@@ -0,0 +1,76 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+
+/**
+ * @brief Helpers shared by the dcp-bench microbenchmarks. All random
+ *        data is generated from fixed seeds, so that every run works
+ *        on the same inputs.
+ */
+
+namespace dcp::bench {
+
+  /**
+   * @brief Returns a random permutation of 0, ..., n-1
+   */
+  inline std::vector<uint64_t> random_permutation (uint64_t n, uint64_t seed = 1)
+  {
+    std::vector<uint64_t> v (n);
+    std::iota (v.begin(), v.end(), 0);
+    std::mt19937_64 gen (seed);
+    std::shuffle (v.begin(), v.end(), gen);
+    return v;
+  }
+
+
+  /**
+   * @brief Returns n distinct keys spread over the 64 bit range, in
+   *        random order
+   */
+  inline std::vector<uint64_t> random_keys (uint64_t n, uint64_t seed = 1)
+  {
+    std::vector<uint64_t> v = random_permutation (n, seed);
+    for (auto& k : v)
+      k = k * 0x9E3779B97F4A7C15ull + 1;
+    return v;
+  }
+
+
+  /**
+   * @brief Returns n random bytes
+   */
+  inline std::vector<uint8_t> random_bytes (size_t n, uint64_t seed = 1)
+  {
+    std::vector<uint8_t> v (n);
+    std::mt19937_64 gen (seed);
+    for (auto& b : v)
+      b = (uint8_t) gen ();
+    return v;
+  }
+
+};  // namespace dcp::bench
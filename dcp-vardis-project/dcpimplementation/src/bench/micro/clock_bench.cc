@@ -0,0 +1,117 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+
+/**
+ * @brief Microbenchmarks for the per-call cost of the timestamp
+ *        sources, and a measurement of how far the coarse clock lags
+ *        behind the precise one (reported as counters)
+ */
+
+
+#include <algorithm>
+#include <chrono>
+#include <benchmark/benchmark.h>
+#include <dcp/common/coarse_clock.h>
+#include <dcp/common/global_types_constants.h>
+
+using dcp::CoarseClock;
+using dcp::TimeStampT;
+
+
+static void BM_Clock_HighResolutionNow (benchmark::State& state)
+{
+  for (auto _ : state)
+    benchmark::DoNotOptimize (std::chrono::high_resolution_clock::now ());
+}
+
+
+static void BM_Clock_SteadyNow (benchmark::State& state)
+{
+  for (auto _ : state)
+    benchmark::DoNotOptimize (std::chrono::steady_clock::now ());
+}
+
+
+static void BM_Clock_CoarseNow (benchmark::State& state)
+{
+  for (auto _ : state)
+    benchmark::DoNotOptimize (CoarseClock::now ());
+}
+
+
+static void BM_TimeStamp_GetCurrentSystemTime (benchmark::State& state)
+{
+  for (auto _ : state)
+    benchmark::DoNotOptimize (TimeStampT::get_current_system_time ());
+}
+
+
+static void BM_TimeStamp_GetCurrentCoarseTime (benchmark::State& state)
+{
+  for (auto _ : state)
+    benchmark::DoNotOptimize (TimeStampT::get_current_coarse_time ());
+}
+
+
+static void BM_TimeStamp_MillisecondsPassedSince (benchmark::State& state)
+{
+  TimeStampT past = TimeStampT::get_current_system_time ();
+  TimeStampT now  = past;
+  now.tStamp += std::chrono::milliseconds (1234);
+  for (auto _ : state)
+    {
+      benchmark::DoNotOptimize (now.milliseconds_passed_since (past));
+      benchmark::ClobberMemory ();
+    }
+}
+
+
+/**
+ * @brief Reads both clocks back to back and reports the mean and
+ *        maximum amount (in microseconds) by which the coarse reading
+ *        lags behind the precise one, together with the clock
+ *        resolution
+ */
+static void BM_Clock_CoarseLag (benchmark::State& state)
+{
+  double   sum_lag = 0;
+  int64_t  max_lag = 0;
+  for (auto _ : state)
+    {
+      auto coarse  = CoarseClock::now ();
+      auto precise = std::chrono::high_resolution_clock::now ();
+      int64_t lag  = std::chrono::duration_cast<std::chrono::nanoseconds> (precise - coarse).count();
+      sum_lag += lag;
+      max_lag  = std::max (max_lag, lag);
+    }
+  state.counters["mean_lag_us"]   = sum_lag / state.iterations() / 1000.0;
+  state.counters["max_lag_us"]    = max_lag / 1000.0;
+  state.counters["resolution_us"] = CoarseClock::resolution().count() / 1000.0;
+}
+
+
+BENCHMARK(BM_Clock_HighResolutionNow);
+BENCHMARK(BM_Clock_SteadyNow);
+BENCHMARK(BM_Clock_CoarseNow);
+BENCHMARK(BM_TimeStamp_GetCurrentSystemTime);
+BENCHMARK(BM_TimeStamp_GetCurrentCoarseTime);
+BENCHMARK(BM_TimeStamp_MillisecondsPassedSince);
+BENCHMARK(BM_Clock_CoarseLag)->MinTime(0.5);
@@ -0,0 +1,128 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+/**
+ * @brief Microbenchmarks measuring the cost of a DCPLOG_* statement
+ *        as seen by the calling thread
+ *
+ * Compares a statement below the minimum severity level, synchronous
+ * logging and asynchronous logging, each writing to a log file in
+ * the temporary directory (removed when the suite exits). A typical
+ * receive-path record with a few numbers and a string is used.
+ */
+
+
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <benchmark/benchmark.h>
+#include <dcp/common/async_logging.h>
+#include <dcp/common/logging_helpers.h>
+
+namespace keywords = boost::log::keywords;
+
+logger_type log_bench (keywords::channel = "BENCH");
+
+const std::string benchLogfilePrefix = "dcp-logging-bench";
+
+
+void remove_bench_logfiles ()
+{
+  for (auto& entry : std::filesystem::directory_iterator (std::filesystem::temp_directory_path()))
+    if (entry.path().filename().string().starts_with (benchLogfilePrefix))
+      std::filesystem::remove (entry.path());
+}
+
+
+/**
+ * @brief Sets up file logging at severity info on first use
+ */
+void initialize_bench_logging ()
+{
+  static bool initialized = false;
+  if (initialized)
+    return;
+  
+  dcp::LoggingConfigurationBlock cfg;
+  cfg.logfileNamePrefix     = (std::filesystem::temp_directory_path() / benchLogfilePrefix).string();
+  cfg.minimumSeverityLevel  = "info";
+  dcp::initialize_file_logging (cfg);
+  std::atexit (remove_bench_logfiles);
+  initialized = true;
+}
+
+
+/**
+ * @brief A trace statement, below the minimum severity level
+ */
+static void BM_Logging_Disabled (benchmark::State& state)
+{
+  initialize_bench_logging ();
+  std::string name = "neighbour";
+  uint64_t seqno = 0;
+  for (auto _ : state)
+    {
+      DCPLOG_TRACE(log_bench) << "received payload from " << name << " seqno " << seqno++ << " length " << 42 << " gap " << 1.5;
+    }
+  state.SetItemsProcessed (state.iterations());
+}
+
+
+/**
+ * @brief An info statement written synchronously to the log file
+ */
+static void BM_Logging_Synchronous (benchmark::State& state)
+{
+  initialize_bench_logging ();
+  std::string name = "neighbour";
+  uint64_t seqno = 0;
+  for (auto _ : state)
+    {
+      DCPLOG_INFO(log_bench) << "received payload from " << name << " seqno " << seqno++ << " length " << 42 << " gap " << 1.5;
+    }
+  state.SetItemsProcessed (state.iterations());
+}
+
+
+/**
+ * @brief An info statement handed to the asynchronous logging
+ *        thread, records dropped because of a full ring buffer are
+ *        reported as counter 'dropped'
+ */
+static void BM_Logging_Asynchronous (benchmark::State& state)
+{
+  initialize_bench_logging ();
+  std::string name = "neighbour";
+  uint64_t seqno = 0;
+  uint64_t droppedBefore = dcp::get_async_logging_dropped ();
+  dcp::start_async_logging (16 * 1024 * 1024, 5);
+  for (auto _ : state)
+    {
+      DCPLOG_INFO(log_bench) << "received payload from " << name << " seqno " << seqno++ << " length " << 42 << " gap " << 1.5;
+    }
+  dcp::stop_async_logging ();
+  state.SetItemsProcessed (state.iterations());
+  state.counters["dropped"] = (double) (dcp::get_async_logging_dropped () - droppedBefore);
+}
+
+
+BENCHMARK(BM_Logging_Disabled);
+BENCHMARK(BM_Logging_Synchronous);
+BENCHMARK(BM_Logging_Asynchronous);
@@ -0,0 +1,207 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+/**
+ * @brief Microbenchmarks comparing FixedMemAVLTree and
+ *        FixedMemHashTable as SRP neighbour table index
+ *
+ * Measures the operations the SRP demon performs, for several
+ * neighbour table sizes (the array size is the number of
+ * neighbours): inserting new neighbours, updating an existing
+ * neighbour on a received payload (is_member followed by
+ * lookup_data_ref), full traversals as done by scrubbing, and
+ * removals. Keys are random MAC addresses.
+ */
+
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <dcp/common/fixedmem_avl_tree.h>
+#include <dcp/common/fixedmem_hash_table.h>
+#include <dcp/common/global_types_constants.h>
+#include "bench_helpers.h"
+
+using dcp::FixedMemAVLTree;
+using dcp::FixedMemHashTable;
+using dcp::NodeIdentifierT;
+
+
+/**
+ * @brief Per-neighbour state of roughly the size used by the SRP store
+ */
+typedef struct BenchNeighbourState {
+  uint64_t  esd_offs   = 0;
+  uint32_t  last_seqno = 0;
+  double    avg_gap    = 0;
+  uint64_t  last_rx    = 0;
+} BenchNeighbourState;
+
+
+template <uint64_t numberElements>
+using AVLIndex = FixedMemAVLTree<NodeIdentifierT, BenchNeighbourState, numberElements>;
+
+template <uint64_t numberElements>
+using HashIndex = FixedMemHashTable<NodeIdentifierT, BenchNeighbourState, numberElements>;
+
+
+/**
+ * @brief Returns n distinct random node identifiers
+ */
+std::vector<NodeIdentifierT> random_node_ids (uint64_t n)
+{
+  std::vector<NodeIdentifierT> ids;
+  for (auto k : dcp::bench::random_keys (n))
+    {
+      NodeIdentifierT nodeId;
+      for (int i = 0; i < 6; i++)
+	nodeId.nodeId[i] = (dcp::byte) (k >> (8*i));
+      ids.push_back (nodeId);
+    }
+  return ids;
+}
+
+
+template <typename IndexT>
+void fill_index (IndexT& index, const std::vector<NodeIdentifierT>& keys)
+{
+  BenchNeighbourState s;
+  for (const auto& k : keys)
+    index.insert (k, s);
+}
+
+
+/**
+ * @brief Clears the index and inserts all neighbours. The clearing
+ *        is part of the measurement, it is linear in the index size
+ *        like the inserts.
+ */
+template <typename IndexT, uint64_t numberElements>
+static void BM_NeighbourIndex_Insert (benchmark::State& state)
+{
+  auto index = std::make_unique<IndexT> ();
+  auto keys  = random_node_ids (numberElements);
+  for (auto _ : state)
+    {
+      index->clear ();
+      fill_index (*index, keys);
+      benchmark::ClobberMemory ();
+    }
+  state.SetItemsProcessed (state.iterations() * numberElements);
+}
+
+
+/**
+ * @brief Updates the state of neighbours of a full index in random
+ *        order
+ */
+template <typename IndexT, uint64_t numberElements>
+static void BM_NeighbourIndex_Update (benchmark::State& state)
+{
+  auto index = std::make_unique<IndexT> ();
+  auto keys  = random_node_ids (numberElements);
+  fill_index (*index, keys);
+  auto order = dcp::bench::random_permutation (numberElements, 2);
+  size_t i = 0;
+  for (auto _ : state)
+    {
+      const NodeIdentifierT& k = keys[order[i]];
+      if (index->is_member (k))
+	{
+	  BenchNeighbourState& s = index->lookup_data_ref (k);
+	  s.last_seqno++;
+	  benchmark::DoNotOptimize (s);
+	}
+      if (++i == numberElements) i = 0;
+    }
+  state.SetItemsProcessed (state.iterations());
+}
+
+
+/**
+ * @brief Visits all neighbours of a full index as the scrubber does,
+ *        items are the neighbours visited
+ */
+template <typename IndexT, uint64_t numberElements>
+static void BM_NeighbourIndex_Scrub (benchmark::State& state)
+{
+  auto index = std::make_unique<IndexT> ();
+  fill_index (*index, random_node_ids (numberElements));
+  std::function<bool (NodeIdentifierT, const BenchNeighbourState&)> pred = [] (NodeIdentifierT, const BenchNeighbourState& s) { return s.last_seqno != 0; };
+  std::function<NodeIdentifierT (NodeIdentifierT, const BenchNeighbourState&)> transf = [] (NodeIdentifierT k, const BenchNeighbourState&) { return k; };
+  for (auto _ : state)
+    {
+      std::list<NodeIdentifierT> result;
+      index-> template find_matching_data<NodeIdentifierT> (pred, transf, result);
+      benchmark::DoNotOptimize (result);
+    }
+  state.SetItemsProcessed (state.iterations() * numberElements);
+}
+
+
+/**
+ * @brief Removes all neighbours of a full index, refilling the index
+ *        is not measured
+ */
+template <typename IndexT, uint64_t numberElements>
+static void BM_NeighbourIndex_Remove (benchmark::State& state)
+{
+  auto index = std::make_unique<IndexT> ();
+  auto keys  = random_node_ids (numberElements);
+  for (auto _ : state)
+    {
+      state.PauseTiming ();
+      index->clear ();
+      fill_index (*index, keys);
+      state.ResumeTiming ();
+      for (const auto& k : keys)
+	index->remove (k);
+      benchmark::ClobberMemory ();
+    }
+  state.SetItemsProcessed (state.iterations() * numberElements);
+}
+
+
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Insert, AVLIndex<64>, 64);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Insert, HashIndex<64>, 64);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Insert, AVLIndex<1024>, 1024);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Insert, HashIndex<1024>, 1024);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Insert, AVLIndex<16384>, 16384);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Insert, HashIndex<16384>, 16384);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Update, AVLIndex<64>, 64);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Update, HashIndex<64>, 64);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Update, AVLIndex<1024>, 1024);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Update, HashIndex<1024>, 1024);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Update, AVLIndex<16384>, 16384);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Update, HashIndex<16384>, 16384);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Scrub, AVLIndex<64>, 64);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Scrub, HashIndex<64>, 64);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Scrub, AVLIndex<1024>, 1024);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Scrub, HashIndex<1024>, 1024);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Scrub, AVLIndex<16384>, 16384);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Scrub, HashIndex<16384>, 16384);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Remove, AVLIndex<64>, 64);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Remove, HashIndex<64>, 64);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Remove, AVLIndex<1024>, 1024);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Remove, HashIndex<1024>, 1024);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Remove, AVLIndex<16384>, 16384);
+BENCHMARK_TEMPLATE(BM_NeighbourIndex_Remove, HashIndex<16384>, 16384);
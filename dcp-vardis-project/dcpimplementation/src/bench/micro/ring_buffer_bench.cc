@@ -0,0 +1,88 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+
+/**
+ * @brief Microbenchmarks for FixedMemRingBuffer: push and pop of
+ *        buffer descriptors (the element type used by ShmFiniteQueue)
+ *        for different capacities
+ */
+
+
+#include <memory>
+#include <benchmark/benchmark.h>
+#include <dcp/common/fixedmem_ring_buffer.h>
+
+using dcp::FixedMemRingBuffer;
+
+
+typedef struct Descriptor {
+  uint64_t offs;
+  size_t   len;
+} Descriptor;
+
+
+template <uint64_t capacity>
+using BenchRing = FixedMemRingBuffer<Descriptor, capacity+1>;
+
+
+/**
+ * @brief One push and one pop on a half full ring buffer
+ */
+template <uint64_t capacity>
+static void BM_RingBuffer_PushPop (benchmark::State& state)
+{
+  auto ring = std::make_unique<BenchRing<capacity>> ("bench", capacity);
+  for (uint64_t i = 0; i < capacity / 2; i++)
+    ring->push (Descriptor {i, 0});
+  uint64_t i = 0;
+  for (auto _ : state)
+    {
+      ring->push (Descriptor {i++, 64});
+      benchmark::DoNotOptimize (ring->pop ());
+    }
+  state.SetItemsProcessed (state.iterations());
+}
+
+
+/**
+ * @brief Fills the ring buffer completely and drains it again
+ */
+template <uint64_t capacity>
+static void BM_RingBuffer_FillDrain (benchmark::State& state)
+{
+  auto ring = std::make_unique<BenchRing<capacity>> ("bench", capacity);
+  for (auto _ : state)
+    {
+      for (uint64_t i = 0; i < capacity; i++)
+	ring->push (Descriptor {i, 64});
+      while (not ring->isEmpty ())
+	benchmark::DoNotOptimize (ring->pop ());
+    }
+  state.SetItemsProcessed (state.iterations() * capacity);
+}
+
+
+BENCHMARK_TEMPLATE(BM_RingBuffer_PushPop, 16);
+BENCHMARK_TEMPLATE(BM_RingBuffer_PushPop, 256);
+BENCHMARK_TEMPLATE(BM_RingBuffer_PushPop, 4096);
+BENCHMARK_TEMPLATE(BM_RingBuffer_FillDrain, 16);
+BENCHMARK_TEMPLATE(BM_RingBuffer_FillDrain, 256);
+BENCHMARK_TEMPLATE(BM_RingBuffer_FillDrain, 4096);
@@ -0,0 +1,306 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+
+/**
+ * @brief Microbenchmarks for ShmFiniteQueue
+ *
+ * The single-process benchmarks measure push and pop of messages of
+ * different sizes without contention. The cross-process benchmarks
+ * fork a child process sharing a segment with two queues with the
+ * parent:
+ *
+ * - Throughput: the parent pushes messages as fast as the queue
+ *   accepts them (yielding when it is full), the child drains the
+ *   queue with popall_wait.
+ * - Latency: the parent sends a message through the ping queue, the
+ *   child returns it through the pong queue; one iteration is one
+ *   round trip. Both sides receive either blocking (pop_wait) or
+ *   polling (pop_nowait), and the segment is optionally backed by
+ *   huge pages. The counter 'thp' reports whether the kernel
+ *   accepted the huge page advice.
+ *
+ * A message carrying the value stopMarker makes the child exit.
+ */
+
+
+#include <cstring>
+#include <format>
+#include <memory>
+#include <thread>
+#include <vector>
+extern "C" {
+#include <sys/wait.h>
+#include <unistd.h>
+}
+#include <benchmark/benchmark.h>
+#include <dcp/common/sharedmem_finite_queue.h>
+#include <dcp/common/sharedmem_structure_base.h>
+
+using dcp::byte;
+using dcp::PopHandler;
+using dcp::PushHandler;
+using dcp::ShmFiniteQueue;
+using dcp::ShmStructureBase;
+
+
+const uint64_t  numberQueueBuffers  = 16;
+const uint64_t  stopMarker          = UINT64_MAX;
+
+
+template <size_t messageSize>
+using BenchQueue = ShmFiniteQueue<numberQueueBuffers, messageSize>;
+
+
+/**
+ * @brief Push handler writing a message of the given size, carrying
+ *        a value in its first eight bytes
+ */
+template <size_t messageSize>
+PushHandler make_push_handler (const byte* payload, uint64_t& value)
+{
+  return [payload, &value] (byte* memaddr, size_t)
+  {
+    std::memcpy (memaddr, payload, messageSize);
+    std::memcpy (memaddr, &value, sizeof(value));
+    return messageSize;
+  };
+}
+
+
+// -----------------------------------------------------------------
+
+
+/**
+ * @brief One push_nowait and one pop_nowait in the same process
+ */
+template <size_t messageSize>
+static void BM_ShmQueue_PushPop (benchmark::State& state)
+{
+  auto queue = std::make_unique<BenchQueue<messageSize>> ("bench", numberQueueBuffers);
+  std::vector<byte> payload (messageSize), received (messageSize);
+  uint64_t value = 0;
+  PushHandler push_handler = make_push_handler<messageSize> (payload.data(), value);
+  PopHandler  pop_handler  = [&] (byte* memaddr, size_t len) { std::memcpy (received.data(), memaddr, len); };
+  bool timed_out, is_full, more;
+  for (auto _ : state)
+    {
+      value++;
+      queue->push_nowait (push_handler, timed_out, is_full);
+      queue->pop_nowait (pop_handler, timed_out, more);
+      benchmark::ClobberMemory ();
+    }
+  state.SetItemsProcessed (state.iterations());
+  state.SetBytesProcessed (state.iterations() * messageSize);
+}
+
+
+// -----------------------------------------------------------------
+
+
+template <size_t messageSize>
+struct QueuePairSegment {
+  BenchQueue<messageSize>  ping;
+  BenchQueue<messageSize>  pong;
+
+  QueuePairSegment ()
+    : ping ("ping", numberQueueBuffers),
+      pong ("pong", numberQueueBuffers)
+  {};
+};
+
+
+/**
+ * @brief Creates a segment holding a pair of queues, forks the
+ *        child running the given function on it and leaves the
+ *        child with _exit(). Returns the segment and the child pid.
+ */
+template <size_t messageSize, typename Fn>
+std::pair<std::unique_ptr<ShmStructureBase>, pid_t> fork_peer (QueuePairSegment<messageSize>*& pSeg, Fn child_fn, bool hugePages = false)
+{
+  static uint64_t instance = 0;
+  const std::string area_name = std::format ("dcp-bench-queue-{}-{}", getpid(), instance++);
+  auto segment = std::make_unique<ShmStructureBase> (area_name.c_str(), sizeof(QueuePairSegment<messageSize>), true, hugePages);
+  pSeg = new (segment->get_memory_address()) QueuePairSegment<messageSize>;
+  pid_t child = fork ();
+  if (child == 0)
+    {
+      child_fn (*pSeg);
+      _exit (0);
+    }
+  return {std::move (segment), child};
+}
+
+
+template <size_t messageSize>
+void send_stop (BenchQueue<messageSize>& queue, const byte* payload)
+{
+  uint64_t value = stopMarker;
+  PushHandler handler = make_push_handler<messageSize> (payload, value);
+  bool timed_out;
+  do {
+    queue.push_wait (handler, timed_out);
+  } while (timed_out);
+}
+
+
+/**
+ * @brief Cross-process throughput, one iteration is one message
+ */
+template <size_t messageSize>
+static void BM_ShmQueue_CrossProcessThroughput (benchmark::State& state)
+{
+  QueuePairSegment<messageSize>* pSeg = nullptr;
+  auto [segment, child] = fork_peer<messageSize> (pSeg, [] (QueuePairSegment<messageSize>& seg)
+  {
+    std::vector<byte> received (messageSize);
+    bool stop = false, timed_out;
+    PopHandler handler = [&] (byte* memaddr, size_t len)
+    {
+      std::memcpy (received.data(), memaddr, len);
+      uint64_t value;
+      std::memcpy (&value, received.data(), sizeof(value));
+      stop = stop or (value == stopMarker);
+    };
+    while (not stop)
+      seg.ping.popall_wait (handler, timed_out);
+  });
+  if (child < 0)
+    {
+      state.SkipWithError ("fork failed");
+      return;
+    }
+
+  std::vector<byte> payload (messageSize);
+  uint64_t value = 0;
+  PushHandler handler = make_push_handler<messageSize> (payload.data(), value);
+  bool timed_out, is_full;
+  for (auto _ : state)
+    {
+      value++;
+      do {
+	pSeg->ping.push_nowait (handler, timed_out, is_full);
+	if (is_full)
+	  std::this_thread::yield ();
+      } while (is_full or timed_out);
+    }
+  send_stop<messageSize> (pSeg->ping, payload.data());
+  waitpid (child, nullptr, 0);
+
+  state.SetItemsProcessed (state.iterations());
+  state.SetBytesProcessed (state.iterations() * messageSize);
+}
+
+
+/**
+ * @brief Pops one message from the queue, either blocking or
+ *        polling. When polling, yields between attempts, otherwise
+ *        on a single core the poller spins away the time slice of
+ *        its peer.
+ */
+template <size_t messageSize>
+void receive_one (BenchQueue<messageSize>& in, PopHandler& handler, bool& got, bool polling)
+{
+  bool timed_out, more;
+  while (not got)
+    {
+      if (polling)
+	{
+	  in.pop_nowait (handler, timed_out, more);
+	  if (not got)
+	    std::this_thread::yield ();
+	}
+      else
+	in.pop_wait (handler, timed_out, more);
+    }
+}
+
+
+/**
+ * @brief Cross-process round trip, one iteration is one round
+ *        trip. Arguments: polling receivers (0/1), huge pages (0/1)
+ */
+template <size_t messageSize>
+static void BM_ShmQueue_CrossProcessRoundTrip (benchmark::State& state)
+{
+  const bool polling    = state.range(0) != 0;
+  const bool hugePages  = state.range(1) != 0;
+
+  auto echo = [polling] (BenchQueue<messageSize>& in, BenchQueue<messageSize>& out, uint64_t& value, const byte* payload)
+  {
+    bool timed_out, got = false;
+    PopHandler pop_handler = [&] (byte* memaddr, size_t) { std::memcpy (&value, memaddr, sizeof(value)); got = true; };
+    receive_one<messageSize> (in, pop_handler, got, polling);
+    if (value == stopMarker)
+      return;
+    PushHandler push_handler = make_push_handler<messageSize> (payload, value);
+    do {
+      out.push_wait (push_handler, timed_out);
+    } while (timed_out);
+  };
+
+  QueuePairSegment<messageSize>* pSeg = nullptr;
+  auto [segment, child] = fork_peer<messageSize> (pSeg, [&] (QueuePairSegment<messageSize>& seg)
+  {
+    std::vector<byte> payload (messageSize);
+    uint64_t value = 0;
+    while (value != stopMarker)
+      echo (seg.ping, seg.pong, value, payload.data());
+  }, hugePages);
+  if (child < 0)
+    {
+      state.SkipWithError ("fork failed");
+      return;
+    }
+
+  std::vector<byte> payload (messageSize);
+  uint64_t value = 0, returned = 0;
+  PushHandler push_handler = make_push_handler<messageSize> (payload.data(), value);
+  bool timed_out;
+  for (auto _ : state)
+    {
+      value++;
+      do {
+	pSeg->ping.push_wait (push_handler, timed_out);
+      } while (timed_out);
+      bool got = false;
+      PopHandler pop_handler = [&] (byte* memaddr, size_t) { std::memcpy (&returned, memaddr, sizeof(returned)); got = true; };
+      receive_one<messageSize> (pSeg->pong, pop_handler, got, polling);
+      if (returned != value)
+	{
+	  state.SkipWithError ("message lost or reordered");
+	  break;
+	}
+    }
+  send_stop<messageSize> (pSeg->ping, payload.data());
+  waitpid (child, nullptr, 0);
+
+  state.SetItemsProcessed (state.iterations());
+  state.counters["thp"] = segment->get_thp_advised() ? 1 : 0;
+}
+
+
+BENCHMARK_TEMPLATE(BM_ShmQueue_PushPop, 64);
+BENCHMARK_TEMPLATE(BM_ShmQueue_PushPop, 512);
+BENCHMARK_TEMPLATE(BM_ShmQueue_PushPop, 2048);
+BENCHMARK_TEMPLATE(BM_ShmQueue_CrossProcessThroughput, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ShmQueue_CrossProcessThroughput, 2048)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ShmQueue_CrossProcessRoundTrip, 64)->ArgsProduct({{0, 1}, {0, 1}})->ArgNames({"polling", "hugepages"})->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ShmQueue_CrossProcessRoundTrip, 2048)->ArgsProduct({{0, 1}, {0, 1}})->ArgNames({"polling", "hugepages"})->UseRealTime();
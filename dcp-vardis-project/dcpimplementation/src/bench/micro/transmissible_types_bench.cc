@@ -0,0 +1,207 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+
+/**
+ * @brief Microbenchmarks for serializing and deserializing the
+ *        transmissible types found on the receive and transmit
+ *        paths: the BP header, the SRP payload and Vardis updates
+ *        with values of different sizes
+ */
+
+
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <dcp/common/area.h>
+#include <dcp/bp/bp_transmissible_types.h>
+#include <dcp/srp/srp_transmissible_types.h>
+#include <dcp/vardis/vardis_transmissible_types.h>
+#include "bench_helpers.h"
+
+using dcp::byte;
+using dcp::MemoryChunkAssemblyArea;
+using dcp::MemoryChunkDisassemblyArea;
+using dcp::NodeIdentifierT;
+using dcp::TimeStampT;
+using dcp::bp::BPHeaderT;
+using dcp::srp::SafetyDataT;
+using dcp::srp::SRPPayloadT;
+using dcp::srp::SRPQuantizationParameters;
+using dcp::vardis::VarIdT;
+using dcp::vardis::VarLenT;
+using dcp::vardis::VarSeqnoT;
+using dcp::vardis::VarUpdateT;
+using dcp::vardis::VarValueT;
+
+
+static void BM_TT_BPHeader_Serialize (benchmark::State& state)
+{
+  BPHeaderT hdr;
+  hdr.senderId     = NodeIdentifierT ("01:02:03:04:05:06");
+  hdr.length       = 500;
+  hdr.numPayloads  = 2;
+  hdr.seqno        = 4711;
+  byte buffer [BPHeaderT::fixed_size()];
+  for (auto _ : state)
+    {
+      MemoryChunkAssemblyArea area ("bench", sizeof(buffer), buffer);
+      hdr.serialize (area);
+      benchmark::ClobberMemory ();
+    }
+  state.SetItemsProcessed (state.iterations());
+}
+
+
+static void BM_TT_BPHeader_Deserialize (benchmark::State& state)
+{
+  BPHeaderT hdr;
+  byte buffer [BPHeaderT::fixed_size()];
+  MemoryChunkAssemblyArea ass_area ("bench", sizeof(buffer), buffer);
+  hdr.serialize (ass_area);
+  for (auto _ : state)
+    {
+      MemoryChunkDisassemblyArea area ("bench", sizeof(buffer), buffer);
+      BPHeaderT hdr2;
+      hdr2.deserialize (area);
+      benchmark::DoNotOptimize (hdr2);
+    }
+  state.SetItemsProcessed (state.iterations());
+}
+
+
+// -----------------------------------------------------------------
+
+
+SRPPayloadT make_srp_payload (bool withVelocity, const SRPQuantizationParameters& qp)
+{
+  SafetyDataT sd;
+  sd.position_x   = 1234.567;
+  sd.position_y   = -1987.654;
+  sd.position_z   = 12.34;
+  sd.has_velocity = withVelocity;
+  sd.speed        = 13.89;
+  sd.heading      = 90;
+  SRPPayloadT pld;
+  pld.encode (sd, NodeIdentifierT ("01:02:03:04:05:06"), 77, 250, qp);
+  return pld;
+}
+
+
+/**
+ * @brief Encodes and serializes an SRP payload, argument selects
+ *        whether it carries the velocity extension
+ */
+static void BM_TT_SRPPayload_EncodeSerialize (benchmark::State& state)
+{
+  SRPQuantizationParameters qp;
+  bool withVelocity = state.range(0) != 0;
+  byte buffer [SRPPayloadT::max_size()];
+  for (auto _ : state)
+    {
+      SRPPayloadT pld = make_srp_payload (withVelocity, qp);
+      MemoryChunkAssemblyArea area ("bench", sizeof(buffer), buffer);
+      pld.serialize (area);
+      benchmark::ClobberMemory ();
+    }
+  state.SetItemsProcessed (state.iterations());
+}
+
+
+/**
+ * @brief Deserializes and decodes an SRP payload
+ */
+static void BM_TT_SRPPayload_DeserializeDecode (benchmark::State& state)
+{
+  SRPQuantizationParameters qp;
+  byte buffer [SRPPayloadT::max_size()];
+  MemoryChunkAssemblyArea ass_area ("bench", sizeof(buffer), buffer);
+  make_srp_payload (state.range(0) != 0, qp).serialize (ass_area);
+  TimeStampT now = TimeStampT::get_current_system_time ();
+  for (auto _ : state)
+    {
+      MemoryChunkDisassemblyArea area ("bench", ass_area.used(), buffer);
+      SRPPayloadT pld;
+      pld.deserialize (area);
+      benchmark::DoNotOptimize (pld.decode (qp, now));
+    }
+  state.SetItemsProcessed (state.iterations());
+}
+
+
+// -----------------------------------------------------------------
+
+
+/**
+ * @brief Serializes a Vardis update with a value of the given size
+ */
+static void BM_TT_VarUpdate_Serialize (benchmark::State& state)
+{
+  std::vector<byte> value = dcp::bench::random_bytes (state.range(0));
+  VarUpdateT upd;
+  upd.varId = VarIdT (17);
+  upd.seqno = VarSeqnoT (47);
+  upd.value = VarValueT (VarLenT (value.size()), value.data());
+  std::vector<byte> buffer (upd.total_size());
+  for (auto _ : state)
+    {
+      MemoryChunkAssemblyArea area ("bench", buffer.size(), buffer.data());
+      upd.serialize (area);
+      benchmark::ClobberMemory ();
+    }
+  state.SetItemsProcessed (state.iterations());
+  state.SetBytesProcessed (state.iterations() * buffer.size());
+}
+
+
+/**
+ * @brief Deserializes a Vardis update with a value of the given
+ *        size, copying the value (range(1) == 0) or as a view into
+ *        the receive buffer (range(1) == 1)
+ */
+static void BM_TT_VarUpdate_Deserialize (benchmark::State& state)
+{
+  std::vector<byte> value = dcp::bench::random_bytes (state.range(0));
+  VarUpdateT upd;
+  upd.value = VarValueT (VarLenT (value.size()), value.data());
+  std::vector<byte> buffer (upd.total_size());
+  MemoryChunkAssemblyArea ass_area ("bench", buffer.size(), buffer.data());
+  upd.serialize (ass_area);
+  const bool asView = state.range(1) != 0;
+  for (auto _ : state)
+    {
+      MemoryChunkDisassemblyArea area ("bench", buffer.size(), buffer.data());
+      VarUpdateT upd2;
+      if (asView)
+	upd2.deserialize_view (area);
+      else
+	upd2.deserialize (area);
+      benchmark::DoNotOptimize (upd2);
+    }
+  state.SetItemsProcessed (state.iterations());
+  state.SetBytesProcessed (state.iterations() * buffer.size());
+}
+
+
+BENCHMARK(BM_TT_BPHeader_Serialize);
+BENCHMARK(BM_TT_BPHeader_Deserialize);
+BENCHMARK(BM_TT_SRPPayload_EncodeSerialize)->Arg(0)->Arg(1);
+BENCHMARK(BM_TT_SRPPayload_DeserializeDecode)->Arg(0)->Arg(1);
+BENCHMARK(BM_TT_VarUpdate_Serialize)->Arg(8)->Arg(64)->Arg(255);
+BENCHMARK(BM_TT_VarUpdate_Deserialize)->ArgsProduct({{8, 64, 255}, {0, 1}});
@@ -0,0 +1,178 @@
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/program_options.hpp>
+#include <dcp/common/exceptions.h>
+#include <dcp/common/global_types_constants.h>
+#include <dcp/common/metrics.h>
+#include <dcp/common/other_helpers.h>
+#include <dcp/bp/bp_configuration.h>
+#include <dcp/srp/srp_constants.h>
+#include <dcp/vardis/vardis_constants.h>
+
+
+/**
+ * @brief Prints the metrics of the BP, SRP and Vardis demons, read
+ *        from their metrics areas in shared memory. The tool only
+ *        maps the areas read-only and never interacts with the
+ *        demons, so it can be run at any rate.
+ */
+
+
+using std::cerr;
+using std::cout;
+using std::endl;
+
+using namespace dcp;
+
+namespace po = boost::program_options;
+
+
+void print_version ()
+{
+  cout << dcp::dcpHighlevelDescription
+       << " -- version " << dcp::dcpVersionNumber
+       << endl;
+}
+
+
+bool       exitFlag = false;
+
+void signalHandler (int)
+{
+  exitFlag = true;
+}
+
+
+void print_area (const std::string& area_name, const MetricsArea& area)
+{
+  cout << "=== " << area.owner << " (" << area_name << ") ===" << endl;
+
+  for (uint32_t i = 0; i < area.get_number_counters(); i++)
+    cout << "  " << std::left << std::setw(36) << area.counters[i].name
+	 << std::right << std::setw(14) << area.counters[i].metric.get() << endl;
+
+  for (uint32_t i = 0; i < area.get_number_gauges(); i++)
+    cout << "  " << std::left << std::setw(36) << area.gauges[i].name
+	 << std::right << std::setw(14) << area.gauges[i].metric.get() << endl;
+
+  uint32_t numberHistograms = area.get_number_histograms();
+  if (numberHistograms == 0)
+    return;
+  cout << "  " << std::left << std::setw(36) << "histogram (ns)" << std::right
+       << std::setw(14) << "count"
+       << std::setw(12) << "mean"
+       << std::setw(12) << "p50"
+       << std::setw(12) << "p90"
+       << std::setw(12) << "p99"
+       << std::setw(12) << "max"
+       << endl;
+  for (uint32_t i = 0; i < numberHistograms; i++)
+    {
+      HistogramSnapshot snap = area.histograms[i].metric.snapshot ();
+      cout << "  " << std::left << std::setw(36) << area.histograms[i].name << std::right
+	   << std::setw(14) << snap.count
+	   << std::setw(12) << std::fixed << std::setprecision(0) << snap.mean()
+	   << std::setw(12) << snap.percentile (0.5)
+	   << std::setw(12) << snap.percentile (0.9)
+	   << std::setw(12) << snap.percentile (0.99)
+	   << std::setw(12) << snap.max
+	   << endl;
+    }
+}
+
+
+int main (int argc, char* argv [])
+{
+  std::vector<std::string> area_names;
+  uint32_t                 interval_ms = 0;
+
+  po::options_description desc("Allowed options");
+  desc.add_options()
+    ("help,h",         "produce help message and exit")
+    ("version,v",      "show version information and exit")
+    ("area,a",         po::value<std::vector<std::string>>(&area_names), "name of a metrics area to read (can be repeated), default are the areas of the BP, SRP and Vardis demons")
+    ("interval,i",     po::value<uint32_t>(&interval_ms)->default_value(0), "repeat every given number of milliseconds until interrupted, 0 to print once")
+    ;
+
+  try {
+    po::variables_map vm;
+    po::store (po::command_line_parser(argc, argv).options(desc).run(), vm);
+    po::notify(vm);
+
+    if (vm.count("help"))
+      {
+	cout << std::string (argv[0]) << " [-a <areaname>]* [-i <intervalMS>]" << endl;
+	cout << desc << endl;
+	return EXIT_SUCCESS;
+      }
+
+    if (vm.count("version"))
+      {
+	print_version();
+	return EXIT_SUCCESS;
+      }
+  }
+  catch(std::exception& e) {
+    cerr << argv[0] << ": option error. Exiting." << endl;
+    cerr << e.what() << endl;
+    cerr << desc << endl;
+    return EXIT_FAILURE;
+  }
+
+  // areas of demons that are not running are skipped silently
+  // unless explicitly asked for
+  bool explicitAreas = not area_names.empty();
+  if (not explicitAreas)
+    area_names = { dcp::bp::defaultBPMetricsShmName, dcp::srp::defaultSRPMetricsShmName, dcp::vardis::defaultVardisMetricsShmName };
+
+  std::signal(SIGTERM, signalHandler);
+  std::signal(SIGINT, signalHandler);
+
+  try {
+    std::vector<std::pair<std::string, std::unique_ptr<MetricsReader>>> readers;
+    for (const auto& name : area_names)
+      {
+	try {
+	  readers.push_back ({name, std::make_unique<MetricsReader> (name)});
+	}
+	catch (MetricsException& e)
+	  {
+	    if (explicitAreas)
+	      throw;
+	  }
+      }
+    if (readers.empty())
+      {
+	cout << "No metrics area found (no demon running?). Exiting." << endl;
+	return EXIT_FAILURE;
+      }
+
+    do {
+      for (const auto& [name, reader] : readers)
+	print_area (name, reader->get_area());
+      if (interval_ms > 0)
+	{
+	  std::this_thread::sleep_for (std::chrono::milliseconds (interval_ms));
+	  cout << endl;
+	}
+    } while ((interval_ms > 0) and not exitFlag);
+  }
+  catch (DcpException& e)
+    {
+      print_exiting_dcp_exception (e);
+      return EXIT_FAILURE;
+    }
+  catch (std::exception& e)
+    {
+      cout << "Caught an exception, got " << e.what() << ". Exiting." << endl;
+      return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -122,6 +122,7 @@ int main (int argc, char* argv [])
 	 << "   countDelete  = " << (int) var_descr.countDelete.val << "\n"
 	 << std::boolalpha
 	 << "   isDeleted    = " << var_descr.isDeleted << "\n"
+	 << "   isStale      = " << var_descr.isStale << "\n"
 	 << "   value_length = " << (int) var_descr.value_length.val << "\n"
 	 << "   data         = " << byte_array_to_string (buffer, std::min (32, (int) var_descr.value_length.val)) << "\n"
 	 << endl;
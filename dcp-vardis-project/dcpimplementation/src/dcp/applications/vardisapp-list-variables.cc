@@ -103,6 +103,7 @@ int main (int argc, char* argv [])
 	     << ", descr = " << descr.description
 	     << ", tStamp = " << descr.tStamp
 	     << ", isDeleted = " << descr.isDeleted
+	     << ", isStale = " << descr.isStale
 	<< endl;
       } 
   }
@@ -64,7 +64,7 @@ VardisTestVariable generate_new_value (boost::normal_distribution<> distribution
 
 void output_cmdline_guidance (char* argv[])
 {
-  cout << std::string (argv[0]) << " [-s <sockname>] [-mc <shmcli>] [-mg <shmgdb>] <varId> <genperiodMS> <average> <stddev>" << endl;
+  cout << std::string (argv[0]) << " [-s <sockname>] [-mc <shmcli>] [-mg <shmgdb>] [--prio <class>] [--mininterval <ms>] <varId> <genperiodMS> <average> <stddev>" << endl;
 }
 
 
@@ -77,6 +77,8 @@ int main (int argc, char* argv [])
   int     periodTmp = 0;
   double  average = 0;
   double  stddev = 0;
+  int     prioTmp = dcp::vardis::VARDIS_PRIO_NORMAL;
+  int     minIntervalTmp = 0;
 
   
   po::options_description desc("Allowed options");
@@ -90,6 +92,8 @@ int main (int argc, char* argv [])
     ("period",         po::value<int>(&periodTmp), "Generation period (in ms)")
     ("average",        po::value<double>(&average), "Average of generated Gaussian")
     ("stddev",         po::value<double>(&stddev), "Standard deviation of generated Gaussian")
+    ("prio",           po::value<int>(&prioTmp)->default_value(dcp::vardis::VARDIS_PRIO_NORMAL), "Priority class of variable (0 = critical, 3 = low)")
+    ("mininterval",    po::value<int>(&minIntervalTmp)->default_value(0), "Minimum interval between transmitted updates (in ms, 0 = none)")
     ;
 
   po::positional_options_description desc_pos;
@@ -133,6 +137,18 @@ int main (int argc, char* argv [])
 	cout << "Varid outside allowed range. Aborting." << endl;
 	return EXIT_FAILURE;
       }
+
+    if ((prioTmp < 0) || (prioTmp > dcp::vardis::VarPriorityT::max_val()))
+      {
+	cout << "Priority class outside allowed range. Aborting." << endl;
+	return EXIT_FAILURE;
+      }
+
+    if ((minIntervalTmp < 0) || (minIntervalTmp > dcp::vardis::VarIntervalT::max_val()))
+      {
+	cout << "Minimum update interval outside allowed range. Aborting." << endl;
+	return EXIT_FAILURE;
+      }
     
     if ((periodTmp <= 0) || (periodTmp > std::numeric_limits<uint16_t>::max()))
       {
@@ -177,11 +193,13 @@ int main (int argc, char* argv [])
     VardisClientRuntime cl_rt (cl_conf, true, true);
 
     VarSpecT spec;
-    spec.varId   = varId;
-    spec.prodId  = cl_rt.get_own_node_identifier();
-    spec.repCnt  = 1;
-    spec.timeout = 10000;
-    spec.descr   = StringT (std::format("vardis-testvar-{}", (int) varId.val));
+    spec.varId       = varId;
+    spec.prodId      = cl_rt.get_own_node_identifier();
+    spec.repCnt      = 1;
+    spec.timeout     = 10000;
+    spec.prio        = prioTmp;
+    spec.minInterval = minIntervalTmp;
+    spec.descr       = StringT (std::format("vardis-testvar-{}", (int) varId.val));
     
     VardisTestVariable initial_varval = generate_new_value (distribution);
     VarValueT initial_value (sizeof(VardisTestVariable), (byte*) &initial_varval);
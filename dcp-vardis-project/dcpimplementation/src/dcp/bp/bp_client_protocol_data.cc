@@ -25,10 +25,11 @@ namespace dcp::bp {
 
   BPClientProtocolData::BPClientProtocolData (const char* area_name,
 					      BPStaticClientInfo static_info,
-					      bool gen_pld_confirms)
+					      bool gen_pld_confirms,
+					      bool useHugePages)
     : static_info (static_info)
   {
-    pSSB = std::make_shared<ShmStructureBase> (area_name, sizeof(BPShmControlSegment), true);
+    pSSB = std::make_shared<ShmStructureBase> (area_name, sizeof(BPShmControlSegment), true, useHugePages);
     pSCS = (BPShmControlSegment*) pSSB->get_memory_address ();
     if (!pSCS)
       throw ShmException ("BPClientProtocolData",
@@ -36,6 +37,15 @@ namespace dcp::bp {
     
     new (pSCS) BPShmControlSegment (static_info, gen_pld_confirms);
   }
+
+
+  BPClientProtocolData::BPClientProtocolData (BPStaticClientInfo static_info,
+					      bool gen_pld_confirms)
+    : static_info (static_info)
+  {
+    pLocalSCS = std::make_shared<BPShmControlSegment> (static_info, gen_pld_confirms);
+    pSCS      = pLocalSCS.get ();
+  }
   
 
   BPClientProtocolData::~BPClientProtocolData ()
@@ -85,6 +85,14 @@ namespace dcp::bp {
      */
     BPShmControlSegment*                 pSCS = nullptr;
 
+
+    /**
+     * @brief Owns the control segment of a client protocol running in
+     *        the same process as BP (see BPLocalRegistrar), pSSB is
+     *        empty in this case
+     */
+    std::shared_ptr<BPShmControlSegment> pLocalSCS;
+
     
     
     /**************************************************************
@@ -106,7 +114,22 @@ namespace dcp::bp {
 
     BPClientProtocolData () {};
 
-    BPClientProtocolData (const char* area_name, BPStaticClientInfo static_info, bool gen_pld_confirms);
+    BPClientProtocolData (const char* area_name, BPStaticClientInfo static_info, bool gen_pld_confirms, bool useHugePages = false);
+
+
+    /**
+     * @brief Constructor for a client protocol running in the same
+     *        process as BP, the control segment is allocated in
+     *        process memory
+     */
+    BPClientProtocolData (BPStaticClientInfo static_info, bool gen_pld_confirms);
+
+
+    /**
+     * @brief Checks whether the client protocol runs in the same
+     *        process as BP
+     */
+    inline bool is_local () const { return (pLocalSCS != nullptr); };
 
 
     ~BPClientProtocolData ();
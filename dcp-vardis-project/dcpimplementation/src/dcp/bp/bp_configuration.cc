@@ -48,6 +48,7 @@ namespace dcp::bp {
       // Other parameters (e.g. run-time statistics)
       (opt("interBeaconTimeEWMAAlpha").c_str(),      po::value<double>(&interBeaconTimeEWMAAlpha)->default_value(defaultValueInterBeaconTimeEWMAAlpha), txt("BP: alpha value for EWMA estimator of inter-beacon reception time in ms (between 0 and 1)").c_str())
       (opt("beaconSizeEWMAAlpha").c_str(),      po::value<double>(&beaconSizeEWMAAlpha)->default_value(defaultValueBeaconSizeEWMAAlpha), txt("BP: alpha value for EWMA estimator of beacon size in bytes (between 0 and 1)").c_str())
+      (opt("sharedMemHugePages").c_str(),       po::value<bool>(&sharedMemHugePages)->default_value(defaultValueSharedMemHugePages), txt("BP: map client protocol shared memory segments with transparent huge pages").c_str())
       
       ;
   }
@@ -100,15 +101,21 @@ namespace dcp::bp {
        << " , ownNetworkIdentifier = " << cfg.bp_conf.ownNetworkIdentifier
        << " , interBeaconTimeEWMAAlpha = " << cfg.bp_conf.interBeaconTimeEWMAAlpha
        << " , beaconSizeEWMAAlpha = " << cfg.bp_conf.beaconSizeEWMAAlpha
+       << " , sharedMemHugePages = " << cfg.bp_conf.sharedMemHugePages
       
        << " , loggingToConsole = " << cfg.logging_conf.loggingToConsole
        << " , logfileNamePrefix = " << cfg.logging_conf.logfileNamePrefix
        << " , logAutoFlush = " << cfg.logging_conf.logAutoFlush
        << " , minimumSeverityLevel = " << cfg.logging_conf.minimumSeverityLevel
        << " , rotationSize = " << cfg.logging_conf.rotationSize
+       << " , asyncLogging = " << cfg.logging_conf.asyncLogging
+       << " , asyncBufferSize = " << cfg.logging_conf.asyncBufferSize
+       << " , asyncDrainIntervalMS = " << cfg.logging_conf.asyncDrainIntervalMS
       
        << " , commandSocketFile = " << cfg.cmdsock_conf.commandSocketFile
        << " , commandSocketTimeoutMS = " << cfg.cmdsock_conf.commandSocketTimeoutMS
+       << " , shmAreaNameMetrics = " << cfg.metrics_conf.shmAreaName
+       << " , " << cfg.realtime_conf
        << " }";
     return os;
   }
@@ -25,6 +25,8 @@
 #include <dcp/common/command_socket.h>
 #include <dcp/common/configuration.h>
 #include <dcp/common/logging_helpers.h>
+#include <dcp/common/realtime.h>
+#include <dcp/common/sharedmem_configuration.h>
 #include <dcp/bp/bp_configuration.h>
 
 namespace po = boost::program_options;
@@ -44,6 +46,8 @@ namespace dcp::bp {
   const double        defaultValueInterBeaconTimeEWMAAlpha    = 0.975;
   const double        defaultValueBeaconSizeEWMAAlpha         = 0.975;
   const uint16_t      defaultValueOwnNetworkIdentifier        = 0x1111; 
+  const bool          defaultValueSharedMemHugePages          = false;
+  const std::string   defaultBPMetricsShmName                 = "shm-area-bp-metrics";
   
     /**
      * @brief This struct contains the configuration data for BP to operate on.
@@ -135,6 +139,13 @@ namespace dcp::bp {
        *        received beacon size (in bytes)
        */
       double  beaconSizeEWMAAlpha      = defaultValueBeaconSizeEWMAAlpha;
+
+
+      /**
+       * @brief Whether the shared memory segments created for client
+       *        protocols are mapped with transparent huge pages
+       */
+      bool    sharedMemHugePages       = defaultValueSharedMemHugePages;
       
             
       /**************************************************
@@ -180,17 +191,21 @@ namespace dcp::bp {
     LoggingConfigurationBlock          logging_conf;
     CommandSocketConfigurationBlock    cmdsock_conf;
     BPConfigurationBlock               bp_conf;
+    SharedMemoryConfigurationBlock     metrics_conf;
+    RealtimeConfigurationBlock         realtime_conf;
 
 
     /**
      * @brief Constructor, setting section names in config file and
-     *        default names for log file prefix and command socket
-     *        name
+     *        default names for log file prefix, command socket name
+     *        and metrics area
      */
     BPConfiguration ()
       : logging_conf ("logging")
       , cmdsock_conf ("BPCommandSocket")
       , bp_conf ("BP")
+      , metrics_conf ("BPMetricsShm", defaultBPMetricsShmName)
+      , realtime_conf ("BPRealtime", {"managementCommand", "managementPayload", "transmitter", "receiver"})
     {
       logging_conf.logfileNamePrefix = "dcp-bp-log";
       cmdsock_conf.commandSocketFile = "/tmp/dcp-bp-command-socket";
@@ -206,6 +221,8 @@ namespace dcp::bp {
       logging_conf.add_options (cfgdesc);
       cmdsock_conf.add_options (cfgdesc);
       bp_conf.add_options (cfgdesc);
+      metrics_conf.add_options (cfgdesc, defaultBPMetricsShmName);
+      realtime_conf.add_options (cfgdesc);
     };
 
 
@@ -218,6 +235,8 @@ namespace dcp::bp {
       logging_conf.validate();
       cmdsock_conf.validate();
       bp_conf.validate();
+      metrics_conf.validate();
+      realtime_conf.validate();
     };
 
     
@@ -0,0 +1,78 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+
+#pragma once
+
+#include <dcp/common/global_types_constants.h>
+#include <dcp/common/services_status.h>
+#include <dcp/bp/bp_client_static_info.h>
+#include <dcp/bp/bp_shm_control_segment.h>
+
+
+/**
+ * @brief This module defines the interface through which a BP client
+ *        protocol that runs in the same process as the BP demon (see
+ *        dcpmain-stack) registers and deregisters with BP by direct
+ *        function calls instead of going through the command socket.
+ *
+ * The control segment of such a client is not placed into a shared
+ * memory area but into ordinary process memory owned by BP, the
+ * payload exchange then works exactly as for external clients.
+ */
+
+
+namespace dcp::bp {
+
+  class BPLocalRegistrar {
+  public:
+
+    virtual ~BPLocalRegistrar () {};
+
+
+    /**
+     * @brief Registers a client protocol hosted in the same process
+     *
+     * @param static_info: static information about the client
+     *        protocol (name, queueing mode etc)
+     * @param gen_pld_confirms: whether BP should generate
+     *        BP-TransmitPayload.confirm primitives
+     * @param pSCS: output parameter, control segment for payload
+     *        exchange, valid until the protocol is deregistered
+     * @param ownNodeIdentifier: output parameter, own node identifier
+     *
+     * @return BP_STATUS_OK or the same status values as the
+     *         BP-RegisterProtocol service
+     */
+    virtual DcpStatus register_local_protocol (const BPStaticClientInfo& static_info,
+					       bool gen_pld_confirms,
+					       BPShmControlSegment*& pSCS,
+					       NodeIdentifierT& ownNodeIdentifier) = 0;
+
+
+    /**
+     * @brief Deregisters a client protocol registered through
+     *        register_local_protocol(), its control segment becomes
+     *        invalid
+     */
+    virtual DcpStatus deregister_local_protocol (BPProtocolIdT protocolId) = 0;
+  };
+
+};  // namespace dcp::bp
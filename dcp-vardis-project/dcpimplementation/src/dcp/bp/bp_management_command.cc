@@ -21,6 +21,7 @@
 #include <chrono>
 #include <exception>
 #include <functional>
+#include <mutex>
 #include <thread>
 extern "C" {
 #include <sys/socket.h>
@@ -159,38 +160,17 @@ namespace dcp::bp {
   
   // ------------------------------------------------------------------
 
-  void handleBPRegisterProtocol_Request (BPRuntimeData& runtime, byte* buffer, size_t nbytes)
+  DcpStatus add_client_protocol (BPRuntimeData& runtime,
+				 const BPStaticClientInfo& sci,
+				 bool gen_pld_confirms,
+				 const char* shm_area_name)
   {
-    if (nbytes != sizeof(BPRegisterProtocol_Request))
-      {
-	DCPLOG_FATAL(log_mgmt_command)
-	    << "Processing BPRegisterProtocol request: wrong data size = "
-	    << nbytes
-	    << ". Exiting"
-           ;
-	runtime.bp_exitFlag = true;
-	sendRegisterConfirmation(runtime, BP_STATUS_INTERNAL_ERROR);
-	return;
-      }
-
-    BPRegisterProtocol_Request*  pReq = (BPRegisterProtocol_Request*) buffer;
-    BPStaticClientInfo& sci = pReq->static_info;
-    DCPLOG_INFO(log_mgmt_command)
-      << "Processing request: RegisterProtocol, protocolId = " << sci.protocolId
-      << " , name = " << sci.protocolName
-      << " , maxPayloadSize = " << sci.maxPayloadSize
-      << " , queueingMode = " << bp_queueing_mode_to_string (sci.queueingMode)
-      << " , maxEntries = " << sci.maxEntries
-      << " , allowMultiplePayloads = " << sci.allowMultiplePayloads;
-
     // check whether client protocol already exists
     if (runtime.clientProtocols.contains (sci.protocolId))
       {
 	DCPLOG_ERROR(log_mgmt_command)
 	  << "Processing BPRegisterProtocol request: protocol already exists";
-
-	sendRegisterConfirmation(runtime, BP_STATUS_PROTOCOL_ALREADY_REGISTERED);
-	return;
+	return BP_STATUS_PROTOCOL_ALREADY_REGISTERED;
       }
 
     // check if maxPayloadSize is not strictly positive
@@ -198,9 +178,7 @@ namespace dcp::bp {
       {
 	DCPLOG_ERROR(log_mgmt_command)
 	  << "Processing BPRegisterProtocol request: max payload size <= 0";
-
-	sendRegisterConfirmation(runtime, BP_STATUS_ILLEGAL_MAX_PAYLOAD_SIZE);
-	return;
+	return BP_STATUS_ILLEGAL_MAX_PAYLOAD_SIZE;
       }
 
     // check if maxPayloadSize is too large
@@ -208,9 +186,7 @@ namespace dcp::bp {
       {
 	DCPLOG_ERROR(log_mgmt_command)
 	  << "Processing BPRegisterProtocol request: max payload size exceeds allowed maximum";
-
-	sendRegisterConfirmation(runtime, BP_STATUS_ILLEGAL_MAX_PAYLOAD_SIZE);
-	return;
+	return BP_STATUS_ILLEGAL_MAX_PAYLOAD_SIZE;
       }
 
     // check maxEntries value
@@ -220,14 +196,14 @@ namespace dcp::bp {
       {
 	DCPLOG_ERROR(log_mgmt_command)
 	  << "Processing BPRegisterProtocol request: illegal dropping queue size";
-
-	sendRegisterConfirmation(runtime, BP_STATUS_ILLEGAL_DROPPING_QUEUE_SIZE);
-	return;
+	return BP_STATUS_ILLEGAL_DROPPING_QUEUE_SIZE;
       }
 
     // Now create and initialize new client protocol data entry and add it to the list of registered protocols
-    BPClientProtocolData clientProt (pReq->shm_area_name, pReq->static_info, pReq->generateTransmitPayloadConfirms);
-    clientProt.static_info                   =  pReq->static_info;
+    BPClientProtocolData clientProt = shm_area_name
+      ? BPClientProtocolData (shm_area_name, sci, gen_pld_confirms, runtime.bp_config.bp_conf.sharedMemHugePages)
+      : BPClientProtocolData (sci, gen_pld_confirms);
+    clientProt.static_info                   =  sci;
     clientProt.timeStampRegistration         =  TimeStampT::get_current_system_time();
     //clientProt.bufferOccupied                =  false;
 
@@ -242,9 +218,73 @@ namespace dcp::bp {
     DCPLOG_INFO(log_mgmt_command)
       << "Processing BPRegisterProtocol request: completed successful registration of protocolId "
       << sci.protocolId
+      << (shm_area_name ? "" : " (in-process)")
       << ", runtime.clientProt.pSCS = " << (void*) runtime.clientProtocols[sci.protocolId].pSCS
       ; 
-    sendRegisterConfirmation(runtime, BP_STATUS_OK);
+    return BP_STATUS_OK;
+  }
+  
+  // ------------------------------------------------------------------
+
+  DcpStatus remove_client_protocol (BPRuntimeData& runtime, BPProtocolIdT protocolId)
+  {
+    // check whether client protocol exists
+    if (not runtime.clientProtocols.contains (protocolId))
+      {
+	DCPLOG_INFO(log_mgmt_command)
+	  << "Processing BPDerregisterProtocol request: protocol is not registered";
+	return BP_STATUS_UNKNOWN_PROTOCOL;
+      }
+
+    BPClientProtocolData& the_client_prot = runtime.clientProtocols[protocolId];
+    auto pSSB = the_client_prot.pSSB;
+    if (pSSB)
+      {
+	DCPLOG_TRACE(log_mgmt_command)
+	  << "Processing BPDerregisterProtocol request: BEFORE erasing: "
+	  << "this = " << (void*) (&the_client_prot)
+	  << ", pSCS = " << (void*) the_client_prot.pSCS
+	  << ", pSSB.use_count = " << pSSB.use_count()
+	  << ", shm_memory_address() = " << (void*) pSSB->get_memory_address()
+	  << ", shm_name() = " << pSSB->get_name()
+	  << ", shm_structure_size = " << pSSB->get_structure_size()
+	  << ", shm_is_creator = " << pSSB->get_is_creator()
+	  << ", shm_has_valid_memory = " << pSSB->has_valid_memory()
+	  ;
+      }
+    runtime.clientProtocols.erase(protocolId);
+    
+    DCPLOG_INFO(log_mgmt_command) << "Processing BPDeregisterProtocol request: erased registered protocol";
+    return BP_STATUS_OK;
+  }
+  
+  // ------------------------------------------------------------------
+
+  void handleBPRegisterProtocol_Request (BPRuntimeData& runtime, byte* buffer, size_t nbytes)
+  {
+    if (nbytes != sizeof(BPRegisterProtocol_Request))
+      {
+	DCPLOG_FATAL(log_mgmt_command)
+	    << "Processing BPRegisterProtocol request: wrong data size = "
+	    << nbytes
+	    << ". Exiting"
+           ;
+	runtime.bp_exitFlag = true;
+	sendRegisterConfirmation(runtime, BP_STATUS_INTERNAL_ERROR);
+	return;
+      }
+
+    BPRegisterProtocol_Request*  pReq = (BPRegisterProtocol_Request*) buffer;
+    BPStaticClientInfo& sci = pReq->static_info;
+    DCPLOG_INFO(log_mgmt_command)
+      << "Processing request: RegisterProtocol, protocolId = " << sci.protocolId
+      << " , name = " << sci.protocolName
+      << " , maxPayloadSize = " << sci.maxPayloadSize
+      << " , queueingMode = " << bp_queueing_mode_to_string (sci.queueingMode)
+      << " , maxEntries = " << sci.maxEntries
+      << " , allowMultiplePayloads = " << sci.allowMultiplePayloads;
+
+    sendRegisterConfirmation(runtime, add_client_protocol (runtime, sci, pReq->generateTransmitPayloadConfirms, pReq->shm_area_name));
 
     DCPLOG_INFO(log_mgmt_command)
       << "Processing BPRegisterProtocol request: FINISHING";
@@ -270,35 +310,9 @@ namespace dcp::bp {
     DCPLOG_INFO(log_mgmt_command)
       << "Processing request: DeregisterProtocol, protocolId = " << pReq->protocolId;
 
-    // check whether client protocol exists
-    if (not runtime.clientProtocols.contains (pReq->protocolId))
-      {
-	DCPLOG_INFO(log_mgmt_command)
-	  << "Processing BPDerregisterProtocol request: protocol is not registered";
-	send_simple_confirmation<BPDeregisterProtocol_Confirm>(runtime, BP_STATUS_UNKNOWN_PROTOCOL);
-	return;
-      }
-
-    BPClientProtocolData& the_client_prot = runtime.clientProtocols[pReq->protocolId];
-    auto pSSB = the_client_prot.pSSB;
-    DCPLOG_TRACE(log_mgmt_command)
-      << "Processing BPDerregisterProtocol request: BEFORE erasing: "
-      << "this = " << (void*) (&the_client_prot)
-      << ", pSCS = " << (void*) the_client_prot.pSCS
-      << ", pSSB.use_count = " << pSSB.use_count()
-      << ", shm_memory_address() = " << (void*) pSSB->get_memory_address()
-      << ", shm_name() = " << pSSB->get_name()
-      << ", shm_structure_size = " << pSSB->get_structure_size()
-      << ", shm_is_creator = " << pSSB->get_is_creator()
-      << ", shm_has_valid_memory = " << pSSB->has_valid_memory()
-      ;
-    runtime.clientProtocols.erase(pReq->protocolId);
-    
-    DCPLOG_INFO(log_mgmt_command) << "Processing BPDeregisterProtocol request: erased registered protocol";
-    send_simple_confirmation<BPDeregisterProtocol_Confirm>(runtime, BP_STATUS_OK);
+    send_simple_confirmation<BPDeregisterProtocol_Confirm>(runtime, remove_client_protocol (runtime, pReq->protocolId));
   }
 
-
   // ------------------------------------------------------------------
 
   void handleBPListRegisteredProtocols_Request (BPRuntimeData& runtime, byte*, size_t nbytes)
@@ -598,4 +612,36 @@ namespace dcp::bp {
     DCPLOG_INFO(log_mgmt_command) << "Stopping command socket thread.";
   }
   
+  // ------------------------------------------------------------------
+
+  DcpStatus BPRuntimeRegistrar::register_local_protocol (const BPStaticClientInfo& static_info,
+							 bool gen_pld_confirms,
+							 BPShmControlSegment*& pSCS,
+							 NodeIdentifierT& ownNodeIdentifier)
+  {
+    DCPLOG_INFO(log_mgmt_command)
+      << "Registering in-process client protocol, protocolId = " << static_info.protocolId
+      << " , name = " << static_info.protocolName;
+
+    std::lock_guard<std::mutex> lock (runtime.clientProtocols_mutex);
+    DcpStatus status = add_client_protocol (runtime, static_info, gen_pld_confirms, nullptr);
+    ownNodeIdentifier = runtime.ownNodeIdentifier;
+    if (status == BP_STATUS_OK)
+      pSCS = runtime.clientProtocols[static_info.protocolId].pSCS;
+    return status;
+  }
+
+  // ------------------------------------------------------------------
+
+  DcpStatus BPRuntimeRegistrar::deregister_local_protocol (BPProtocolIdT protocolId)
+  {
+    DCPLOG_INFO(log_mgmt_command)
+      << "Deregistering in-process client protocol, protocolId = " << protocolId;
+
+    std::lock_guard<std::mutex> lock (runtime.clientProtocols_mutex);
+    return remove_client_protocol (runtime, protocolId);
+  }
+
+  // ------------------------------------------------------------------
+
 };  // namespace dcp::bp
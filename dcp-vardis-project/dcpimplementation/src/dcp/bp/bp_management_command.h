@@ -21,6 +21,7 @@
 #pragma once
 
 #include <exception>
+#include <dcp/bp/bp_local_registrar.h>
 #include <dcp/bp/bp_runtime_data.h>
 
 namespace dcp::bp {
@@ -30,5 +31,59 @@ namespace dcp::bp {
    * @brief Start thread handling the command socket, run it until exitFlag is set
    */
   void management_thread_command (BPRuntimeData& runtime);
+
+
+  /**
+   * @brief Checks the static client information of a registering
+   *        client protocol and adds it to the client protocols of
+   *        the runtime. Must be called with the client protocols
+   *        mutex held.
+   *
+   * @param sci: static client information of the client protocol
+   * @param gen_pld_confirms: whether to generate transmit payload
+   *        confirms
+   * @param shm_area_name: name of the shared memory area of the
+   *        client protocol, nullptr for an in-process client
+   *        protocol
+   *
+   * @return BP_STATUS_OK or the reason for rejecting the client
+   *         protocol
+   */
+  DcpStatus add_client_protocol (BPRuntimeData& runtime,
+				 const BPStaticClientInfo& sci,
+				 bool gen_pld_confirms,
+				 const char* shm_area_name);
+
+
+  /**
+   * @brief Removes a client protocol from the runtime. Must be
+   *        called with the client protocols mutex held.
+   *
+   * @return BP_STATUS_OK or BP_STATUS_UNKNOWN_PROTOCOL
+   */
+  DcpStatus remove_client_protocol (BPRuntimeData& runtime, BPProtocolIdT protocolId);
+
+
+  /**
+   * @brief Lets client protocols that run in the same process as BP
+   *        (dcpmain-stack) register and deregister directly with the
+   *        BP runtime data, with the same checks as the
+   *        BP-RegisterProtocol service
+   */
+  class BPRuntimeRegistrar : public BPLocalRegistrar {
+  private:
+    BPRuntimeData& runtime;
+
+  public:
+    BPRuntimeRegistrar () = delete;
+    BPRuntimeRegistrar (BPRuntimeData& rt) : runtime (rt) {};
+
+    virtual DcpStatus register_local_protocol (const BPStaticClientInfo& static_info,
+					       bool gen_pld_confirms,
+					       BPShmControlSegment*& pSCS,
+					       NodeIdentifierT& ownNodeIdentifier);
+
+    virtual DcpStatus deregister_local_protocol (BPProtocolIdT protocolId);
+  };
   
 };  // namespace dcp::bp
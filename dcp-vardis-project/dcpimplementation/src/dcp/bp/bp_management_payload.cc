@@ -32,6 +32,7 @@ extern "C" {
 }
 #include <dcp/common/debug_helpers.h>
 #include <dcp/common/memblock.h>
+#include <dcp/common/realtime.h>
 #include <dcp/common/services_status.h>
 #include <dcp/bp/bp_transmissible_types.h>
 #include <dcp/bp/bp_service_primitives.h>
@@ -118,7 +119,7 @@ namespace dcp::bp {
     try {
       while (not runtime.bp_exitFlag)
 	{
-	  std::this_thread::sleep_for (20ms);
+	  sleep_for_measured (20ms, runtime.metricPayloadWakeupLatency);
 	  runtime.clientProtocols_mutex.lock();
 	  handle_payload_from_client (runtime);
 	  runtime.clientProtocols_mutex.unlock();
@@ -58,6 +58,7 @@ namespace dcp::bp {
 	
 	area.incr (pldHdr.length.val);
 	clientProt.cntDroppedIncomingPayloads += 1;
+	runtime.metricPayloadsDropped.inc ();
 	return;
       }
 
@@ -74,6 +75,7 @@ namespace dcp::bp {
 	
 	area.incr (pldHdr.length.val);
 	clientProt.cntDroppedIncomingPayloads += 1;
+	runtime.metricPayloadsDropped.inc ();
 	return;
       }
 
@@ -101,9 +103,11 @@ namespace dcp::bp {
 	  << "deliver_payload: no free buffer available in shared memory, dropping payload.";
 	area.incr (pldHdr.length.val);
 	clientProt.cntDroppedIncomingPayloads += 1;
+	runtime.metricPayloadsDropped.inc ();
       }
     else
       {
+	runtime.metricPayloadsDelivered.inc ();
 	DCPLOG_TRACE(log_rx)
 	  << "pushed payload of length "
 	  << pldHdr.length
@@ -244,7 +248,7 @@ namespace dcp::bp {
 		  bytevect payload      = raw_pdu.payload();
 		  ByteVectorDisassemblyArea area ("bp-rx", payload);
 		  
-		  TimeStampT current_time = TimeStampT::get_current_system_time();
+		  TimeStampT current_time = TimeStampT::get_current_coarse_time();
 		  auto ib_time = current_time.milliseconds_passed_since(last_beacon_reception_time);
 		  
 		  // update beacon size statistics
@@ -271,8 +275,9 @@ namespace dcp::bp {
 			+ (1 - ibTimeAlpha) * ((double) ib_time);
 		    }
 		  
-		  last_beacon_reception_time = TimeStampT::get_current_system_time();
+		  last_beacon_reception_time = current_time;
 		  runtime.cntBPPayloads++;
+		  runtime.metricBeaconsReceived.inc ();
 		  
 		  DCPLOG_TRACE(log_rx)
 		    << "process_received_payload: avg inter beacon time (ms) = " << runtime.avg_inter_beacon_reception_time
@@ -280,6 +285,7 @@ namespace dcp::bp {
 		  
 		  if (runtime.bp_isActive)
 		    {
+		      ScopedLatencyMeasurement parse_time (runtime.metricRxParseTime);
 		      process_received_payload (runtime, area);
 		    }
 		  
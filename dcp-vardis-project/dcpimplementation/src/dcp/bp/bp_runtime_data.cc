@@ -32,7 +32,17 @@ namespace dcp::bp {
     : bp_config (cfg),
       bp_isActive (true),
       bp_exitFlag (false),
-      commandSocket(bp_config.cmdsock_conf.commandSocketFile, bp_config.cmdsock_conf.commandSocketTimeoutMS)
+      commandSocket(bp_config.cmdsock_conf.commandSocketFile, bp_config.cmdsock_conf.commandSocketTimeoutMS),
+      metrics ("BP", cfg.metrics_conf),
+      metricBeaconBuildTime (metrics.histogram ("beacon_build_ns")),
+      metricRxParseTime (metrics.histogram ("rx_parse_ns")),
+      metricClientLockHoldTime (metrics.histogram ("client_protocols_lock_hold_ns")),
+      metricBeaconsSent (metrics.counter ("beacons_sent")),
+      metricBeaconsReceived (metrics.counter ("beacons_received")),
+      metricPayloadsDelivered (metrics.counter ("payloads_delivered")),
+      metricPayloadsDropped (metrics.counter ("payloads_dropped")),
+      metricTxWakeupLatency (metrics.histogram ("tx_wakeup_latency_ns")),
+      metricPayloadWakeupLatency (metrics.histogram ("payload_wakeup_latency_ns"))
   {
     // retrieve own node identifier (aka: MAC address)
     nw_if_info = NetworkInterface(cfg.bp_conf.interfaceName).addresses();
@@ -25,6 +25,7 @@
 #include <tins/tins.h>
 #include <dcp/common/command_socket.h>
 #include <dcp/common/global_types_constants.h>
+#include <dcp/common/metrics.h>
 #include <dcp/bp/bp_configuration.h>
 #include <dcp/bp/bp_client_protocol_data.h>
 
@@ -130,6 +131,22 @@ namespace dcp::bp {
      */
     double avg_received_beacon_size = 0;
 
+
+    /*********************************************************************
+     * Metrics (shared memory area read by dcp-stats)
+     ********************************************************************/
+
+    MetricsRegistry    metrics;
+    LatencyHistogram&  metricBeaconBuildTime;    /*!< Time for collecting payloads and serializing a beacon, without sending it */
+    LatencyHistogram&  metricRxParseTime;        /*!< Time for parsing a received beacon and handing its payloads to the client protocols */
+    LatencyHistogram&  metricClientLockHoldTime; /*!< Time the transmitter holds the client protocols mutex */
+    MetricCounter&     metricBeaconsSent;
+    MetricCounter&     metricBeaconsReceived;
+    MetricCounter&     metricPayloadsDelivered;  /*!< Received payloads handed to client protocols */
+    MetricCounter&     metricPayloadsDropped;    /*!< Received payloads dropped (e.g. client queue full) */
+    LatencyHistogram&  metricTxWakeupLatency;    /*!< Lateness of the transmitter thread waking up for the next beacon */
+    LatencyHistogram&  metricPayloadWakeupLatency; /*!< Same for the thread taking payloads from client protocols */
+
     
     /*********************************************************************
      * Methods
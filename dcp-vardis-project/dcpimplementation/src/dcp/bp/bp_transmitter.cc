@@ -27,6 +27,7 @@
 #include <tins/tins.h>
 #include <dcp/common/area.h>
 #include <dcp/common/memblock.h>
+#include <dcp/common/realtime.h>
 #include <dcp/bp/bp_client_protocol_data.h>
 #include <dcp/bp/bp_logging.h>
 #include <dcp/bp/bp_service_primitives.h>
@@ -139,6 +140,8 @@ namespace dcp::bp {
   {
     if (not runtime.bp_isActive)
       return;
+
+    ScopedLatencyMeasurement build_time (runtime.metricBeaconBuildTime);
     
     // first determine number and total size of available payloads without
     // yet moving them into a beacon. We use a very simple method allowing
@@ -183,7 +186,9 @@ namespace dcp::bp {
 	EthernetII ethpacket = EthernetII(EthernetII::BROADCAST, runtime.nw_if_info.hw_addr);
 	ethpacket.payload_type (runtime.bp_config.bp_conf.etherType);
 	ethpacket = ethpacket / payload_pdu;
+	build_time.finish ();
 
+	runtime.metricBeaconsSent.inc ();
 	runtime.pktSender.send (ethpacket, runtime.bp_config.bp_conf.interfaceName);	  
       }
   }
@@ -217,10 +222,13 @@ namespace dcp::bp {
       while (not runtime.bp_exitFlag)
 	{
 	  unsigned int wait_time_ms = dist (randgen);
-	  std::this_thread::sleep_for (std::chrono::milliseconds (wait_time_ms));
+	  sleep_for_measured (std::chrono::milliseconds (wait_time_ms), runtime.metricTxWakeupLatency);
 	  
 	  runtime.clientProtocols_mutex.lock();
-	  generate_beacon (runtime);
+	  {
+	    ScopedLatencyMeasurement hold_time (runtime.metricClientLockHoldTime);
+	    generate_beacon (runtime);
+	  }
 	  runtime.clientProtocols_mutex.unlock();
 	}
     }
@@ -46,19 +46,32 @@ namespace dcp {
 
   BPClientRuntime::BPClientRuntime (BPClientConfiguration client_conf,
 				    BPStaticClientInfo static_client_info,
-				    bool gen_pld_conf
+				    bool gen_pld_conf,
+				    BPLocalRegistrar* registrar
 				    )
     : BaseClientRuntime (client_conf.bp_cmdsock_conf.commandSocketFile.c_str(), client_conf.bp_cmdsock_conf.commandSocketTimeoutMS),
       static_client_info (static_client_info),
       shmAreaName (client_conf.bp_shm_conf.shmAreaName),
       generateTransmitPayloadConfirms (gen_pld_conf),
-      client_configuration (client_conf)
+      client_configuration (client_conf),
+      local_registrar (registrar)
   {
     if (gen_pld_conf)
       throw BPClientLibException ("BPClientRuntime",
 				  "generation of payload confirms not supported");
 
     check_protocol_name (static_client_info.protocolName);
+
+    if (local_registrar)
+      {
+	DcpStatus reg_status = local_registrar->register_local_protocol (static_client_info, generateTransmitPayloadConfirms, pSCS, ownNodeIdentifier);
+	if (reg_status != BP_STATUS_OK)
+	  throw BPClientLibException ("BPClientRuntime, ",
+				      std::format("in-process registration failed, status code = {}", bp_status_to_string(reg_status)));
+	_isRegistered = true;
+	return;
+      }
+
     check_shm_area_name (shmAreaName);
     
     DcpStatus reg_status = register_with_bp (generateTransmitPayloadConfirms);
@@ -187,6 +200,14 @@ namespace dcp {
   
   DcpStatus BPClientRuntime::deregister_with_bp ()
   {
+    if (local_registrar)
+      {
+	DcpStatus rv = local_registrar->deregister_local_protocol (static_client_info.protocolId);
+	_isRegistered = false;
+	pSCS          = nullptr;
+	return rv;
+      }
+
     BPDeregisterProtocol_Confirm rpConf;
     DcpStatus rv = simple_bp_request_confirm_service <BPDeregisterProtocol_Request, BPDeregisterProtocol_Confirm> ("deregister_with_bp", rpConf);
 
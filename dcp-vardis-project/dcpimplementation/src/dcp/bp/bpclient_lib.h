@@ -29,6 +29,7 @@
 #include <dcp/common/global_types_constants.h>
 #include <dcp/common/services_status.h>
 #include <dcp/common/sharedmem_structure_base.h>
+#include <dcp/bp/bp_local_registrar.h>
 #include <dcp/bp/bp_queueing_mode.h>
 #include <dcp/bp/bp_service_primitives.h>
 #include <dcp/bp/bp_shm_control_segment.h>
@@ -46,6 +47,7 @@ using dcp::ShmStructureBase;
 using dcp::bp::BPDeregisterProtocol_Confirm;
 using dcp::bp::BPDeregisterProtocol_Request;
 using dcp::bp::BPLengthT;
+using dcp::bp::BPLocalRegistrar;
 using dcp::bp::BPQueueingMode;
 using dcp::bp::BPRegisteredProtocolDataDescription;
 using dcp::bp::BPRegisterProtocol_Confirm;
@@ -99,6 +101,14 @@ namespace dcp {
     BPClientConfiguration client_configuration;
 
 
+    /**
+     * @brief Registrar of a BP instance running in the same process
+     *        (dcpmain-stack), nullptr when BP is a separate demon
+     *        reached through command socket and shared memory
+     */
+    BPLocalRegistrar* local_registrar = nullptr;
+
+
     /**
      * @brief Register BP client protocol with BP (service
      *        'BP-RegisterProtocol'), using the stored
@@ -193,8 +203,13 @@ namespace dcp {
      *        a BP client protocol (e.g. protocol name, queueing mode etc)
      * @param gen_pld_conf: specify whether client protocol expects BP
      *        demon to generate BP-TransmitPayload.confirm primitives
+     * @param registrar: when given, BP runs in the same process and
+     *        registration and deregistration are direct calls to it,
+     *        and the control segment lives in process memory instead
+     *        of a shared memory area. Other management services still
+     *        use the command socket.
      */
-    BPClientRuntime (BPClientConfiguration client_conf, BPStaticClientInfo static_client_info, bool gen_pld_conf);
+    BPClientRuntime (BPClientConfiguration client_conf, BPStaticClientInfo static_client_info, bool gen_pld_conf, BPLocalRegistrar* registrar = nullptr);
 
 
     /**
@@ -350,6 +365,42 @@ namespace dcp {
      */
     DcpStatus receive_payload_wait (BPLengthT& result_length, byte* result_buffer, bool& more_payloads, bool& exitFlag);
 
+
+    /**
+     * @brief Retrieves up to max_payloads received payloads while
+     *        holding the lock of the payload queue only once. Blocks
+     *        caller until at least one payload is available or the
+     *        exitFlag is true
+     *
+     * @param max_payloads: maximum number of payloads to retrieve
+     * @param result_lengths: output array of at least max_payloads
+     *        elements. Entry k receives the length of the k-th
+     *        payload, or zero if that payload was dropped (e.g. for
+     *        being too large)
+     * @param result_buffer: buffer of at least max_payloads times
+     *        the maximum payload length for this client protocol. The
+     *        k-th payload is copied to offset k times the maximum
+     *        payload length.
+     * @param number_received: output value, number of entries of
+     *        result_lengths that have been filled in
+     * @param more_payloads: says whether there are more received
+     *        payloads available
+     * @param exitFlag: waiting is aborted when this becomes true
+     *
+     * @return DcpStatus value, BP_STATUS_OK unless any of the
+     *         retrieved payloads had to be dropped
+     *
+     * Throws upon processing errors (e.g. inability to access shared
+     * memory area). This method can only be used when the client
+     * protocol is registered with BP, otherwise it throws.
+     */
+    DcpStatus receive_payloads_wait (size_t max_payloads,
+				     BPLengthT* result_lengths,
+				     byte* result_buffer,
+				     size_t& number_received,
+				     bool& more_payloads,
+				     bool& exitFlag);
+
     
     /**
      * @brief Delete all BP payloads for the client protocol
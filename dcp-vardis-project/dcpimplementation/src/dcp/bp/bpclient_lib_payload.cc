@@ -140,7 +140,79 @@ namespace dcp {
   {
     return receive_payload_helper (result_length, result_buffer, more_payloads, true, exitFlag);
   }
-    
+
+  // ---------------------------------------------------------------
+
+
+  DcpStatus BPClientRuntime::receive_payloads_wait (size_t max_payloads,
+						    BPLengthT* result_lengths,
+						    byte* result_buffer,
+						    size_t& number_received,
+						    bool& more_payloads,
+						    bool& exitFlag)
+  {
+    number_received      = 0;
+    more_payloads        = false;
+    BPLengthT max_length = static_client_info.maxPayloadSize;
+    DcpStatus retval     = BP_STATUS_OK;
+
+    if (not _isRegistered)
+      throw BPClientLibException ("receive_payloads_wait",
+				  "not registered with BP");
+    if (max_length == 0)
+      throw BPClientLibException ("receive_payloads_wait",
+				  "max_length is zero");
+    if (max_payloads == 0)
+      throw BPClientLibException ("receive_payloads_wait",
+				  "max_payloads is zero");
+    if ((!result_buffer) or (!result_lengths))
+      throw BPClientLibException ("receive_payloads_wait",
+				  "no result buffer given");
+
+    BPShmControlSegment& CS = *pSCS;
+    bool   timed_out;
+    size_t number_popped;
+    PopHandler handler = [&] (const byte* memaddr, size_t len)
+    {
+      BPLengthT& result_length = result_lengths[number_received];
+      byte*      result_ptr    = result_buffer + number_received * max_length.val;
+      result_length = 0;
+      number_received++;
+
+      if (len < sizeof(bp::BPReceivePayload_Indication))
+	return;
+
+      BPReceivePayload_Indication* pInd         = (BPReceivePayload_Indication*) memaddr;
+      const byte*                  payload_ptr  = memaddr + sizeof(BPReceivePayload_Indication);
+
+      if (pInd->s_type != stBP_ReceivePayload)
+	throw BPClientLibException ("receive_payloads_wait",
+				    std::format("incorrect service type {}", pInd->s_type));
+      if (pInd->length == 0)
+	throw BPClientLibException ("receive_payloads_wait",
+				    "got payload of zero length");
+      if (pInd->length > max_length)
+	{
+	  retval = BP_STATUS_PAYLOAD_TOO_LARGE;
+	  return;
+	}
+      if (pInd->length != len - sizeof(bp::BPReceivePayload_Indication))
+	{
+	  retval = BP_STATUS_INTERNAL_ERROR;
+	  return;
+	}
+
+      result_length = pInd->length;
+      std::memcpy (result_ptr, payload_ptr, result_length.val);
+    };
+
+    do {
+      CS.pqReceivePayloadIndication.popmany_wait (handler, max_payloads, number_popped, timed_out, more_payloads, defaultShortSharedMemoryLockTimeoutMS);
+    } while ((not exitFlag) and timed_out);
+
+    return retval;
+  }
+
   // ---------------------------------------------------------------
   
 };  // namespace dcp
@@ -283,6 +283,21 @@ namespace dcp {
     virtual byte peek_byte () = 0;
 
     
+    /**
+     * @brief Returns a pointer to the next 'size' bytes of the
+     *        underlying memory and skips over them, without copying
+     *        them. With size zero the current position is returned.
+     *
+     * Only supported by areas working over contiguous memory, the
+     * returned pointer remains valid as long as that memory does.
+     */
+    virtual byte* view_byte_block ([[maybe_unused]] size_t size)
+    {
+      throw DisassemblyAreaException(std::format ("{}.view_byte_block", _name),
+				     std::format ("not supported by this area"));
+    };
+
+    
     /**
      * @brief Default method for deserializing a byte block, assumed
      *        to be slow.
@@ -550,6 +565,18 @@ namespace dcp {
     };
 
 
+    /**
+     * @brief Returns pointer to the next size bytes and skips them
+     */
+    virtual byte* view_byte_block (size_t size)
+    {
+      byte* rv = pointer;
+      incr (size);
+      pointer += size;
+      return rv;
+    };
+
+
     /**
      * @brief Re-set area to start serializing at the beginning again
      */
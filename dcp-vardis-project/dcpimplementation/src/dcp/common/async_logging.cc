@@ -0,0 +1,360 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <boost/date_time/c_local_time_adjustor.hpp>
+#include <boost/date_time/posix_time/conversion.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/log/attributes/mutable_constant.hpp>
+#include <boost/log/sources/record_ostream.hpp>
+#include <dcp/common/async_logging.h>
+
+
+namespace attrs    = boost::log::attributes;
+namespace keywords = boost::log::keywords;
+
+
+namespace dcp {
+
+  LogRingBuffer::LogRingBuffer (size_t cap)
+  {
+    capacity = minimumAsyncLogBufferSize;
+    while (capacity < cap)
+      capacity *= 2;
+    storage = std::make_unique<byte[]> (capacity);
+  }
+
+
+  bool LogRingBuffer::push (const byte* rec, size_t len)
+  {
+    const size_t need  = slot_size (len);
+    uint64_t     wpos  = write_pos.load (std::memory_order_relaxed);
+    uint64_t     rpos  = read_pos.load (std::memory_order_acquire);
+    size_t       offs  = wpos & (capacity - 1);
+    size_t       skip  = (capacity - offs < need) ? capacity - offs : 0;
+
+    if (wpos + skip + need - rpos > capacity)
+      {
+	number_dropped.fetch_add (1, std::memory_order_relaxed);
+	return false;
+      }
+
+    if (skip > 0)
+      {
+	std::memcpy (storage.get() + offs, &skipMarker, sizeof(skipMarker));
+	wpos += skip;
+	offs  = 0;
+      }
+    uint32_t len32 = (uint32_t) len;
+    std::memcpy (storage.get() + offs, &len32, sizeof(len32));
+    std::memcpy (storage.get() + offs + 8, rec, len);
+    write_pos.store (wpos + need, std::memory_order_release);
+    return true;
+  }
+
+
+  // -----------------------------------------------------------------
+
+
+  void format_log_record (std::ostream& os, const byte* rec, size_t len)
+  {
+    const size_t prefix = sizeof(LogArgFormatter) + sizeof(uint16_t);
+    LogRecordHeader hdr;
+    std::memcpy (&hdr, rec, sizeof(hdr));
+    size_t pos = sizeof(LogRecordHeader);
+    while (pos + prefix <= len)
+      {
+	LogArgFormatter  fmt;
+	uint16_t         arglen;
+	std::memcpy (&fmt, rec + pos, sizeof(fmt));
+	std::memcpy (&arglen, rec + pos + sizeof(fmt), sizeof(arglen));
+	fmt (os, rec + pos + prefix, arglen);
+	pos += prefix + arglen;
+      }
+    if (hdr.truncated)
+      os << " [...]";
+  }
+
+
+  // -----------------------------------------------------------------
+
+
+  /**
+   * @brief The background part of asynchronous logging: the registry
+   *        of per-thread ring buffers and the thread draining them
+   */
+  class AsyncLogBackend {
+  public:
+
+    /**
+     * @brief A record taken out of a ring buffer and formatted,
+     *        waiting to be written in time stamp order
+     */
+    typedef struct PendingRecord {
+      int64_t                  timestamp_ns;
+      logger_type*             logger;
+      trivial::severity_level  severity;
+      std::string              text;
+    } PendingRecord;
+
+    std::mutex                                   registry_mutex;   /*!< Protects rings and generation */
+    std::vector<std::shared_ptr<LogRingBuffer>>  rings;
+    std::atomic<uint64_t>                        generation {0};   /*!< Incremented on every start, odd while active */
+    size_t                                       buffer_size = defaultAsyncLogBufferSize;
+
+    std::mutex                                   drain_mutex;      /*!< Serializes the consumer side of all rings */
+    logger_type                                  backend_logger {keywords::channel = "LOG"};
+    attrs::mutable_constant<boost::posix_time::ptime>  timestamp_attr {boost::posix_time::ptime ()};
+    std::atomic<uint64_t>                        total_dropped {0};   /*!< Records dropped over all rings, including those of ended threads */
+    uint64_t                                     reported_dropped = 0;
+    std::atomic<logger_type*>                    report_logger {nullptr};  /*!< Channel of the report of dropped records, "LOG" when null */
+
+    std::mutex                                   thread_mutex;
+    std::condition_variable                      thread_cond;
+    std::thread                                  drain_thread;
+    bool                                         stop_requested = false;
+
+
+    AsyncLogBackend ()
+    {
+      backend_logger.add_attribute ("TimeStamp", timestamp_attr);
+    };
+
+
+    bool is_active () const { return (generation.load (std::memory_order_acquire) & 1) == 1; };
+
+
+    void start (size_t bufsize, uint32_t interval_ms, logger_type* reportLogger)
+    {
+      std::lock_guard<std::mutex> tlock (thread_mutex);
+      if (is_active())
+	return;
+      report_logger.store (reportLogger);
+      {
+	std::lock_guard<std::mutex> rlock (registry_mutex);
+	buffer_size = bufsize;
+	generation.fetch_add (1, std::memory_order_release);
+      }
+      stop_requested = false;
+      drain_thread = std::thread ([this, interval_ms] ()
+      {
+	std::unique_lock<std::mutex> lock (thread_mutex);
+	while (not stop_requested)
+	  {
+	    thread_cond.wait_for (lock, std::chrono::milliseconds (interval_ms));
+	    lock.unlock ();
+	    drain ();
+	    lock.lock ();
+	  }
+      });
+    };
+
+
+    void stop ()
+    {
+      {
+	std::lock_guard<std::mutex> tlock (thread_mutex);
+	if (not is_active())
+	  return;
+	stop_requested = true;
+	generation.fetch_add (1, std::memory_order_seq_cst);
+      }
+      // pairs with the fence in submit_log_record(), see there
+      std::atomic_thread_fence (std::memory_order_seq_cst);
+      thread_cond.notify_all ();
+      if (drain_thread.joinable())
+	drain_thread.join ();
+      drain ();
+    };
+
+
+    std::shared_ptr<LogRingBuffer> register_ring (uint64_t& gen)
+    {
+      std::lock_guard<std::mutex> rlock (registry_mutex);
+      gen = generation.load (std::memory_order_acquire);
+      auto ring = std::make_shared<LogRingBuffer> (buffer_size);
+      rings.push_back (ring);
+      return ring;
+    };
+
+
+    void write (int64_t timestamp_ns, logger_type* logger, trivial::severity_level severity, const std::string& text)
+    {
+      auto tp = boost::posix_time::from_time_t (timestamp_ns / 1000000000)
+	+ boost::posix_time::microseconds ((timestamp_ns % 1000000000) / 1000);
+      timestamp_attr.set (boost::date_time::c_local_adjustor<boost::posix_time::ptime>::utc_to_local (tp));
+      backend_logger.channel (logger ? logger->channel() : std::string ("LOG"));
+      BOOST_LOG_SEV(backend_logger, severity) << text;
+    };
+
+
+    void drain ()
+    {
+      std::lock_guard<std::mutex> dlock (drain_mutex);
+
+      std::vector<std::shared_ptr<LogRingBuffer>> current;
+      {
+	std::lock_guard<std::mutex> rlock (registry_mutex);
+	// rings of threads that have ended are dropped once empty
+	std::erase_if (rings, [] (const std::shared_ptr<LogRingBuffer>& r) { return (r.use_count() == 1) and r->is_empty(); });
+	current = rings;
+      }
+
+      std::vector<PendingRecord> pending;
+      for (auto& ring : current)
+	{
+	  ring->drain ([&] (const byte* rec, size_t len)
+	  {
+	    LogRecordHeader hdr;
+	    std::memcpy (&hdr, rec, sizeof(hdr));
+	    std::ostringstream os;
+	    format_log_record (os, rec, len);
+	    pending.push_back (PendingRecord {hdr.timestamp_ns, hdr.logger, (trivial::severity_level) hdr.severity, os.str()});
+	  });
+	}
+
+      std::stable_sort (pending.begin(), pending.end(),
+			[] (const PendingRecord& a, const PendingRecord& b) { return a.timestamp_ns < b.timestamp_ns; });
+      for (auto& p : pending)
+	write (p.timestamp_ns, p.logger, p.severity, p.text);
+
+      uint64_t dropped = total_dropped.load (std::memory_order_relaxed);
+      if (dropped > reported_dropped)
+	{
+	  write (std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::system_clock::now().time_since_epoch()).count(),
+		 report_logger.load (), trivial::warning,
+		 std::format ("asynchronous logging dropped {} records (ring buffer full)", dropped - reported_dropped));
+	  reported_dropped = dropped;
+	}
+    };
+  };
+
+
+  /**
+   * @brief The backend is never destroyed, so that log statements in
+   *        destructors of other static objects remain safe. Pending
+   *        records are written by an exit handler installed on the
+   *        first start.
+   */
+  static AsyncLogBackend& get_backend ()
+  {
+    static AsyncLogBackend* backend = new AsyncLogBackend;
+    return *backend;
+  }
+
+
+  /**
+   * @brief Ring buffer of the calling thread, together with the
+   *        backend generation it was registered for
+   */
+  typedef struct ThreadLogRing {
+    std::shared_ptr<LogRingBuffer>  ring;
+    uint64_t                        generation = 0;
+  } ThreadLogRing;
+
+  static thread_local ThreadLogRing thread_log_ring;
+
+
+  // -----------------------------------------------------------------
+
+
+  LogRecordBuilder::LogRecordBuilder (logger_type& logger, trivial::severity_level severity)
+  {
+    LogRecordHeader& hdr = header();
+    hdr.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::system_clock::now().time_since_epoch()).count();
+    hdr.logger       = &logger;
+    hdr.severity     = (uint8_t) severity;
+    hdr.truncated    = false;
+  }
+
+
+  void submit_log_record (const byte* rec, size_t len)
+  {
+    AsyncLogBackend& backend = get_backend ();
+    LogRecordHeader hdr;
+    std::memcpy (&hdr, rec, sizeof(hdr));
+
+    uint64_t gen = backend.generation.load (std::memory_order_acquire);
+    if ((gen & 1) == 1)
+      {
+	if ((not thread_log_ring.ring) or (thread_log_ring.generation != gen))
+	  thread_log_ring.ring = backend.register_ring (thread_log_ring.generation);
+	if (not thread_log_ring.ring->push (rec, len))
+	  backend.total_dropped.fetch_add (1, std::memory_order_relaxed);
+
+	// if logging was stopped meanwhile, the final drain of stop()
+	// may have missed the record, so it is written here. The fence
+	// pairs with the increment in stop(): either stop() sees the
+	// record or this sees the new generation
+	std::atomic_thread_fence (std::memory_order_seq_cst);
+	if ((hdr.severity >= trivial::fatal) or (backend.generation.load (std::memory_order_relaxed) != gen))
+	  backend.drain ();
+	return;
+      }
+
+    std::ostringstream os;
+    format_log_record (os, rec, len);
+    BOOST_LOG_SEV(*hdr.logger, (trivial::severity_level) hdr.severity) << os.str();
+  }
+
+
+  void start_async_logging (size_t buffer_size, uint32_t drain_interval_ms, logger_type* report_logger)
+  {
+    if (buffer_size < minimumAsyncLogBufferSize)
+      throw LoggingException ("start_async_logging",
+			      std::format ("buffer size {} is below minimum {}", buffer_size, minimumAsyncLogBufferSize));
+    if (drain_interval_ms == 0)
+      throw LoggingException ("start_async_logging", "drain interval is zero");
+    static std::once_flag exit_handler_flag;
+    std::call_once (exit_handler_flag, [] () { std::atexit (stop_async_logging); });
+    get_backend().start (buffer_size, drain_interval_ms, report_logger);
+  }
+
+
+  void stop_async_logging ()
+  {
+    get_backend().stop ();
+  }
+
+
+  void flush_async_logging ()
+  {
+    get_backend().drain ();
+  }
+
+
+  bool async_logging_active ()
+  {
+    return get_backend().is_active ();
+  }
+
+
+  uint64_t get_async_logging_dropped ()
+  {
+    return get_backend().total_dropped.load (std::memory_order_relaxed);
+  }
+
+};  // namespace dcp
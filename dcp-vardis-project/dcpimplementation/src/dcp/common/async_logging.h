@@ -0,0 +1,354 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <ostream>
+#include <sstream>
+#include <string_view>
+#include <type_traits>
+#include <dcp/common/foundation_types.h>
+#include <dcp/common/global_types_constants.h>
+#include <dcp/common/logging_helpers.h>
+
+
+/**
+ * @brief This module provides the asynchronous backend behind the
+ *        DCPLOG_* macros.
+ *
+ * A log statement captures its arguments into a log record in binary
+ * form: arithmetic values and other trivially copyable types are
+ * copied together with a pointer to a function that later formats
+ * them, strings are copied, and only values of other types are
+ * formatted at the call site. Formatting the record and handing it
+ * to Boost.Log is deferred.
+ *
+ * When asynchronous logging is active, the record is appended to a
+ * lock-free single-producer / single-consumer ring buffer owned by
+ * the calling thread, and a background thread periodically drains
+ * all ring buffers, formats the records and writes them to the
+ * configured Boost.Log sinks, with the time stamp taken at the call
+ * site. When a ring buffer is full, the record is dropped and
+ * counted rather than blocking the caller. When asynchronous
+ * logging is not active, the record is formatted and written
+ * immediately.
+ */
+
+
+namespace dcp {
+
+  /**
+   * @brief Maximum size of a log record (header and captured
+   *        arguments). Longer records are truncated.
+   */
+  const size_t maxLogRecordSize = 1024;
+
+
+  /**
+   * @brief Default and minimum size of the per-thread ring buffers
+   */
+  const size_t defaultAsyncLogBufferSize = 256 * 1024;
+  const size_t minimumAsyncLogBufferSize = 4 * maxLogRecordSize;
+
+
+  /**
+   * @brief Default interval between two runs of the background
+   *        thread draining the ring buffers
+   */
+  const uint32_t defaultAsyncLogDrainIntervalMS = 20;
+
+
+  /**
+   * @brief Function formatting one captured argument, getting the
+   *        address and length of the captured bytes
+   */
+  typedef void (*LogArgFormatter) (std::ostream&, const byte*, size_t);
+
+
+  /**
+   * @brief Header at the start of every log record
+   */
+  typedef struct LogRecordHeader {
+    int64_t        timestamp_ns;   /*!< System time of the log statement, nanoseconds since the epoch */
+    logger_type*   logger;         /*!< Logger (and thereby channel) the statement was made on */
+    uint8_t        severity;       /*!< Severity level */
+    bool           truncated;      /*!< Whether arguments were dropped or shortened */
+  } LogRecordHeader;
+
+
+  // -----------------------------------------------------------------
+
+
+  /**
+   * @brief Lock-free single-producer / single-consumer ring buffer of
+   *        variable-length records
+   *
+   * Read and write positions grow monotonically, records are stored
+   * contiguously with an eight-byte length prefix. A record that does
+   * not fit before the end of the buffer is preceded by a skip marker
+   * and written at the start.
+   */
+  class LogRingBuffer {
+  protected:
+
+    static const uint32_t skipMarker = 0xFFFFFFFF;
+
+    std::unique_ptr<byte[]>   storage;
+    size_t                    capacity;
+
+    alignas(cacheLineSize) std::atomic<uint64_t>  read_pos {0};     /*!< Advanced by the consumer */
+    alignas(cacheLineSize) std::atomic<uint64_t>  write_pos {0};    /*!< Advanced by the producer */
+    alignas(cacheLineSize) std::atomic<uint64_t>  number_dropped {0};
+
+    static constexpr size_t slot_size (size_t len) { return 8 + ((len + 7) & ~((size_t) 7)); };
+
+  public:
+
+    /**
+     * @brief Constructor, capacity is rounded up to a power of two
+     */
+    LogRingBuffer (size_t cap);
+
+    /**
+     * @brief Appends a record. Returns false and counts the record as
+     *        dropped when there is not enough free space. Producer
+     *        side only.
+     */
+    bool push (const byte* rec, size_t len);
+
+    /**
+     * @brief Calls fn(address, length) for every available record in
+     *        order and releases them. Returns the number of records.
+     *        Consumer side only.
+     */
+    template <typename Fn>
+    size_t drain (Fn fn)
+    {
+      uint64_t  rpos   = read_pos.load (std::memory_order_relaxed);
+      uint64_t  wpos   = write_pos.load (std::memory_order_acquire);
+      size_t    count  = 0;
+      while (rpos < wpos)
+	{
+	  size_t    offs = rpos & (capacity - 1);
+	  uint32_t  len;
+	  std::memcpy (&len, storage.get() + offs, sizeof(len));
+	  if (len == skipMarker)
+	    {
+	      rpos += capacity - offs;
+	      continue;
+	    }
+	  fn ((const byte*) storage.get() + offs + 8, (size_t) len);
+	  rpos += slot_size (len);
+	  count++;
+	}
+      read_pos.store (rpos, std::memory_order_release);
+      return count;
+    }
+
+    /**
+     * @brief Checks whether there are no records available
+     */
+    bool is_empty () const { return read_pos.load (std::memory_order_acquire) == write_pos.load (std::memory_order_acquire); };
+
+    /**
+     * @brief Returns number of records dropped so far
+     */
+    uint64_t get_number_dropped () const { return number_dropped.load (std::memory_order_relaxed); };
+
+    /**
+     * @brief Returns the (rounded) capacity in bytes
+     */
+    size_t get_capacity () const { return capacity; };
+  };
+
+
+  // -----------------------------------------------------------------
+
+
+  /**
+   * @brief Starts asynchronous logging with the given size of the
+   *        per-thread ring buffers and drain interval. Has no effect
+   *        when already started.
+   *
+   * Records dropped because of full ring buffers are reported as a
+   * warning on the channel of report_logger, which must pass the
+   * channel filter of the process (channel "LOG" when null).
+   */
+  void start_async_logging (size_t buffer_size = defaultAsyncLogBufferSize,
+			    uint32_t drain_interval_ms = defaultAsyncLogDrainIntervalMS,
+			    logger_type* report_logger = nullptr);
+
+
+  /**
+   * @brief Stops the background thread after writing all pending
+   *        records. Subsequent log statements are written
+   *        synchronously.
+   */
+  void stop_async_logging ();
+
+
+  /**
+   * @brief Writes all records pending in the ring buffers
+   */
+  void flush_async_logging ();
+
+
+  /**
+   * @brief Checks whether asynchronous logging is active
+   */
+  bool async_logging_active ();
+
+
+  /**
+   * @brief Returns the number of records dropped because a ring
+   *        buffer was full, summed over all threads
+   */
+  uint64_t get_async_logging_dropped ();
+
+
+  /**
+   * @brief Formats the arguments of the given record (without header)
+   *        into the given stream
+   */
+  void format_log_record (std::ostream& os, const byte* rec, size_t len);
+
+
+  /**
+   * @brief Hands a completed record to the backend (ring buffer of
+   *        the calling thread, or synchronous output)
+   */
+  void submit_log_record (const byte* rec, size_t len);
+
+
+  // -----------------------------------------------------------------
+
+
+  /**
+   * @brief Collects the arguments of one log statement, created by
+   *        the DCPLOG_* macros. The destructor submits the record.
+   */
+  class LogRecordBuilder {
+  protected:
+
+    static const size_t maxBinaryArgSize = 64;
+
+    alignas(LogRecordHeader) byte  buffer [maxLogRecordSize];
+    size_t  used = sizeof(LogRecordHeader);
+
+    template <typename T>
+    static void format_binary (std::ostream& os, const byte* p, size_t)
+    {
+      alignas(T) byte tmp [sizeof(T)];
+      std::memcpy (tmp, p, sizeof(T));
+      os << *std::launder ((const T*) tmp);
+    }
+
+    static void format_string (std::ostream& os, const byte* p, size_t len)
+    {
+      os.write ((const char*) p, len);
+    };
+
+    LogRecordHeader& header () { return *((LogRecordHeader*) buffer); };
+
+    void append (LogArgFormatter fmt, const void* data, size_t len, bool shorten)
+    {
+      const size_t prefix = sizeof(LogArgFormatter) + sizeof(uint16_t);
+      if (used + prefix + len > maxLogRecordSize)
+	{
+	  header().truncated = true;
+	  if ((not shorten) or (used + prefix >= maxLogRecordSize))
+	    return;
+	  len = maxLogRecordSize - used - prefix;
+	}
+      uint16_t len16 = (uint16_t) len;
+      std::memcpy (buffer + used, &fmt, sizeof(fmt));
+      std::memcpy (buffer + used + sizeof(fmt), &len16, sizeof(len16));
+      std::memcpy (buffer + used + prefix, data, len);
+      used += prefix + len;
+    };
+
+  public:
+
+    LogRecordBuilder (logger_type& logger, trivial::severity_level severity);
+
+    ~LogRecordBuilder ()
+    {
+      submit_log_record (buffer, used);
+    };
+
+    LogRecordBuilder (const LogRecordBuilder&) = delete;
+    LogRecordBuilder& operator= (const LogRecordBuilder&) = delete;
+
+    template <typename T>
+    LogRecordBuilder& operator<< (const T& value)
+    {
+      if constexpr (std::is_convertible_v<const T&, const char*>)
+	{
+	  const char* s = value;
+	  std::string_view sv = s ? std::string_view (s) : std::string_view ("(null)");
+	  append (&format_string, sv.data(), sv.size(), true);
+	}
+      else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+	{
+	  std::string_view sv = value;
+	  append (&format_string, sv.data(), sv.size(), true);
+	}
+      else if constexpr (std::is_pointer_v<std::decay_t<T>>)
+	{
+	  // the pointee may be gone when the record gets formatted: a
+	  // string behind a character pointer is formatted right away,
+	  // any other pointer is logged as address only
+	  typedef std::remove_cv_t<std::remove_pointer_t<std::decay_t<T>>> Pointee;
+	  const auto ptr = (std::decay_t<T>) value;
+	  if constexpr (   std::is_same_v<Pointee, char>
+			or std::is_same_v<Pointee, signed char>
+			or std::is_same_v<Pointee, unsigned char>
+			or std::is_same_v<Pointee, char8_t>)
+	    {
+	      std::string_view sv = ptr ? std::string_view ((const char*) ptr) : std::string_view ("(null)");
+	      append (&format_string, sv.data(), sv.size(), true);
+	    }
+	  else
+	    {
+	      const void* addr = (const void*) ptr;
+	      append (&format_binary<const void*>, &addr, sizeof(addr), false);
+	    }
+	}
+      else if constexpr (std::is_trivially_copyable_v<T> and (sizeof(T) <= maxBinaryArgSize))
+	{
+	  append (&format_binary<T>, &value, sizeof(T), false);
+	}
+      else
+	{
+	  std::ostringstream os;
+	  os << value;
+	  const std::string s = os.str();
+	  append (&format_string, s.data(), s.size(), true);
+	}
+      return *this;
+    }
+  };
+
+};  // namespace dcp
@@ -0,0 +1,104 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+
+#pragma once
+
+#include <chrono>
+#include <type_traits>
+extern "C" {
+#include <time.h>
+}
+
+
+/**
+ * @brief This module provides a cheap, coarse-grained source of the
+ *        current time for hot paths that only need millisecond
+ *        resolution (timeouts, ages of entries, inter-arrival
+ *        statistics).
+ *
+ * The time is read from CLOCK_REALTIME_COARSE, which the kernel
+ * serves from the vDSO without reading a hardware counter: it simply
+ * returns the time recorded at the last timer tick. No ticker thread
+ * and no calibration is needed, and the clock is consistent across
+ * all processes, which matters because timestamps are stored in
+ * shared memory and compared by other processes.
+ *
+ * Accuracy: a coarse reading never lies ahead of the precise clock.
+ * It normally lags behind by less than one tick, i.e. resolution()
+ * (1 to 4 ms depending on CONFIG_HZ), but when timer interrupts are
+ * delayed (e.g. in virtual machines) the lag can reach a few ticks
+ * (the dcp-bench benchmark BM_Clock_CoarseLag reports it). An age
+ * computed from two coarse readings is off by about one tick in
+ * either direction; an age computed from a coarse reading and a
+ * precise one can be too large by the lag (precise minus coarse) or
+ * come out as zero (coarse minus a slightly later precise reading,
+ * see TimeStampT::milliseconds_passed_since). Hence coarse timestamps
+ * should only be used where such errors are negligible against the
+ * intervals involved (timeouts and periods of tens of milliseconds
+ * or more).
+ *
+ * Cost: when the precise clocksource can be read from user space
+ * (TSC) both clocks are served by the vDSO and the saving is modest;
+ * with other clocksources (hpet, acpi_pm, some virtualised setups)
+ * the precise clock needs a system call whereas the coarse one does
+ * not.
+ *
+ * The realtime rather than the monotonic coarse clock is used since
+ * TimeStampT is based on std::chrono::high_resolution_clock, which is
+ * the system clock, and coarse and precise timestamps are mixed.
+ */
+
+
+namespace dcp {
+
+  static_assert (std::is_same_v<std::chrono::high_resolution_clock, std::chrono::system_clock>,
+		 "coarse clock requires high_resolution_clock to be the system clock");
+
+
+  class CoarseClock {
+  public:
+
+    /**
+     * @brief Returns the current time as of the last timer tick
+     */
+    static inline std::chrono::time_point<std::chrono::high_resolution_clock> now ()
+    {
+      struct timespec ts;
+      clock_gettime (CLOCK_REALTIME_COARSE, &ts);
+      return std::chrono::time_point<std::chrono::high_resolution_clock>
+	(std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>
+	 (std::chrono::seconds (ts.tv_sec) + std::chrono::nanoseconds (ts.tv_nsec)));
+    };
+
+
+    /**
+     * @brief Returns the resolution of the coarse clock, i.e. the
+     *        amount by which it normally lags behind the precise one
+     */
+    static inline std::chrono::nanoseconds resolution ()
+    {
+      struct timespec ts;
+      clock_getres (CLOCK_REALTIME_COARSE, &ts);
+      return std::chrono::seconds (ts.tv_sec) + std::chrono::nanoseconds (ts.tv_nsec);
+    };
+  };
+
+};  // namespace dcp
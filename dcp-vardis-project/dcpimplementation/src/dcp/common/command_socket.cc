@@ -20,6 +20,9 @@
 
 
 extern "C" {
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/time.h>
@@ -27,6 +30,8 @@ extern "C" {
 #include <unistd.h>
 #include <string.h>
 }
+#include <algorithm>
+#include <chrono>
 #include <dcp/common/command_socket.h>
 #include <dcp/common/exceptions.h>
 #include <dcp/common/global_types_constants.h>
@@ -36,6 +41,7 @@ extern "C" {
 namespace dcp {
 
   static const int commandSocketListenBufferBacklog = 20;
+  static const int commandSocketMaxEvents           = 16;
 
   // -----------------------------------------------------------------------------------------
 
@@ -58,6 +64,7 @@ namespace dcp {
     {
       if (the_command_socket >= 0)
 	close_owner();
+      close_client_connection ();
     };
 
   
@@ -139,6 +146,33 @@ namespace dcp {
 			       std::format("cannot call listen on command socket, errno = {}", strerror (errno)));
       }
 
+    // accept connections without blocking and watch them with epoll
+    ret = fcntl (the_command_socket, F_SETFL, fcntl (the_command_socket, F_GETFL, 0) | O_NONBLOCK);
+    if (ret < 0)
+      {
+	DCPLOG_FATAL(log) << "Cannot make command socket non-blocking, errno = " << errno << " , text = " << strerror(errno);
+	close (the_command_socket);
+	unlink (socket_name);
+	throw SocketException ("open_owner",
+			       std::format("cannot make command socket non-blocking, errno = {}", strerror (errno)));
+      }
+
+    epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+    struct epoll_event ev;
+    ev.events  = EPOLLIN;
+    ev.data.fd = the_command_socket;
+    if ((epoll_fd < 0) or (epoll_ctl (epoll_fd, EPOLL_CTL_ADD, the_command_socket, &ev) < 0))
+      {
+	DCPLOG_FATAL(log) << "Cannot set up epoll for command socket, errno = " << errno << " , text = " << strerror(errno);
+	if (epoll_fd >= 0)
+	  close (epoll_fd);
+	epoll_fd = -1;
+	close (the_command_socket);
+	unlink (socket_name);
+	throw SocketException ("open_owner",
+			       std::format("cannot set up epoll for command socket, errno = {}", strerror (errno)));
+      }
+
     if (the_command_socket < 0)
       throw SocketException ("open_owner", "command socket inexplicably not open");
   }
@@ -147,6 +181,13 @@ namespace dcp {
 
   void CommandSocket::close_owner ()
   {
+    for (auto& conn : connections)
+      close (conn.first);
+    connections.clear ();
+    data_socket = -1;
+    if (epoll_fd >= 0)
+      close (epoll_fd);
+    epoll_fd = -1;
     if (the_command_socket >= 0)
       {
 	unlink (socketName.c_str());
@@ -157,51 +198,198 @@ namespace dcp {
 
   // -----------------------------------------------------------------------------------------
 
-  int CommandSocket::read_owner (logger_type& log, int& data_socket, byte* buffer, size_t buflen)
+  void CommandSocket::close_connection (int fd)
   {
-    if (the_command_socket < 0)
+    epoll_ctl (epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+    close (fd);
+    connections.erase (fd);
+  }
+
+  // -----------------------------------------------------------------------------------------
+
+  void CommandSocket::accept_connections (logger_type& log)
+  {
+    while (true)
       {
-	return -1;
+	int fd = accept4 (the_command_socket, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+	if (fd < 0)
+	  {
+	    if ((errno != EAGAIN) and (errno != EWOULDBLOCK) and (errno != EINTR))
+	      DCPLOG_ERROR(log) << "CommandSocket::accept_connections: accept() returns error, errno = " << errno << " , text = " << strerror(errno);
+	    return;
+	  }
+
+	if (connections.size() >= maxCommandSocketConnections)
+	  {
+	    DCPLOG_ERROR(log) << "CommandSocket::accept_connections: too many client connections, rejecting new one";
+	    close (fd);
+	    continue;
+	  }
+
+	struct epoll_event ev;
+	ev.events  = EPOLLIN;
+	ev.data.fd = fd;
+	if (epoll_ctl (epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0)
+	  {
+	    DCPLOG_ERROR(log) << "CommandSocket::accept_connections: epoll_ctl() returns error, errno = " << errno << " , text = " << strerror(errno);
+	    close (fd);
+	    continue;
+	  }
+	connections[fd] = CommandConnection ();
       }
-    
-    // we first call select with a timeout before calling accept
-    // (because accept does not have timeout parameter)
-    struct timeval tv = milliseconds_to_timeval (socketTimeoutMS);
-    fd_set rfds;
-    FD_ZERO(&rfds);
-    FD_SET(the_command_socket, &rfds);
-    int rv = select(the_command_socket + 1, &rfds, NULL, NULL, &tv);
+  }
+
+  // -----------------------------------------------------------------------------------------
 
-    if (rv == 0)
+  void CommandSocket::read_connection (logger_type& log, int fd)
+  {
+    CommandConnection& conn = connections[fd];
+    byte buffer [command_sock_buffer_size];
+    while (true)
       {
-	return 0;
+	ssize_t nbytes = read (fd, buffer, sizeof(buffer));
+	if (nbytes == 0)
+	  {
+	    close_connection (fd);
+	    return;
+	  }
+	if (nbytes < 0)
+	  {
+	    if (errno == EINTR)
+	      continue;
+	    if ((errno == EAGAIN) or (errno == EWOULDBLOCK))
+	      return;
+	    DCPLOG_ERROR(log) << "CommandSocket::read_connection: read() returns error, errno = " << errno << " , text = " << strerror(errno);
+	    close_connection (fd);
+	    return;
+	  }
+	conn.inbuf.insert (conn.inbuf.end(), buffer, buffer + nbytes);
+	if (conn.inbuf.size() > maxCommandSocketPendingInput)
+	  {
+	    DCPLOG_ERROR(log) << "CommandSocket::read_connection: too much unprocessed request data, closing connection";
+	    close_connection (fd);
+	    return;
+	  }
       }
+  }
 
-    if (rv < 0)
+  // -----------------------------------------------------------------------------------------
+
+  void CommandSocket::flush_connection (logger_type& log, int fd)
+  {
+    CommandConnection& conn = connections[fd];
+    while (conn.out_sent < conn.outbuf.size())
       {
-	DCPLOG_FATAL(log) << "CommandSocket::read_owner: select() returns error, errno = " << errno << " , text = " << strerror(errno);
-	return -1;
+	ssize_t nbytes = send (fd, conn.outbuf.data() + conn.out_sent, conn.outbuf.size() - conn.out_sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+	if (nbytes < 0)
+	  {
+	    if (errno == EINTR)
+	      continue;
+	    if ((errno == EAGAIN) or (errno == EWOULDBLOCK))
+	      break;
+	    DCPLOG_ERROR(log) << "CommandSocket::flush_connection: send() returns error, errno = " << errno << " , text = " << strerror(errno);
+	    close_connection (fd);
+	    return;
+	  }
+	conn.out_sent += nbytes;
       }
-    
-    // now call accept
-    data_socket = accept (the_command_socket, NULL, NULL);
-    if (data_socket < 0)
+
+    if (conn.out_sent == conn.outbuf.size())
       {
-	DCPLOG_FATAL(log) << "CommandSocket::read_owner: accept() returns error, errno = " << errno << " , text = " << strerror(errno);
-	return - 1;
+	conn.outbuf.clear ();
+	conn.out_sent = 0;
       }
-	    
-    // read received data, check its validity and process it
-    int nbytes = read (data_socket, buffer, buflen);
-    
-    if (nbytes < 0)
+    else if (conn.outbuf.size() - conn.out_sent > maxCommandSocketPendingOutput)
       {
-	DCPLOG_FATAL(log) << "CommandSocket::read_owner: read() returns error, errno = " << errno << " , text = " << strerror(errno);
-	close (data_socket);
-	return -1;
+	DCPLOG_ERROR(log) << "CommandSocket::flush_connection: client does not read responses, closing connection";
+	close_connection (fd);
+	return;
       }
 
-    return nbytes;
+    // only ask for EPOLLOUT while there is data pending
+    bool want_write = not conn.outbuf.empty();
+    if (want_write != conn.want_write)
+      {
+	struct epoll_event ev;
+	ev.events  = want_write ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+	ev.data.fd = fd;
+	epoll_ctl (epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+	conn.want_write = want_write;
+      }
+  }
+
+  // -----------------------------------------------------------------------------------------
+
+  bool CommandSocket::poll_connections (logger_type& log, int timeoutMS)
+  {
+    struct epoll_event events [commandSocketMaxEvents];
+    int nev = epoll_wait (epoll_fd, events, commandSocketMaxEvents, timeoutMS);
+
+    if (nev < 0)
+      {
+	if (errno == EINTR)
+	  return true;
+	DCPLOG_FATAL(log) << "CommandSocket::poll_connections: epoll_wait() returns error, errno = " << errno << " , text = " << strerror(errno);
+	return false;
+      }
+
+    for (int i = 0; i < nev; i++)
+      {
+	int fd = events[i].data.fd;
+	if (fd == the_command_socket)
+	  {
+	    accept_connections (log);
+	    continue;
+	  }
+	if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+	  read_connection (log, fd);
+	if ((events[i].events & EPOLLOUT) and connections.contains (fd))
+	  flush_connection (log, fd);
+      }
+    return true;
+  }
+
+  // -----------------------------------------------------------------------------------------
+
+  int CommandSocket::next_buffered_request (logger_type& log, byte* buffer, size_t buflen)
+  {
+    if (connections.empty())
+      return 0;
+
+    // start with the connection after the one served last, so that
+    // a client pipelining many requests cannot starve the others
+    auto it = connections.upper_bound (last_served);
+    for (size_t i = 0; i < connections.size(); i++, it++)
+      {
+	if (it == connections.end())
+	  it = connections.begin();
+
+	CommandConnection& conn = it->second;
+	if (conn.inbuf.size() < sizeof(CommandFrameLengthT))
+	  continue;
+
+	CommandFrameLengthT len;
+	std::memcpy (&len, conn.inbuf.data(), sizeof(CommandFrameLengthT));
+	if ((len > buflen) or (len < sizeof(DcpServiceType)))
+	  {
+	    DCPLOG_ERROR(log) << "CommandSocket::next_buffered_request: invalid request length " << len << ", closing connection";
+	    close_connection (it->first);
+	    return next_buffered_request (log, buffer, buflen);
+	  }
+	if (conn.inbuf.size() < sizeof(CommandFrameLengthT) + len)
+	  continue;
+
+	std::memcpy (buffer, conn.inbuf.data() + sizeof(CommandFrameLengthT), len);
+	conn.inbuf.erase (conn.inbuf.begin(), conn.inbuf.begin() + sizeof(CommandFrameLengthT) + len);
+
+	// reserve room for the length field of the response frame
+	data_socket  = it->first;
+	last_served  = it->first;
+	reply_start  = conn.outbuf.size();
+	conn.outbuf.resize (reply_start + sizeof(CommandFrameLengthT));
+	return (int) len;
+      }
+    return 0;
   }
 
   // -----------------------------------------------------------------------------------------
@@ -216,33 +404,35 @@ namespace dcp {
 	exitFlag = true;
 	return -1;
       }
-    
-    int nbytes = read_owner (log, data_socket, buffer, buflen);
-    
-    if (nbytes < 0)
+
+    if ((the_command_socket < 0) or (epoll_fd < 0))
       {
-	DCPLOG_FATAL(log) << "CommandSocket::start_read_command: Error reading from socket. Exiting.";
+	DCPLOG_FATAL(log) << "CommandSocket::start_read_command: command socket not open. Exiting.";
 	exitFlag = true;
-	if (data_socket >= 0)
+	return -1;
+      }
+
+    // pipelined requests may already be buffered, otherwise wait
+    // until a complete request has come in or the timeout expires
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds (socketTimeoutMS);
+    int nbytes    = next_buffered_request (log, buffer, buflen);
+    while (nbytes == 0)
+      {
+	auto remaining = std::chrono::duration_cast<std::chrono::milliseconds> (deadline - std::chrono::steady_clock::now()).count();
+	if (remaining <= 0)
+	  break;
+	if (not poll_connections (log, (int) remaining))
 	  {
-	    close (data_socket);
-	    data_socket = -1;
+	    DCPLOG_FATAL(log) << "CommandSocket::start_read_command: Error reading from socket. Exiting.";
+	    exitFlag = true;
+	    return -1;
 	  }
-	return -1;
+	nbytes = next_buffered_request (log, buffer, buflen);
       }
 
     if (nbytes == 0)
       return nbytes;
     
-    if (((size_t) nbytes) < sizeof(DcpServiceType))
-      {
-	DCPLOG_FATAL(log) << "CommandSocket::start_read_command: truncated service type, nbytes = " << nbytes;
-	close (data_socket);
-	data_socket = -1;
-	exitFlag = true;
-	return -1;
-      }
-    
     // dispatch on actual service type
     serv_t = *((DcpServiceType*) buffer);
     
@@ -260,68 +450,53 @@ namespace dcp {
 	exitFlag = true;
 	return -1;
       }
-    close (data_socket);
+
+    // fill in the length of the response frame, or drop the frame
+    // when the request had no response
+    CommandConnection&   conn = connections[data_socket];
+    CommandFrameLengthT  len  = conn.outbuf.size() - reply_start - sizeof(CommandFrameLengthT);
+    if (len == 0)
+      conn.outbuf.resize (reply_start);
+    else
+      std::memcpy (conn.outbuf.data() + reply_start, &len, sizeof(CommandFrameLengthT));
+
+    int fd      = data_socket;
     data_socket = -1;
+    flush_connection (log, fd);
     return 0;
   };
 
 
   // -----------------------------------------------------------------------------------------
 
-  void CommandSocket::send_raw_confirmation (logger_type& log, const ServiceConfirm& conf, ssize_t confsize, bool& exitFlag)
+  bool CommandSocket::append_response (logger_type& log, const byte* data, size_t len, const char* methname, bool& exitFlag)
   {
     if (data_socket < 0)
       {
-	DCPLOG_FATAL(log) << "CommandSocket::send_raw_confirmation: no data socket";
+	DCPLOG_FATAL(log) << "CommandSocket::" << methname << ": no data socket";
 	exitFlag = true;
-	return;
+	return false;
       }
 
-    ssize_t bytessent = write (data_socket, (void*) &conf, confsize);
-        
-    if (bytessent < 0)
-      {
-	DCPLOG_FATAL(log) << "CommandSocket::send_raw_confirmation: Error sending confirmation primitive, error when calling sendto(), errno = " << errno << " , text = " << strerror(errno);
-	exitFlag = true;
-	return;
-      }
+    std::vector<byte>& outbuf = connections[data_socket].outbuf;
+    outbuf.insert (outbuf.end(), data, data + len);
+    return true;
+  }
 
-    if (bytessent != confsize)
-      {
-	DCPLOG_FATAL(log) << "CommandSocket::send_raw_confirmation: Error sending confirmation primitive, wrong number of bytes sent = " << bytessent;
-	exitFlag = true;
-	return;
-      }
+  // -----------------------------------------------------------------------------------------
+
+  void CommandSocket::send_raw_confirmation (logger_type& log, const ServiceConfirm& conf, ssize_t confsize, bool& exitFlag)
+  {
+    append_response (log, (const byte*) &conf, confsize, "send_raw_confirmation", exitFlag);
   }
   
   // -----------------------------------------------------------------------------------------
 
   ssize_t CommandSocket::send_raw_data (logger_type& log, byte* buffer, size_t len, bool& exitFlag)
   {
-    if (data_socket < 0)
-      {
-	DCPLOG_FATAL(log) << "CommandSocket::send_raw_data: no data socket";
-	exitFlag = true;
-	return -1;
-      }
-
-    ssize_t bytessent = write (data_socket, (void*) buffer, len);
-    
-    if (bytessent < 0)
-      {
-	DCPLOG_FATAL(log) << "CommandSocket::send_raw_data: error when calling write(), errno = " << errno << " , text = " << strerror(errno);
-	exitFlag = true;
-	return -1;
-      }
-    
-    if (((size_t) bytessent) != len)
-      {
-	DCPLOG_FATAL(log) << "CommandSocket::send_raw_data: error when calling write(), wrong number of bytes sent = " << bytessent;
-	exitFlag = true;
-	return -1;
-      }
-    
-    return bytessent;
+    if (not append_response (log, buffer, len, "send_raw_data", exitFlag))
+      return -1;
+    return len;
   }
   
   // -----------------------------------------------------------------------------------------
@@ -374,18 +549,66 @@ namespace dcp {
 
   // -----------------------------------------------------------------------------------------
   
-  int ScopedClientSocket::read_whole_response (byte* buffer, size_t buffer_len, int max_attempts)
+  int CommandSocket::acquire_client_connection ()
   {
-    if (the_sock < 0)
+    if (client_socket >= 0)
       {
-	throw SocketException ("read_whole_response", "invalid socket");
-	return -1;
+	// an idle connection has nothing to read, unless the server
+	// has closed it in the meantime
+	struct pollfd pfd;
+	pfd.fd      = client_socket;
+	pfd.events  = POLLIN;
+	pfd.revents = 0;
+	if (poll (&pfd, 1, 0) != 0)
+	  close_client_connection ();
       }
-    
+
+    if (client_socket < 0)
+      client_socket = open_client ();
+    return client_socket;
+  }
+
+  // -----------------------------------------------------------------------------------------
+
+  void CommandSocket::close_client_connection ()
+  {
+    if (client_socket >= 0)
+      close (client_socket);
+    client_socket = -1;
+  }
+
+  // -----------------------------------------------------------------------------------------
+
+  void ScopedClientSocket::send_frame (const byte* data, size_t len)
+  {
+    if (the_sock < 0)
+      throw SocketException ("send_frame", "invalid socket");
+
+    CommandFrameLengthT  frame_len = len;
+    struct iovec         iov [2];
+    iov[0].iov_base = (void*) &frame_len;
+    iov[0].iov_len  = sizeof(CommandFrameLengthT);
+    iov[1].iov_base = (void*) data;
+    iov[1].iov_len  = len;
+
+    struct msghdr msg;
+    std::memset (&msg, 0, sizeof(msg));
+    msg.msg_iov    = iov;
+    msg.msg_iovlen = 2;
+
+    ssize_t ret = sendmsg (the_sock, &msg, MSG_NOSIGNAL);
+    if (ret != (ssize_t) (sizeof(CommandFrameLengthT) + len))
+      abort (std::format ("send_frame: cannot send request, errno = {}", strerror (errno)));
+  }
+
+  // -----------------------------------------------------------------------------------------
+
+  void ScopedClientSocket::read_exact (byte* buffer, size_t len, int max_attempts)
+  {
     size_t bytes_read = 0;
     int    attempts   = 0;
     
-    while (true)
+    while (bytes_read < len)
       {
 	fd_set set;
 	struct timeval timeout;
@@ -398,30 +621,51 @@ namespace dcp {
 	
 	int rv = select (the_sock + 1, &set, NULL, NULL, &timeout);
 	if (rv == -1)
-	  throw SocketException ("read_whole_response",
-				 std::format("select() returns errno = {}", strerror (errno)));
-	
-	if ((rv == 0) and (attempts >= max_attempts))
-	  throw SocketException ("read_whole_response", "exhausted all attempts to read from socket");
+	  abort (std::format("read_whole_response: select() returns errno = {}", strerror (errno)));
+
+	if (rv == 0)
+	  {
+	    if (attempts >= max_attempts)
+	      abort ("read_whole_response: exhausted all attempts to read from socket");
+	    continue;
+	  }
 	
-	int nrcvd = read (the_sock, (void*) (buffer + bytes_read), buffer_len - bytes_read);
+	int nrcvd = read (the_sock, (void*) (buffer + bytes_read), len - bytes_read);
 	
 	if (nrcvd < 0)
-	  throw SocketException ("read_whole_response",
-				 std::format("read() returns errno = {}", strerror (errno)));
+	  abort (std::format("read_whole_response: read() returns errno = {}", strerror (errno)));
 	
 	if (nrcvd == 0)
-	  {
-	    return bytes_read;
-	  }
+	  abort ("read_whole_response: connection closed by server");
 	
 	bytes_read += nrcvd;
-	
-	if (bytes_read > buffer_len)
-	  throw SocketException ("read_whole_response",
-				 std::format("buffer provided ({} B) is too small (req: {} B", buffer_len, bytes_read));
       }
   }
+
+  // -----------------------------------------------------------------------------------------
+  
+  int ScopedClientSocket::read_whole_response (byte* buffer, size_t buffer_len, int max_attempts)
+  {
+    if (the_sock < 0)
+      {
+	throw SocketException ("read_whole_response", "invalid socket");
+	return -1;
+      }
+
+    if (not in_frame)
+      {
+	CommandFrameLengthT frame_len;
+	read_exact ((byte*) &frame_len, sizeof(CommandFrameLengthT), max_attempts);
+	in_frame        = true;
+	frame_remaining = frame_len;
+      }
+
+    size_t len = std::min (buffer_len, frame_remaining);
+    if (len > 0)
+      read_exact (buffer, len, max_attempts);
+    frame_remaining -= len;
+    return len;
+  }
   
 
   // -----------------------------------------------------------------------------------------
@@ -24,7 +24,10 @@
 
 #include <cstdint>
 #include <format>
+#include <map>
+#include <mutex>
 #include <string>
+#include <vector>
 #include <dcp/common/configuration.h>
 #include <dcp/common/exceptions.h>
 #include <dcp/common/global_types_constants.h>
@@ -41,9 +44,39 @@ namespace dcp {
    * Command sockets are used to send commands from a 'client' to a
    * 'server' and have the server send responses back to the
    * client. The server is assumed to be active permanently (they
-   * accept client connections at any time), whereas clients use
-   * ephemeral connections to interact with the server.
+   * accept client connections at any time). Clients keep one
+   * persistent connection to the server, over which they send any
+   * number of requests.
+   *
+   * Every request and every response is sent as a frame, consisting
+   * of a length field (of type CommandFrameLengthT, in host byte
+   * order) followed by that many bytes of data. Requests without a
+   * response (e.g. shutdown) produce no response frame. The server
+   * multiplexes all client connections with epoll and processes
+   * requests one at a time, in round-robin order over the
+   * connections. Responses are buffered per connection and written
+   * without blocking, so that a client that reads slowly does not
+   * hold up the others.
+   */
+
+
+  typedef uint32_t CommandFrameLengthT;   /*!< Type of the length field preceding every frame */
+
+  const size_t maxCommandSocketConnections   = 64;                /*!< Maximum number of concurrent client connections */
+  const size_t maxCommandSocketPendingInput  = 64 * 1024;         /*!< Connections buffering more unprocessed request data are closed */
+  const size_t maxCommandSocketPendingOutput = 4 * 1024 * 1024;   /*!< Connections buffering more unsent response data are closed */
+
+
+  /**
+   * @brief Server-side state of one client connection
    */
+  class CommandConnection {
+  public:
+    std::vector<byte>  inbuf;              /*!< Received data not yet processed */
+    std::vector<byte>  outbuf;             /*!< Response data not yet sent */
+    size_t             out_sent = 0;       /*!< Number of bytes of outbuf already sent */
+    bool               want_write = false; /*!< Whether the connection is registered for EPOLLOUT */
+  };
 
 
   /**
@@ -52,25 +85,74 @@ namespace dcp {
   class CommandSocket {
   private:
     int           the_command_socket   = -1;     /*!< Socket on which the server accepts connection requests */
-    int           data_socket          = -1;     /*!< Current data socket when interacting with a client */
+    int           data_socket          = -1;     /*!< Connection of the request currently being processed */
     std::string   socketName           = "";     /*!< Socket name, should be valid filename for Unix Domain Socket */
     uint16_t      socketTimeoutMS      =  defaultValueCommandSocketTimeoutMS;   /*!< Timeout for reading from command socket */
 
+    int                                 epoll_fd    = -1;   /*!< Epoll instance watching the command socket and all connections */
+    std::map<int, CommandConnection>    connections;        /*!< Open client connections, by socket descriptor */
+    int                                 last_served = -1;   /*!< Connection whose request was processed last */
+    size_t                              reply_start = 0;    /*!< Position of the response frame in the output buffer of data_socket */
+
+    int           client_socket        = -1;     /*!< Persistent connection to the server (client side) */
+    std::mutex    client_mutex;                  /*!< Serializes request/response exchanges over client_socket */
+
+
     /**
-     * @brief Waits for an incoming client connection for a limited
-     *        amount of time and attempts to read data from it.
+     * @brief Waits up to the given time for events on the command
+     *        socket and the client connections, accepts new
+     *        connections, reads incoming request data and writes
+     *        pending response data.
      *
-     * @param log: the logging object to use
-     * @param data_socket: the data socket returned by accept() call
-     * @param buffer: buffer in which any read data is stored
-     * @param buflen: length of buffer
+     * @return false in case of a fatal error, true otherwise
+     */
+    bool poll_connections (logger_type& log, int timeoutMS);
+
+
+    /**
+     * @brief Removes the first complete request frame from the input
+     *        buffer of the connections, checking them in round-robin
+     *        order, copies it into the given buffer and makes the
+     *        connection the current one.
      *
-     * @return -1 in case of any error, 0 when no connection request
-     *         came in during timeout, and >0 when data has been read
-     *         from incoming connection -- in this case the return
-     *         value gives the number of data bytes read.
+     * @return Length of the request, or 0 if no connection has a
+     *         complete request buffered. Connections sending invalid
+     *         frames are closed.
+     */
+    int next_buffered_request (logger_type& log, byte* buffer, size_t buflen);
+
+
+    /**
+     * @brief Accepts all pending connection requests
      */
-    int read_owner (logger_type& log, int& data_socket, byte* buffer, size_t buflen);
+    void accept_connections (logger_type& log);
+
+
+    /**
+     * @brief Reads all available data from a connection into its
+     *        input buffer. Closes the connection on EOF or error.
+     */
+    void read_connection (logger_type& log, int fd);
+
+
+    /**
+     * @brief Writes as much pending response data of a connection as
+     *        possible without blocking. Closes the connection on
+     *        error or when too much data is pending.
+     */
+    void flush_connection (logger_type& log, int fd);
+
+
+    /**
+     * @brief Closes a client connection and discards its state
+     */
+    void close_connection (int fd);
+
+
+    /**
+     * @brief Appends response data to the current connection
+     */
+    bool append_response (logger_type& log, const byte* data, size_t len, const char* methname, bool& exitFlag);
     
   public:
 
@@ -136,7 +218,11 @@ namespace dcp {
 
     /**
      * @brief Method for the server to attempt reading a command from
-     *        an incoming connection
+     *        any client connection. Waits at most for the socket
+     *        timeout, returns 0 when no request came in during that
+     *        time, -1 on error and otherwise the length of the
+     *        request. The response is collected from the send
+     *        methods until stop_read_command() is called.
      *
      * @param log: logging object to use
      * @param buffer: buffer to store read data in
@@ -149,7 +235,7 @@ namespace dcp {
 
 
     /**
-     * @brief Sends a confirmation primitive over the current data socket (server side, responding to a request)
+     * @brief Sends a confirmation primitive over the current connection (server side, responding to a request)
      *
      * @param log: logging object to use
      * @param conf: The confirmation to send (of type ServiceConfirm or derived)
@@ -162,7 +248,7 @@ namespace dcp {
 
     /**
      * @brief Template method to create and send a simple confirmation
-     *        over the current data socket (server side). A simple
+     *        over the current connection (server side). A simple
      *        confirmation is one with fixed data size
      *
      * @tparam CT: Type of confirmation to create (and send)
@@ -181,7 +267,7 @@ namespace dcp {
 
     
     /**
-     * @brief Sends a block of raw data over the current data socket
+     * @brief Sends a block of raw data over the current connection
      *        (server side)
      *
      * @param log: logging object to use
@@ -194,7 +280,9 @@ namespace dcp {
 
 
     /**
-     * @brief Used by server to close a data socket after processing command
+     * @brief Used by server to complete the response after processing
+     *        a command. The response is sent as one frame, the
+     *        connection stays open for further requests.
      *
      * @param log: logging object to use
      * @param exitFlag: output value, will be set to true when processing error
@@ -213,6 +301,28 @@ namespace dcp {
      * is set. Throws exceptions upon processing error.
      */
     int open_client (); 
+
+
+    /**
+     * @brief Returns the persistent client connection, opening it
+     *        first if needed. A connection that the server has
+     *        closed meanwhile is replaced by a new one. Caller must
+     *        hold the client mutex.
+     */
+    int acquire_client_connection ();
+
+
+    /**
+     * @brief Closes the persistent client connection, if open
+     */
+    void close_client_connection ();
+
+
+    /**
+     * @brief Returns the mutex serializing exchanges over the client
+     *        connection
+     */
+    inline std::mutex& get_client_mutex () { return client_mutex; };
     
   };
   
@@ -221,8 +331,9 @@ namespace dcp {
 
 
   /**
-   * @brief Opens and closes a command socket as a client following
-   *        the lifetime of this object.
+   * @brief Carries out one request/response exchange over the
+   *        persistent client connection of a command socket, holding
+   *        the connection exclusively for the lifetime of this object.
    *
    * The methods of this class throw exceptions in case of processing
    * errors.
@@ -230,33 +341,53 @@ namespace dcp {
   class ScopedClientSocket {
 
   private:
-    int the_sock = -1;  /*!< Socket descriptor */
+    CommandSocket&                 cmdsock;                 /*!< Command socket owning the connection */
+    std::unique_lock<std::mutex>   lock;                    /*!< Held for the lifetime of this object */
+    int                            the_sock = -1;           /*!< Socket descriptor */
+    bool                           in_frame = false;        /*!< Whether the header of the response frame has been read */
+    size_t                         frame_remaining = 0;     /*!< Unread bytes of the response frame */
+
+
+    /**
+     * @brief Sends the given data as one frame
+     */
+    void send_frame (const byte* data, size_t len);
+
 
+    /**
+     * @brief Reads exactly len bytes, throws on EOF, error or timeout
+     */
+    void read_exact (byte* buffer, size_t len, int max_attempts);
+    
   public:
     
     ScopedClientSocket () = delete;
 
 
     /**
-     * @brief Constructor, opens the given command socket as a client
+     * @brief Constructor, obtains the persistent client connection of
+     *        the given command socket, opening it if needed
      *
      * @param cmdsock: The command socket to use, needs to include the socket name
      */
     ScopedClientSocket (CommandSocket& cmdsock)
+      : cmdsock (cmdsock),
+	lock (cmdsock.get_client_mutex())
     {
-      the_sock = cmdsock.open_client ();
+      the_sock = cmdsock.acquire_client_connection ();
       if (the_sock < 0)
 	throw ManagementException ("ScopedClientSocket", "invalid socket");
     };
 
 
     /**
-     * @brief Destructor, closes the command socket
+     * @brief Destructor. The connection is kept open for the next
+     *        exchange, unless part of the response was left unread
      */
     ~ScopedClientSocket ()
     {
-      if (the_sock >= 0)
-	close (the_sock);
+      if ((the_sock >= 0) and (frame_remaining > 0))
+	cmdsock.close_client_connection ();
     };
 
 
@@ -267,8 +398,10 @@ namespace dcp {
 
 
     /**
-     * @brief Reads all available data from the socket until EOF and
-     *        places it in given buffer
+     * @brief Reads the response data from the socket until the end of
+     *        the response frame (or until the buffer is full) and
+     *        places it in given buffer. Repeated calls continue
+     *        reading the same response.
      *
      * @param buffer: points to the buffer into which to store data
      * @param buffer_len: maximum amount of data that can be stored in that buffer
@@ -297,10 +430,7 @@ namespace dcp {
     int sendRequestAndReadResponseBlock (RT& sReq, byte* buffer, size_t buffer_len)
     {
       // send service request
-      int ret = write (the_sock, (void*) &sReq, sizeof(sReq));
-      
-      if (ret < 0)
-	abort ("sendRequestAndReadResponseBlock: cannot send request");
+      send_frame ((const byte*) &sReq, sizeof(sReq));
       
       // await and check response
       return read_whole_response (buffer, buffer_len);
@@ -314,25 +444,21 @@ namespace dcp {
      */
     template <class RT>
     int sendRequest (RT& sReq)
-      {
-	// send service request
-	int ret = write (the_sock, (void*) &sReq, sizeof(sReq));
-	
-	if (ret < 0)
-	  abort ("sendRequest: cannot send request");
-
-	return ret;
+    {
+      // send service request
+      send_frame ((const byte*) &sReq, sizeof(sReq));
+      return sizeof(sReq);
     }
 
     
 
     /**
-     * @brief Closes the client socket and throws an exception
+     * @brief Closes the client connection and throws an exception
      */
     void abort (const std::string& msg)
     {
       if (the_sock >= 0)
-	close (the_sock);
+	cmdsock.close_client_connection ();
       the_sock = -1;
       throw SocketException ("ScopedClientSocket::abort", msg);
     };
@@ -0,0 +1,255 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+
+extern "C" {
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <string.h>
+}
+#include <format>
+#include <dcp/common/event_loop.h>
+
+
+namespace dcp {
+
+  static const int eventLoopMaxEvents = 16;
+
+  // -----------------------------------------------------------------------------------------
+
+  static void arm_timerfd (int fd, uint32_t firstMS, uint32_t periodMS)
+  {
+    struct itimerspec its;
+    its.it_value.tv_sec     = firstMS / 1000;
+    its.it_value.tv_nsec    = (firstMS % 1000) * 1000000L;
+    its.it_interval.tv_sec  = periodMS / 1000;
+    its.it_interval.tv_nsec = (periodMS % 1000) * 1000000L;
+
+    // a zero it_value would disarm the timer
+    if (firstMS == 0)
+      its.it_value.tv_nsec = 1;
+    
+    if (timerfd_settime (fd, 0, &its, nullptr) < 0)
+      throw EventLoopException ("EventLoop", std::format ("cannot arm timer, errno = {}", strerror (errno)));
+  }
+
+  // -----------------------------------------------------------------------------------------
+
+  EventLoop::EventLoop ()
+  {
+    epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+    if (epoll_fd < 0)
+      throw EventLoopException ("EventLoop::ctor", std::format ("cannot create epoll instance, errno = {}", strerror (errno)));
+
+    stop_fd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event ev;
+    ev.events    = EPOLLIN;
+    ev.data.u64  = (EventId) stop_fd;
+    if ((stop_fd < 0) or (epoll_ctl (epoll_fd, EPOLL_CTL_ADD, stop_fd, &ev) < 0))
+      {
+	int err = errno;
+	if (stop_fd >= 0)
+	  close (stop_fd);
+	close (epoll_fd);
+	throw EventLoopException ("EventLoop::ctor", std::format ("cannot set up stop event, errno = {}", strerror (err)));
+      }
+  }
+
+  // -----------------------------------------------------------------------------------------
+
+  EventLoop::~EventLoop ()
+  {
+    while (not entries.empty())
+      remove (entries.begin()->first);
+    close (stop_fd);
+    close (epoll_fd);
+  }
+
+  // -----------------------------------------------------------------------------------------
+
+  EventLoop::EventId EventLoop::add_entry (std::shared_ptr<Entry> entry)
+  {
+    entry->id = (((EventId) ++registrations) << 32) | (uint32_t) entry->fd;
+    
+    struct epoll_event ev;
+    ev.events    = EPOLLIN;
+    ev.data.u64  = entry->id;
+    if (epoll_ctl (epoll_fd, EPOLL_CTL_ADD, entry->fd, &ev) < 0)
+      {
+	int err = errno;
+	close (entry->fd);
+	throw EventLoopException ("EventLoop::add_entry", std::format ("cannot add descriptor {} to epoll set, errno = {}", entry->fd, strerror (err)));
+      }
+    entries[entry->id] = entry;
+    return entry->id;
+  }
+
+  // -----------------------------------------------------------------------------------------
+
+  EventLoop::EventId EventLoop::add_periodic_timer (uint32_t periodMS, Handler handler)
+  {
+    if (periodMS == 0)
+      throw EventLoopException ("EventLoop::add_periodic_timer", "period must be strictly positive");
+    
+    auto entry      = std::make_shared<Entry> ();
+    entry->type     = EntryType::PeriodicTimer;
+    entry->handler  = std::move (handler);
+    entry->periodMS = periodMS;
+    entry->due      = std::chrono::steady_clock::now () + std::chrono::milliseconds (periodMS);
+    entry->fd       = timerfd_create (CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (entry->fd < 0)
+      throw EventLoopException ("EventLoop::add_periodic_timer", std::format ("cannot create timer, errno = {}", strerror (errno)));
+    arm_timerfd (entry->fd, periodMS, periodMS);
+    return add_entry (entry);
+  }
+
+  // -----------------------------------------------------------------------------------------
+
+  EventLoop::EventId EventLoop::add_timer (uint32_t firstMS, TimerHandler handler)
+  {
+    auto entry            = std::make_shared<Entry> ();
+    entry->type           = EntryType::Timer;
+    entry->timer_handler  = std::move (handler);
+    entry->due            = std::chrono::steady_clock::now () + std::chrono::milliseconds (firstMS);
+    entry->fd             = timerfd_create (CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (entry->fd < 0)
+      throw EventLoopException ("EventLoop::add_timer", std::format ("cannot create timer, errno = {}", strerror (errno)));
+    arm_timerfd (entry->fd, firstMS, 0);
+    return add_entry (entry);
+  }
+
+  // -----------------------------------------------------------------------------------------
+
+  void EventLoop::remove (EventId id)
+  {
+    auto it = entries.find (id);
+    if (it == entries.end())
+      return;
+
+    int fd = it->second->fd;
+    epoll_ctl (epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    close (fd);
+
+    // marks the entry as removed for a dispatch still holding it
+    it->second->fd = -1;
+    entries.erase (it);
+  }
+
+  // -----------------------------------------------------------------------------------------
+
+  void EventLoop::stop ()
+  {
+    uint64_t one = 1;
+    [[maybe_unused]] auto rv = write (stop_fd, &one, sizeof(one));
+  }
+
+  // -----------------------------------------------------------------------------------------
+
+  void EventLoop::dispatch (Entry& entry)
+  {
+    uint64_t count;
+    switch (entry.type)
+      {
+      case EntryType::PeriodicTimer:
+	{
+	  // reading resets the expiration count, the lateness is
+	  // measured against the last of the coalesced expirations
+	  if (read (entry.fd, &count, sizeof(count)) != sizeof(count))
+	    return;
+	  auto period = std::chrono::milliseconds (entry.periodMS);
+	  entry.due += (count - 1) * period;
+	  if (wakeup_latency)
+	    wakeup_latency->record (std::chrono::steady_clock::now () - entry.due);
+	  entry.due += period;
+	  entry.handler ();
+	  break;
+	}
+
+      case EntryType::Timer:
+	{
+	  if (read (entry.fd, &count, sizeof(count)) != sizeof(count))
+	    return;
+	  if (wakeup_latency)
+	    wakeup_latency->record (std::chrono::steady_clock::now () - entry.due);
+	  uint32_t nextMS = entry.timer_handler ();
+	  if (entry.fd < 0)
+	    return;
+	  if (nextMS == 0)
+	    remove (entry.id);
+	  else
+	    {
+	      entry.due = std::chrono::steady_clock::now () + std::chrono::milliseconds (nextMS);
+	      arm_timerfd (entry.fd, nextMS, 0);
+	    }
+	  break;
+	}
+      }
+  }
+
+  // -----------------------------------------------------------------------------------------
+
+  size_t EventLoop::run_once (uint32_t timeoutMS)
+  {
+    struct epoll_event events [eventLoopMaxEvents];
+    int nfds = epoll_wait (epoll_fd, events, eventLoopMaxEvents, (int) timeoutMS);
+    if (nfds < 0)
+      {
+	if (errno == EINTR)
+	  return 0;
+	throw EventLoopException ("EventLoop::run_once", std::format ("epoll_wait fails, errno = {}", strerror (errno)));
+      }
+
+    size_t dispatched = 0;
+    for (int i = 0; i < nfds; i++)
+      {
+	EventId id = events[i].data.u64;
+	if (id == (EventId) stop_fd)
+	  {
+	    uint64_t count;
+	    [[maybe_unused]] auto rv = read (stop_fd, &count, sizeof(count));
+	    stopped = true;
+	    continue;
+	  }
+
+	// an earlier callback of this round may have removed the entry,
+	// or removed it and registered a new timer reusing its descriptor
+	auto it = entries.find (id);
+	if (it == entries.end())
+	  continue;
+
+	std::shared_ptr<Entry> entry = it->second;
+	dispatch (*entry);
+	dispatched++;
+      }
+    return dispatched;
+  }
+
+  // -----------------------------------------------------------------------------------------
+
+  void EventLoop::run (const bool& exitFlag, uint32_t checkIntervalMS)
+  {
+    stopped = false;
+    while ((not stopped) and (not exitFlag))
+      run_once (checkIntervalMS);
+  }
+  
+};  // namespace dcp
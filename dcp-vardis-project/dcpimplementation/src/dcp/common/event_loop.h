@@ -0,0 +1,165 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <dcp/common/exceptions.h>
+#include <dcp/common/metrics.h>
+
+
+namespace dcp {
+
+  /**
+   * @brief A reactor dispatching timers from one thread
+   *
+   * The event loop is built on epoll, timers are timerfds (on the
+   * monotonic clock). All callbacks run on the thread calling run(),
+   * one at a time, so state only touched by callbacks needs no
+   * locking.
+   *
+   * Registration and removal are allowed before run() and from
+   * within callbacks, but not from other threads. stop() may be
+   * called from any thread.
+   */
+
+  class EventLoop {
+  public:
+
+    /**
+     * @brief Callback for a timer, returns the time in ms until the
+     *        timer should fire again, or zero to remove the timer
+     */
+    typedef std::function<uint32_t ()> TimerHandler;
+
+    /**
+     * @brief Callback for periodic timers
+     */
+    typedef std::function<void ()> Handler;
+
+    /**
+     * @brief Identifies a timer: the registration number in the
+     *        upper, the timerfd in the lower 32 bits. Events of a
+     *        timer that has been removed within one round of epoll
+     *        events thus do not reach a new timer reusing its
+     *        descriptor.
+     */
+    typedef uint64_t EventId;
+
+
+    EventLoop ();
+    ~EventLoop ();
+    EventLoop (const EventLoop&) = delete;
+    EventLoop& operator= (const EventLoop&) = delete;
+
+
+    /**
+     * @brief Adds a periodic timer, first firing after one period.
+     *
+     * When the loop falls behind by more than a period (e.g. because
+     * a callback ran long), the missed expirations are coalesced into
+     * one call.
+     */
+    EventId add_periodic_timer (uint32_t periodMS, Handler handler);
+
+
+    /**
+     * @brief Adds a timer first firing after firstMS, afterwards
+     *        rearmed with the value returned by the handler
+     */
+    EventId add_timer (uint32_t firstMS, TimerHandler handler);
+
+
+    /**
+     * @brief Removes a timer. Unknown identifiers are ignored.
+     */
+    void remove (EventId id);
+
+
+    /**
+     * @brief Runs the loop until stop() is called or exitFlag gets
+     *        set. The flag is checked at least every checkIntervalMS,
+     *        and after every round of dispatched callbacks.
+     */
+    void run (const bool& exitFlag, uint32_t checkIntervalMS = 100);
+
+
+    /**
+     * @brief Waits at most timeoutMS for events and dispatches all
+     *        ready ones, returns the number of dispatched events
+     */
+    size_t run_once (uint32_t timeoutMS);
+
+
+    /**
+     * @brief Makes run() return after the current round of
+     *        callbacks. Can be called from any thread, also before
+     *        run().
+     */
+    void stop ();
+
+
+    /**
+     * @brief Records by how much timer callbacks start after their
+     *        expiry time in the given histogram (null pointer: no
+     *        measurement)
+     */
+    void set_wakeup_latency_histogram (LatencyHistogram* hist) { wakeup_latency = hist; };
+
+
+    /**
+     * @brief Returns number of registered timers
+     */
+    size_t size () const { return entries.size(); };
+    
+    
+  private:
+
+    enum class EntryType { Timer, PeriodicTimer };
+
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    struct Entry {
+      EntryType     type;
+      EventId       id       = 0;
+      int           fd;
+      TimerHandler  timer_handler;
+      Handler       handler;
+      TimePoint     due;              /*!< Next expiry of a timer */
+      uint32_t      periodMS = 0;     /*!< Period of a periodic timer */
+    };
+
+    int                                       epoll_fd        = -1;
+    int                                       stop_fd         = -1;
+    bool                                      stopped         = false;
+    uint32_t                                  registrations   = 0;   /*!< Registration number of the latest entry, the stop event has number zero */
+    LatencyHistogram*                         wakeup_latency  = nullptr;
+    std::map<EventId, std::shared_ptr<Entry>> entries;
+
+    EventId add_entry (std::shared_ptr<Entry> entry);
+    void    dispatch (Entry& entry);
+  };
+  
+};  // namespace dcp
@@ -68,6 +68,9 @@ namespace dcp {
 
   DCP_EXCEPTION(RingBufferException)
   DCP_EXCEPTION(AVLTreeException)
+  DCP_EXCEPTION(HashTableException)
+  DCP_EXCEPTION(SpatialGridException)
+  DCP_EXCEPTION(DeadlineHeapException)
   DCP_EXCEPTION(ConfigurationException)
   DCP_EXCEPTION(SocketException)
   DCP_EXCEPTION(ReceiverException)
@@ -82,6 +85,9 @@ namespace dcp {
   DCP_EXCEPTION(AssemblyAreaException)
   DCP_EXCEPTION(DisassemblyAreaException)
   DCP_EXCEPTION(ShmException)
+  DCP_EXCEPTION(MetricsException)
+  DCP_EXCEPTION(EventLoopException)
+  DCP_EXCEPTION(SchedulingException)
   DCP_EXCEPTION(VardisReceiveException)
   DCP_EXCEPTION(VardisTransmitException)
  
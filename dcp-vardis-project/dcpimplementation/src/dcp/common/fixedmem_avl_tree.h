@@ -558,6 +558,20 @@ namespace dcp {
       find_matching_data (right_ch (root), predicate, transform, result_lst); 
     }
 
+
+    /**
+     * @brief Calls fn(key, data) for all nodes of the sub-tree, in
+     *        key order
+     */
+    template <typename Fn>
+    void for_each (int root, Fn& fn) const
+    {
+      if (is_null (root)) return;
+      for_each (left_ch (root), fn);
+      fn (the_array[root].key, the_array[root].data);
+      for_each (right_ch (root), fn);
+    }
+
     
   public:
 
@@ -698,6 +712,17 @@ namespace dcp {
     {
       find_matching_data<R> (root, predicate, transform, result_lst);
     }
+
+
+    /**
+     * @brief Calls fn(key, data) for all nodes of the tree, in key
+     *        order
+     */
+    template <typename Fn>
+    inline void for_each (Fn fn) const
+    {
+      for_each (root, fn);
+    }
     
     /*********************************************************************
      * Public methods only relevant for unit testing
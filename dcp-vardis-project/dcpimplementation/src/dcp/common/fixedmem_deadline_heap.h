@@ -0,0 +1,282 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <dcp/common/exceptions.h>
+
+
+/**
+ * @brief This module provides an indexed binary min-heap of deadlines
+ *        over a fixed number of entries (identified by their slot
+ *        number) operating in fixed memory.
+ *
+ * Each slot holds at most one deadline. Besides the heap array, a
+ * position array maps every slot to its place in the heap, so that
+ * the deadline of any slot can be changed or removed in O(log n)
+ * time, and the earliest deadline is available in O(1).
+ *
+ * Like the other fixed-memory structures the heap contains no
+ * pointers, so it can be placed into a shared memory segment.
+ */
+
+
+namespace dcp {
+
+  /**
+   * @brief Indexed min-heap of deadlines over a fixed-size array of
+   *        entries
+   *
+   * @tparam DeadlineT: deadline type, must be copyable and provide
+   *         operator<
+   * @tparam maxEntries: number of entries (slots) that can be held
+   */
+  template <typename DeadlineT, uint64_t maxEntries>
+  class FixedMemDeadlineHeap {
+
+    static_assert (maxEntries >= 1, "FixedMemDeadlineHeap: maxEntries must be at least one");
+
+  protected:
+
+    static const int32_t H_NULL = -1;   /*!< Position of a slot that is not in the heap */
+
+    uint64_t   number_elements = 0;           /*!< Number of slots currently in the heap */
+    uint32_t   heap      [maxEntries];        /*!< Slots in heap order, earliest deadline first */
+    int32_t    position  [maxEntries];        /*!< Heap position of each slot, or H_NULL */
+    DeadlineT  deadlines [maxEntries];        /*!< Deadline of each slot */
+
+
+    inline bool earlier (uint64_t posA, uint64_t posB) const
+    {
+      return deadlines[heap[posA]] < deadlines[heap[posB]];
+    };
+
+
+    inline void swap_positions (uint64_t posA, uint64_t posB)
+    {
+      uint32_t tmp = heap[posA];
+      heap[posA]   = heap[posB];
+      heap[posB]   = tmp;
+      position[heap[posA]] = (int32_t) posA;
+      position[heap[posB]] = (int32_t) posB;
+    };
+
+
+    inline void sift_up (uint64_t pos)
+    {
+      while ((pos > 0) and earlier (pos, (pos-1)/2))
+	{
+	  swap_positions (pos, (pos-1)/2);
+	  pos = (pos-1)/2;
+	}
+    };
+
+
+    inline void sift_down (uint64_t pos)
+    {
+      while (true)
+	{
+	  uint64_t left     = 2*pos+1;
+	  uint64_t right    = 2*pos+2;
+	  uint64_t smallest = pos;
+	  if ((left < number_elements) and earlier (left, smallest))
+	    smallest = left;
+	  if ((right < number_elements) and earlier (right, smallest))
+	    smallest = right;
+	  if (smallest == pos)
+	    return;
+	  swap_positions (pos, smallest);
+	  pos = smallest;
+	}
+    };
+
+
+    /**
+     * @brief Calls fn(slot) for all entries in the subtree rooted at
+     *        the given heap position that are due, skipping subtrees
+     *        whose root is not due
+     */
+    template <typename Pred, typename Fn>
+    inline void visit_due (uint64_t pos, Pred& is_due, Fn& fn) const
+    {
+      if ((pos >= number_elements) or (not is_due (deadlines[heap[pos]])))
+	return;
+      fn ((uint64_t) heap[pos]);
+      visit_due (2*pos+1, is_due, fn);
+      visit_due (2*pos+2, is_due, fn);
+    }
+
+
+  public:
+
+    /**
+     * @brief Constructor, creates an empty heap
+     */
+    FixedMemDeadlineHeap ()
+    {
+      for (uint64_t i = 0; i < maxEntries; i++)
+	position[i] = H_NULL;
+    };
+
+
+    /**
+     * @brief Returns number of slots currently in the heap
+     */
+    inline uint64_t size () const { return number_elements; };
+
+
+    /**
+     * @brief Checks whether heap is empty
+     */
+    inline bool is_empty () const { return number_elements == 0; };
+
+
+    /**
+     * @brief Checks whether the given slot is currently in the heap
+     */
+    inline bool contains (uint64_t slot) const { return (slot < maxEntries) and (position[slot] != H_NULL); };
+
+
+    /**
+     * @brief Sets the deadline of the given slot, inserting the slot
+     *        if it is not yet in the heap. Throws for illegal slots
+     */
+    inline void update (uint64_t slot, const DeadlineT& deadline)
+    {
+      if (slot >= maxEntries)
+	throw DeadlineHeapException ("FixedMemDeadlineHeap::update", "slot out of range");
+
+      if (position[slot] == H_NULL)
+	{
+	  uint64_t pos     = number_elements++;
+	  heap[pos]        = (uint32_t) slot;
+	  position[slot]   = (int32_t) pos;
+	  deadlines[slot]  = deadline;
+	  sift_up (pos);
+	  return;
+	}
+
+      uint64_t pos = (uint64_t) position[slot];
+      bool moves_earlier = deadline < deadlines[slot];
+      deadlines[slot] = deadline;
+      if (moves_earlier)
+	sift_up (pos);
+      else
+	sift_down (pos);
+    };
+
+
+    /**
+     * @brief Removes the given slot from the heap, no effect if it is
+     *        not in the heap
+     */
+    inline void remove (uint64_t slot)
+    {
+      if (not contains (slot))
+	return;
+
+      uint64_t pos  = (uint64_t) position[slot];
+      uint64_t last = --number_elements;
+      if (pos != last)
+	{
+	  // move the last entry into the gap and restore heap order
+	  swap_positions (pos, last);
+	  sift_up (pos);
+	  sift_down (pos);
+	}
+      position[slot] = H_NULL;
+    };
+
+
+    /**
+     * @brief Returns the slot with the earliest deadline. Throws if
+     *        heap is empty
+     */
+    inline uint64_t top_slot () const
+    {
+      if (is_empty())
+	throw DeadlineHeapException ("FixedMemDeadlineHeap::top_slot", "heap is empty");
+      return heap[0];
+    };
+
+
+    /**
+     * @brief Returns the earliest deadline. Throws if heap is empty
+     */
+    inline const DeadlineT& top_deadline () const
+    {
+      if (is_empty())
+	throw DeadlineHeapException ("FixedMemDeadlineHeap::top_deadline", "heap is empty");
+      return deadlines[heap[0]];
+    };
+
+
+    /**
+     * @brief Returns the deadline of the given slot. Throws if the
+     *        slot is not in the heap
+     */
+    inline const DeadlineT& get_deadline (uint64_t slot) const
+    {
+      if (not contains (slot))
+	throw DeadlineHeapException ("FixedMemDeadlineHeap::get_deadline", "slot not in heap");
+      return deadlines[slot];
+    };
+
+
+    /**
+     * @brief Calls fn(slot) for every slot whose deadline satisfies
+     *        is_due(deadline), in unspecified order. The predicate
+     *        must be monotone, i.e. hold for every deadline earlier
+     *        than one for which it holds. Takes time proportional to
+     *        the number of due slots.
+     */
+    template <typename Pred, typename Fn>
+    void for_each_due (Pred is_due, Fn fn) const
+    {
+      visit_due (0, is_due, fn);
+    }
+
+
+    /**
+     * @brief Checks the heap property and the consistency of the
+     *        position array (for testing)
+     */
+    bool is_consistent () const
+    {
+      uint64_t in_heap = 0;
+      for (uint64_t slot = 0; slot < maxEntries; slot++)
+	if (position[slot] != H_NULL)
+	  {
+	    in_heap++;
+	    if (((uint64_t) position[slot] >= number_elements) or (heap[position[slot]] != slot))
+	      return false;
+	  }
+      if (in_heap != number_elements)
+	return false;
+      for (uint64_t pos = 1; pos < number_elements; pos++)
+	if (earlier (pos, (pos-1)/2))
+	  return false;
+      return true;
+    };
+
+  };
+
+};  // namespace dcp
@@ -0,0 +1,362 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <utility>
+#include <dcp/common/exceptions.h>
+
+
+/**
+ * @brief This module provides a hash table operating in fixed memory,
+ *        as an alternative to FixedMemAVLTree when no ordering of the
+ *        keys is needed.
+ *
+ * The key / data entries are stored densely packed at the beginning
+ * of an entry array, so that iterating over all entries touches only
+ * occupied memory. A separate open-addressing index with Robin Hood
+ * probing (entries displaced furthest from their home position win
+ * a slot, removal by backward shifting, no tombstones) maps keys to
+ * positions in the entry array. The index has at least twice as many
+ * slots as there are entries, keeping the load factor at or below
+ * one half.
+ *
+ * All links are array indices, so the table can be placed into a
+ * shared memory segment, provided that the hash function yields the
+ * same value in all processes.
+ */
+
+
+namespace dcp {
+
+  /**
+   * @brief Robin Hood hash table over fixed-size arrays
+   *
+   * @tparam KeyT: type name of the key type. Must be equality
+   *         comparable and hashable by HashFn.
+   * @tparam DataT: type name of data entries. Must have copy
+   *         constructor and copy assignment.
+   * @tparam maxEntries: maximum number of entries in the table
+   * @tparam HashFn: hash function object type for keys
+   *
+   * Note that removing an entry moves the last entry of the entry
+   * array into its place, so references obtained from
+   * lookup_data_ref() are invalidated by remove().
+   */
+  template <typename KeyT, typename DataT, uint64_t maxEntries, typename HashFn = std::hash<KeyT>>
+  class FixedMemHashTable {
+
+    static_assert (std::equality_comparable<KeyT>, "FixedMemHashTable: KeyT must be equality comparable");
+    static_assert (maxEntries >= 1, "FixedMemHashTable: maxEntries must be at least one");
+    static_assert (maxEntries < INT32_MAX / 2, "FixedMemHashTable: maxEntries too large");
+    
+  protected:
+
+    static const int32_t H_NULL = -1;    /*!< Index corresponding to a null pointer */
+
+    static constexpr uint64_t compute_capacity ()
+    {
+      uint64_t c = 1;
+      while (c < 2*maxEntries)
+	c = c << 1;
+      return c;
+    };
+
+    static constexpr uint64_t capacity = compute_capacity ();   /*!< Number of index slots, a power of two */
+    static constexpr uint64_t mask     = capacity - 1;
+
+    
+    /**
+     * @brief Type of an index slot
+     */
+    class IndexSlot {
+    public:
+      int32_t   entry = H_NULL;    /*!< Position in the entry array, or H_NULL for an empty slot */
+      uint32_t  dist  = 0;         /*!< Distance of this slot from the home slot of the key */
+      uint32_t  hash  = 0;         /*!< Lower bits of the key hash, to skip most key comparisons */
+    };
+
+
+    /**
+     * @brief Type of an entry
+     */
+    class HEntry {
+    public:
+      KeyT      key;               /*!< Key */
+      DataT     data;              /*!< Data field */
+      uint32_t  slot = 0;          /*!< Index slot referring to this entry */
+    };
+
+
+    uint64_t   number_elements = 0;         /*!< Number of current entries, occupying entries[0 .. number_elements-1] */
+    IndexSlot  index   [capacity];          /*!< Open-addressing index */
+    HEntry     entries [maxEntries];        /*!< Densely packed entries */
+
+
+    /**
+     * @brief Returns the hash of a key, with the bits mixed so that
+     *        the lower bits used for the home slot depend on all bits
+     *        of the key (std::hash is the identity for integers)
+     */
+    static inline uint64_t hash_of (const KeyT& key)
+    {
+      uint64_t h = (uint64_t) HashFn{} (key);
+      h ^= h >> 33;
+      h *= 0xff51afd7ed558ccdULL;
+      h ^= h >> 33;
+      h *= 0xc4ceb9fe1a85ec53ULL;
+      h ^= h >> 33;
+      return h;
+    };
+
+
+    /**
+     * @brief Returns the index slot holding the given key, or H_NULL
+     */
+    inline int64_t find_slot (const KeyT& key) const
+    {
+      uint64_t  h    = hash_of (key);
+      uint64_t  pos  = h & mask;
+      for (uint32_t d = 0; ; d++, pos = (pos + 1) & mask)
+	{
+	  const IndexSlot& s = index[pos];
+	  if ((s.entry == H_NULL) or (s.dist < d))
+	    return H_NULL;
+	  if ((s.hash == (uint32_t) h) and (entries[s.entry].key == key))
+	    return (int64_t) pos;
+	}
+    };
+
+
+    /**
+     * @brief Places a new index slot value with Robin Hood probing
+     */
+    inline void place (IndexSlot carry, uint64_t pos)
+    {
+      while (true)
+	{
+	  IndexSlot& s = index[pos];
+	  if (s.entry == H_NULL)
+	    {
+	      s = carry;
+	      entries[s.entry].slot = (uint32_t) pos;
+	      return;
+	    }
+	  if (s.dist < carry.dist)
+	    {
+	      std::swap (s, carry);
+	      entries[s.entry].slot = (uint32_t) pos;
+	    }
+	  pos = (pos + 1) & mask;
+	  carry.dist++;
+	}
+    };
+
+    
+  public:
+
+    /**
+     * @brief Constructor, initializes an empty table
+     */
+    FixedMemHashTable ()
+    {
+      clear ();
+    };
+
+
+    /**
+     * @brief Returns the maximum number of entries
+     */
+    inline uint64_t get_array_size () const { return maxEntries; };
+
+
+    /**
+     * @brief Returns current number of entries
+     */
+    inline uint64_t get_number_elements () const { return number_elements; };
+
+
+    /**
+     * @brief Checks whether an entry with given key exists
+     */
+    inline bool is_member (const KeyT& key) const
+    {
+      return find_slot (key) != H_NULL;
+    };
+
+
+    /**
+     * @brief Returns reference to the data field of an existing
+     *        entry. Throws when no entry with given key exists.
+     */
+    inline DataT& lookup_data_ref (const KeyT& key)
+    {
+      int64_t pos = find_slot (key);
+      if (pos == H_NULL)
+	throw HashTableException ("lookup_data_ref", "unknown key");
+      return entries[index[pos].entry].data;
+    };
+
+
+    /**
+     * @brief Insert given key / data pair into the table, if there is
+     *        space available
+     *
+     * If the key already exists in the table, its data value is
+     * updated with the new data.
+     */
+    void insert (const KeyT& key, const DataT& data)
+    {
+      int64_t pos = find_slot (key);
+      if (pos != H_NULL)
+	{
+	  entries[index[pos].entry].data = data;
+	  return;
+	}
+      if (number_elements >= maxEntries)
+	return;
+
+      uint64_t   h = hash_of (key);
+      IndexSlot  carry;
+      carry.entry = (int32_t) number_elements;
+      carry.dist  = 0;
+      carry.hash  = (uint32_t) h;
+      entries[number_elements].key   = key;
+      entries[number_elements].data  = data;
+      number_elements++;
+      place (carry, h & mask);
+    };
+
+
+    /**
+     * @brief Removes the entry with given key, no effect if there is
+     *        none
+     */
+    void remove (const KeyT& key)
+    {
+      int64_t found = find_slot (key);
+      if (found == H_NULL)
+	return;
+
+      uint64_t pos   = (uint64_t) found;
+      int32_t  entry = index[pos].entry;
+
+      // backward shift deletion in the index
+      uint64_t next = (pos + 1) & mask;
+      while ((index[next].entry != H_NULL) and (index[next].dist > 0))
+	{
+	  index[pos] = index[next];
+	  index[pos].dist--;
+	  entries[index[pos].entry].slot = (uint32_t) pos;
+	  pos  = next;
+	  next = (next + 1) & mask;
+	}
+      index[pos] = IndexSlot ();
+
+      // keep the entry array dense
+      int32_t last = (int32_t) (number_elements - 1);
+      if (entry != last)
+	{
+	  entries[entry] = entries[last];
+	  index[entries[entry].slot].entry = entry;
+	}
+      number_elements--;
+    };
+
+
+    /**
+     * @brief Clears the table
+     */
+    inline void clear ()
+    {
+      number_elements = 0;
+      for (uint64_t i = 0; i < capacity; i++)
+	index[i] = IndexSlot ();
+    };
+
+
+    /**
+     * @brief Calls fn(key, data) for all entries, in the order of
+     *        the dense entry array
+     */
+    template <typename Fn>
+    inline void for_each (Fn fn) const
+    {
+      for (uint64_t i = 0; i < number_elements; i++)
+	fn (entries[i].key, entries[i].data);
+    }
+    
+
+    /**
+     * @brief Checks all entries whether they satisfy a predicate, and
+     *        for those that do collects transforms of them into an
+     *        output list (same interface as FixedMemAVLTree)
+     *
+     * @tparam R: type of the elements of the result list
+     * @param predicate: Boolean predicate applied to an entry (its key and data)
+     * @param transform: Transforms given key and data to output type
+     * @param result_lst: output parameter collecting the results of the
+     *        transform function applied to all entries satisfying the predicate
+     */      
+    template <typename R>
+    void find_matching_data (std::function<bool (KeyT, const DataT&)> predicate,
+			     std::function<R (KeyT, const DataT&)> transform,
+			     std::list<R>& result_lst) const
+    {
+      for (uint64_t i = 0; i < number_elements; i++)
+	if (predicate (entries[i].key, entries[i].data))
+	  result_lst.push_back (transform (entries[i].key, entries[i].data));
+    }
+
+    
+    /*********************************************************************
+     * Public methods only relevant for unit testing
+     ********************************************************************/
+
+    /**
+     * @brief Checks the invariants of index and entry array
+     *
+     * @return Flag saying whether any of the invariants has been violated
+     */
+    bool is_consistent () const
+    {
+      uint64_t occupied = 0;
+      for (uint64_t pos = 0; pos < capacity; pos++)
+	{
+	  const IndexSlot& s = index[pos];
+	  if (s.entry == H_NULL)
+	    continue;
+	  occupied++;
+	  if ((uint64_t) s.entry >= number_elements) return false;
+	  if (entries[s.entry].slot != pos) return false;
+	  uint64_t h = hash_of (entries[s.entry].key);
+	  if (s.hash != (uint32_t) h) return false;
+	  if (((h + s.dist) & mask) != pos) return false;
+	  if ((s.dist > 0) and (index[(pos + mask) & mask].entry == H_NULL)) return false;
+	}
+      return occupied == number_elements;
+    };
+    
+  };
+    
+};  // namespace dcp
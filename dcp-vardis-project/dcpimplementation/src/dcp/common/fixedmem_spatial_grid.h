@@ -0,0 +1,381 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <dcp/common/exceptions.h>
+
+
+/**
+ * @brief This module provides a spatial index over a fixed number of
+ *        entries (identified by their slot number) operating in fixed
+ *        memory, supporting radius and k-nearest-neighbour queries.
+ *
+ * The index is a uniform grid over the x/y plane with square cells of
+ * configurable size. Since the extent of the plane is not known in
+ * advance, cells are hashed into a fixed number of buckets, each
+ * holding a doubly-linked list (over array indices, not pointers) of
+ * the entries whose position falls into a cell hashing to that
+ * bucket. Distances are full three-dimensional Euclidean distances,
+ * only the grid itself ignores the z coordinate.
+ *
+ * Like the other fixed-memory structures the grid contains no
+ * pointers, so it can be placed into a shared memory segment.
+ */
+
+
+namespace dcp {
+
+  /**
+   * @brief Spatial grid index over a fixed-size array of entries
+   *
+   * @tparam maxEntries: number of entries (slots) that can be indexed
+   * @tparam numBuckets: number of hash buckets for grid cells
+   */
+  template <uint64_t maxEntries, uint64_t numBuckets>
+  class FixedMemSpatialGrid {
+
+    static_assert (maxEntries >= 1, "FixedMemSpatialGrid: maxEntries must be at least one");
+    static_assert (numBuckets >= 1, "FixedMemSpatialGrid: numBuckets must be at least one");
+
+  protected:
+
+    static const int32_t G_NULL = -1;   /*!< Index corresponding to a null pointer */
+
+
+    /**
+     * @brief Type holding position and list management data of one entry
+     */
+    class GridEntry {
+    public:
+      bool     used  = false;     /*!< Whether the slot is currently indexed */
+      int32_t  next  = G_NULL;    /*!< Next entry in the same bucket */
+      int32_t  prev  = G_NULL;    /*!< Previous entry in the same bucket */
+      int64_t  cx    = 0;         /*!< Grid cell, x direction */
+      int64_t  cy    = 0;         /*!< Grid cell, y direction */
+      double   x     = 0;         /*!< Indexed position */
+      double   y     = 0;
+      double   z     = 0;
+    };
+
+
+    double     cellSize;                       /*!< Edge length of a grid cell */
+    uint64_t   number_elements = 0;            /*!< Number of currently indexed entries */
+    int32_t    buckets [numBuckets];           /*!< First entry of each bucket */
+    GridEntry  entries [maxEntries];           /*!< Per-slot entries */
+
+
+    static constexpr double max_cell = 4611686018427387904.0;   /*!< 2^62, cell indices are clamped to +/- this so that neighbouring cells stay representable */
+
+
+    /**
+     * @brief Returns the grid cell of a coordinate. Coordinates beyond
+     *        the representable range are clamped (converting them
+     *        to int64_t would be undefined), NaN is mapped to cell zero
+     */
+    inline int64_t cell_of (double coord) const
+    {
+      double c = std::floor (coord / cellSize);
+      if (std::isnan (c))
+	return 0;
+      return (int64_t) std::clamp (c, -max_cell, max_cell);
+    };
+
+
+    inline uint64_t bucket_of (int64_t cx, int64_t cy) const
+    {
+      return (((uint64_t) cx * 73856093u) ^ ((uint64_t) cy * 19349663u)) % numBuckets;
+    };
+
+
+    inline double distance2 (const GridEntry& e, double x, double y, double z) const
+    {
+      return (e.x-x)*(e.x-x) + (e.y-y)*(e.y-y) + (e.z-z)*(e.z-z);
+    };
+
+
+    inline void check_slot (uint64_t slot, const char* method) const
+    {
+      if (slot >= maxEntries)
+	throw SpatialGridException (method, "slot out of range");
+    };
+
+
+    inline void unlink (uint64_t slot)
+    {
+      GridEntry& e = entries[slot];
+      if (e.prev != G_NULL)
+	entries[e.prev].next = e.next;
+      else
+	buckets[bucket_of (e.cx, e.cy)] = e.next;
+      if (e.next != G_NULL)
+	entries[e.next].prev = e.prev;
+      e.next = e.prev = G_NULL;
+    };
+
+
+    inline void link (uint64_t slot)
+    {
+      GridEntry& e = entries[slot];
+      int32_t&   head = buckets[bucket_of (e.cx, e.cy)];
+      e.prev = G_NULL;
+      e.next = head;
+      if (head != G_NULL)
+	entries[head].prev = (int32_t) slot;
+      head = (int32_t) slot;
+    };
+
+
+    /**
+     * @brief Calls fn(slot, distance2) for all entries in the given
+     *        cell within squared distance r2 of the given position
+     */
+    template <typename Fn>
+    inline void visit_cell (int64_t cx, int64_t cy, double x, double y, double z, double r2, Fn& fn) const
+    {
+      for (int32_t idx = buckets[bucket_of (cx, cy)]; idx != G_NULL; idx = entries[idx].next)
+	{
+	  const GridEntry& e = entries[idx];
+	  if ((e.cx != cx) or (e.cy != cy))
+	    continue;
+	  double d2 = distance2 (e, x, y, z);
+	  if (d2 <= r2)
+	    fn ((uint64_t) idx, d2);
+	}
+    }
+
+
+    /**
+     * @brief Calls fn(slot, distance2) for all indexed entries within
+     *        squared distance r2, by scanning all buckets
+     */
+    template <typename Fn>
+    inline void visit_all (double x, double y, double z, double r2, Fn& fn) const
+    {
+      for (uint64_t b = 0; b < numBuckets; b++)
+	for (int32_t idx = buckets[b]; idx != G_NULL; idx = entries[idx].next)
+	  {
+	    double d2 = distance2 (entries[idx], x, y, z);
+	    if (d2 <= r2)
+	      fn ((uint64_t) idx, d2);
+	  }
+    }
+
+
+  public:
+
+    FixedMemSpatialGrid () = delete;
+
+
+    /**
+     * @brief Constructor, throws if the cell size is not strictly
+     *        positive
+     *
+     * @param cell_size: edge length of a grid cell, should be in the
+     *        order of the typical query radius
+     */
+    FixedMemSpatialGrid (double cell_size)
+      : cellSize (cell_size)
+    {
+      if (not (cell_size > 0))
+	throw SpatialGridException ("FixedMemSpatialGrid", "cell size must be strictly positive");
+      for (uint64_t b = 0; b < numBuckets; b++)
+	buckets[b] = G_NULL;
+    };
+
+
+    /**
+     * @brief Returns the edge length of a grid cell
+     */
+    inline double get_cell_size () const { return cellSize; };
+
+
+    /**
+     * @brief Returns number of currently indexed entries
+     */
+    inline uint64_t size () const { return number_elements; };
+
+
+    /**
+     * @brief Checks whether the given slot is currently indexed
+     */
+    inline bool contains (uint64_t slot) const { return (slot < maxEntries) and entries[slot].used; };
+
+
+    /**
+     * @brief Inserts the given slot at the given position, or moves
+     *        it there if already indexed. Throws for illegal slots
+     */
+    inline void update (uint64_t slot, double x, double y, double z)
+    {
+      check_slot (slot, "FixedMemSpatialGrid::update");
+      GridEntry& e   = entries[slot];
+      int64_t    cx  = cell_of (x);
+      int64_t    cy  = cell_of (y);
+
+      if (e.used and ((e.cx != cx) or (e.cy != cy)))
+	unlink (slot);
+
+      bool relink = (not e.used) or (e.cx != cx) or (e.cy != cy);
+      if (not e.used)
+	number_elements++;
+
+      e.used = true;
+      e.cx   = cx;
+      e.cy   = cy;
+      e.x    = x;
+      e.y    = y;
+      e.z    = z;
+      if (relink)
+	link (slot);
+    };
+
+
+    /**
+     * @brief Removes the given slot from the index, no effect if it
+     *        is not indexed
+     */
+    inline void remove (uint64_t slot)
+    {
+      if (not contains (slot))
+	return;
+      unlink (slot);
+      entries[slot].used = false;
+      number_elements--;
+    };
+
+
+    /**
+     * @brief Calls fn(slot, distance2) for every indexed entry within
+     *        the given radius of the given position, where distance2
+     *        is the squared distance. The order is unspecified. No
+     *        entry is reported for a negative or NaN radius or a
+     *        non-finite position, an infinite radius reports all
+     *        entries.
+     */
+    template <typename Fn>
+    void for_each_within (double x, double y, double z, double radius, Fn fn) const
+    {
+      if (    (not (radius >= 0))
+	   || (not std::isfinite (x)) || (not std::isfinite (y)) || (not std::isfinite (z))
+	   || (number_elements == 0))
+	return;
+
+      double   r2    = radius * radius;
+
+      // for large radii scanning all buckets is cheaper than visiting
+      // every cell. The cell range is computed in floating point, as
+      // for huge radii it is not representable as int64_t
+      double   width = std::floor ((x + radius) / cellSize) - std::floor ((x - radius) / cellSize) + 1;
+      double   depth = std::floor ((y + radius) / cellSize) - std::floor ((y - radius) / cellSize) + 1;
+      if (not (width * depth <= (double) numBuckets))
+	{
+	  visit_all (x, y, z, r2, fn);
+	  return;
+	}
+
+      int64_t  cxmin = cell_of (x - radius);
+      int64_t  cxmax = cell_of (x + radius);
+      int64_t  cymin = cell_of (y - radius);
+      int64_t  cymax = cell_of (y + radius);
+
+      for (int64_t cx = cxmin; cx <= cxmax; cx++)
+	for (int64_t cy = cymin; cy <= cymax; cy++)
+	  visit_cell (cx, cy, x, y, z, r2, fn);
+    }
+
+
+    /**
+     * @brief Finds the k entries nearest to the given position
+     *
+     * @param k: number of entries to find
+     * @param slots: output array of at least k elements, receives the
+     *        slots sorted by increasing distance
+     * @param distances2: output array of at least k elements,
+     *        receives the squared distances
+     * @return Number of entries found, i.e. min(k, size())
+     *
+     * Visits rings of grid cells of increasing distance around the
+     * cell of the query position, until the k-th best candidate is
+     * closer than any entry in an unvisited ring could be.
+     */
+    uint64_t nearest (double x, double y, double z, uint64_t k, uint64_t* slots, double* distances2) const
+    {
+      uint64_t found  = 0;
+      uint64_t wanted = std::min (k, number_elements);
+      if (wanted == 0)
+	return 0;
+
+      auto collect = [&] (uint64_t slot, double d2)
+      {
+	if ((found == wanted) and (d2 >= distances2[found-1]))
+	  return;
+	uint64_t pos = (found < wanted) ? found++ : found-1;
+	while ((pos > 0) and (distances2[pos-1] > d2))
+	  {
+	    slots[pos]      = slots[pos-1];
+	    distances2[pos] = distances2[pos-1];
+	    pos--;
+	  }
+	slots[pos]      = slot;
+	distances2[pos] = d2;
+      };
+
+      const double infinity = std::numeric_limits<double>::infinity();
+      int64_t qx = cell_of (x);
+      int64_t qy = cell_of (y);
+      for (int64_t r = 0; ; r++)
+	{
+	  // rings beyond this size are more expensive than a full scan
+	  if ((double) (2*r+1) * (double) (2*r+1) > (double) numBuckets)
+	    {
+	      found = 0;
+	      visit_all (x, y, z, infinity, collect);
+	      return found;
+	    }
+
+	  for (int64_t cx = qx - r; cx <= qx + r; cx++)
+	    {
+	      if ((cx == qx - r) or (cx == qx + r))
+		{
+		  for (int64_t cy = qy - r; cy <= qy + r; cy++)
+		    visit_cell (cx, cy, x, y, z, infinity, collect);
+		}
+	      else
+		{
+		  visit_cell (cx, qy - r, x, y, z, infinity, collect);
+		  visit_cell (cx, qy + r, x, y, z, infinity, collect);
+		}
+	    }
+
+	  // entries in rings beyond r are at least r cells away
+	  double bound = (double) r * cellSize;
+	  if ((found == wanted) and (distances2[found-1] <= bound * bound))
+	    return found;
+	}
+    };
+
+  };
+
+};  // namespace dcp
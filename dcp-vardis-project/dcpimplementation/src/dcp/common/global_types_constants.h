@@ -24,11 +24,13 @@
 #include <cstring>
 #include <cstdint>
 #include <chrono>
+#include <functional>
 #ifdef __DCPSIMULATION__
 #include <omnetpp.h>
 #endif
 #include <netinet/ether.h>
 #include <boost/chrono/duration.hpp>
+#include <dcp/common/coarse_clock.h>
 #include <dcp/common/foundation_types.h>
 #include <dcp/common/transmissible_type.h>
 #include <dcp/common/memblock.h>
@@ -88,6 +90,38 @@ namespace dcp {
   const size_t maxShmAreaNameLength = 255;
 
 
+  /**
+   * @brief Cache line size assumed for the layout of shared memory
+   *        structures. Fields written by different processes or
+   *        threads (mutexes, queue control data, flags) are aligned
+   *        to this size to avoid false sharing. Can be overridden at
+   *        compile time, but then consistently for the whole tree,
+   *        as the libraries and all their users share these layouts.
+   */
+#ifndef DCP_CACHE_LINE_SIZE
+#define DCP_CACHE_LINE_SIZE 64
+#endif
+  const size_t cacheLineSize = DCP_CACHE_LINE_SIZE;
+
+
+  /**
+   * @brief Returns the given address rounded up to the next multiple
+   *        of the given alignment (a power of two)
+   */
+  inline byte* align_address (byte* addr, size_t alignment)
+  {
+    uintptr_t a = (uintptr_t) addr;
+    return (byte*) ((a + alignment - 1) & ~((uintptr_t) alignment - 1));
+  }
+
+
+  /**
+   * @brief Size of a (transparent) huge page, shared memory segments
+   *        backed by huge pages are rounded up to a multiple of this
+   */
+  const size_t hugePageSize = 2 * 1024 * 1024;
+
+
   /**
    * @brief Timeout for packet sniffer in ms
    */
@@ -263,6 +297,7 @@ namespace dcp {
 
     friend inline bool operator== (const TimeStampT& lhs, const TimeStampT& rhs) { return (lhs.tStamp == rhs.tStamp); };
     friend inline bool operator>= (const TimeStampT& lhs, const TimeStampT& rhs) { return (lhs.tStamp >= rhs.tStamp); };
+    friend inline bool operator< (const TimeStampT& lhs, const TimeStampT& rhs)  { return (lhs.tStamp < rhs.tStamp); };
     
     /**
      * @brief Serialization methods
@@ -285,6 +320,21 @@ namespace dcp {
     };
 
 
+    /**
+     * @brief Returns current system time as of the last timer tick,
+     *        which is considerably cheaper than
+     *        get_current_system_time() but lags behind it by up to
+     *        one tick (see coarse_clock.h). Only for uses where
+     *        millisecond resolution is sufficient.
+     */
+    static TimeStampT get_current_coarse_time ()
+    {
+      TimeStampT ts;
+      ts.tStamp = CoarseClock::now();
+      return ts;
+    };
+
+
     /**
      * @brief Type shorthand for milliseconds
      */
@@ -328,6 +378,7 @@ namespace dcp {
 
     friend inline bool operator== (const TimeStampT& lhs, const TimeStampT& rhs) { return (lhs.tStamp == rhs.tStamp); };
     friend inline bool operator>= (const TimeStampT& lhs, const TimeStampT& rhs) { return (lhs.tStamp >= rhs.tStamp); };
+    friend inline bool operator< (const TimeStampT& lhs, const TimeStampT& rhs)  { return (lhs.tStamp < rhs.tStamp); };
     
     /**
      * @brief Serialization methods
@@ -350,6 +401,16 @@ namespace dcp {
     };
 
 
+    /**
+     * @brief Same as get_current_system_time(), simulation time has
+     *        no cost to save
+     */
+    static TimeStampT get_current_coarse_time ()
+    {
+      return get_current_system_time ();
+    };
+
+
     /**
      * @brief Returns number of whole milliseconds passed since reference time
      *
@@ -454,9 +515,31 @@ namespace dcp {
         }
     };
 
+
+    /**
+     * @brief Deserialize this string as a view into the memory of
+     *        the given area, without allocating or copying
+     */
+    virtual void deserialize_view (DisassemblyArea& area)
+    {
+      size_t len = area.deserialize_byte ();
+      set_view (len, area.view_byte_block (len));
+    };
+
     
     friend std::ostream& operator<<(std::ostream& os, const StringT& str);
   };
   
   
 };  // namespace dcp
+
+
+/**
+ * @brief Hash support for node identifiers, e.g. for use as keys of
+ *        FixedMemHashTable. Depends only on the address bytes, so
+ *        the hash is the same in all processes.
+ */
+template <>
+struct std::hash<dcp::NodeIdentifierT> {
+  size_t operator() (const dcp::NodeIdentifierT& nodeId) const noexcept { return (size_t) nodeId.to_uint64_t (); };
+};
@@ -32,6 +32,7 @@
 #include <boost/log/sources/severity_channel_logger.hpp>
 #include <boost/log/sources/record_ostream.hpp>
 #include <boost/log/support/date_time.hpp>
+#include <dcp/common/async_logging.h>
 #include <dcp/common/logging_helpers.h>
 #include <dcp/common/exceptions.h>
 
@@ -80,7 +81,7 @@ namespace dcp {
   }
   
   
-  void initialize_file_logging(const dcp::LoggingConfigurationBlock& cfg)
+  void initialize_file_logging(const dcp::LoggingConfigurationBlock& cfg, logger_type* report_logger)
   {
     minimumSeverityLevel = dcp::string_to_severity_level (cfg.minimumSeverityLevel);
     
@@ -125,6 +126,9 @@ namespace dcp {
 				  );
 				  
       }
+
+    if (cfg.asyncLogging)
+      start_async_logging (cfg.asyncBufferSize, cfg.asyncDrainIntervalMS, report_logger);
   }
 
 
@@ -139,6 +143,9 @@ namespace dcp {
       (opt("autoFlush").c_str(),         po::value<bool>(&logAutoFlush)->default_value(defaultValueLogAutoFlush), txt("whether or not to flush buffer after each write to log").c_str())
       (opt("severityLevel").c_str(),     po::value<std::string>(&minimumSeverityLevel)->default_value(defaultValueMinimumSeverityLevel), txt("minimum severity level for logging").c_str())
       (opt("rotationSize").c_str(),      po::value<size_t>(&rotationSize)->default_value(defaultValueRotationSize), txt("maximum size of one log file before rotation").c_str())
+      (opt("asyncLogging").c_str(),      po::value<bool>(&asyncLogging)->default_value(defaultValueAsyncLogging), txt("whether to format and write log records in a background thread").c_str())
+      (opt("asyncBufferSize").c_str(),   po::value<size_t>(&asyncBufferSize)->default_value(defaultValueAsyncBufferSize), txt("size of per-thread buffer for asynchronous logging (bytes)").c_str())
+      (opt("asyncDrainIntervalMS").c_str(), po::value<uint32_t>(&asyncDrainIntervalMS)->default_value(defaultValueAsyncDrainIntervalMS), txt("interval for writing buffered log records (ms)").c_str())
       ;
   }
 
@@ -162,6 +169,12 @@ namespace dcp {
     if (rotationSize < 1024*1024)
       throw ConfigurationException("LoggingConfigurationBlock",
 				   std::format("minimum rotation size of 1 MB expected, given is {}", rotationSize));
+    if (asyncBufferSize < minimumAsyncLogBufferSize)
+      throw ConfigurationException("LoggingConfigurationBlock",
+				   std::format("asynchronous logging buffer size must be at least {}, given is {}", minimumAsyncLogBufferSize, asyncBufferSize));
+    if (asyncDrainIntervalMS == 0)
+      throw ConfigurationException("LoggingConfigurationBlock",
+				   "asynchronous logging drain interval must be strictly positive");
   }
 
   
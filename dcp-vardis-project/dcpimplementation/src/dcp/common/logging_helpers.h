@@ -80,6 +80,9 @@ namespace dcp {
     std::string defaultValueMinimumSeverityLevel  = "warning";
     std::size_t defaultValueRotationSize          = 10485760;
     bool        defaultValueLoggingToConsole      = false;
+    bool        defaultValueAsyncLogging          = false;
+    std::size_t defaultValueAsyncBufferSize       = 262144;
+    uint32_t    defaultValueAsyncDrainIntervalMS  = 20;
 
     /**************************************************
      * Logging options
@@ -116,6 +119,32 @@ namespace dcp {
      * @brief Maximum size one log file can reach before rotation
      */
     std::size_t    rotationSize = defaultValueRotationSize;
+
+
+    /**
+     * @brief Whether log records are handed to a background thread
+     *        for formatting and writing
+     *
+     * Takes formatting and file output off the protocol threads, at
+     * the price that records still buffered are lost if the process
+     * crashes, and that records are dropped when a thread logs
+     * faster than the background thread drains.
+     */
+    bool           asyncLogging = defaultValueAsyncLogging;
+
+
+    /**
+     * @brief Size of the per-thread buffer for asynchronous logging
+     *        (bytes)
+     */
+    std::size_t    asyncBufferSize = defaultValueAsyncBufferSize;
+
+
+    /**
+     * @brief Interval at which the background thread writes buffered
+     *        log records (ms)
+     */
+    uint32_t       asyncDrainIntervalMS = defaultValueAsyncDrainIntervalMS;
     
     /**************************************************
      * Logging options
@@ -142,9 +171,11 @@ namespace dcp {
 
   /**
    * @brief Initializes logging from the configuration data given in
-   *        DcpConfiguration
+   *        DcpConfiguration. With asynchronous logging, dropped
+   *        records are reported on the channel of report_logger (see
+   *        start_async_logging())
    */
-  void initialize_file_logging(const LoggingConfigurationBlock& cfg);
+  void initialize_file_logging(const LoggingConfigurationBlock& cfg, logger_type* report_logger = nullptr);
 
 };  // namespace dcp
   
@@ -153,6 +184,14 @@ namespace dcp {
  * @brief A set of macros to act as wrapper around logging calls for
  *        either BOOST logging (in the implementation) or OMNeT++
  *        logging (in the simulation)
+ *
+ * In the implementation, a statement below the minimum severity
+ * level costs a single branch, its arguments are not evaluated (the
+ * for loop runs at most once, and unlike an if/else it does not
+ * capture a following else).
+ * Otherwise the arguments are captured by a LogRecordBuilder (see
+ * async_logging.h), which writes them through BOOST logging either
+ * immediately or from the background thread.
  */
 #ifdef __DCPSIMULATION__
 #include <omnetpp.h>
@@ -163,11 +202,13 @@ using namespace omnetpp;
 #define DCPLOG_ERROR(logstream) EV_ERROR
 #define DCPLOG_FATAL(logstream) EV_FATAL
 #else
-#define DCPLOG_TRACE(logstream) BOOST_LOG_SEV(logstream,trivial::trace)
-#define DCPLOG_INFO(logstream) BOOST_LOG_SEV(logstream,trivial::info)
-#define DCPLOG_WARNING(logstream) BOOST_LOG_SEV(logstream,trivial::warning)
-#define DCPLOG_ERROR(logstream) BOOST_LOG_SEV(logstream,trivial::error)
-#define DCPLOG_FATAL(logstream) BOOST_LOG_SEV(logstream,trivial::fatal)
+#include <dcp/common/async_logging.h>
+#define DCPLOG_SEV(logstream,sev) for (bool dcplog_enabled_ = ((sev) >= dcp::minimumSeverityLevel); dcplog_enabled_; dcplog_enabled_ = false) dcp::LogRecordBuilder (logstream,sev)
+#define DCPLOG_TRACE(logstream) DCPLOG_SEV(logstream,trivial::trace)
+#define DCPLOG_INFO(logstream) DCPLOG_SEV(logstream,trivial::info)
+#define DCPLOG_WARNING(logstream) DCPLOG_SEV(logstream,trivial::warning)
+#define DCPLOG_ERROR(logstream) DCPLOG_SEV(logstream,trivial::error)
+#define DCPLOG_FATAL(logstream) DCPLOG_SEV(logstream,trivial::fatal)
 #endif
   
 
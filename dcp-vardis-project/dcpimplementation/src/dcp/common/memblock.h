@@ -144,6 +144,32 @@ namespace dcp {
     };
 
 
+    /**
+     * @brief Deletes current memory block if necessary and lets this
+     *        MemBlock refer to the given memory without copying or
+     *        owning it. The caller must ensure the memory outlives
+     *        this MemBlock
+     *
+     * @param len: length of memory block
+     * @param pdata: pointer to memory block
+     */
+    inline void set_view (size_t len, byte* pdata)
+    {
+      check_delete ();
+      do_delete = false;
+      if (len > 0 && pdata)
+	{
+	  length = len;
+	  data   = pdata;
+	}
+      else
+	{
+	  length = 0;
+	  data   = nullptr;
+	}
+    };
+
+
     /**
      * @brief Assignment operator, deleting current memory block if
      *        necessary, copying memory block from other MemBlock
@@ -0,0 +1,160 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <new>
+#include <dcp/common/exceptions.h>
+#include <dcp/common/metrics.h>
+
+
+namespace dcp {
+
+  LatencyHistogram* shmQueueLockWaitHistogram = nullptr;
+
+
+  // -----------------------------------------------------------------
+
+
+  uint64_t HistogramSnapshot::percentile (double p) const
+  {
+    uint64_t total = 0;
+    for (auto b : buckets)
+      total += b;
+    if (total == 0)
+      return 0;
+
+    p = std::clamp (p, 0.0, 1.0);
+    uint64_t rank = std::max ((uint64_t) 1, (uint64_t) std::ceil (p * (double) total));
+    uint64_t cum  = 0;
+    for (size_t i = 0; i < numberBuckets; i++)
+      {
+	cum += buckets[i];
+	if (cum >= rank)
+	  return std::min (bucket_upper (i), max);
+      }
+    return max;
+  }
+
+
+  HistogramSnapshot LatencyHistogram::snapshot () const
+  {
+    HistogramSnapshot snap;
+    snap.count = count.load (std::memory_order_relaxed);
+    snap.sum   = sum.load (std::memory_order_relaxed);
+    snap.max   = max.load (std::memory_order_relaxed);
+    for (size_t i = 0; i < HistogramSnapshot::numberBuckets; i++)
+      snap.buckets[i] = buckets[i].load (std::memory_order_relaxed);
+    return snap;
+  }
+
+
+  // -----------------------------------------------------------------
+
+
+  MetricsRegistry::MetricsRegistry (const std::string& owner)
+    : heap_area (std::make_unique<MetricsArea> ())
+  {
+    area = heap_area.get();
+    initialize_area (nullptr, owner);
+  }
+
+
+  MetricsRegistry::MetricsRegistry (const std::string& owner, const SharedMemoryConfigurationBlock& shm_conf)
+  {
+    // the demon is the only writer of its metrics area, and the
+    // protocol's own shared memory segments (created before) would
+    // already have failed if another instance were running
+    shared_memory_object::remove (shm_conf.shmAreaName.c_str());
+    shm_area = ShmStructureBase (shm_conf.shmAreaName.c_str(), sizeof(MetricsArea), true, shm_conf.shmHugePages);
+    initialize_area (shm_area.get_memory_address(), owner);
+  }
+
+
+  void MetricsRegistry::initialize_area (void* memaddr, const std::string& owner)
+  {
+    if (memaddr)
+      area = new (memaddr) MetricsArea;
+    std::strncpy (area->owner, owner.c_str(), maxMetricNameLength);
+    area->magic.store (metricsAreaMagic, std::memory_order_release);
+  }
+
+
+  template <typename MetricT>
+  MetricT& MetricsRegistry::register_metric (MetricEntry<MetricT>* entries, std::atomic<uint32_t>& number, size_t capacity, const std::string& name)
+  {
+    if (name.empty() or (name.size() > maxMetricNameLength))
+      throw MetricsException ("MetricsRegistry", std::format ("illegal metric name '{}'", name));
+
+    std::lock_guard<std::mutex> lock (registration_mutex);
+    uint32_t n = number.load (std::memory_order_relaxed);
+    for (uint32_t i = 0; i < n; i++)
+      if (name == entries[i].name)
+	return entries[i].metric;
+    if (n >= capacity)
+      throw MetricsException ("MetricsRegistry", std::format ("no space left for metric '{}'", name));
+    std::strncpy (entries[n].name, name.c_str(), maxMetricNameLength);
+    number.store (n + 1, std::memory_order_release);
+    return entries[n].metric;
+  }
+
+
+  MetricCounter& MetricsRegistry::counter (const std::string& name)
+  {
+    return register_metric (area->counters, area->numberCounters, maxMetricCounters, name);
+  }
+
+
+  MetricGauge& MetricsRegistry::gauge (const std::string& name)
+  {
+    return register_metric (area->gauges, area->numberGauges, maxMetricGauges, name);
+  }
+
+
+  LatencyHistogram& MetricsRegistry::histogram (const std::string& name)
+  {
+    return register_metric (area->histograms, area->numberHistograms, maxMetricHistograms, name);
+  }
+
+
+  // -----------------------------------------------------------------
+
+
+  MetricsReader::MetricsReader (const std::string& area_name)
+  {
+    try {
+      shm_obj = shared_memory_object (open_only, area_name.c_str(), read_only);
+      region  = mapped_region (shm_obj, read_only);
+    }
+    catch (...)
+      {
+	throw MetricsException ("MetricsReader", std::format ("cannot open metrics area '{}'", area_name));
+      }
+    if (region.get_size() < shmSegmentHeaderSize + sizeof(MetricsArea))
+      throw MetricsException ("MetricsReader", std::format ("'{}' is too small for a metrics area", area_name));
+    // the area follows the header of the segment created by ShmStructureBase
+    area = (const MetricsArea*) ((const byte*) region.get_address() + shmSegmentHeaderSize);
+    if (not area->is_valid())
+      throw MetricsException ("MetricsReader", std::format ("'{}' is not a valid metrics area (version {})", area_name, area->version));
+  }
+
+};  // namespace dcp
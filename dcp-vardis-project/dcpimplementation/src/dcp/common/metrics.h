@@ -0,0 +1,402 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <dcp/common/global_types_constants.h>
+#include <dcp/common/sharedmem_configuration.h>
+#include <dcp/common/sharedmem_structure_base.h>
+
+
+/**
+ * @brief This module provides a metrics registry with counters,
+ *        gauges and latency histograms, kept in a shared memory
+ *        segment of its own.
+ *
+ * A demon registers its metrics by name at startup and keeps
+ * references to them. Updates are plain relaxed atomic operations and
+ * never take a lock, so they can be made from hot paths. Other
+ * processes (e.g. the dcp-stats tool) map the segment read-only and
+ * can take snapshots at any rate without interacting with the demon.
+ *
+ * Latency histograms use logarithmic buckets with eight linear
+ * sub-buckets per power of two (in the style of HDR histograms),
+ * giving a relative error of at most 12.5% over the range from one
+ * nanosecond to about 18 minutes.
+ */
+
+
+namespace dcp {
+
+  /**
+   * @brief Maximum length of a metric name (without terminating zero)
+   */
+  const size_t    maxMetricNameLength       = 47;
+
+
+  /**
+   * @brief Capacities of a metrics area
+   */
+  const size_t    maxMetricCounters         = 64;
+  const size_t    maxMetricGauges           = 32;
+  const size_t    maxMetricHistograms       = 24;
+
+
+  /**
+   * @brief Marks an initialized metrics area, and its layout version
+   */
+  const uint32_t  metricsAreaMagic          = 0x44435053;
+  const uint32_t  metricsAreaVersion        = 1;
+
+
+  static_assert (std::atomic<uint64_t>::is_always_lock_free, "metrics require lock-free 64 bit atomics");
+
+
+  /**
+   * @brief Monotonically increasing counter
+   */
+  class MetricCounter {
+  protected:
+    std::atomic<uint64_t>  value {0};
+  public:
+    inline void      inc (uint64_t n = 1) { value.fetch_add (n, std::memory_order_relaxed); };
+    inline uint64_t  get () const { return value.load (std::memory_order_relaxed); };
+  };
+
+
+  /**
+   * @brief Gauge holding a current value that can go up and down
+   */
+  class MetricGauge {
+  protected:
+    std::atomic<int64_t>  value {0};
+  public:
+    inline void     set (int64_t v) { value.store (v, std::memory_order_relaxed); };
+    inline void     add (int64_t n) { value.fetch_add (n, std::memory_order_relaxed); };
+    inline int64_t  get () const { return value.load (std::memory_order_relaxed); };
+  };
+
+
+  // -----------------------------------------------------------------
+
+
+  /**
+   * @brief Copy of a latency histogram taken at one point in time,
+   *        used for evaluation
+   */
+  typedef struct HistogramSnapshot {
+
+    static const unsigned  subBucketBits  = 3;
+    static const unsigned  subBuckets     = 1 << subBucketBits;
+    static const unsigned  maxExponent    = 40;   /*!< Values from 2^maxExponent upwards go into the last bucket */
+    static const size_t    numberBuckets  = (maxExponent - subBucketBits + 1) * subBuckets;
+
+    uint64_t  count  = 0;
+    uint64_t  sum    = 0;
+    uint64_t  max    = 0;
+    std::array<uint64_t, numberBuckets>  buckets {};
+
+
+    /**
+     * @brief Returns the index of the bucket holding the given value
+     */
+    static constexpr size_t bucket_index (uint64_t v)
+    {
+      if (v < subBuckets)
+	return (size_t) v;
+      if (v >= ((uint64_t) 1 << maxExponent))
+	return numberBuckets - 1;
+      unsigned e = 63 - __builtin_clzll (v);
+      return (e - subBucketBits + 1) * subBuckets + ((v >> (e - subBucketBits)) & (subBuckets - 1));
+    };
+
+    /**
+     * @brief Returns the smallest and largest value of the given bucket
+     */
+    static constexpr uint64_t bucket_lower (size_t idx)
+    {
+      if (idx < subBuckets)
+	return idx;
+      unsigned e = idx / subBuckets + subBucketBits - 1;
+      return (subBuckets + (idx % subBuckets)) << (e - subBucketBits);
+    };
+    static constexpr uint64_t bucket_upper (size_t idx)
+    {
+      if (idx < subBuckets)
+	return idx;
+      unsigned e = idx / subBuckets + subBucketBits - 1;
+      return bucket_lower (idx) + ((uint64_t) 1 << (e - subBucketBits)) - 1;
+    };
+
+    /**
+     * @brief Returns the mean value, zero when empty
+     */
+    double mean () const { return (count == 0) ? 0 : ((double) sum) / ((double) count); };
+
+    /**
+     * @brief Returns an upper bound for the given percentile (p in
+     *        [0,1]), i.e. the upper end of the bucket it falls into,
+     *        but never more than the maximum seen. Zero when empty.
+     */
+    uint64_t percentile (double p) const;
+
+  } HistogramSnapshot;
+
+
+  /**
+   * @brief Histogram of latencies in nanoseconds, with logarithmic
+   *        buckets
+   */
+  class LatencyHistogram {
+  protected:
+    std::atomic<uint64_t>  count {0};
+    std::atomic<uint64_t>  sum {0};
+    std::atomic<uint64_t>  max {0};
+    std::array<std::atomic<uint64_t>, HistogramSnapshot::numberBuckets>  buckets {};
+
+  public:
+
+    /**
+     * @brief Adds one value
+     */
+    inline void record (uint64_t ns)
+    {
+      buckets[HistogramSnapshot::bucket_index (ns)].fetch_add (1, std::memory_order_relaxed);
+      count.fetch_add (1, std::memory_order_relaxed);
+      sum.fetch_add (ns, std::memory_order_relaxed);
+      uint64_t cur = max.load (std::memory_order_relaxed);
+      while ((ns > cur) and not max.compare_exchange_weak (cur, ns, std::memory_order_relaxed))
+	;
+    };
+
+    /**
+     * @brief Adds one duration
+     */
+    template <typename Rep, typename Period>
+    inline void record (std::chrono::duration<Rep, Period> d)
+    {
+      auto ns = std::chrono::duration_cast<std::chrono::nanoseconds> (d).count();
+      record ((uint64_t) ((ns < 0) ? 0 : ns));
+    }
+
+    /**
+     * @brief Returns a copy of the current contents. Concurrent
+     *        updates may be partially included.
+     */
+    HistogramSnapshot snapshot () const;
+  };
+
+
+  // -----------------------------------------------------------------
+
+
+  /**
+   * @brief Measures the time from construction until finish() or
+   *        destruction and records it in the given histogram. Does
+   *        nothing when given a null pointer.
+   */
+  class ScopedLatencyMeasurement {
+  private:
+    LatencyHistogram*                      histogram;
+    std::chrono::steady_clock::time_point  start;
+  public:
+    ScopedLatencyMeasurement (LatencyHistogram* hist)
+      : histogram (hist)
+    {
+      if (histogram)
+	start = std::chrono::steady_clock::now ();
+    };
+    ScopedLatencyMeasurement (LatencyHistogram& hist) : ScopedLatencyMeasurement (&hist) {};
+
+    ~ScopedLatencyMeasurement () { finish (); };
+
+    ScopedLatencyMeasurement (const ScopedLatencyMeasurement&) = delete;
+    ScopedLatencyMeasurement& operator= (const ScopedLatencyMeasurement&) = delete;
+
+    /**
+     * @brief Records the time elapsed so far, later calls have no effect
+     */
+    inline void finish ()
+    {
+      if (histogram)
+	{
+	  histogram->record (std::chrono::steady_clock::now () - start);
+	  histogram = nullptr;
+	}
+    };
+  };
+
+
+  // -----------------------------------------------------------------
+
+
+  /**
+   * @brief Named metric as stored in a metrics area
+   */
+  template <typename MetricT>
+  struct MetricEntry {
+    char     name [maxMetricNameLength + 1];
+    MetricT  metric;
+  };
+
+
+  /**
+   * @brief Layout of a metrics area (shared memory segment or heap)
+   *
+   * Entries are only ever appended. The name of an entry is written
+   * before the number of entries is increased with release semantics,
+   * readers load the numbers with acquire semantics and only look at
+   * entries below them. The magic number is written last.
+   */
+  typedef struct MetricsArea {
+    std::atomic<uint32_t>  magic {0};
+    uint32_t               version = metricsAreaVersion;
+    char                   owner [maxMetricNameLength + 1] = {0};
+    std::atomic<uint32_t>  numberCounters {0};
+    std::atomic<uint32_t>  numberGauges {0};
+    std::atomic<uint32_t>  numberHistograms {0};
+
+    MetricEntry<MetricCounter>     counters   [maxMetricCounters];
+    MetricEntry<MetricGauge>       gauges     [maxMetricGauges];
+    MetricEntry<LatencyHistogram>  histograms [maxMetricHistograms];
+
+    inline bool      is_valid () const { return (magic.load (std::memory_order_acquire) == metricsAreaMagic) and (version == metricsAreaVersion); };
+    inline uint32_t  get_number_counters () const { return numberCounters.load (std::memory_order_acquire); };
+    inline uint32_t  get_number_gauges () const { return numberGauges.load (std::memory_order_acquire); };
+    inline uint32_t  get_number_histograms () const { return numberHistograms.load (std::memory_order_acquire); };
+  } MetricsArea;
+
+
+  // -----------------------------------------------------------------
+
+
+  /**
+   * @brief Owns a metrics area and registers metrics in it
+   *
+   * Registration takes a lock and is meant for initialization, the
+   * returned references stay valid for the lifetime of the registry.
+   * Registering an existing name again returns the existing metric.
+   */
+  class MetricsRegistry {
+  protected:
+    std::unique_ptr<MetricsArea>  heap_area;
+    ShmStructureBase              shm_area;
+    MetricsArea*                  area = nullptr;
+    std::mutex                    registration_mutex;
+
+    void initialize_area (void* memaddr, const std::string& owner);
+
+    template <typename MetricT>
+    MetricT& register_metric (MetricEntry<MetricT>* entries, std::atomic<uint32_t>& number, size_t capacity, const std::string& name);
+
+  public:
+
+    /**
+     * @brief Constructor, keeping the metrics area on the heap (not
+     *        visible to other processes)
+     */
+    MetricsRegistry (const std::string& owner);
+
+    /**
+     * @brief Constructor, creating the metrics area as shared memory
+     *        segment with the configured name. A stale segment with
+     *        the same name (left behind by a demon that crashed) is
+     *        removed first.
+     */
+    MetricsRegistry (const std::string& owner, const SharedMemoryConfigurationBlock& shm_conf);
+
+    MetricsRegistry (const MetricsRegistry&) = delete;
+    MetricsRegistry& operator= (const MetricsRegistry&) = delete;
+
+    /**
+     * @brief Return the metric with the given name, registering it if
+     *        necessary. Throw MetricsException when the name is too
+     *        long or the area is full.
+     */
+    MetricCounter&     counter (const std::string& name);
+    MetricGauge&       gauge (const std::string& name);
+    LatencyHistogram&  histogram (const std::string& name);
+
+    /**
+     * @brief Returns the metrics area
+     */
+    inline const MetricsArea& get_area () const { return *area; };
+
+    /**
+     * @brief Returns whether the area lives in shared memory
+     */
+    inline bool is_shared () const { return shm_area.has_valid_memory (); };
+  };
+
+
+  // -----------------------------------------------------------------
+
+
+  /**
+   * @brief Maps an existing metrics area read-only, for scraping by
+   *        other processes
+   */
+  class MetricsReader {
+  protected:
+    shared_memory_object  shm_obj;
+    mapped_region         region;
+    const MetricsArea*    area = nullptr;
+
+  public:
+
+    /**
+     * @brief Attaches to the metrics area with the given name. Throws
+     *        MetricsException if it does not exist or is not a
+     *        (completely initialized) metrics area.
+     */
+    MetricsReader (const std::string& area_name);
+
+    /**
+     * @brief Returns the metrics area
+     */
+    inline const MetricsArea& get_area () const { return *area; };
+  };
+
+
+  // -----------------------------------------------------------------
+
+
+  /**
+   * @brief Histogram receiving the time ShmFiniteQueue operations
+   *        wait for the queue mutex, null (no measurement) by default.
+   *
+   * The queue locks are process-wide, so there is one such histogram
+   * per process: each demon main registers it under
+   * shmQueueLockWaitMetricName in its own metrics area, the
+   * combined stack in the BP metrics area. It must be reset to null
+   * before that area goes away.
+   */
+  extern LatencyHistogram* shmQueueLockWaitHistogram;
+
+  const std::string shmQueueLockWaitMetricName = "shm_queue_lock_wait_ns";
+
+};  // namespace dcp
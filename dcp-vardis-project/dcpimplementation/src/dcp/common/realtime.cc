@@ -0,0 +1,307 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+
+extern "C" {
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <string.h>
+}
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <dcp/common/exceptions.h>
+#include <dcp/common/realtime.h>
+
+
+// older C libraries lack these, older kernels reject them
+#ifndef MADV_POPULATE_READ
+#define MADV_POPULATE_READ   22
+#endif
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE  23
+#endif
+
+
+namespace dcp {
+
+  // -----------------------------------------------------------------------------------------
+
+  // values of policy_from_string besides the SCHED_* constants
+  static const int policyUnknown = -1;
+  static const int policyInherit = -2;
+  
+  static int policy_from_string (const std::string& policy)
+  {
+    if (policy == "inherit") return policyInherit;
+    if (policy == "other")  return SCHED_OTHER;
+    if (policy == "fifo")   return SCHED_FIFO;
+    if (policy == "rr")     return SCHED_RR;
+    return policyUnknown;
+  }
+
+  static std::string policy_to_string (int policy)
+  {
+    switch (policy)
+      {
+      case SCHED_OTHER:  return "SCHED_OTHER";
+      case SCHED_FIFO:   return "SCHED_FIFO";
+      case SCHED_RR:     return "SCHED_RR";
+      case SCHED_BATCH:  return "SCHED_BATCH";
+      case SCHED_IDLE:   return "SCHED_IDLE";
+      default:           return std::format ("policy {}", policy);
+      }
+  }
+
+  // -----------------------------------------------------------------------------------------
+
+  RealtimeConfigurationBlock::RealtimeConfigurationBlock (std::string bname, const std::vector<std::string>& thread_names)
+    : DcpConfigurationBlock (bname)
+  {
+    for (const auto& name : thread_names)
+      threads[name] = ThreadSchedulingParameters ();
+  }
+  
+  // -----------------------------------------------------------------------------------------
+
+  void RealtimeConfigurationBlock::add_options (po::options_description& cfgdesc)
+  {
+    cfgdesc.add_options()
+      (opt("lockMemory").c_str(),            po::value<bool>(&lockMemory)->default_value(defaultValueLockMemory), txt("lock all pages of the process into memory (mlockall)").c_str())
+      (opt("prefaultSharedMemory").c_str(),  po::value<bool>(&prefaultSharedMemory)->default_value(defaultValuePrefaultSharedMemory), txt("fault in all shared memory segments at startup").c_str())
+      ;
+
+    // the map nodes do not move, so the option values can point into them
+    for (auto& [name, params] : threads)
+      {
+	cfgdesc.add_options()
+	  (opt(name + "Policy").c_str(),    po::value<std::string>(&params.policy)->default_value(defaultValueSchedulingPolicy), txt(std::format ("scheduling policy of {} thread (inherit, other, fifo or rr)", name)).c_str())
+	  (opt(name + "Priority").c_str(),  po::value<int>(&params.priority)->default_value(defaultValueSchedulingPriority), txt(std::format ("real-time priority of {} thread (fifo and rr)", name)).c_str())
+	  (opt(name + "Nice").c_str(),      po::value<int>(&params.nice)->default_value(defaultValueSchedulingNice), txt(std::format ("nice value of {} thread (other)", name)).c_str())
+	  (opt(name + "Cpus").c_str(),      po::value<std::string>(&params.cpus)->default_value(defaultValueSchedulingCpus), txt(std::format ("CPUs {} thread may run on, e.g. 1,3-4 (empty: unchanged)", name)).c_str())
+	  ;
+      }
+  }
+  
+  // -----------------------------------------------------------------------------------------
+
+  void RealtimeConfigurationBlock::validate ()
+  {
+    for (const auto& [name, params] : threads)
+      {
+	int policy = policy_from_string (params.policy);
+	if (policy == policyUnknown)
+	  throw ConfigurationException ("RealtimeConfigurationBlock", std::format ("unknown scheduling policy '{}' for {} thread", params.policy, name));
+	if (    ((policy == SCHED_FIFO) || (policy == SCHED_RR))
+	     && (    (params.priority < sched_get_priority_min (policy))
+		  || (params.priority > sched_get_priority_max (policy))))
+	  throw ConfigurationException ("RealtimeConfigurationBlock", std::format ("real-time priority of {} thread out of range", name));
+	if ((params.nice < -20) || (params.nice > 19))
+	  throw ConfigurationException ("RealtimeConfigurationBlock", std::format ("nice value of {} thread must be between -20 and 19", name));
+	for (int cpu : parse_cpu_list (params.cpus))
+	  if (cpu >= CPU_SETSIZE)
+	    throw ConfigurationException ("RealtimeConfigurationBlock", std::format ("CPU {} of {} thread too large", cpu, name));
+      }
+  }
+  
+  // -----------------------------------------------------------------------------------------
+
+  const ThreadSchedulingParameters& RealtimeConfigurationBlock::get_thread_parameters (const std::string& thread_name) const
+  {
+    auto it = threads.find (thread_name);
+    if (it == threads.end())
+      throw SchedulingException ("RealtimeConfigurationBlock", std::format ("unknown thread name '{}'", thread_name));
+    return it->second;
+  }
+  
+  // -----------------------------------------------------------------------------------------
+
+  std::ostream& operator<< (std::ostream& os, const RealtimeConfigurationBlock& cfg)
+  {
+    os << "lockMemory = " << cfg.lockMemory
+       << " , prefaultSharedMemory = " << cfg.prefaultSharedMemory;
+    for (const auto& [name, params] : cfg.threads)
+      {
+	os << " , " << name << " = { policy = " << params.policy
+	   << " , priority = " << params.priority
+	   << " , nice = " << params.nice
+	   << " , cpus = " << params.cpus
+	   << " }";
+      }
+    return os;
+  }
+  
+  // -----------------------------------------------------------------------------------------
+
+  std::vector<int> parse_cpu_list (const std::string& cpus)
+  {
+    std::vector<int> result;
+    std::stringstream ss (cpus);
+    std::string item;
+    while (std::getline (ss, item, ','))
+      {
+	int first, last;
+	char dash;
+	std::stringstream is (item);
+	if (not (is >> first))
+	  throw ConfigurationException ("parse_cpu_list", std::format ("illegal CPU list '{}'", cpus));
+	last = first;
+	if ((is >> dash) and ((dash != '-') or not (is >> last)))
+	  throw ConfigurationException ("parse_cpu_list", std::format ("illegal CPU list '{}'", cpus));
+	if ((first < 0) or (last < first) or not (is >> std::ws).eof())
+	  throw ConfigurationException ("parse_cpu_list", std::format ("illegal CPU list '{}'", cpus));
+	for (int cpu = first; cpu <= last; cpu++)
+	  result.push_back (cpu);
+      }
+    return result;
+  }
+  
+  // -----------------------------------------------------------------------------------------
+
+  void set_thread_scheduling (const ThreadSchedulingParameters& params)
+  {
+    int policy = policy_from_string (params.policy);
+    if (policy == policyUnknown)
+      throw SchedulingException ("set_thread_scheduling", std::format ("unknown scheduling policy '{}'", params.policy));
+    
+    if (policy != policyInherit)
+      {
+	struct sched_param sp;
+	sp.sched_priority = (policy == SCHED_OTHER) ? 0 : params.priority;
+	int rv = pthread_setschedparam (pthread_self (), policy, &sp);
+	if (rv != 0)
+	  throw SchedulingException ("set_thread_scheduling", std::format ("cannot set policy {} with priority {}: {}", params.policy, sp.sched_priority, strerror (rv)));
+      }
+
+    // under Linux the nice value is a per-thread attribute
+    if ((policy == SCHED_OTHER) and (setpriority (PRIO_PROCESS, gettid (), params.nice) < 0))
+      throw SchedulingException ("set_thread_scheduling", std::format ("policy {} set, but cannot set nice value {}: {}", params.policy, params.nice, strerror (errno)));
+
+    if (not params.cpus.empty())
+      {
+	cpu_set_t set;
+	CPU_ZERO (&set);
+	for (int cpu : parse_cpu_list (params.cpus))
+	  CPU_SET (cpu, &set);
+	int rv = pthread_setaffinity_np (pthread_self (), sizeof(set), &set);
+	if (rv != 0)
+	  throw SchedulingException ("set_thread_scheduling", std::format ("cannot set CPU affinity {}: {}", params.cpus, strerror (rv)));
+      }
+  }
+  
+  // -----------------------------------------------------------------------------------------
+
+  std::string describe_thread_scheduling ()
+  {
+    int policy;
+    struct sched_param sp;
+    pthread_getschedparam (pthread_self (), &policy, &sp);
+
+    std::string result = policy_to_string (policy);
+    if ((policy == SCHED_FIFO) or (policy == SCHED_RR))
+      result += std::format (" priority {}", sp.sched_priority);
+    else
+      result += std::format (" nice {}", getpriority (PRIO_PROCESS, gettid ()));
+
+    cpu_set_t set;
+    CPU_ZERO (&set);
+    if (pthread_getaffinity_np (pthread_self (), sizeof(set), &set) == 0)
+      {
+	result += ", cpus";
+	std::string sep = " ";
+	for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+	  if (CPU_ISSET (cpu, &set))
+	    {
+	      result += sep + std::to_string (cpu);
+	      sep = ",";
+	    }
+      }
+    return result;
+  }
+  
+  // -----------------------------------------------------------------------------------------
+
+  void apply_thread_scheduling (const RealtimeConfigurationBlock& cfg, const std::string& thread_name, logger_type& log)
+  {
+    try {
+      set_thread_scheduling (cfg.get_thread_parameters (thread_name));
+    }
+    catch (DcpException& e)
+      {
+	DCPLOG_WARNING(log) << "Thread " << thread_name << ": " << e.what();
+      }
+    DCPLOG_INFO(log) << "Thread " << thread_name << " runs with " << describe_thread_scheduling ();
+  }
+  
+  // -----------------------------------------------------------------------------------------
+
+  size_t prefault_shared_memory ()
+  {
+    std::ifstream maps ("/proc/self/maps");
+    std::string   line;
+    size_t        total     = 0;
+    long          page_size = sysconf (_SC_PAGESIZE);
+    
+    while (std::getline (maps, line))
+      {
+	if (line.find (" /dev/shm/") == std::string::npos)
+	  continue;
+
+	uintptr_t start, end;
+	char      dash;
+	std::string perms;
+	std::stringstream ls (line);
+	ls >> std::hex >> start >> dash >> end >> perms;
+	if (ls.fail() or (perms.size() < 2) or (perms[0] != 'r'))
+	  continue;
+
+	// populating needs Linux 5.14, otherwise touch every page (a
+	// read fault is enough to map the page of a shared mapping)
+	int advice = (perms[1] == 'w') ? MADV_POPULATE_WRITE : MADV_POPULATE_READ;
+	if (madvise ((void*) start, end - start, advice) != 0)
+	  {
+	    for (uintptr_t addr = start; addr < end; addr += page_size)
+	      (void) *((volatile const byte*) addr);
+	  }
+	total += end - start;
+      }
+    return total;
+  }
+  
+  // -----------------------------------------------------------------------------------------
+
+  void apply_process_realtime_settings (const RealtimeConfigurationBlock& cfg, logger_type& log)
+  {
+    if (cfg.lockMemory)
+      {
+	if (mlockall (MCL_CURRENT | MCL_FUTURE) == 0)
+	  DCPLOG_INFO(log) << "Locked process memory.";
+	else
+	  DCPLOG_WARNING(log) << "Cannot lock process memory: " << strerror (errno);
+      }
+
+    if (cfg.prefaultSharedMemory)
+      DCPLOG_INFO(log) << "Pre-faulted " << prefault_shared_memory () << " bytes of shared memory.";
+  }
+  
+};  // namespace dcp
@@ -0,0 +1,215 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dcp/common/configuration.h>
+#include <dcp/common/logging_helpers.h>
+#include <dcp/common/metrics.h>
+
+
+/**
+ * @brief This module provides real-time related settings of the
+ *        demons: per-thread scheduling policy, priority and CPU
+ *        affinity, locking the process memory, and pre-faulting the
+ *        shared memory segments, so that protocol threads are
+ *        neither preempted by unrelated work nor stalled by page
+ *        faults on the hot path.
+ */
+
+
+namespace dcp {
+
+  /**
+   * @brief Default values for configuration options
+   */
+  const std::string  defaultValueSchedulingPolicy     = "inherit";
+  const int          defaultValueSchedulingPriority   = 0;
+  const int          defaultValueSchedulingNice       = 0;
+  const std::string  defaultValueSchedulingCpus       = "";
+  const bool         defaultValueLockMemory           = false;
+  const bool         defaultValuePrefaultSharedMemory = false;
+
+
+  /**
+   * @brief Scheduling settings for one thread
+   */
+  typedef struct ThreadSchedulingParameters {
+    std::string  policy    = defaultValueSchedulingPolicy;    /*!< "inherit" (leave policy, priority and nice value unchanged), "other" (SCHED_OTHER), "fifo" (SCHED_FIFO) or "rr" (SCHED_RR) */
+    int          priority  = defaultValueSchedulingPriority;  /*!< Real-time priority (1 to 99), only for fifo and rr */
+    int          nice      = defaultValueSchedulingNice;      /*!< Nice value (-20 to 19), only for other */
+    std::string  cpus      = defaultValueSchedulingCpus;      /*!< CPUs the thread may run on, e.g. "1,3-4", empty leaves the affinity unchanged */
+  } ThreadSchedulingParameters;
+
+
+  /**
+   * @brief Configuration block with the real-time settings of one
+   *        demon
+   *
+   * The block has process-wide options (lockMemory,
+   * prefaultSharedMemory) and, for every thread name given to the
+   * constructor, the options <name>Policy, <name>Priority, <name>Nice
+   * and <name>Cpus. The defaults leave everything as it is.
+   */
+  class RealtimeConfigurationBlock : public DcpConfigurationBlock {
+  public:
+
+    /**
+     * @brief Lock all current and future pages of the process into
+     *        memory (mlockall). Needs CAP_IPC_LOCK or a sufficient
+     *        RLIMIT_MEMLOCK.
+     */
+    bool lockMemory            = defaultValueLockMemory;
+
+
+    /**
+     * @brief Fault in all shared memory segments mapped at startup
+     */
+    bool prefaultSharedMemory  = defaultValuePrefaultSharedMemory;
+
+
+    /**
+     * @brief Scheduling parameters by thread name
+     */
+    std::map<std::string, ThreadSchedulingParameters> threads;
+
+
+    /**
+     * @brief Constructor, setting section name for config file and
+     *        the names of the threads of the demon
+     */
+    RealtimeConfigurationBlock (std::string bname, const std::vector<std::string>& thread_names);
+
+
+    /**
+     * @brief Add description of configuration options for config file
+     */
+    virtual void add_options (po::options_description& cfgdesc);
+
+
+    /**
+     * @brief Validates configuration values. Throws exception if invalid.
+     */
+    virtual void validate ();
+
+
+    /**
+     * @brief Returns the parameters for the given thread, throws for
+     *        unknown thread names
+     */
+    const ThreadSchedulingParameters& get_thread_parameters (const std::string& thread_name) const;
+  };
+
+
+  /**
+   * @brief Prints all settings of the block
+   */
+  std::ostream& operator<< (std::ostream& os, const RealtimeConfigurationBlock& cfg);
+
+  
+  /**
+   * @brief Parses a CPU list like "0,2-3" into CPU numbers, throws
+   *        ConfigurationException on syntax errors
+   */
+  std::vector<int> parse_cpu_list (const std::string& cpus);
+
+
+  /**
+   * @brief Applies the given scheduling parameters to the calling
+   *        thread. Throws SchedulingException when the kernel refuses
+   *        (typically for lack of CAP_SYS_NICE); the settings applied
+   *        before the failing step are kept.
+   */
+  void set_thread_scheduling (const ThreadSchedulingParameters& params);
+
+
+  /**
+   * @brief Returns a description of the actual scheduling policy,
+   *        priority / nice value and CPU affinity of the calling
+   *        thread
+   */
+  std::string describe_thread_scheduling ();
+
+
+  /**
+   * @brief Applies the parameters configured for the named thread to
+   *        the calling thread and logs the achieved settings. A
+   *        failure is logged as a warning, the thread keeps running
+   *        with the settings achieved so far.
+   */
+  void apply_thread_scheduling (const RealtimeConfigurationBlock& cfg, const std::string& thread_name, logger_type& log);
+
+
+  /**
+   * @brief Applies the process-wide settings (memory locking,
+   *        pre-faulting shared memory) and logs the outcome. Failures
+   *        are logged as warnings.
+   */
+  void apply_process_realtime_settings (const RealtimeConfigurationBlock& cfg, logger_type& log);
+
+
+  /**
+   * @brief Faults in all pages of the shared memory segments
+   *        (/dev/shm) currently mapped by the process, returns the
+   *        number of bytes covered
+   */
+  size_t prefault_shared_memory ();
+
+
+  /**
+   * @brief Starts a thread running thread_func(runtime) after
+   *        applying the scheduling parameters configured for
+   *        thread_name
+   */
+  template <typename RuntimeT>
+  std::thread start_thread (const RealtimeConfigurationBlock& cfg,
+			    const std::string& thread_name,
+			    logger_type& log,
+			    void (*thread_func) (RuntimeT&),
+			    RuntimeT& runtime)
+  {
+    return std::thread ([&cfg, thread_name, &log, thread_func, &runtime] ()
+    {
+      apply_thread_scheduling (cfg, thread_name, log);
+      thread_func (runtime);
+    });
+  }
+
+
+  /**
+   * @brief Sleeps for the given time and records by how much the
+   *        wake-up was late in the given histogram
+   */
+  template <typename Rep, typename Period>
+  inline void sleep_for_measured (std::chrono::duration<Rep, Period> d, LatencyHistogram& wakeup_latency)
+  {
+    auto due = std::chrono::steady_clock::now () + d;
+    std::this_thread::sleep_until (due);
+    wakeup_latency.record (std::chrono::steady_clock::now () - due);
+  }
+  
+};  // namespace dcp
@@ -105,6 +105,8 @@ namespace dcp {
       case VARDIS_STATUS_APPLICATION_ALREADY_REGISTERED:  return "VARDIS_STATUS_APPLICATION_ALREADY_REGISTERED";
       case VARDIS_STATUS_INTERNAL_SHARED_MEMORY_ERROR:    return "VARDIS_STATUS_INTERNAL_SHARED_MEMORY_ERROR";
       case VARDIS_STATUS_UNKNOWN_APPLICATION:             return "VARDIS_STATUS_UNKNOWN_APPLICATION";
+      case VARDIS_STATUS_ILLEGAL_PRIORITY:                return "VARDIS_STATUS_ILLEGAL_PRIORITY";
+      case VARDIS_STATUS_ILLEGAL_INTERVAL:                return "VARDIS_STATUS_ILLEGAL_INTERVAL";
 	
       default:
 	throw std::invalid_argument(std::format("vardis_status_to_string: illegal status code {}", stat));
@@ -150,6 +152,16 @@ namespace dcp {
       {
 	// status codes prescribed by the specification
       case SRP_STATUS_OK:                              return "SRP_STATUS_OK";
+
+	// implementation-dependent status codes
+      case SRP_STATUS_NO_FREE_SUBSCRIPTION:            return "SRP_STATUS_NO_FREE_SUBSCRIPTION";
+      case SRP_STATUS_ALREADY_SUBSCRIBED:              return "SRP_STATUS_ALREADY_SUBSCRIBED";
+      case SRP_STATUS_NOT_SUBSCRIBED:                  return "SRP_STATUS_NOT_SUBSCRIBED";
+      case SRP_STATUS_ILLEGAL_DISTANCE:                return "SRP_STATUS_ILLEGAL_DISTANCE";
+      case SRP_STATUS_ILLEGAL_HORIZON:                 return "SRP_STATUS_ILLEGAL_HORIZON";
+      case SRP_STATUS_ILLEGAL_SAFETY_DATA:             return "SRP_STATUS_ILLEGAL_SAFETY_DATA";
+      case SRP_STATUS_ILLEGAL_POSITION:                return "SRP_STATUS_ILLEGAL_POSITION";
+      case SRP_STATUS_SNAPSHOT_UNAVAILABLE:            return "SRP_STATUS_SNAPSHOT_UNAVAILABLE";
 	
       default:
 	throw std::invalid_argument(std::format("srp_status_to_string: illegal status code {}", stat));
@@ -205,6 +205,8 @@ namespace dcp {
   const DcpStatus VARDIS_STATUS_APPLICATION_ALREADY_REGISTERED  =  BaseVardisStatus + 0x0101;
   const DcpStatus VARDIS_STATUS_INTERNAL_SHARED_MEMORY_ERROR    =  BaseVardisStatus + 0x0102;
   const DcpStatus VARDIS_STATUS_UNKNOWN_APPLICATION             =  BaseVardisStatus + 0x0103;
+  const DcpStatus VARDIS_STATUS_ILLEGAL_PRIORITY                =  BaseVardisStatus + 0x0104;
+  const DcpStatus VARDIS_STATUS_ILLEGAL_INTERVAL                =  BaseVardisStatus + 0x0105;
 
 
   /**
@@ -226,6 +228,19 @@ namespace dcp {
    */
   const DcpStatus SRP_STATUS_OK     =  BaseSRPStatus + 0x0000;
 
+
+  /**
+   * @brief Additional implementation-dependent status codes
+   */
+  const DcpStatus SRP_STATUS_NO_FREE_SUBSCRIPTION  =  BaseSRPStatus + 0x0100;
+  const DcpStatus SRP_STATUS_ALREADY_SUBSCRIBED    =  BaseSRPStatus + 0x0101;
+  const DcpStatus SRP_STATUS_NOT_SUBSCRIBED        =  BaseSRPStatus + 0x0102;
+  const DcpStatus SRP_STATUS_ILLEGAL_DISTANCE      =  BaseSRPStatus + 0x0103;
+  const DcpStatus SRP_STATUS_ILLEGAL_HORIZON       =  BaseSRPStatus + 0x0104;
+  const DcpStatus SRP_STATUS_ILLEGAL_SAFETY_DATA   =  BaseSRPStatus + 0x0105;
+  const DcpStatus SRP_STATUS_ILLEGAL_POSITION      =  BaseSRPStatus + 0x0106;
+  const DcpStatus SRP_STATUS_SNAPSHOT_UNAVAILABLE  =  BaseSRPStatus + 0x0107;
+
   
   /**
    * @brief Returns string representation of SRP status code.
@@ -28,6 +28,7 @@ namespace dcp {
   {
     cfgdesc.add_options()
       (opt("areaName").c_str(),  po::value<std::string>(&shmAreaName)->default_value(default_area_name), txt("shared memory area name").c_str())
+      (opt("hugePages").c_str(), po::value<bool>(&shmHugePages)->default_value(defaultValueShmHugePages), txt("map shared memory area with transparent huge pages").c_str())
       ;
   }
 
@@ -41,6 +41,13 @@ namespace dcp {
   const std::string defaultValueShmAreaName    = "dcp-shm";
 
 
+  /**
+   * @brief Default setting for mapping a shared memory block with
+   *        huge pages
+   */
+  const bool defaultValueShmHugePages          = false;
+
+
   /**
    * @brief This class holds all the configuration data for a shared
    *        memory block
@@ -52,6 +59,7 @@ namespace dcp {
   public:
 
     std::string shmAreaName; /*!< Name of shared memory area, must be systemwide unique at the time of creation */
+    bool        shmHugePages = defaultValueShmHugePages; /*!< Whether to back the area with transparent huge pages (only used by the creator) */
 
 
     /**
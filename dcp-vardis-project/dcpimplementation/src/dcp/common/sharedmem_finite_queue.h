@@ -31,6 +31,7 @@
 #include <dcp/common/exceptions.h>
 #include <dcp/common/fixedmem_ring_buffer.h>
 #include <dcp/common/global_types_constants.h>
+#include <dcp/common/metrics.h>
 #include <dcp/common/sharedmem_structure_base.h>
 
 /**
@@ -86,6 +87,11 @@ namespace dcp {
    * The buffers themselves are just byte blocks which user code can
    * tinker without further checks.
    *
+   * The mutex, the condition variables and the two ring buffers each
+   * start on their own cache line, so that a producer and a consumer
+   * process do not invalidate each others cache lines when spinning
+   * on the lock or touching the ring buffer of the other side.
+   *
    * @tparam numberBuffers: number of buffers in the queue, the queue
    *         can hold only this many elements
    * @tparam bufferSize: size of a buffer
@@ -131,13 +137,13 @@ namespace dcp {
 
     uint64_t  magicNo = defaultMagicNo;
     char queue_name [maxQueueNameLength+1];                          /*!< storing the user-given name of the finite queue */
-    FixedMemRingBuffer<DescrT, numberBuffers+1>  queue;              /*!< ring buffer with current queue elements / buffers */
-    FixedMemRingBuffer<DescrT, numberBuffers+1>  freeList;           /*!< ring buffer with list of free elements / buffers */
-    byte buffer_space [numberBuffers * get_actual_buffer_size()];    /*!< the actual buffer space storing user data */
+    alignas(cacheLineSize) FixedMemRingBuffer<DescrT, numberBuffers+1>  queue;              /*!< ring buffer with current queue elements / buffers */
+    alignas(cacheLineSize) FixedMemRingBuffer<DescrT, numberBuffers+1>  freeList;           /*!< ring buffer with list of free elements / buffers */
+    alignas(cacheLineSize) byte buffer_space [numberBuffers * get_actual_buffer_size()];    /*!< the actual buffer space storing user data */
 
     
-    interprocess_mutex      mutex;               /*!< mutex protecting access to the finite queue */
-    interprocess_condition  cond_empty;          /*!< condition variable telling whether queue is empty or not */
+    alignas(cacheLineSize) interprocess_mutex      mutex;               /*!< mutex protecting access to the finite queue */
+    alignas(cacheLineSize) interprocess_condition  cond_empty;          /*!< condition variable telling whether queue is empty or not */
     interprocess_condition  cond_full;           /*!< condition variable telling whether queue is full or not */
     bool                    has_data = false;    /*!< flag indicating whether queue has data or not */
 
@@ -171,6 +177,18 @@ namespace dcp {
       if (magicNo != defaultMagicNo)
 	throw ShmException (std::format("{}.{}", get_queue_name (), modname), "check for magic number failed");
     };
+
+
+    /**
+     * @brief Acquires the queue mutex with the given timeout, the
+     *        time spent waiting goes into shmQueueLockWaitHistogram
+     *        (when set)
+     */
+    inline scoped_lock<interprocess_mutex> acquire_lock (const boost::posix_time::ptime& timeout)
+    {
+      ScopedLatencyMeasurement lock_wait (shmQueueLockWaitHistogram);
+      return scoped_lock<interprocess_mutex> (mutex, timeout);
+    };
     
     
   public:
@@ -290,7 +308,7 @@ namespace dcp {
       
       const boost::posix_time::ptime timeout (boost::get_system_time() + boost::posix_time::milliseconds(timeoutMS));
       
-      scoped_lock<interprocess_mutex> lock (mutex, timeout);
+      scoped_lock<interprocess_mutex> lock = acquire_lock (timeout);
       
       if (!lock.owns())
 	{
@@ -359,7 +377,7 @@ namespace dcp {
       
       const boost::posix_time::ptime timeout (boost::get_system_time() + boost::posix_time::milliseconds(timeoutMS));
       
-      scoped_lock<interprocess_mutex> lock (mutex, timeout);
+      scoped_lock<interprocess_mutex> lock = acquire_lock (timeout);
       
       if (!lock.owns())
 	{
@@ -419,7 +437,7 @@ namespace dcp {
       
       const boost::posix_time::ptime timeout (boost::get_system_time() + boost::posix_time::milliseconds(timeoutMS));
       
-      scoped_lock<interprocess_mutex> lock (mutex, timeout);
+      scoped_lock<interprocess_mutex> lock = acquire_lock (timeout);
       
       if (!lock.owns())
 	{
@@ -477,7 +495,7 @@ namespace dcp {
       
       const boost::posix_time::ptime timeout (boost::get_system_time() + boost::posix_time::milliseconds(timeoutMS));
       
-      scoped_lock<interprocess_mutex> lock (mutex, timeout);
+      scoped_lock<interprocess_mutex> lock = acquire_lock (timeout);
       
       if (!lock.owns())
 	{
@@ -544,7 +562,7 @@ namespace dcp {
       
       const boost::posix_time::ptime timeout (boost::get_system_time() + boost::posix_time::milliseconds(timeoutMS));
       
-      scoped_lock<interprocess_mutex> lock (mutex, timeout);
+      scoped_lock<interprocess_mutex> lock = acquire_lock (timeout);
       
       if (!lock.owns())
 	{
@@ -599,7 +617,7 @@ namespace dcp {
       
       const boost::posix_time::ptime timeout (boost::get_system_time() + boost::posix_time::milliseconds(timeoutMS));
       
-      scoped_lock<interprocess_mutex> lock (mutex, timeout);
+      scoped_lock<interprocess_mutex> lock = acquire_lock (timeout);
       
       if (!lock.owns())
 	{
@@ -662,7 +680,7 @@ namespace dcp {
       
       const boost::posix_time::ptime timeout (boost::get_system_time() + boost::posix_time::milliseconds(timeoutMS));
       
-      scoped_lock<interprocess_mutex> lock (mutex, timeout);
+      scoped_lock<interprocess_mutex> lock = acquire_lock (timeout);
       
       if (!lock.owns())
 	{
@@ -685,12 +703,148 @@ namespace dcp {
 	}
       
       has_data = false;
-      
+
       cond_full.notify_all ();
     };
-    
-    
-    
+
+
+    // -----------------------------------------
+
+    /**
+     * @brief Retrieves up to max_entries elements from the queue in
+     *        one critical section, processing them in order. Caller
+     *        is put into waiting state until the queue becomes
+     *        nonempty or a timeout occurs.
+     *
+     * @param handler: a pop handler that is called for each element
+     *        immediately before its buffer is removed. The handler
+     *        can copy the data or process it otherwise.
+     * @param max_entries: maximum number of elements to retrieve,
+     *        must not be zero
+     * @param number_popped: output parameter, number of elements
+     *        that have been retrieved
+     * @param timed_out: output parameter indicating whether any of
+     *        the involved locking operations (for the mutex or the
+     *        condition variable) timed out
+     * @param further_entries: output parameter indicating whether
+     *        after removing the elements there are further entries
+     *        available in the queue
+     * @param timeoutMS: timeout value to use for locking operations
+     *        in milliseconds
+     */
+    void popmany_wait (PopHandler handler,
+		       size_t max_entries,
+		       size_t& number_popped,
+		       bool& timed_out,
+		       bool& further_entries,
+		       uint16_t timeoutMS = defaultLongSharedMemoryLockTimeoutMS)
+    {
+      if (timeoutMS==0)
+	throw ShmException (std::format("{}.popmany_wait", get_queue_name()), "timeout is zero");
+      if (max_entries==0)
+	throw ShmException (std::format("{}.popmany_wait", get_queue_name()), "max_entries is zero");
+
+      number_popped   = 0;
+      timed_out       = false;
+      further_entries = false;
+
+      const boost::posix_time::ptime timeout (boost::get_system_time() + boost::posix_time::milliseconds(timeoutMS));
+
+      scoped_lock<interprocess_mutex> lock = acquire_lock (timeout);
+
+      if (!lock.owns())
+	{
+	  timed_out = true;
+	  return;
+	}
+
+      if (!has_data)
+	{
+	  const boost::posix_time::ptime cv_timeout (boost::get_system_time() + boost::posix_time::milliseconds(timeoutMS));
+
+	  if (not cond_empty.timed_wait (lock, cv_timeout))
+	    {
+	      timed_out = true;
+	      return;
+	    }
+	}
+
+      while ((number_popped < max_entries) and (not queue.isEmpty()))
+	{
+	  DescrT descr = queue.pop ();
+	  byte* effective_address = buffer_space + descr.offs;
+	  handler (effective_address, descr.len);
+	  descr.len = 0;
+	  freeList.push (descr);
+	  number_popped++;
+	}
+
+      if (queue.isEmpty())
+	has_data = false;
+      else
+	further_entries = true;
+
+      cond_full.notify_all ();
+    };
+
+
+    // -----------------------------------------
+
+    /**
+     * @brief Like popmany_wait(), but returns without further action
+     *        or waiting if the queue is empty
+     */
+    void popmany_nowait (PopHandler handler,
+			 size_t max_entries,
+			 size_t& number_popped,
+			 bool& timed_out,
+			 bool& further_entries,
+			 uint16_t timeoutMS = defaultLongSharedMemoryLockTimeoutMS)
+    {
+      if (timeoutMS==0)
+	throw ShmException (std::format("{}.popmany_nowait", get_queue_name()), "timeout is zero");
+      if (max_entries==0)
+	throw ShmException (std::format("{}.popmany_nowait", get_queue_name()), "max_entries is zero");
+
+      number_popped   = 0;
+      timed_out       = false;
+      further_entries = false;
+
+      const boost::posix_time::ptime timeout (boost::get_system_time() + boost::posix_time::milliseconds(timeoutMS));
+
+      scoped_lock<interprocess_mutex> lock = acquire_lock (timeout);
+
+      if (!lock.owns())
+	{
+	  timed_out = true;
+	  return;
+	}
+
+      if (!has_data)
+	{
+	  return;
+	}
+
+      while ((number_popped < max_entries) and (not queue.isEmpty()))
+	{
+	  DescrT descr = queue.pop ();
+	  byte* effective_address = buffer_space + descr.offs;
+	  handler (effective_address, descr.len);
+	  descr.len = 0;
+	  freeList.push (descr);
+	  number_popped++;
+	}
+
+      if (queue.isEmpty())
+	has_data = false;
+      else
+	further_entries = true;
+
+      cond_full.notify_all ();
+    };
+
+
+
     // -----------------------------------------
 
     /**
@@ -719,7 +873,7 @@ namespace dcp {
       
       const boost::posix_time::ptime timeout (boost::get_system_time() + boost::posix_time::milliseconds(timeoutMS));
       
-      scoped_lock<interprocess_mutex> lock (mutex, timeout);
+      scoped_lock<interprocess_mutex> lock = acquire_lock (timeout);
       
       if (!lock.owns())
 	{
@@ -772,7 +926,7 @@ namespace dcp {
       
       const boost::posix_time::ptime timeout (boost::get_system_time() + boost::posix_time::milliseconds(timeoutMS));
       
-      scoped_lock<interprocess_mutex> lock (mutex, timeout);
+      scoped_lock<interprocess_mutex> lock = acquire_lock (timeout);
       
       if (!lock.owns())
 	{
@@ -19,6 +19,10 @@
 
 
 
+extern "C" {
+#include <sys/mman.h>
+}
+#include <new>
 #include <dcp/common/exceptions.h>
 #include <dcp/common/sharedmem_structure_base.h>
 
@@ -31,12 +35,12 @@ namespace dcp {
   {
   }
   
-  ShmStructureBase::ShmStructureBase (const char* area_name, size_t struct_size, bool isCreator)
+  ShmStructureBase::ShmStructureBase (const char* area_name, size_t struct_size, bool isCreator, bool useHugePages)
     : isCreator (isCreator),
       memory_address (nullptr),
       structure_size (struct_size)
   {
-    if (isCreator)      create_shm_area (area_name, struct_size);
+    if (isCreator)      create_shm_area (area_name, struct_size, useHugePages);
     if (not isCreator)  attach_to_shm_area (area_name);
   }
   
@@ -59,6 +63,7 @@ namespace dcp {
     isCreator       = other.isCreator;
     memory_address  = other.memory_address;
     structure_size  = other.structure_size;
+    thpAdvised      = other.thpAdvised;
     
     other.isCreator       = false;
     other.memory_address  = nullptr;
@@ -68,19 +73,32 @@ namespace dcp {
   }
   
   
-  void ShmStructureBase::create_shm_area (const char* area_name, size_t struct_size)
+  void ShmStructureBase::advise_huge_pages ()
+  {
+    thpAdvised = (madvise (region.get_address(), region.get_size(), MADV_HUGEPAGE) == 0);
+  }
+
+
+  void ShmStructureBase::create_shm_area (const char* area_name, size_t struct_size, bool useHugePages)
   {
     if (!area_name)
       throw ShmException  ("create_shm_area", "no area name");
     if (std::strlen(area_name) > maxShmAreaNameLength)
       throw ShmException  (std::format("{}.create_shm_area", area_name),
 			   "name is too long");
-    if (structure_size == 0)
+    if (struct_size == 0)
       throw ShmException (std::format("{}.create_shm_area", area_name),
 			  "structure size is zero");
+
+    // a whole number of huge pages, the structure gets all the space
+    // behind the segment header
+    size_t segment_size = shmSegmentHeaderSize + struct_size;
+    if (useHugePages)
+      segment_size = hugePageSize * ((segment_size + hugePageSize - 1) / hugePageSize);
+    structure_size = segment_size - shmSegmentHeaderSize;
         
     shm_obj = shared_memory_object (create_only, area_name, read_write);
-    shm_obj.truncate (structure_size);
+    shm_obj.truncate (segment_size);
     
     // #####ISSUE: This is incredibly ugly and very probably
     // #####absolutely not portable, but so far the only way I
@@ -92,14 +110,17 @@ namespace dcp {
     chmod (std::format("/dev/shm/{}", area_name).c_str(), 0666);  
     
     region = mapped_region (shm_obj, read_write);
-    if (region.get_size() != structure_size)
+    if (region.get_size() != segment_size)
       throw ShmException (std::format("{}.create_shm_area", area_name),
-			  std::format("wrong region size {} where {} is required", region.get_size(), structure_size));
-    memory_address = (byte*) region.get_address();
-    if (!memory_address)
+			  std::format("wrong region size {} where {} is required", region.get_size(), segment_size));
+    if (!region.get_address())
       throw ShmException (std::format("{}.create_shm_area", area_name),
 			  "illegal region pointer for creator");
-    structure_size = struct_size;    
+    memory_address = (byte*) region.get_address() + shmSegmentHeaderSize;
+    if (useHugePages)
+      advise_huge_pages ();
+    new (header()) ShmSegmentHeader;
+    header()->thpAdvised = thpAdvised;
   }
   
 
@@ -113,11 +134,16 @@ namespace dcp {
     try {
       shm_obj = shared_memory_object (open_only, area_name, read_write);
       region  = mapped_region (shm_obj, read_write);
-      memory_address = (byte*) region.get_address();
-      if (!memory_address)
+      if (!region.get_address())
 	throw ShmException (std::format("{}.attach_to_shm_area", area_name),
 			    "illegal region pointer for client");
-      structure_size = region.get_size();
+      if (region.get_size() < shmSegmentHeaderSize)
+	throw ShmException (std::format("{}.attach_to_shm_area", area_name),
+			    std::format("region size {} is smaller than the segment header", region.get_size()));
+      memory_address = (byte*) region.get_address() + shmSegmentHeaderSize;
+      structure_size = region.get_size() - shmSegmentHeaderSize;
+      if (header()->thpAdvised)
+	advise_huge_pages ();
     }
     catch (ShmException& se)
       {
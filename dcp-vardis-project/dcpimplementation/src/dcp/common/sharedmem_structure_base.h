@@ -21,6 +21,8 @@
 #pragma once
 
 
+#include <algorithm>
+#include <cstddef>
 #include <boost/interprocess/shared_memory_object.hpp>
 #include <boost/interprocess/mapped_region.hpp>
 #include <dcp/common/global_types_constants.h>
@@ -34,6 +36,23 @@ using namespace boost::interprocess;
 
 namespace dcp {
 
+  /**
+   * @brief Header placed by the creator at the start of a shared
+   *        memory segment, ahead of the structure it holds
+   */
+  typedef struct ShmSegmentHeader {
+    bool  thpAdvised = false;   /*!< Creator has advised transparent huge pages for the segment */
+  } ShmSegmentHeader;
+
+
+  /**
+   * @brief Space reserved for the ShmSegmentHeader, keeps the
+   *        structure behind it aligned
+   */
+  const size_t shmSegmentHeaderSize = std::max (cacheLineSize, alignof(std::max_align_t));
+  static_assert (sizeof(ShmSegmentHeader) <= shmSegmentHeaderSize);
+  
+
   /**
    * @brief Provides support for creating a shared memory segment, and
    *        for attaching to an existing shared memory segment.
@@ -44,8 +63,23 @@ namespace dcp {
     shared_memory_object shm_obj;      /*!< Boost shared memory object */
     mapped_region region;              /*!< Boost shared memory region, holds information about the region (address, size) */
     bool    isCreator      = false;    /*!< Indicates whether user of this object is the one creating the shared memory segmeng */
-    byte*   memory_address = nullptr;  /*!< Memory address of shared memory segment */
-    size_t  structure_size = 0;        /*!< Size of shared memory segment */
+    byte*   memory_address = nullptr;  /*!< Memory address of the structure in the shared memory segment */
+    size_t  structure_size = 0;        /*!< Size of the structure in the shared memory segment */
+    bool    thpAdvised     = false;    /*!< Whether transparent huge pages have been advised for the mapping */
+
+
+    /**
+     * @brief Advises the kernel to back the mapped segment with
+     *        transparent huge pages, records whether the advice was
+     *        accepted
+     */
+    void advise_huge_pages ();
+
+    
+    /**
+     * @brief Returns the header at the start of the mapped segment
+     */
+    inline ShmSegmentHeader* header () const { return (ShmSegmentHeader*) region.get_address(); };
 
   public:
 
@@ -63,8 +97,13 @@ namespace dcp {
      *        attaching to an existing area.
      * @param isCreator: indicates whether to create new area or attach to
      *        existing area
+     * @param useHugePages: when creating, round the segment size up
+     *        to a multiple of the huge page size and advise
+     *        transparent huge pages for it. The creator records this
+     *        in the segment header, processes attaching to such an
+     *        area advise huge pages as well.
      */
-    ShmStructureBase (const char* area_name, size_t struct_size, bool isCreator);
+    ShmStructureBase (const char* area_name, size_t struct_size, bool isCreator, bool useHugePages = false);
 
 
     /**
@@ -84,18 +123,27 @@ namespace dcp {
      *
      * @param area_name: name of shared memory area to create
      * @param struct_size: requested size of shared memory area
+     * @param useHugePages: whether to map the area with transparent
+     *        huge pages
      *
      * Throws if shared memory area cannot be created (e.g. when it
      * already exists). WARNING: currently the shared memory area is
      * made world-readable and write-able.
+     *
+     * Huge pages for POSIX shared memory require the kernel setting
+     * /sys/kernel/mm/transparent_hugepage/shmem_enabled to be
+     * 'advise' or 'always', otherwise the area silently uses regular
+     * pages even when the advice has been accepted (see
+     * get_thp_advised()).
      */
-    void create_shm_area (const char* area_name, size_t struct_size);
+    void create_shm_area (const char* area_name, size_t struct_size, bool useHugePages = false);
 
 
     /**
      * @brief Attempts to attach to an existing shared memory
      *        area. Throws if this is not possible (e.g. area does not
-     *        exist)
+     *        exist). Advises transparent huge pages when the creator
+     *        has done so.
      *
      * @param area_name: name of shared memory area to attach to.
      */
@@ -103,7 +151,8 @@ namespace dcp {
 
 
     /**
-     * @brief Returns the address of shared memory area
+     * @brief Returns the address of the structure in the shared
+     *        memory area (behind the segment header)
      */
     inline byte*       get_memory_address () const { return memory_address; };
 
@@ -115,11 +164,20 @@ namespace dcp {
 
 
     /**
-     * @brief Returns size of shared memory area
+     * @brief Returns size of the structure in the shared memory area,
+     *        excluding the segment header
      */
     inline size_t      get_structure_size () const { return structure_size; };
 
 
+    /**
+     * @brief Returns whether transparent huge pages have been advised
+     *        for the mapping of the area. Whether the kernel actually
+     *        backs it with huge pages depends on its THP settings.
+     */
+    inline bool        get_thp_advised () const { return thpAdvised; };
+
+
     /**
      * @brief Returns area name
      */
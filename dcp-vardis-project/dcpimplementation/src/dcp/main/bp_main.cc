@@ -9,7 +9,9 @@
 #include <boost/program_options.hpp>
 #include <dcp/common/exceptions.h>
 #include <dcp/common/global_types_constants.h>
+#include <dcp/common/metrics.h>
 #include <dcp/common/other_helpers.h>
+#include <dcp/common/realtime.h>
 #include <dcp/common/services_status.h>
 #include <dcp/bp/bpclient_configuration.h>
 #include <dcp/bp/bp_configuration.h>
@@ -67,6 +69,7 @@ void run_bp_demon (const std::string cfg_filename)
   
   // create runtime data
   pRuntime = new BPRuntimeData (bpconfig);
+  dcp::shmQueueLockWaitHistogram = &pRuntime->metrics.histogram (dcp::shmQueueLockWaitMetricName);
   BOOST_LOG_SEV(log_main, trivial::info) << "Own node identifier (MAC address): " << pRuntime->ownNodeIdentifier;
   
   // install signal handlers
@@ -74,12 +77,17 @@ void run_bp_demon (const std::string cfg_filename)
   std::signal(SIGINT, signalHandler);
   std::signal(SIGABRT, signalHandler);
   
+  // shared memory areas towards client protocols are only created
+  // when they register, memory locking covers them as well
+  const dcp::RealtimeConfigurationBlock& rtconf = pRuntime->bp_config.realtime_conf;
+  apply_process_realtime_settings (rtconf, log_main);
+  
   // start threads
   BOOST_LOG_SEV(log_main, trivial::info) << "Starting threads.";
-  std::thread thread_mgmt_command (management_thread_command, std::ref(*pRuntime));
-  std::thread thread_mgmt_payload (management_thread_payload, std::ref(*pRuntime));
-  std::thread thread_tx (transmitter_thread, std::ref(*pRuntime));
-  std::thread thread_rx (receiver_thread, std::ref(*pRuntime));
+  std::thread thread_mgmt_command = start_thread (rtconf, "managementCommand", log_main, management_thread_command, *pRuntime);
+  std::thread thread_mgmt_payload = start_thread (rtconf, "managementPayload", log_main, management_thread_payload, *pRuntime);
+  std::thread thread_tx = start_thread (rtconf, "transmitter", log_main, transmitter_thread, *pRuntime);
+  std::thread thread_rx = start_thread (rtconf, "receiver", log_main, receiver_thread, *pRuntime);
 
   
   // and wait for their end
@@ -4,16 +4,20 @@
 #include <csignal>
 #include <signal.h>
 #include <thread>
+#include <vector>
 #include <chrono>
 #include <boost/program_options.hpp>
 #include <dcp/common/debug_helpers.h>
 #include <dcp/common/global_types_constants.h>
+#include <dcp/common/metrics.h>
 #include <dcp/common/other_helpers.h>
+#include <dcp/common/realtime.h>
 #include <dcp/common/services_status.h>
 #include <dcp/common/sharedmem_configuration.h>
 #include <dcp/bp/bp_queueing_mode.h>
 #include <dcp/bp/bpclient_lib.h>
 #include <dcp/srp/srp_configuration.h>
+#include <dcp/srp/srp_event_loop.h>
 #include <dcp/srp/srp_logging.h>
 #include <dcp/srp/srp_receiver.h>
 #include <dcp/srp/srp_runtime_data.h>
@@ -31,7 +35,6 @@ using std::cout;
 using std::endl;
 using std::exception;
 using std::size_t;
-using dcp::bp::BPStaticClientInfo;
 
 using namespace std::chrono_literals;
 
@@ -39,15 +42,6 @@ namespace po = boost::program_options;
 
 using namespace dcp::srp;
 
-std::string get_protocol_name ()
-{
-  char buf [500] = "State Reporting Protocol ";
-
-  return std::string(std::string(buf) + dcp::dcpVersionNumber);
-}
-
-
-
 void print_version ()
 {
   cout << dcp::dcpHighlevelDescription
@@ -75,17 +69,9 @@ int run_srp_demon (const std::string cfg_filename)
   BOOST_LOG_SEV(log_main, trivial::info) << "Demon mode with config file " << cfg_filename;
   BOOST_LOG_SEV(log_main, trivial::info) << "Configuration: " << srpconfig;
 
-  BPStaticClientInfo client_info;
-  client_info.protocolId      =  dcp::BP_PROTID_SRP;
-  std::strncpy (client_info.protocolName, get_protocol_name().c_str(), dcp::bp::maximumProtocolNameLength);
-  client_info.maxPayloadSize         =  sizeof(ExtendedSafetyDataT);
-  client_info.queueingMode           =  dcp::bp::BP_QMODE_ONCE;
-  client_info.maxEntries             =  0;
-  client_info.allowMultiplePayloads  =  false;
-
-  
   try {
-    srp_rt_ptr = new SRPRuntimeData (client_info, srpconfig);
+    srp_rt_ptr = new SRPRuntimeData (get_bp_client_info (), srpconfig);
+    dcp::shmQueueLockWaitHistogram = &srp_rt_ptr->metrics.histogram (dcp::shmQueueLockWaitMetricName);
 
     BOOST_LOG_SEV(log_main, trivial::info) << "BP registration successful, ownNodeIdentifier = " << srp_rt_ptr->get_own_node_identifier();
 
@@ -95,17 +81,26 @@ int run_srp_demon (const std::string cfg_filename)
     std::signal(SIGINT, signalHandler);
     std::signal(SIGABRT, signalHandler);
 
+    const dcp::RealtimeConfigurationBlock& rtconf = srp_rt_ptr->srp_config.realtime_conf;
+    apply_process_realtime_settings (rtconf, log_main);
+
     BOOST_LOG_SEV(log_main, trivial::info) << "Starting threads.";    
-    std::thread thread_rx (receiver_thread, std::ref(*srp_rt_ptr));
-    std::thread thread_tx (transmitter_thread, std::ref(*srp_rt_ptr));
-    std::thread thread_scrub (scrubber_thread, std::ref(*srp_rt_ptr));
+    std::vector<std::thread> threads;
+    threads.push_back (start_thread (rtconf, "receiver", log_main, receiver_thread, *srp_rt_ptr));
+    if (srpconfig.srp_conf.srpUseEventLoop)
+      threads.push_back (start_thread (rtconf, "eventLoop", log_main, event_loop_thread, *srp_rt_ptr));
+    else
+      {
+	threads.push_back (start_thread (rtconf, "transmitter", log_main, transmitter_thread, *srp_rt_ptr));
+	threads.push_back (start_thread (rtconf, "scrubber", log_main, scrubber_thread, *srp_rt_ptr));
+      }
     
     // and wait for their end
     BOOST_LOG_SEV (log_main, trivial::info) << "Running ...";
-    thread_rx.join ();
-    thread_tx.join ();
-    thread_scrub.join ();
+    for (auto& th : threads)
+      th.join ();
 
+    dcp::shmQueueLockWaitHistogram = nullptr;
     delete srp_rt_ptr;
     srp_rt_ptr = nullptr;
 
@@ -119,6 +114,7 @@ int run_srp_demon (const std::string cfg_filename)
     {
       BOOST_LOG_SEV(log_main, trivial::fatal) << "Caught an exception, got " << e.what() << ". Exiting.";
 
+      dcp::shmQueueLockWaitHistogram = nullptr;
       if (srp_rt_ptr)
 	delete srp_rt_ptr;
 
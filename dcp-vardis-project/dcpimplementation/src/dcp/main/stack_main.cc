@@ -0,0 +1,331 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <exception>
+#include <csignal>
+#include <signal.h>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/program_options.hpp>
+#include <dcp/common/exceptions.h>
+#include <dcp/common/global_types_constants.h>
+#include <dcp/common/logging_helpers.h>
+#include <dcp/common/metrics.h>
+#include <dcp/common/other_helpers.h>
+#include <dcp/common/realtime.h>
+#include <dcp/common/services_status.h>
+#include <dcp/bp/bp_configuration.h>
+#include <dcp/bp/bp_logging.h>
+#include <dcp/bp/bp_management_command.h>
+#include <dcp/bp/bp_management_payload.h>
+#include <dcp/bp/bp_receiver.h>
+#include <dcp/bp/bp_runtime_data.h>
+#include <dcp/bp/bp_transmitter.h>
+#include <dcp/srp/srp_configuration.h>
+#include <dcp/srp/srp_event_loop.h>
+#include <dcp/srp/srp_logging.h>
+#include <dcp/srp/srp_receiver.h>
+#include <dcp/srp/srp_runtime_data.h>
+#include <dcp/srp/srp_scrubber.h>
+#include <dcp/srp/srp_transmissible_types.h>
+#include <dcp/srp/srp_transmitter.h>
+#include <dcp/vardis/vardis_configuration.h>
+#include <dcp/vardis/vardis_event_loop.h>
+#include <dcp/vardis/vardis_logging.h>
+#include <dcp/vardis/vardis_management_command.h>
+#include <dcp/vardis/vardis_management_rtdb.h>
+#include <dcp/vardis/vardis_receiver.h>
+#include <dcp/vardis/vardis_runtime_data.h>
+#include <dcp/vardis/vardis_scrubber.h>
+#include <dcp/vardis/vardis_snapshot.h>
+#include <dcp/vardis/vardis_transmitter.h>
+
+
+/**
+ * @brief Runs BP, SRP and Vardis as one process (for small embedded
+ *        boards), instead of the three demons dcpmain-bp,
+ *        dcpmain-srp and dcpmain-vardis.
+ *
+ * Each protocol is configured by its usual configuration file and
+ * runs its usual threads. SRP and Vardis register with BP by direct
+ * function calls, and their BP control segments live in process
+ * memory instead of shared memory areas, so no BP client shared
+ * memory segments are created for them. Everything that external
+ * clients and applications see stays the same: the BP, SRP and
+ * Vardis command sockets, the SRP store and Vardis variable store
+ * shared memory areas, and registration of further (external) BP
+ * client protocols.
+ *
+ * Logging uses the logging section of the BP configuration file for
+ * all three protocols. SRP and Vardis are optional, at least one of
+ * them should be given.
+ */
+
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using dcp::DcpException;
+
+namespace po = boost::program_options;
+namespace logging = boost::log;
+namespace trivial = boost::log::trivial;
+
+
+void print_version ()
+{
+  cout << dcp::dcpHighlevelDescription
+       << " -- BP, SRP and Vardis in one process -- Version " << dcp::dcpVersionNumber
+       << endl;
+}
+
+
+dcp::bp::BPRuntimeData*          bp_rt_ptr     = nullptr;
+dcp::srp::SRPRuntimeData*        srp_rt_ptr    = nullptr;
+dcp::vardis::VardisRuntimeData*  vd_rt_ptr     = nullptr;
+bool                             stackExitFlag = false;
+
+
+void signalHandler (int signum)
+{
+  BOOST_LOG_SEV(dcp::bp::log_main, trivial::info) << "Caught signal code " << signum << " (" << strsignal(signum) << ")";
+  BOOST_LOG_SEV(dcp::bp::log_main, trivial::info) << "Setting exit flag.";
+  stackExitFlag = true;
+}
+
+
+/**
+ * @brief Returns true when any of the protocols wants to exit (due
+ *        to a signal, a shutdown command or a fatal error), the
+ *        whole stack is then stopped
+ */
+bool any_exit_flag ()
+{
+  return    stackExitFlag
+         or (bp_rt_ptr and bp_rt_ptr->bp_exitFlag)
+         or (srp_rt_ptr and srp_rt_ptr->srp_exitFlag)
+         or (vd_rt_ptr and vd_rt_ptr->vardis_exitFlag);
+}
+
+
+void set_all_exit_flags ()
+{
+  stackExitFlag = true;
+  if (bp_rt_ptr)  bp_rt_ptr->bp_exitFlag       = true;
+  if (srp_rt_ptr) srp_rt_ptr->srp_exitFlag     = true;
+  if (vd_rt_ptr)  vd_rt_ptr->vardis_exitFlag   = true;
+}
+
+
+/**
+ * @brief Initializes logging for all protocols from one logging
+ *        configuration block. The per-protocol initialize_logging()
+ *        functions each set a filter for their own channels only.
+ */
+void initialize_stack_logging (const dcp::LoggingConfigurationBlock& logcfg)
+{
+  dcp::initialize_file_logging (logcfg);
+  logging::core::get()->set_filter (trivial::severity >= dcp::minimumSeverityLevel);
+}
+
+
+int run_stack (const std::string& bp_cfg_filename,
+	       const std::string& srp_cfg_filename,
+	       const std::string& vardis_cfg_filename)
+{
+  // read all configurations first, so that errors show up before
+  // anything is started
+  dcp::bp::BPConfiguration bpconfig;
+  bpconfig.read_from_config_file (bp_cfg_filename);
+  dcp::srp::SRPConfiguration srpconfig;
+  if (not srp_cfg_filename.empty())
+    srpconfig.read_from_config_file (srp_cfg_filename);
+  dcp::vardis::VardisConfiguration vdconfig;
+  if (not vardis_cfg_filename.empty())
+    vdconfig.read_from_config_file (vardis_cfg_filename);
+
+  initialize_stack_logging (bpconfig.logging_conf);
+  BOOST_LOG_SEV(dcp::bp::log_main, trivial::info) << "Stack mode with config files " << bp_cfg_filename
+						  << ", " << srp_cfg_filename << ", " << vardis_cfg_filename;
+  BOOST_LOG_SEV(dcp::bp::log_main, trivial::info) << "BP configuration: " << bpconfig;
+  BOOST_LOG_SEV(dcp::bp::log_main, trivial::info) << "uid = " << getuid() << ", euid = " << geteuid();
+
+  std::vector<std::thread> bp_threads;
+  std::vector<std::thread> client_threads;
+  int                      retval = EXIT_SUCCESS;
+
+  try {
+    bp_rt_ptr = new dcp::bp::BPRuntimeData (bpconfig);
+    dcp::bp::BPRuntimeRegistrar registrar (*bp_rt_ptr);
+
+    // one lock wait histogram for the queues of all three protocols,
+    // in the metrics area of BP, which lives longest
+    dcp::shmQueueLockWaitHistogram = &bp_rt_ptr->metrics.histogram (dcp::shmQueueLockWaitMetricName);
+    BOOST_LOG_SEV(dcp::bp::log_main, trivial::info) << "Own node identifier (MAC address): " << bp_rt_ptr->ownNodeIdentifier;
+
+    std::signal(SIGTERM, signalHandler);
+    std::signal(SIGINT, signalHandler);
+    std::signal(SIGABRT, signalHandler);
+
+    BOOST_LOG_SEV(dcp::bp::log_main, trivial::info) << "Starting BP threads.";
+    const dcp::RealtimeConfigurationBlock& bp_rtconf = bp_rt_ptr->bp_config.realtime_conf;
+    bp_threads.push_back (dcp::start_thread (bp_rtconf, "managementCommand", dcp::bp::log_main, dcp::bp::management_thread_command, *bp_rt_ptr));
+    bp_threads.push_back (dcp::start_thread (bp_rtconf, "managementPayload", dcp::bp::log_main, dcp::bp::management_thread_payload, *bp_rt_ptr));
+    bp_threads.push_back (dcp::start_thread (bp_rtconf, "transmitter", dcp::bp::log_main, dcp::bp::transmitter_thread, *bp_rt_ptr));
+    bp_threads.push_back (dcp::start_thread (bp_rtconf, "receiver", dcp::bp::log_main, dcp::bp::receiver_thread, *bp_rt_ptr));
+
+    try {
+      if (not srp_cfg_filename.empty())
+	{
+	  BOOST_LOG_SEV(dcp::bp::log_main, trivial::info) << "SRP configuration: " << srpconfig;
+	  srp_rt_ptr = new dcp::srp::SRPRuntimeData (dcp::srp::get_bp_client_info (), srpconfig, &registrar);
+	  const dcp::RealtimeConfigurationBlock& srp_rtconf = srp_rt_ptr->srp_config.realtime_conf;
+	  client_threads.push_back (dcp::start_thread (srp_rtconf, "receiver", dcp::srp::log_main, dcp::srp::receiver_thread, *srp_rt_ptr));
+	  if (srpconfig.srp_conf.srpUseEventLoop)
+	    client_threads.push_back (dcp::start_thread (srp_rtconf, "eventLoop", dcp::srp::log_main, dcp::srp::event_loop_thread, *srp_rt_ptr));
+	  else
+	    {
+	      client_threads.push_back (dcp::start_thread (srp_rtconf, "transmitter", dcp::srp::log_main, dcp::srp::transmitter_thread, *srp_rt_ptr));
+	      client_threads.push_back (dcp::start_thread (srp_rtconf, "scrubber", dcp::srp::log_main, dcp::srp::scrubber_thread, *srp_rt_ptr));
+	    }
+	}
+
+      if (not vardis_cfg_filename.empty())
+	{
+	  BOOST_LOG_SEV(dcp::bp::log_main, trivial::info) << "Vardis configuration: " << vdconfig;
+	  vd_rt_ptr = new dcp::vardis::VardisRuntimeData (dcp::vardis::get_bp_client_info (vdconfig), vdconfig, &registrar);
+	  dcp::vardis::restore_store_snapshot (*vd_rt_ptr);
+	  const dcp::RealtimeConfigurationBlock& vd_rtconf = vd_rt_ptr->vardis_config.vardis_realtime_conf;
+	  client_threads.push_back (dcp::start_thread (vd_rtconf, "receiver", dcp::vardis::log_main, dcp::vardis::receiver_thread, *vd_rt_ptr));
+	  client_threads.push_back (dcp::start_thread (vd_rtconf, "managementCommand", dcp::vardis::log_main, dcp::vardis::management_thread_command, *vd_rt_ptr));
+	  if (vdconfig.vardis_conf.useEventLoop)
+	    client_threads.push_back (dcp::start_thread (vd_rtconf, "eventLoop", dcp::vardis::log_main, dcp::vardis::event_loop_thread, *vd_rt_ptr));
+	  else
+	    {
+	      client_threads.push_back (dcp::start_thread (vd_rtconf, "transmitter", dcp::vardis::log_main, dcp::vardis::transmitter_thread, *vd_rt_ptr));
+	      client_threads.push_back (dcp::start_thread (vd_rtconf, "managementRTDB", dcp::vardis::log_main, dcp::vardis::management_thread_rtdb, *vd_rt_ptr));
+	      client_threads.push_back (dcp::start_thread (vd_rtconf, "scrubber", dcp::vardis::log_main, dcp::vardis::scrubbing_thread, *vd_rt_ptr));
+	      if (not vdconfig.vardis_conf.snapshotFile.empty())
+		client_threads.push_back (dcp::start_thread (vd_rtconf, "snapshot", dcp::vardis::log_main, dcp::vardis::snapshot_thread, *vd_rt_ptr));
+	    }
+	}
+
+      // memory locking and pre-faulting are process-wide, they are
+      // taken from the BP configuration once all areas exist
+      dcp::apply_process_realtime_settings (bp_rtconf, dcp::bp::log_main);
+
+      BOOST_LOG_SEV(dcp::bp::log_main, trivial::info) << "Running ...";
+      while (not any_exit_flag ())
+	std::this_thread::sleep_for (std::chrono::milliseconds (100));
+    }
+    catch (std::exception& e)
+      {
+	BOOST_LOG_SEV(dcp::bp::log_main, trivial::fatal) << "Caught an exception, got " << e.what() << ". Exiting.";
+	retval = EXIT_FAILURE;
+      }
+
+    // stop the client protocols first, they deregister with BP in
+    // their destructors
+    set_all_exit_flags ();
+    for (auto& th : client_threads)
+      th.join ();
+    delete vd_rt_ptr;
+    vd_rt_ptr = nullptr;
+    delete srp_rt_ptr;
+    srp_rt_ptr = nullptr;
+
+    for (auto& th : bp_threads)
+      th.join ();
+    dcp::shmQueueLockWaitHistogram = nullptr;
+    delete bp_rt_ptr;
+    bp_rt_ptr = nullptr;
+  }
+  catch (std::exception& e)
+    {
+      BOOST_LOG_SEV(dcp::bp::log_main, trivial::fatal) << "Caught an exception, got " << e.what() << ". Exiting.";
+      set_all_exit_flags ();
+      for (auto& th : bp_threads)
+	th.join ();
+      return EXIT_FAILURE;
+    }
+
+  BOOST_LOG_SEV(dcp::bp::log_main, trivial::info) << "Exiting.";
+  return retval;
+}
+
+
+int main (int argc, char* argv[])
+{
+  std::string bp_cfg_filename;
+  std::string srp_cfg_filename;
+  std::string vardis_cfg_filename;
+
+  po::options_description desc("Allowed options");
+  desc.add_options()
+    ("help,h",     "produce help message and exit")
+    ("version,v",  "show version information and exit")
+    ("bp,b",       po::value<std::string>(&bp_cfg_filename), "run the stack, with the given BP config file (required)")
+    ("srp,s",      po::value<std::string>(&srp_cfg_filename), "run SRP within the stack, with the given SRP config file")
+    ("vardis,d",   po::value<std::string>(&vardis_cfg_filename), "run Vardis within the stack, with the given Vardis config file")
+    ;
+
+  try {
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help"))     { cout << desc << endl; return EXIT_SUCCESS; }
+    if (vm.count("version"))  { print_version(); return EXIT_SUCCESS; }
+
+    if (vm.count("bp"))
+      {
+	if (srp_cfg_filename.empty() and vardis_cfg_filename.empty())
+	  cerr << "Neither SRP nor Vardis given, running BP only." << endl;
+	cout << "Running DCP stack ..." << endl;
+	return run_stack (bp_cfg_filename, srp_cfg_filename, vardis_cfg_filename);
+      }
+
+    cerr << "No valid option given." << endl;
+    cerr << desc << endl;
+    return EXIT_FAILURE;
+  }
+  catch (DcpException& e)
+    {
+      print_exiting_dcp_exception (e);
+      return EXIT_FAILURE;
+    }
+  catch (std::exception& e) {
+    cerr << e.what() << endl;
+    cerr << desc << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -7,18 +7,23 @@
 #include <sys/types.h>
 #include <thread>
 #include <list>
+#include <vector>
 #include <boost/program_options.hpp>
 #include <dcp/common/global_types_constants.h>
+#include <dcp/common/metrics.h>
 #include <dcp/common/other_helpers.h>
+#include <dcp/common/realtime.h>
 #include <dcp/common/services_status.h>
 #include <dcp/bp/bpclient_lib.h>
 #include <dcp/vardis/vardis_configuration.h>
+#include <dcp/vardis/vardis_event_loop.h>
 #include <dcp/vardis/vardis_logging.h>
 #include <dcp/vardis/vardis_management_command.h>
 #include <dcp/vardis/vardis_management_rtdb.h>
 #include <dcp/vardis/vardis_receiver.h>
 #include <dcp/vardis/vardis_runtime_data.h>
 #include <dcp/vardis/vardis_scrubber.h>
+#include <dcp/vardis/vardis_snapshot.h>
 #include <dcp/vardis/vardis_transmitter.h>
 #include <dcp/vardis/vardisclient_lib.h>
 
@@ -32,7 +37,6 @@ using dcp::DcpException;
 using dcp::VardisClientRuntime;
 using dcp::VardisClientConfiguration;
 using dcp::vardis_status_to_string;
-using dcp::bp::BPStaticClientInfo;
 
 
 namespace po = boost::program_options;
@@ -40,15 +44,6 @@ namespace po = boost::program_options;
 using namespace dcp::vardis;
 
 
-std::string get_protocol_name ()
-{
-  char buf [500] = "Variable Dissemination Protocol ";
-
-  return std::string(std::string(buf) + dcp::dcpVersionNumber);
-}
-
-
-
 void print_version ()
 {
   cout << dcp::dcpHighlevelDescription
@@ -76,41 +71,43 @@ int run_vardis_demon (const std::string cfg_filename)
   BOOST_LOG_SEV(log_main, trivial::info) << "Demon mode with config file " << cfg_filename; 
   BOOST_LOG_SEV(log_main, trivial::info) << "Configuration: " << vdconfig;
 
-  BPStaticClientInfo client_info;
-  client_info.protocolId      =  dcp::BP_PROTID_VARDIS;
-  std::strncpy (client_info.protocolName, get_protocol_name().c_str(), dcp::bp::maximumProtocolNameLength);
-  client_info.maxPayloadSize         =  vdconfig.vardis_conf.maxPayloadSize;
-  client_info.queueingMode           =  dcp::bp::BP_QMODE_QUEUE_DROPHEAD;
-  client_info.maxEntries             =  vdconfig.vardis_conf.queueMaxEntries;
-  client_info.allowMultiplePayloads  =  false;
-
-  
   try {
-    vd_rt_ptr = new VardisRuntimeData (client_info, vdconfig);
+    vd_rt_ptr = new VardisRuntimeData (get_bp_client_info (vdconfig), vdconfig);
+    dcp::shmQueueLockWaitHistogram = &vd_rt_ptr->metrics.histogram (dcp::shmQueueLockWaitMetricName);
 
     BOOST_LOG_SEV(log_main, trivial::info) << "BP registration successful, ownNodeIdentifier = " << vd_rt_ptr->get_own_node_identifier();
+    restore_store_snapshot (*vd_rt_ptr);
     
     // install signal handlers
     std::signal(SIGTERM, signalHandler);
     std::signal(SIGINT, signalHandler);
     std::signal(SIGABRT, signalHandler);
     
+    const dcp::RealtimeConfigurationBlock& rtconf = vd_rt_ptr->vardis_config.vardis_realtime_conf;
+    apply_process_realtime_settings (rtconf, log_main);
+    
     // start threads
     BOOST_LOG_SEV(log_main, trivial::info) << "Starting threads.";
-    std::thread thread_rx (receiver_thread, std::ref(*vd_rt_ptr));
-    std::thread thread_tx (transmitter_thread, std::ref(*vd_rt_ptr));
-    std::thread thread_mgmt_command (management_thread_command, std::ref(*vd_rt_ptr));
-    std::thread thread_mgmt_rtdb (management_thread_rtdb, std::ref(*vd_rt_ptr));
-    std::thread thread_scrubbing (scrubbing_thread, std::ref(*vd_rt_ptr));
+    std::vector<std::thread> threads;
+    threads.push_back (start_thread (rtconf, "receiver", log_main, receiver_thread, *vd_rt_ptr));
+    threads.push_back (start_thread (rtconf, "managementCommand", log_main, management_thread_command, *vd_rt_ptr));
+    if (vdconfig.vardis_conf.useEventLoop)
+      threads.push_back (start_thread (rtconf, "eventLoop", log_main, event_loop_thread, *vd_rt_ptr));
+    else
+      {
+	threads.push_back (start_thread (rtconf, "transmitter", log_main, transmitter_thread, *vd_rt_ptr));
+	threads.push_back (start_thread (rtconf, "managementRTDB", log_main, management_thread_rtdb, *vd_rt_ptr));
+	threads.push_back (start_thread (rtconf, "scrubber", log_main, scrubbing_thread, *vd_rt_ptr));
+	if (not vdconfig.vardis_conf.snapshotFile.empty())
+	  threads.push_back (start_thread (rtconf, "snapshot", log_main, snapshot_thread, *vd_rt_ptr));
+      }
     
     // and wait for their end
     BOOST_LOG_SEV (log_main, trivial::info) << "Running ...";
-    thread_rx.join ();
-    thread_tx.join ();
-    thread_mgmt_command.join ();
-    thread_mgmt_rtdb.join ();
-    thread_scrubbing.join ();
+    for (auto& th : threads)
+      th.join ();
 
+    dcp::shmQueueLockWaitHistogram = nullptr;
     delete vd_rt_ptr;
     vd_rt_ptr = nullptr;
 
@@ -124,6 +121,7 @@ int run_vardis_demon (const std::string cfg_filename)
     {
       BOOST_LOG_SEV(log_main, trivial::fatal) << "Caught an exception, got " << e.what() << ". Exiting.";
 
+      dcp::shmQueueLockWaitHistogram = nullptr;
       if (vd_rt_ptr)
 	delete vd_rt_ptr;
 
@@ -164,7 +162,21 @@ int run_vardis_management_command (MgmtCommand cmd, const std::string cfg_filena
 		 << ", summary: " << protocol_stats.count_process_var_summary
 		 << ", reqcreate: " << protocol_stats.count_process_var_reqcreate
 		 << ", requpdate: " << protocol_stats.count_process_var_requpdate
+		 << ", summrange: " << protocol_stats.count_process_var_summrange
+		 << ", reqsummrange: " << protocol_stats.count_process_var_reqsummrange
+		 << ", merklenode: " << protocol_stats.count_process_var_merklenode
+		 << ", reqmerklenode: " << protocol_stats.count_process_var_reqmerklenode
 		 << endl;
+	    for (size_t prio = 0; prio < dcp::vardis::VarPriorityT::number_classes(); prio++)
+	      {
+		unsigned long ntx = protocol_stats.count_update_tx[prio];
+		cout << "    Updates of priority class " << prio
+		     << ": transmitted: " << ntx
+		     << ", coalesced: " << protocol_stats.count_update_coalesced[prio]
+		     << ", avg delay (ms): " << ((ntx > 0) ? ((double) protocol_stats.sum_update_delay_ms[prio] / ntx) : 0.0)
+		     << ", max delay (ms): " << protocol_stats.max_update_delay_ms[prio]
+		     << endl;
+	      }
 	  }
 	break;
       }
@@ -18,6 +18,7 @@
  */
 
 
+#include <cstring>
 #include <exception>
 #include <boost/program_options.hpp>
 #include <dcp/common/logging_helpers.h>
@@ -39,6 +40,17 @@ namespace dcp::srp {
       (opt("keepaliveTimeoutMS").c_str(),   po::value<uint16_t>(&srpKeepaliveTimeoutMS)->default_value(defaultValueSrpKeepaliveTimeoutMS), txt("timeout for generating own payloads (in ms)").c_str())
       (opt("scrubbingTimeoutMS").c_str(),   po::value<uint16_t>(&srpScrubbingTimeoutMS)->default_value(defaultValueSrpScrubbingTimeoutMS), txt("timeout for neighbour entries in the scrubbing process (in ms)").c_str())
       (opt("gapSizeEWMAAlpha").c_str(),     po::value<double>(&srpGapSizeEWMAAlpha)->default_value(defaultValueSrpGapSizeEWMAAlpha), txt("Alpha value for the EWMA estimator for average sequence number gap size").c_str())
+      (opt("spatialGridCellSize").c_str(),  po::value<double>(&srpSpatialGridCellSize)->default_value(defaultValueSrpSpatialGridCellSize), txt("cell size of the spatial index over neighbour positions (in m)").c_str())
+      (opt("positionOriginX").c_str(),      po::value<double>(&srpPositionOriginX)->default_value(defaultValueSrpPositionOrigin), txt("x coordinate of the origin for quantized positions in SRP payloads (in m)").c_str())
+      (opt("positionOriginY").c_str(),      po::value<double>(&srpPositionOriginY)->default_value(defaultValueSrpPositionOrigin), txt("y coordinate of the origin for quantized positions in SRP payloads (in m)").c_str())
+      (opt("positionOriginZ").c_str(),      po::value<double>(&srpPositionOriginZ)->default_value(defaultValueSrpPositionOrigin), txt("z coordinate of the origin for quantized positions in SRP payloads (in m)").c_str())
+      (opt("positionResolution").c_str(),   po::value<double>(&srpPositionResolution)->default_value(defaultValueSrpPositionResolution), txt("quantization step for positions in SRP payloads (in m)").c_str())
+      (opt("deadReckoning").c_str(),        po::value<bool>(&srpDeadReckoning)->default_value(defaultValueSrpDeadReckoning), txt("only transmit when the extrapolated position deviates from the actual one").c_str())
+      (opt("deadReckoningThreshold").c_str(),  po::value<double>(&srpDeadReckoningThreshold)->default_value(defaultValueSrpDeadReckoningThreshold), txt("maximum tolerated extrapolation error with dead reckoning (in m)").c_str())
+      (opt("deadReckoningMaxIntervalMS").c_str(),  po::value<uint16_t>(&srpDeadReckoningMaxIntervalMS)->default_value(defaultValueSrpDeadReckoningMaxIntervalMS), txt("maximum time between transmissions with dead reckoning (in ms)").c_str())
+      (opt("snapshotPeriodMS").c_str(),     po::value<uint16_t>(&srpSnapshotPeriodMS)->default_value(defaultValueSrpSnapshotPeriodMS), txt("minimum time between publications of the neighbour table snapshot (in ms)").c_str())
+      (opt("payloadBudget").c_str(),        po::value<uint16_t>(&srpPayloadBudget)->default_value(defaultValueSrpPayloadBudget), txt("maximum size of own SRP payloads, optional extensions not fitting are left out (in bytes)").c_str())
+      (opt("useEventLoop").c_str(),         po::value<bool>(&srpUseEventLoop)->default_value(defaultValueSrpUseEventLoop), txt("run payload generation and scrubbing as timers of one event loop thread").c_str())
       ;
     
   }
@@ -54,6 +66,13 @@ namespace dcp::srp {
     if (srpScrubbingTimeoutMS <= 0) throw ConfigurationException("SRPConfigurationBlock", "scrubbing timeout (in ms) must be strictly positive");
     if (srpGapSizeEWMAAlpha < 0) throw ConfigurationException("SRPConfigurationBlock", "EWMA alpha value must be non-negative");
     if (srpGapSizeEWMAAlpha > 1) throw ConfigurationException("SRPConfigurationBlock", "EWMA alpha value must not exceed one");
+    if (not (srpSpatialGridCellSize > 0)) throw ConfigurationException("SRPConfigurationBlock", "spatial grid cell size must be strictly positive");
+    if (not (srpPositionResolution > 0)) throw ConfigurationException("SRPConfigurationBlock", "position resolution must be strictly positive");
+    if (srpDeadReckoningThreshold < 0) throw ConfigurationException("SRPConfigurationBlock", "dead reckoning threshold must be non-negative");
+    if (srpDeadReckoningMaxIntervalMS <= 0) throw ConfigurationException("SRPConfigurationBlock", "dead reckoning maximum interval (in ms) must be strictly positive");
+    if (srpDeadReckoning and (srpDeadReckoningMaxIntervalMS >= srpScrubbingTimeoutMS)) throw ConfigurationException("SRPConfigurationBlock", "dead reckoning maximum interval must be smaller than scrubbing timeout");
+    if (srpPayloadBudget < SRPPayloadT::fixed_size()) throw ConfigurationException("SRPConfigurationBlock", "payload budget must not be smaller than the fixed-size part of an SRP payload");
+    if (srpPayloadBudget > SRPPayloadT::max_wire_size()) throw ConfigurationException("SRPConfigurationBlock", "payload budget must not exceed the maximum SRP payload size on the wire");
   }
 
   std::ostream& operator<< (std::ostream& os, const dcp::srp::SRPConfiguration& cfg)
@@ -65,20 +84,58 @@ namespace dcp::srp {
        << " , logAutoFlush = " << cfg.logging_conf.logAutoFlush
        << " , minimumSeverityLevel = " << cfg.logging_conf.minimumSeverityLevel
        << " , rotationSize = " << cfg.logging_conf.rotationSize
+       << " , asyncLogging = " << cfg.logging_conf.asyncLogging
+       << " , asyncBufferSize = " << cfg.logging_conf.asyncBufferSize
+       << " , asyncDrainIntervalMS = " << cfg.logging_conf.asyncDrainIntervalMS
        << " , commandSocketFile[BP] = " << cfg.bp_cmdsock_conf.commandSocketFile
        << " , commandSocketTimeoutMS[BP] = " << cfg.bp_cmdsock_conf.commandSocketTimeoutMS
        << " , shmAreaNameBP = " << cfg.bp_shm_conf.shmAreaName
        << " , shmAreaNameNeighbourStore = " << cfg.shm_conf.shmAreaName
+       << " , shmHugePagesNeighbourStore = " << cfg.shm_conf.shmHugePages
+       << " , shmAreaNameMetrics = " << cfg.metrics_conf.shmAreaName
+       << " , " << cfg.realtime_conf
       
        << " , generationPeriodMS = " << cfg.srp_conf.srpGenerationPeriodMS
        << " , scrubbingPeriodMS = " << cfg.srp_conf.srpScrubbingPeriodMS
        << " , keepaliveTimeoutMS = " << cfg.srp_conf.srpKeepaliveTimeoutMS
        << " , scrubbingTimeoutMS = " << cfg.srp_conf.srpScrubbingTimeoutMS
        << " , gapSizeEWMAAlpha = " << cfg.srp_conf.srpGapSizeEWMAAlpha
+       << " , spatialGridCellSize = " << cfg.srp_conf.srpSpatialGridCellSize
+       << " , positionOriginX = " << cfg.srp_conf.srpPositionOriginX
+       << " , positionOriginY = " << cfg.srp_conf.srpPositionOriginY
+       << " , positionOriginZ = " << cfg.srp_conf.srpPositionOriginZ
+       << " , positionResolution = " << cfg.srp_conf.srpPositionResolution
+       << " , deadReckoning = " << cfg.srp_conf.srpDeadReckoning
+       << " , deadReckoningThreshold = " << cfg.srp_conf.srpDeadReckoningThreshold
+       << " , deadReckoningMaxIntervalMS = " << cfg.srp_conf.srpDeadReckoningMaxIntervalMS
+       << " , snapshotPeriodMS = " << cfg.srp_conf.srpSnapshotPeriodMS
+       << " , payloadBudget = " << cfg.srp_conf.srpPayloadBudget
+       << " , useEventLoop = " << cfg.srp_conf.srpUseEventLoop
        << " }";
     return os;
   }
   
+  // ------------------------------------------------------------------------------
+
+  std::string get_protocol_name ()
+  {
+    return std::string ("State Reporting Protocol ") + dcp::dcpVersionNumber;
+  }
+
+  // ------------------------------------------------------------------------------
+
+  bp::BPStaticClientInfo get_bp_client_info ()
+  {
+    bp::BPStaticClientInfo client_info;
+    client_info.protocolId             =  dcp::BP_PROTID_SRP;
+    std::strncpy (client_info.protocolName, get_protocol_name().c_str(), bp::maximumProtocolNameLength);
+    client_info.maxPayloadSize         =  SRPPayloadT::max_wire_size();
+    client_info.queueingMode           =  bp::BP_QMODE_ONCE;
+    client_info.maxEntries             =  0;
+    client_info.allowMultiplePayloads  =  false;
+    return client_info;
+  }
+  
 };  // namespace dcp::srp
 
 
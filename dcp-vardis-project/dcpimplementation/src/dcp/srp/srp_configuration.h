@@ -21,11 +21,15 @@
 #pragma once
 
 #include <iostream>
+#include <string>
 #include <boost/program_options.hpp>
 #include <dcp/common/command_socket.h>
+#include <dcp/common/realtime.h>
 #include <dcp/common/sharedmem_configuration.h>
+#include <dcp/bp/bp_client_static_info.h>
 #include <dcp/bp/bpclient_configuration.h>
 #include <dcp/srp/srp_constants.h>
+#include <dcp/srp/srp_transmissible_types.h>
 
 namespace po = boost::program_options;
 
@@ -43,6 +47,15 @@ namespace dcp::srp {
   const uint16_t    defaultValueSrpKeepaliveTimeoutMS   = 5000;
   const uint16_t    defaultValueSrpScrubbingTimeoutMS   = 3000;
   const double      defaultValueSrpGapSizeEWMAAlpha     = 0.95;
+  const double      defaultValueSrpSpatialGridCellSize  = 50.0;
+  const double      defaultValueSrpPositionOrigin       = 0.0;
+  const double      defaultValueSrpPositionResolution   = 0.01;
+  const bool        defaultValueSrpDeadReckoning        = false;
+  const double      defaultValueSrpDeadReckoningThreshold  = 1.0;
+  const uint16_t    defaultValueSrpDeadReckoningMaxIntervalMS = 1000;
+  const uint16_t    defaultValueSrpSnapshotPeriodMS     = 10;
+  const uint16_t    defaultValueSrpPayloadBudget        = SRPPayloadT::max_size();
+  const bool        defaultValueSrpUseEventLoop         = false;
   
 
   /**
@@ -63,7 +76,8 @@ namespace dcp::srp {
     
 
     /**
-     * @brief Period between scrubbing runs
+     * @brief Maximum period between scrubbing runs. The scrubber
+     *        wakes up earlier when a neighbour expires before that.
      */
     uint16_t srpScrubbingPeriodMS  = defaultValueSrpScrubbingPeriodMS;
 
@@ -88,6 +102,94 @@ namespace dcp::srp {
      *        for one particular neighbour
      */
     double srpGapSizeEWMAAlpha        = defaultValueSrpGapSizeEWMAAlpha;
+
+
+    /**
+     * @brief Edge length (in metres) of a cell of the spatial index
+     *        over neighbour positions, should be in the order of the
+     *        typical radius of neighbourhood queries
+     */
+    double srpSpatialGridCellSize     = defaultValueSrpSpatialGridCellSize;
+
+
+    /**
+     * @brief Origin of the quantized positions in SRP payloads. Must
+     *        be the same on all nodes
+     */
+    double srpPositionOriginX         = defaultValueSrpPositionOrigin;
+    double srpPositionOriginY         = defaultValueSrpPositionOrigin;
+    double srpPositionOriginZ         = defaultValueSrpPositionOrigin;
+
+
+    /**
+     * @brief Quantization step (in metres) of positions in SRP
+     *        payloads. Must be the same on all nodes
+     */
+    double srpPositionResolution      = defaultValueSrpPositionResolution;
+
+
+    /**
+     * @brief If set, own safety data is only transmitted when the
+     *        position extrapolated from the last transmission (using
+     *        its speed and heading) deviates from the actual position
+     *        by more than srpDeadReckoningThreshold, or when
+     *        srpDeadReckoningMaxIntervalMS have passed since the last
+     *        transmission
+     */
+    bool srpDeadReckoning             = defaultValueSrpDeadReckoning;
+
+
+    /**
+     * @brief Maximum tolerated extrapolation error (in m) before a
+     *        new transmission is triggered, with dead reckoning
+     */
+    double srpDeadReckoningThreshold  = defaultValueSrpDeadReckoningThreshold;
+
+
+    /**
+     * @brief Maximum time between transmissions with dead reckoning
+     *        (in ms), must be below the scrubbing timeout
+     */
+    uint16_t srpDeadReckoningMaxIntervalMS = defaultValueSrpDeadReckoningMaxIntervalMS;
+
+
+    /**
+     * @brief Minimum time between publications of the neighbour table
+     *        snapshot read by clients (in ms). Changes are published
+     *        by the receiver at most this often, and by the scrubber
+     *        at the latest after one scrubbing period. Zero publishes
+     *        after every change.
+     */
+    uint16_t srpSnapshotPeriodMS      = defaultValueSrpSnapshotPeriodMS;
+
+
+    /**
+     * @brief Maximum size (in bytes) of own SRP payloads. Optional
+     *        extensions that do not fit are left out, the
+     *        fixed-size part is always included
+     */
+    uint16_t srpPayloadBudget         = defaultValueSrpPayloadBudget;
+
+
+    /**
+     * @brief Run payload generation and scrubbing as timers of one
+     *        event loop thread instead of one sleeping thread each
+     */
+    bool srpUseEventLoop              = defaultValueSrpUseEventLoop;
+
+
+    /**
+     * @brief Returns the quantization parameters for SRP payloads
+     */
+    inline SRPQuantizationParameters get_quantization_parameters () const
+    {
+      SRPQuantizationParameters qp;
+      qp.origin_x    = srpPositionOriginX;
+      qp.origin_y    = srpPositionOriginY;
+      qp.origin_z    = srpPositionOriginZ;
+      qp.resolution  = srpPositionResolution;
+      return qp;
+    };
     
     /**
      * @brief Constructors, mainly for setting section names in the
@@ -122,6 +224,8 @@ namespace dcp::srp {
     LoggingConfigurationBlock         logging_conf; /*!< Logging configuration */
     SRPConfigurationBlock             srp_conf;     /*!< Actual SRP configuration data */
     SharedMemoryConfigurationBlock    shm_conf;     /*!< Shared memory configuration for neighbour store */
+    SharedMemoryConfigurationBlock    metrics_conf; /*!< Shared memory configuration for metrics area */
+    RealtimeConfigurationBlock        realtime_conf; /*!< Scheduling and memory locking settings */
 
 
     /**
@@ -132,7 +236,9 @@ namespace dcp::srp {
       : BPClientConfiguration ("BPCommandSocket", "BPSharedMem"),
 	logging_conf (),
 	srp_conf (),
-	shm_conf ("SRPStoreShm", defaultSRPStoreShmName)
+	shm_conf ("SRPStoreShm", defaultSRPStoreShmName),
+	metrics_conf ("SRPMetricsShm", defaultSRPMetricsShmName),
+	realtime_conf ("SRPRealtime", {"receiver", "transmitter", "scrubber", "eventLoop"})
     {
     };
 
@@ -147,6 +253,8 @@ namespace dcp::srp {
       logging_conf.add_options (cfgdesc);
       srp_conf.add_options (cfgdesc);
       shm_conf.add_options (cfgdesc, defaultSRPStoreShmName);
+      metrics_conf.add_options (cfgdesc, defaultSRPMetricsShmName);
+      realtime_conf.add_options (cfgdesc);
     };
 
 
@@ -159,10 +267,25 @@ namespace dcp::srp {
       logging_conf.validate();
       srp_conf.validate();
       shm_conf.validate();
+      metrics_conf.validate();
+      realtime_conf.validate();
     };
     
     friend std::ostream& operator<<(std::ostream& os, const dcp::srp::SRPConfiguration& cfg);
     
   } SRPConfiguration;
+
+
+  /**
+   * @brief Returns the protocol name of SRP, including the version
+   */
+  std::string get_protocol_name ();
+
+
+  /**
+   * @brief Returns the static client information with which SRP
+   *        registers with BP
+   */
+  bp::BPStaticClientInfo get_bp_client_info ();
   
 };  // namespace dcp::srp
@@ -30,5 +30,6 @@
 namespace dcp::srp {
 
   const std::string   defaultSRPStoreShmName   = "shm-area-srp-store";
+  const std::string   defaultSRPMetricsShmName = "shm-area-srp-metrics";
   
 };  // namespace dcp::srp
@@ -0,0 +1,169 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <dcp/common/global_types_constants.h>
+#include <dcp/srp/srp_transmissible_types.h>
+
+
+/**
+ * @brief This module provides the closest-point-of-approach (CPA)
+ *        computation of SRP over the kinematic state of all
+ *        neighbours.
+ *
+ * The kinematic state is kept in a structure-of-arrays layout indexed
+ * by neighbour slot, so that the CPA kernel is a single loop over
+ * contiguous arrays of doubles without data-dependent branches,
+ * which the compiler can auto-vectorize (SSE/AVX2/NEON, depending on
+ * the target flags). Like the other fixed-memory structures it
+ * contains no pointers and can be placed into shared memory.
+ *
+ * The motion model matches the SRP dead reckoning: constant
+ * horizontal velocity, constant altitude.
+ */
+
+
+namespace dcp::srp {
+
+
+  /**
+   * @brief Converts a timestamp into seconds since the clock epoch,
+   *        as used for the reference times in CPAKinematics
+   */
+  inline double timestamp_to_seconds (const TimeStampT& ts)
+  {
+    return std::chrono::duration<double> (ts.tStamp.time_since_epoch()).count();
+  }
+
+
+  /**
+   * @brief Kinematic state of all neighbour slots in
+   *        structure-of-arrays layout
+   *
+   * @tparam numSlots: number of neighbour slots
+   *
+   * Unused slots are marked by an infinite distance penalty rather
+   * than a flag, so that the kernel needs no conditional selects or
+   * divisions, which the compiler refuses to if-convert (and hence
+   * to vectorize) under the default -ftrapping-math.
+   */
+  template <uint64_t numSlots>
+  class CPAKinematics {
+  public:
+    double  x      [numSlots];   /*!< Reported position */
+    double  y      [numSlots];
+    double  z      [numSlots];
+    double  vx     [numSlots];   /*!< Horizontal velocity, in m/s */
+    double  vy     [numSlots];
+    double  t_ref  [numSlots];   /*!< Time of the reported position, see timestamp_to_seconds */
+    double  unused [numSlots];   /*!< 0 if the slot holds a neighbour, infinity otherwise */
+
+    CPAKinematics ()
+    {
+      std::fill_n (x, numSlots, 0.0);
+      std::fill_n (y, numSlots, 0.0);
+      std::fill_n (z, numSlots, 0.0);
+      std::fill_n (vx, numSlots, 0.0);
+      std::fill_n (vy, numSlots, 0.0);
+      std::fill_n (t_ref, numSlots, 0.0);
+      std::fill_n (unused, numSlots, std::numeric_limits<double>::infinity());
+    };
+
+
+    /**
+     * @brief Stores the kinematic state of the given slot from the
+     *        given ExtendedSafetyDataT record
+     */
+    inline void update (uint64_t slot, const ExtendedSafetyDataT& esd)
+    {
+      const SafetyDataT& sd = esd.safetyData;
+      double hdg   = sd.heading * M_PI / 180.0;
+      double speed = sd.has_velocity ? sd.speed : 0.0;
+      x[slot]      = sd.position_x;
+      y[slot]      = sd.position_y;
+      z[slot]      = sd.position_z;
+      vx[slot]     = speed * std::sin (hdg);
+      vy[slot]     = speed * std::cos (hdg);
+      t_ref[slot]  = timestamp_to_seconds (esd.timeStamp);
+      unused[slot] = 0.0;
+    };
+
+
+    /**
+     * @brief Marks the given slot as unused
+     */
+    inline void remove (uint64_t slot) { unused[slot] = std::numeric_limits<double>::infinity(); };
+
+
+    /**
+     * @brief Computes time and squared distance of closest approach
+     *        of every slot relative to the own node
+     *
+     * @param own: own safety data, already extrapolated to time now
+     * @param now: current time, see timestamp_to_seconds
+     * @param horizon: look-ahead time in seconds. Times of closest
+     *        approach are clamped to [0, horizon]
+     * @param tcpa: output array of numSlots elements, time of
+     *        closest approach from now (in s)
+     * @param d2cpa: output array of numSlots elements, squared
+     *        distance at closest approach, infinity for unused slots
+     */
+    void compute (const SafetyDataT& own,
+		  double now,
+		  double horizon,
+		  double* __restrict tcpa,
+		  double* __restrict d2cpa) const
+    {
+      const double hdg  = own.heading * M_PI / 180.0;
+      const double ospd = own.has_velocity ? own.speed : 0.0;
+      const double ovx  = ospd * std::sin (hdg);
+      const double ovy  = ospd * std::cos (hdg);
+      const double ox   = own.position_x;
+      const double oy   = own.position_y;
+      const double oz   = own.position_z;
+
+      for (uint64_t i = 0; i < numSlots; i++)
+	{
+	  double dt  = now - t_ref[i];
+	  double px  = x[i] + vx[i] * dt - ox;
+	  double py  = y[i] + vy[i] * dt - oy;
+	  double pz  = z[i] - oz;
+	  double rvx = vx[i] - ovx;
+	  double rvy = vy[i] - ovy;
+	  double vv  = rvx * rvx + rvy * rvy;
+	  double pv  = px * rvx + py * rvy;
+	  double t   = std::min (std::max (-pv / (vv + 1e-12), 0.0), horizon);
+	  double cx  = px + rvx * t;
+	  double cy  = py + rvy * t;
+	  double d2  = cx * cx + cy * cy + pz * pz;
+	  tcpa[i]    = t;
+	  d2cpa[i]   = d2 + unused[i];
+	}
+    };
+  };
+
+  
+};  // namespace dcp::srp
@@ -0,0 +1,81 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+
+#include <algorithm>
+#include <dcp/common/event_loop.h>
+#include <dcp/srp/srp_event_loop.h>
+#include <dcp/srp/srp_logging.h>
+#include <dcp/srp/srp_scrubber.h>
+#include <dcp/srp/srp_transmitter.h>
+
+
+namespace dcp::srp {
+
+  // -----------------------------------------------------------------
+  
+  void event_loop_thread (SRPRuntimeData& runtime)
+  {
+    DCPLOG_INFO(log_main) << "Starting event loop thread.";
+
+    const SRPConfigurationBlock& conf = runtime.srp_config.srp_conf;
+    DeadReckoningFilter  dr_filter (conf.srpDeadReckoningThreshold, conf.srpDeadReckoningMaxIntervalMS);
+    
+    try {
+      EventLoop loop;
+      loop.set_wakeup_latency_histogram (&runtime.metricEventLoopWakeupLatency);
+
+      loop.add_periodic_timer (conf.srpGenerationPeriodMS, [&] ()
+      {
+	transmit_payload (runtime, dr_filter);
+      });
+
+      // the scrubber determines its next run itself, a zero delay
+      // would remove the timer
+      loop.add_timer (conf.srpScrubbingPeriodMS, [&] ()
+      {
+	return std::max<uint32_t> (1, scrub_neighbours (runtime));
+      });
+
+      loop.run (runtime.srp_exitFlag);
+    }
+    catch (DcpException& e)
+      {
+	DCPLOG_FATAL(log_main)
+	  << "Caught DCP exception in SRP event loop. "
+	  << "Exception type: " << e.ename()
+	  << ", module: " << e.modname()
+	  << ", message: " << e.what()
+	  << ". Exiting.";
+	runtime.srp_exitFlag = true;
+      }
+    catch (std::exception& e)
+      {
+	DCPLOG_FATAL(log_main)
+	  << "Caught other exception in SRP event loop. "
+	  << "Message: " << e.what()
+	  << ". Exiting.";
+	runtime.srp_exitFlag = true;
+      }
+    
+    DCPLOG_INFO(log_main) << "Exiting event loop thread.";
+  }
+  
+};  // namespace dcp::srp
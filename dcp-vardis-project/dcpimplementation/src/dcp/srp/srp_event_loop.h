@@ -0,0 +1,36 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+
+#pragma once
+
+#include <dcp/srp/srp_runtime_data.h>
+
+namespace dcp::srp {
+
+  /**
+   * @brief Runs payload generation and scrubbing as timers of one
+   *        event loop, until exitFlag is set. Replaces
+   *        transmitter_thread and scrubber_thread when useEventLoop
+   *        is configured.
+   */
+  void event_loop_thread (SRPRuntimeData& runtime);
+  
+};  // namespace dcp::srp
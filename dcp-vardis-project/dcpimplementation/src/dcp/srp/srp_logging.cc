@@ -57,7 +57,7 @@ namespace dcp::srp {
   
   void initialize_logging(const LoggingConfigurationBlock& logcfg)
   {
-    initialize_file_logging (logcfg);
+    initialize_file_logging (logcfg, &log_main);
     
     logging::core::get()->set_filter
       (
@@ -20,6 +20,7 @@
 
 #include <queue>
 #include <thread>
+#include <vector>
 #include <chrono>
 #include <dcp/common/area.h>
 #include <dcp/common/services_status.h>
@@ -32,7 +33,11 @@
 
 namespace dcp::srp {
 
-  static const uint16_t rx_buffer_length = 1000;
+  /**
+   * Maximum number of payloads retrieved from BP and applied to the
+   * neighbour table in one go
+   */
+  static const size_t rx_batch_size = 32;
   
   // -----------------------------------------------------------------
   
@@ -40,6 +45,15 @@ namespace dcp::srp {
   {
     DCPLOG_INFO(log_rx) << "Starting receive thread.";
 
+    const SRPQuantizationParameters qp = runtime.srp_config.srp_conf.get_quantization_parameters ();
+    const uint16_t snapshot_period     = runtime.srp_config.srp_conf.srpSnapshotPeriodMS;
+    const size_t   max_payload_size    = runtime.get_static_client_info().maxPayloadSize.val;
+
+    std::vector<byte>                 rx_buffer (rx_batch_size * max_payload_size);
+    std::vector<BPLengthT>            rx_lengths (rx_batch_size);
+    std::vector<ExtendedSafetyDataT>  batch;
+    batch.reserve (rx_batch_size);
+
     try {
       while (not runtime.srp_exitFlag)
 	{				     
@@ -49,42 +63,85 @@ namespace dcp::srp {
 	      continue;
 	    }
 	  
-	  // check if we have received a payload
-	  BPLengthT result_length = 0;
-	  DcpStatus rx_stat;
-	  byte rx_buffer [rx_buffer_length];
-	  bool more_payloads = false;
-	  
-	  do {
-	    rx_stat = runtime.receive_payload_wait (result_length, rx_buffer, more_payloads, runtime.srp_exitFlag);
-	    
-	    if ((rx_stat == BP_STATUS_OK) and (result_length == sizeof(ExtendedSafetyDataT)))
-	      {
-		DCPLOG_TRACE(log_rx) << "Processing payload of correct length";
-		ExtendedSafetyDataT *pESD = (ExtendedSafetyDataT*) rx_buffer;
-		
-		if (pESD->nodeId == runtime.srp_store.get_own_node_identifier ())
+	  // retrieve a batch of received payloads
+	  size_t    number_received = 0;
+	  bool      more_payloads   = false;
+	  DcpStatus rx_stat         = runtime.receive_payloads_wait (rx_batch_size,
+								     rx_lengths.data(),
+								     rx_buffer.data(),
+								     number_received,
+								     more_payloads,
+								     runtime.srp_exitFlag);
+
+	  if (rx_stat != BP_STATUS_OK)
+	    {
+	      DCPLOG_INFO(log_rx)
+		<< "Retrieving received payloads issued error "
+		<< bp_status_to_string (rx_stat);
+	    }
+
+	  // decode the batch without holding the neighbour table lock
+	  TimeStampT now = TimeStampT::get_current_system_time();
+	  batch.clear ();
+	  for (size_t k = 0; k < number_received; k++)
+	    {
+	      BPLengthT result_length = rx_lengths[k];
+	      if (result_length == 0)
+		continue;
+	      if (result_length < SRPPayloadT::fixed_size())
+		{
+		  DCPLOG_INFO(log_rx)
+		    << "Retrieving received payload had wrong length "
+		    << result_length;
 		  continue;
-		
-		ScopedNeighbourTableMutex mtx (runtime);
-		runtime.srp_store.insert_esd_entry (*pESD);	      
-	      }
-	    else
-	      {
-		if (rx_stat != BP_STATUS_OK)
-		  {
-		    DCPLOG_INFO(log_rx)
-		      << "Retrieving received payload issued error "
-		      << bp_status_to_string (rx_stat);
-		  }
-		else if (result_length != 0)
-		  {
-		    DCPLOG_INFO(log_rx)
-		      << "Retrieving received payload had wrong length "
-		      << result_length;
-		  }
+		}
+
+	      ScopedLatencyMeasurement parse_time (runtime.metricRxParseTime);
+	      runtime.metricPayloadsReceived.inc ();
+	      SRPPayloadT pld;
+	      try {
+		MemoryChunkDisassemblyArea area ("srp-rx", result_length.val, rx_buffer.data() + k * max_payload_size);
+		pld.deserialize (area);
+		if (area.used() != result_length.val)
+		  throw DisassemblyAreaException ("srp::receiver_thread", "payload has bytes left after its last extension");
 	      }
-	  } while (more_payloads);
+	      catch (DisassemblyAreaException& e)
+		{
+		  DCPLOG_INFO(log_rx)
+		    << "Dropping malformed payload of length " << result_length
+		    << ", message: " << e.what();
+		  runtime.metricPayloadsMalformed.inc ();
+		  continue;
+		}
+		
+	      if (pld.nodeId == runtime.srp_store.get_own_node_identifier ())
+		continue;
+
+	      batch.push_back (pld.decode (qp, now));
+	    }
+
+	  if (batch.empty())
+	    continue;
+	  runtime.metricRxBatchSize.set ((int64_t) batch.size());
+
+	  // own position for the distance threshold of neighbour event
+	  // subscriptions
+	  bool        own_sd_written;
+	  SafetyDataT own_sd;
+	  {
+	    ScopedOwnSDMutex own_mtx (runtime);
+	    own_sd_written = runtime.srp_store.get_own_safety_data_written_flag ();
+	    own_sd         = runtime.srp_store.get_own_safety_data ();
+	    own_sd         = own_sd.extrapolated (now.milliseconds_passed_since (runtime.srp_store.get_own_safety_data_timestamp ()) / 1000.0);
+	  }
+
+	  // apply the whole batch under a single lock acquisition
+	  ScopedNeighbourTableMutex mtx (runtime);
+	  if (own_sd_written)
+	    runtime.srp_store.set_event_reference_position (own_sd);
+	  for (const auto& esd : batch)
+	    runtime.srp_store.insert_esd_entry (esd);
+	  runtime.srp_store.publish_neighbour_snapshot (now, snapshot_period);
 	}
     }
     catch (DcpException& e)
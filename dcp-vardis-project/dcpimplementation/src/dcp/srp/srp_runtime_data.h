@@ -23,7 +23,9 @@
 #include <map>
 #include <queue>
 #include <mutex>
+#include <optional>
 #include <dcp/common/command_socket.h>
+#include <dcp/common/metrics.h>
 #include <dcp/bp/bpclient_lib.h>
 #include <dcp/srp/srp_configuration.h>
 #include <dcp/srp/srp_store_fixedmem_shm.h>
@@ -57,22 +59,35 @@ namespace dcp::srp {
      * @param static_client_info: static BP client protocol data to
      *        use (e.g. protocol name, queueing mode)
      * @param cfg: SRP configuration
+     * @param registrar: registrar of a BP instance in the same
+     *        process (dcpmain-stack), nullptr for a separate BP demon
      *
      * Initializes SRP as BP client (i.e. performs protocol
      * registration) and also initializes the SRP store (global shared
      * memory segment)
      */
     SRPRuntimeData (const BPStaticClientInfo static_client_info,
-		    const SRPConfiguration cfg)
-      : BPClientRuntime (cfg, static_client_info, false),   // generateTransmitPayloadConfirms
+		    const SRPConfiguration cfg,
+		    BPLocalRegistrar* registrar = nullptr)
+      : BPClientRuntime (cfg, static_client_info, false, registrar),   // generateTransmitPayloadConfirms
 	srp_store (cfg.shm_conf.shmAreaName.c_str(),
 		   true,
 		   cfg.srp_conf.srpGapSizeEWMAAlpha,
-		   get_own_node_identifier()),
+		   get_own_node_identifier(),
+		   cfg.srp_conf.srpSpatialGridCellSize,
+		   cfg.shm_conf.shmHugePages),
 	srp_config (cfg),
-	srp_exitFlag (false)
-    {
-    };
+	srp_exitFlag (false),
+	metrics ("SRP", cfg.metrics_conf),
+	metricRxParseTime (metrics.histogram ("rx_parse_ns")),
+	metricNeighbourTableLockHoldTime (metrics.histogram ("neighbour_table_lock_hold_ns")),
+	metricPayloadsReceived (metrics.counter ("payloads_received")),
+	metricPayloadsMalformed (metrics.counter ("payloads_malformed")),
+	metricRxBatchSize (metrics.gauge ("rx_batch_size")),
+	metricTxWakeupLatency (metrics.histogram ("tx_wakeup_latency_ns")),
+	metricScrubWakeupLatency (metrics.histogram ("scrub_wakeup_latency_ns")),
+	metricEventLoopWakeupLatency (metrics.histogram ("event_loop_wakeup_latency_ns"))
+    {};
 
 
     /**
@@ -93,6 +108,20 @@ namespace dcp::srp {
      * @brief Flag set by signal handlers to exit SRP demon
      */
     bool srp_exitFlag = false;
+
+
+    /**
+     * @brief Metrics (shared memory area read by dcp-stats)
+     */
+    MetricsRegistry    metrics;
+    LatencyHistogram&  metricRxParseTime;                 /*!< Time for deserializing and decoding one received payload */
+    LatencyHistogram&  metricNeighbourTableLockHoldTime;  /*!< Time the neighbour table mutex is held (ScopedNeighbourTableMutex) */
+    MetricCounter&     metricPayloadsReceived;
+    MetricCounter&     metricPayloadsMalformed;
+    MetricGauge&       metricRxBatchSize;                 /*!< Number of payloads in the last batch applied to the neighbour table */
+    LatencyHistogram&  metricTxWakeupLatency;             /*!< Lateness of the transmitter thread waking up for the next payload */
+    LatencyHistogram&  metricScrubWakeupLatency;          /*!< Same for the scrubber thread */
+    LatencyHistogram&  metricEventLoopWakeupLatency;      /*!< Lateness of timer callbacks in the event loop thread */
   };
 
 
@@ -112,16 +141,19 @@ namespace dcp::srp {
   class ScopedNeighbourTableMutex {
   private:
     SRPRuntimeData* ptr = nullptr;
+    std::optional<ScopedLatencyMeasurement> hold_time;
   public:
     ScopedNeighbourTableMutex() = delete;
     ScopedNeighbourTableMutex (SRPRuntimeData& runtime)
     {
       ptr = &runtime;
       runtime.srp_store.lock_neighbour_table();
+      hold_time.emplace (runtime.metricNeighbourTableLockHoldTime);
     };
     
     ~ScopedNeighbourTableMutex ()
     {
+      hold_time.reset ();
       if (ptr)
 	ptr->srp_store.unlock_neighbour_table ();
     };
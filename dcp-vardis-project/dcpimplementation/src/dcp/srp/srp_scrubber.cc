@@ -18,12 +18,14 @@
  */
 
 
+#include <algorithm>
 #include <functional>
 #include <list>
 #include <queue>
 #include <thread>
 #include <chrono>
 #include <dcp/common/area.h>
+#include <dcp/common/realtime.h>
 #include <dcp/common/services_status.h>
 #include <dcp/bp/bpclient_lib.h>
 #include <dcp/srp/srp_logging.h>
@@ -35,27 +37,50 @@ namespace dcp::srp {
 
   // -----------------------------------------------------------------
   
+  uint32_t scrub_neighbours (SRPRuntimeData& runtime)
+  {
+    uint16_t timeoutMS = runtime.srp_config.srp_conf.srpScrubbingTimeoutMS;
+    uint32_t waitMS    = runtime.srp_config.srp_conf.srpScrubbingPeriodMS;
+    
+    if (not runtime.srp_store.get_srp_isactive())
+      return waitMS;
+    
+    TimeStampT current_time = TimeStampT::get_current_coarse_time();
+    
+    ScopedNeighbourTableMutex lock (runtime);
+    std::list<NodeIdentifierT> nodes_to_remove = runtime.srp_store.find_nodes_to_scrub (current_time, timeoutMS);
+    
+    for (const auto& nodeId : nodes_to_remove)
+      runtime.srp_store.remove_esd_entry (nodeId);
+
+    // also publishes changes the receiver has held back
+    runtime.srp_store.publish_neighbour_snapshot (current_time, 0);
+
+    // next run when the next neighbour expires, but at most one
+    // scrubbing period later
+    TimeStampT oldest;
+    if (runtime.srp_store.get_oldest_reception_time (oldest))
+      {
+	uint32_t passedMS = current_time.milliseconds_passed_since (oldest);
+	uint32_t leftMS   = (passedMS >= timeoutMS) ? 0 : timeoutMS - passedMS;
+	waitMS = std::min (waitMS, leftMS);
+      }
+    return waitMS;
+  }
+  
+  // -----------------------------------------------------------------
+  
   void scrubber_thread (SRPRuntimeData& runtime)
   {
     DCPLOG_INFO(log_scrub) << "Starting scrubbing thread.";
 
-    uint16_t timeoutMS = runtime.srp_config.srp_conf.srpScrubbingTimeoutMS;
+    uint32_t waitMS = runtime.srp_config.srp_conf.srpScrubbingPeriodMS;
 
     try {
       while (not runtime.srp_exitFlag)
 	{
-	  std::this_thread::sleep_for (std::chrono::milliseconds (runtime.srp_config.srp_conf.srpScrubbingPeriodMS));
-	  
-	  if (not runtime.srp_store.get_srp_isactive())
-	    continue;
-	  
-	  TimeStampT current_time = TimeStampT::get_current_system_time();
-	  
-	  ScopedNeighbourTableMutex lock (runtime);
-	  std::list<NodeIdentifierT> nodes_to_remove = runtime.srp_store.find_nodes_to_scrub (current_time, timeoutMS);
-	  
-	  for (const auto& nodeId : nodes_to_remove)
-	    runtime.srp_store.remove_esd_entry (nodeId);
+	  sleep_for_measured (std::chrono::milliseconds (waitMS), runtime.metricScrubWakeupLatency);
+	  waitMS = scrub_neighbours (runtime);
 	}
     }
     catch (DcpException& e)
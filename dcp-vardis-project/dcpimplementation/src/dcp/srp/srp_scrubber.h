@@ -25,6 +25,14 @@
 
 namespace dcp::srp {
 
+  /**
+   * @brief Removes expired neighbours and publishes the neighbour
+   *        table snapshot (one scrubbing run). Returns the time in
+   *        ms until the next run is due.
+   */
+  uint32_t scrub_neighbours (SRPRuntimeData& runtime);
+
+  
   /**
    * @brief This thread handles and processes received SRP payloads,
    *        in particular it will update the neighbour store
@@ -21,22 +21,42 @@
 #pragma once
 
 #include <atomic>
+#include <cerrno>
+#include <cmath>
 #include <cstdint>
+#include <format>
 #include <functional>
 #include <list>
+#include <optional>
+#include <thread>
 #include <type_traits>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
 #include <dcp/common/fixedmem_avl_tree.h>
+#include <dcp/common/fixedmem_deadline_heap.h>
+#include <dcp/common/fixedmem_hash_table.h>
+#include <dcp/common/fixedmem_spatial_grid.h>
 #include <dcp/common/exceptions.h>
 #include <dcp/common/global_types_constants.h>
+#include <dcp/common/sharedmem_finite_queue.h>
+#include <dcp/srp/srp_cpa.h>
 #include <dcp/srp/srp_store_interface.h>
 
 /**
  * @brief This module implements the SRP store abstraction in a
  *        fixed-size memory region (allocated outside this module).
  *
- * The fixed-size memory region will include an array-based AVL tree
- * for the neighbour table, the own safety data for transmission and
- * relevant flags for managing the own safety data.
+ * The fixed-size memory region will include the neighbour table, a
+ * spatial grid index over the neighbour positions, a heap ordering the neighbours by their last reception
+ * time (for scrubbing), the event queues of neighbour event
+ * subscriptions, the own safety data for transmission and relevant
+ * flags for managing the own safety data.
+ *
+ * The index structure of the neighbour table is a template
+ * parameter: by default an open-addressing hash table
+ * (HashNeighbourIndex), alternatively an array-based AVL tree
+ * (AVLNeighbourIndex), which is kept for comparison.
  *
  * None of the operations implemented here perform any locking /
  * unlocking of their own, that is left to calling code.
@@ -60,10 +80,10 @@ namespace dcp::srp {
     SafetyDataT            own_sd;                             /*!< Own safety data for transmission */
     TimeStampT             last_own_sd_write;                  /*!< Timestamp of last write to own safety data (transmission is suppressed if more time than keepaliveTimeoutMS time has passed */
     bool                   own_sd_written;                     /*!< Indicates whether valid own safety data has been written into own_sd field */
-    uint32_t               next_seqno;                         /*!< Sequence number to use for next outgoing ExtendedSafetyDataT record */
+    alignas(cacheLineSize) uint32_t  next_seqno;               /*!< Sequence number to use for next outgoing ExtendedSafetyDataT record */
     NodeIdentifierT        ownNodeIdentifier;                  /*!< Own node identifier */
     double                 gapSizeEstimatorEWMAAlphaValue;     /*!< Alpha value to be used for EWMA estimator of average sequence number gap size for a neighbour */
-    std::atomic<bool>      srp_isActive;                       /*!< Flag indicating whether SRP demon is active (generating and processing SRP payloads) or not */
+    alignas(cacheLineSize) std::atomic<bool>  srp_isActive;    /*!< Flag indicating whether SRP demon is active (generating and processing SRP payloads) or not, polled by clients and kept on its own cache line */
   };
 
   
@@ -75,22 +95,44 @@ namespace dcp::srp {
 
 
 
+  /**
+   * @brief The data structures that can serve as index of the
+   *        neighbour table, keyed by node identifier. The hash table
+   *        has constant-time lookups and dense iteration, the AVL
+   *        tree is kept for comparison.
+   */
+  template <typename KeyT, typename DataT, uint64_t maxEntries>
+  using AVLNeighbourIndex = FixedMemAVLTree<KeyT, DataT, maxEntries>;
+
+  template <typename KeyT, typename DataT, uint64_t maxEntries>
+  using HashNeighbourIndex = FixedMemHashTable<KeyT, DataT, maxEntries>;
+
+
   /**
    * @brief This is the main fixed-memory SRP store template class
    *
    * @tparam GlobalState: type to be used for the global state (has to
    *         be derived from type GlobalStateBase)
    * @tparam maxNeighbours: maximum size of neighbour table
+   * @tparam NeighbourIndex: data structure used as neighbour table
+   *         index, AVLNeighbourIndex or HashNeighbourIndex
    *
    * The data held by this structure includes:
    *   - A 'global data' structure of type GlobalStateBase or derived
-   *   - An array-based AVL tree holding meta-data for each node in the
-   *     neighbour table
+   *   - An array-based index (hash table or AVL tree) holding
+   *     meta-data for each node in the neighbour table
    *   - An array of ExtendedSafetyDataT entries for neighbours
    *   - A free list indicating which array entry (of the ExtendedSafetyDataT
    *     array) are still available
+   *   - A spatial grid index over the positions of the neighbours, keyed
+   *     by the index of their ExtendedSafetyDataT array entry
+   *   - A min-heap of the last reception times of the neighbours, with
+   *     the same keys, so that expired neighbours are found without
+   *     visiting the whole neighbour table
    */
-  template <GlobalStateT GlobalState, uint64_t maxNeighbours>
+  template <GlobalStateT GlobalState,
+	    uint64_t maxNeighbours,
+	    template <typename, typename, uint64_t> class NeighbourIndex = HashNeighbourIndex>
   class FixedMemSRPStoreBase : public SRPStoreI {
   public:
 
@@ -100,12 +142,40 @@ namespace dcp::srp {
     static constexpr uint64_t get_max_neighbours () { return maxNeighbours; };
 
 
+    /**
+     * @brief Returns the number of hash buckets of the spatial grid
+     *        index
+     */
+    static constexpr uint64_t get_grid_buckets () { return 2*maxNeighbours; };
+
+
+    /**
+     * @brief Returns the number of neighbour event subscriptions that
+     *        can exist at the same time
+     */
+    static constexpr uint64_t get_max_event_subscriptions () { return 4; };
+
+
+    /**
+     * @brief Returns the number of events a subscription can hold
+     *        before further events are dropped
+     */
+    static constexpr uint64_t get_event_queue_length () { return 256; };
+
+
+    /**
+     * @brief Returns the number of attempts of a reader to find a
+     *        neighbour table snapshot that is not being published
+     */
+    static constexpr uint64_t get_snapshot_read_attempts () { return 10000; };
+
+
   protected:
 
 
     /**
      * @brief This represents the data we store for one neighbour in
-     *        the AVL tree
+     *        the neighbour index (hash table or AVL tree)
      */
     class NeighbourState {
     public:
@@ -126,6 +196,45 @@ namespace dcp::srp {
     } FreeListEntry;
 
 
+    /**
+     * @brief An immutable copy of the neighbour table published for
+     *        lock-free reading by clients, protected by a sequence
+     *        number (seqlock): the version is odd while the snapshot
+     *        is being written, and readers retry when it is odd or
+     *        has changed while they were copying.
+     */
+    class alignas(cacheLineSize) NeighbourSnapshot {
+    public:
+      std::atomic<uint64_t>  version {0};                        /*!< Seqlock sequence number */
+      uint64_t               number_records = 0;                 /*!< Number of valid records */
+      NodeInformation        records [maxNeighbours];            /*!< Neighbour records */
+    };
+
+    
+    /**
+     * @brief State of one neighbour event subscription. The event
+     *        queue has its own lock, all other fields are protected by
+     *        the neighbour table lock.
+     */
+    class EventSubscription {
+    public:
+      bool                   in_use = false;                     /*!< Whether the subscription is taken by a client */
+      pid_t                  owner_pid = 0;                      /*!< Process id of the subscribing client */
+      NeighbourEventFilter   filter;                             /*!< Filter given when subscribing */
+      std::atomic<uint64_t>  number_dropped {0};                 /*!< Events dropped because the queue was full */
+      bool                   reported [maxNeighbours];           /*!< Whether the neighbour has been reported as added, keyed by ExtendedSafetyDataT buffer index */
+      SafetyDataT            reported_sd [maxNeighbours];        /*!< Last reported safety data, same keys */
+      bool                   expiry_pending [maxNeighbours];     /*!< Whether an expiry event could not be queued yet, same keys */
+      NeighbourEvent         pending_expiry [maxNeighbours];     /*!< The expiry event waiting to be queued, same keys */
+      uint64_t               number_pending_expiries = 0;        /*!< Number of slots with expiry_pending set */
+      ShmFiniteQueue<get_event_queue_length(), sizeof(NeighbourEvent)>  events;   /*!< Pending events */
+
+      EventSubscription ()
+	: events ("srp-neighbour-events", get_event_queue_length())
+      {};
+    };
+
+    
     /**
      * @brief This class specifies the actual structure that is stored
      *        in the given memory block.
@@ -135,12 +244,30 @@ namespace dcp::srp {
       GlobalState   global_state;                                                         /*!< Global state (own safety data etc) */
       ExtendedSafetyDataT    neighbour_ESD [maxNeighbours];                               /*!< Buffers for ExtendedSafetyDataT records of neighbours */
       FixedMemRingBuffer<FreeListEntry, get_max_neighbours()+1>  freeList;                /*!< Ring buffer of free ExtendedSafetyDataT buffers */
-      FixedMemAVLTree<NodeIdentifierT, NeighbourState, maxNeighbours> neighbour_table;    /*!< AVL tree containing neighbour table (with per-neighbour metadata) */
+      NeighbourIndex<NodeIdentifierT, NeighbourState, maxNeighbours> neighbour_table;     /*!< Index containing neighbour table (with per-neighbour metadata) */
+      FixedMemSpatialGrid<maxNeighbours, get_grid_buckets()>  neighbour_grid;            /*!< Spatial index over neighbour positions, keyed by ExtendedSafetyDataT buffer index */
+      CPAKinematics<maxNeighbours>  neighbour_kinematics;                                  /*!< Neighbour positions and velocities in structure-of-arrays layout, same keys */
+      FixedMemDeadlineHeap<TimeStampT, maxNeighbours>  neighbour_expiry;                   /*!< Last reception times of neighbours, oldest first, same keys */
+      NeighbourSnapshot      snapshots [2];                                               /*!< Double-buffered published neighbour table */
+      alignas(cacheLineSize) std::atomic<uint32_t>  current_snapshot {0};                 /*!< Index of the most recently published snapshot */
+      bool                   snapshot_dirty = false;                                      /*!< Neighbour table changed since last publication */
+      TimeStampT             last_snapshot_publication;                                   /*!< Time of last publication */
+      EventSubscription      subscriptions [get_max_event_subscriptions()];               /*!< Neighbour event subscriptions */
+      SafetyDataT            event_reference;                                             /*!< Own position for the distance threshold of subscriptions */
+      bool                   event_reference_valid = false;                               /*!< Whether event_reference has been set */
+      double                 cpa_tcpa  [maxNeighbours];                                   /*!< Scratch space of find_closest_approach_threats */
+      double                 cpa_d2cpa [maxNeighbours];
+      uint64_t               cpa_best  [maxNeighbours];
+      uint64_t               knn_slots      [maxNeighbours];                              /*!< Scratch space of find_nearest_neighbours */
+      double                 knn_distances2 [maxNeighbours];
       
       /**
-       * @brief Constructor, initializes free list
+       * @brief Constructor, initializes free list and spatial index
        */
-      FixedMemContents () : freeList ("FixedMemContents::freeList", get_max_neighbours()) {};
+      FixedMemContents (double grid_cell_size)
+	: freeList ("FixedMemContents::freeList", get_max_neighbours()),
+	  neighbour_grid (grid_cell_size)
+      {};
     };
 
 
@@ -156,6 +283,206 @@ namespace dcp::srp {
     FixedMemContents*   pContents            = nullptr;
 
 
+    /**
+     * @brief Returns the index of the ExtendedSafetyDataT buffer of
+     *        the given neighbour state, used as key in the spatial
+     *        grid index
+     */
+    static inline uint64_t esd_slot (const NeighbourState& nstate) { return nstate.esd_offs / sizeof(ExtendedSafetyDataT); };
+
+
+    /**
+     * @brief Updates the spatial index and the kinematic state of the
+     *        given slot from a new ExtendedSafetyDataT record
+     */
+    inline void index_neighbour (uint64_t slot, const ExtendedSafetyDataT& esd)
+    {
+      FixedMemContents&  FMC  = *pContents;
+      FMC.neighbour_grid.update (slot,
+				 esd.safetyData.position_x,
+				 esd.safetyData.position_y,
+				 esd.safetyData.position_z);
+      FMC.neighbour_kinematics.update (slot, esd);
+    };
+
+
+    /**
+     * @brief Removes the given slot from the spatial index, the
+     *        kinematic state and the expiry heap
+     */
+    inline void unindex_neighbour (uint64_t slot)
+    {
+      FixedMemContents&  FMC  = *pContents;
+      FMC.neighbour_grid.remove (slot);
+      FMC.neighbour_kinematics.remove (slot);
+      FMC.neighbour_expiry.remove (slot);
+    };
+
+    
+    /**
+     * @brief Returns the NodeInformation record for the neighbour
+     *        stored in the given ExtendedSafetyDataT buffer
+     */
+    inline void fill_node_information (uint64_t slot, NodeInformation& ni) const
+    {
+      FixedMemContents&  FMC  = *pContents;
+      ni.esd                          = FMC.neighbour_ESD[slot];
+      NeighbourState& nstate          = FMC.neighbour_table.lookup_data_ref (ni.esd.nodeId);
+      ni.last_reception_time          = nstate.last_esd_received;
+      ni.avg_seqno_gap_size_estimate  = nstate.avg_seqno_gap_size;
+    };
+
+
+    /**
+     * @brief Appends an event to the queue of the given subscription
+     *        without waiting. Returns false if the queue is full.
+     */
+    inline bool try_push_neighbour_event (EventSubscription& sub, const NeighbourEvent& event)
+    {
+      bool timed_out, is_full;
+      PushHandler handler = [&event] (byte* memaddr, size_t)
+      {
+	new (memaddr) NeighbourEvent (event);
+	return sizeof(NeighbourEvent);
+      };
+      sub.events.push_nowait (handler, timed_out, is_full, defaultShortSharedMemoryLockTimeoutMS);
+      return not (timed_out or is_full);
+    };
+
+
+    /**
+     * @brief Like try_push_neighbour_event, but counts the event as
+     *        dropped if the queue is full
+     */
+    inline bool push_neighbour_event (EventSubscription& sub, const NeighbourEvent& event)
+    {
+      if (try_push_neighbour_event (sub, event))
+	return true;
+      sub.number_dropped++;
+      return false;
+    };
+
+
+    /**
+     * @brief Queues the pending expiry events of the given
+     *        subscription, in slot order. Returns true if none is
+     *        left pending.
+     */
+    inline bool flush_pending_expiries (EventSubscription& sub)
+    {
+      for (uint64_t slot = 0; (slot < maxNeighbours) and (sub.number_pending_expiries > 0); slot++)
+	{
+	  if (not sub.expiry_pending[slot])
+	    continue;
+	  if (not try_push_neighbour_event (sub, sub.pending_expiry[slot]))
+	    return false;
+	  sub.expiry_pending[slot] = false;
+	  sub.number_pending_expiries--;
+	}
+      return true;
+    };
+
+
+    /**
+     * @brief Generates the events of all subscriptions for a new or
+     *        updated neighbour in the given slot
+     *
+     * The reported state of a subscription only changes when its
+     * event could be queued, so that a dropped event is generated
+     * again with the next update of the neighbour. Pending expiry
+     * events of a subscription are queued first, a subscription that
+     * still has some is skipped, so that a reused slot is not
+     * reported as added before the expiry of its previous neighbour.
+     */
+    inline void notify_neighbour_update (uint64_t slot, const ExtendedSafetyDataT& esd)
+    {
+      FixedMemContents&  FMC  = *pContents;
+      NeighbourEvent     event;
+      event.esd         = esd;
+      event.event_time  = TimeStampT::get_current_system_time ();
+      
+      for (auto& sub : FMC.subscriptions)
+	{
+	  if ((not sub.in_use) or (not flush_pending_expiries (sub)))
+	    continue;
+	  
+	  const NeighbourEventFilter& filter = sub.filter;
+	  bool in_range =    (filter.max_distance <= 0)
+	                  or (not FMC.event_reference_valid)
+	                  or (FMC.event_reference.distance_to (esd.safetyData) <= filter.max_distance);
+
+	  if (not sub.reported[slot])
+	    {
+	      if (not in_range)
+		continue;
+	      event.type = netNeighbourAdded;
+	      if (push_neighbour_event (sub, event))
+		{
+		  sub.reported[slot]     = true;
+		  sub.reported_sd[slot]  = esd.safetyData;
+		}
+	    }
+	  else if (not in_range)
+	    {
+	      event.type = netNeighbourOutOfRange;
+	      if (push_neighbour_event (sub, event))
+		sub.reported[slot] = false;
+	    }
+	  else if (sub.reported_sd[slot].distance_to (esd.safetyData) >= filter.min_position_delta)
+	    {
+	      event.type = netNeighbourUpdated;
+	      if (push_neighbour_event (sub, event))
+		sub.reported_sd[slot] = esd.safetyData;
+	    }
+	}
+    };
+
+
+    /**
+     * @brief Generates expiry events for the neighbour in the given
+     *        slot for all subscriptions it has been reported to
+     *
+     * An expiry event that cannot be queued is kept pending in the
+     * subscription (the slot may be reused right away) and queued
+     * with the next event of that subscription.
+     */
+    inline void notify_neighbour_expiry (uint64_t slot)
+    {
+      FixedMemContents&  FMC  = *pContents;
+      NeighbourEvent     event;
+      event.type        = netNeighbourExpired;
+      event.esd         = FMC.neighbour_ESD[slot];
+      event.event_time  = TimeStampT::get_current_system_time ();
+      
+      for (auto& sub : FMC.subscriptions)
+	{
+	  if ((not sub.in_use) or (not sub.reported[slot]))
+	    continue;
+	  sub.reported[slot] = false;
+	  if (flush_pending_expiries (sub) and try_push_neighbour_event (sub, event))
+	    continue;
+	  sub.expiry_pending[slot]  = true;
+	  sub.pending_expiry[slot]  = event;
+	  sub.number_pending_expiries++;
+	}
+    };
+
+
+    /**
+     * @brief Returns the subscription with the given identifier,
+     *        throws if it does not exist or is not in use
+     */
+    inline EventSubscription& get_subscription (uint32_t subscription_id, const char* method) const
+    {
+      if (subscription_id >= get_max_event_subscriptions())
+	throw SRPStoreException (method, "illegal subscription identifier");
+      EventSubscription& sub = pContents->subscriptions[subscription_id];
+      if (not sub.in_use)
+	throw SRPStoreException (method, "subscription not in use");
+      return sub;
+    };
+
+    
   public:
 
     // ---------------------------------------
@@ -180,6 +507,9 @@ namespace dcp::srp {
      * @param gap_ewma_estimator_alpha: alpha value to be used for
      *        the EWMA estimator for the average sequence number gap
      *        size of a neighbour. This is not checked for validity.
+     * @param grid_cell_size: edge length (in metres) of a cell of the
+     *        spatial index over neighbour positions. Throws if not
+     *        strictly positive.
      *
      * This mainly sets the memory_start_address and pContents
      * pointers, adds all ExtendedSafetyDataT buffers to the free list
@@ -187,7 +517,8 @@ namespace dcp::srp {
      */
     void initialize_srp_store (byte* mem_start_addr,
 			       NodeIdentifierT own_node_id,
-			       double gap_ewma_estimator_alpha)
+			       double gap_ewma_estimator_alpha,
+			       double grid_cell_size)
       
        
     {
@@ -196,7 +527,7 @@ namespace dcp::srp {
       if (memory_start_address == nullptr)
 	throw SRPStoreException ("initialize_srp_store", "memory start address is null");
 
-      pContents = new (memory_start_address) FixedMemContents;
+      pContents = new (align_address (memory_start_address, alignof(FixedMemContents))) FixedMemContents (grid_cell_size);
 
       for (uint64_t i = 0; i < get_max_neighbours(); i++)
 	{
@@ -218,9 +549,10 @@ namespace dcp::srp {
 
     /**
      * @brief Returns the actual size needed for the FixedMemContents
-     *        structure in the given memory block.
+     *        structure in the given memory block, including padding
+     *        for aligning the structure to a cache line boundary.
      */
-    static constexpr size_t get_fixedmem_contents_size () { return sizeof(FixedMemContents); };
+    static constexpr size_t get_fixedmem_contents_size () { return sizeof(FixedMemContents) + alignof(FixedMemContents) - 1; };
 
 
     // ---------------------------------------
@@ -280,7 +612,7 @@ namespace dcp::srp {
 	  
 	  byte* effective_address = (byte*) FMC.neighbour_ESD + nstate.esd_offs;
 	  std::memcpy (effective_address, (byte*) &new_esd, sizeof(ExtendedSafetyDataT));
-	  nstate.last_esd_received  = TimeStampT::get_current_system_time ();
+	  nstate.last_esd_received  = TimeStampT::get_current_coarse_time ();
 
 	  if (nstate.seqno_received)
 	    {
@@ -293,6 +625,10 @@ namespace dcp::srp {
 	    }
 	  nstate.last_seqno      = new_esd.seqno;
 	  nstate.seqno_received  = true;
+	  index_neighbour (esd_slot (nstate), new_esd);
+	  FMC.neighbour_expiry.update (esd_slot (nstate), nstate.last_esd_received);
+	  notify_neighbour_update (esd_slot (nstate), new_esd);
+	  FMC.snapshot_dirty     = true;
 	  return;
 	}
 
@@ -305,12 +641,16 @@ namespace dcp::srp {
       new_nstate.last_seqno          = new_esd.seqno;
       new_nstate.seqno_received      = false;
       new_nstate.avg_seqno_gap_size  = 0;
-      new_nstate.last_esd_received   = TimeStampT::get_current_system_time();
+      new_nstate.last_esd_received   = TimeStampT::get_current_coarse_time();
 
       byte* effective_address = (byte*) FMC.neighbour_ESD + new_nstate.esd_offs;
       std::memcpy (effective_address, (byte*) &new_esd, sizeof(ExtendedSafetyDataT));
       
       FMC.neighbour_table.insert (nodeId, new_nstate);      
+      index_neighbour (esd_slot (new_nstate), new_esd);
+      FMC.neighbour_expiry.update (esd_slot (new_nstate), new_nstate.last_esd_received);
+      notify_neighbour_update (esd_slot (new_nstate), new_esd);
+      FMC.snapshot_dirty = true;
     };
 
     // ---------------------------------------
@@ -372,6 +712,9 @@ namespace dcp::srp {
       fl_entry.esd_offs = nstat.esd_offs;
       FMC.freeList.push (fl_entry);
 
+      notify_neighbour_expiry (esd_slot (nstat));
+      unindex_neighbour (esd_slot (nstat));
+      FMC.snapshot_dirty = true;
       FMC.neighbour_table.remove (nodeId);
     };
 
@@ -529,27 +872,51 @@ namespace dcp::srp {
      *
      * @return List of all node identifiers whose last reception time
      *         is older than the given timeout
+     *
+     * Only the expired part of the expiry heap is visited, so the
+     * effort does not depend on the size of the neighbour table.
      */
     virtual std::list<NodeIdentifierT> find_nodes_to_scrub (TimeStampT current_time, uint16_t timeoutMS) const
     {
       FixedMemContents&  FMC = *pContents;
-      
-      std::function<bool (NodeIdentifierT, const NeighbourState&)> predicate =
-	[current_time, timeoutMS] (NodeIdentifierT, const NeighbourState& nstate)
-	{
-	  return current_time.milliseconds_passed_since (nstate.last_esd_received) >= timeoutMS;
-	};
-
-      std::function<NodeIdentifierT (NodeIdentifierT, const NeighbourState&)> transform =
-	[] (NodeIdentifierT nodeId, const NeighbourState&) { return nodeId; };
-      
       std::list<NodeIdentifierT> result_list;
-      FMC.neighbour_table. template find_matching_data<NodeIdentifierT> (predicate, transform, result_list);
+
+      auto is_expired = [&] (const TimeStampT& last_received)
+      {
+	return current_time.milliseconds_passed_since (last_received) >= timeoutMS;
+      };
+      auto collect = [&] (uint64_t slot)
+      {
+	result_list.push_back (FMC.neighbour_ESD[slot].nodeId);
+      };
+
+      FMC.neighbour_expiry.for_each_due (is_expired, collect);
       return result_list;
     };
 
     // ---------------------------------------
 
+
+    /**
+     * @brief Returns the oldest last reception time over all
+     *        neighbours, i.e. the one that expires first
+     *
+     * @param oldest: output value, left unmodified if the neighbour
+     *        table is empty
+     *
+     * @return false if the neighbour table is empty, true otherwise
+     */
+    virtual bool get_oldest_reception_time (TimeStampT& oldest) const
+    {
+      FixedMemContents&  FMC = *pContents;
+      if (FMC.neighbour_expiry.is_empty())
+	return false;
+      oldest = FMC.neighbour_expiry.top_deadline ();
+      return true;
+    };
+
+    // ---------------------------------------
+
     virtual std::list<NodeInformation> list_matching_node_information (std::function<bool (const ExtendedSafetyDataT&)> esd_predicate) const
     {
       FixedMemContents&  FMC = *pContents;
@@ -582,6 +949,330 @@ namespace dcp::srp {
       return result_list;
     };
 
+    // ---------------------------------------
+
+
+    /**
+     * @brief Collects NodeInformation records of all neighbours within
+     *        the given distance of the given position, using the
+     *        spatial grid index
+     *
+     * @param centre: position to measure distances from
+     * @param radius: maximum distance
+     * @param buffer: caller-provided output buffer
+     * @param buffer_size: number of records the buffer can hold
+     *
+     * @return Number of matching neighbours, only the first
+     *         buffer_size of which are written (in unspecified order)
+     */
+    virtual size_t find_neighbours_within_radius (const SafetyDataT& centre,
+						  double radius,
+						  NodeInformation* buffer,
+						  size_t buffer_size) const
+    {
+      FixedMemContents&  FMC = *pContents;
+      size_t number_matching = 0;
+      
+      FMC.neighbour_grid.for_each_within (centre.position_x, centre.position_y, centre.position_z, radius,
+					  [&] (uint64_t slot, double)
+					  {
+					    if (number_matching < buffer_size)
+					      fill_node_information (slot, buffer[number_matching]);
+					    number_matching++;
+					  });
+      return number_matching;
+    };
+
+    // ---------------------------------------
+
+
+    /**
+     * @brief Collects NodeInformation records of the k neighbours
+     *        nearest to the given position, using the spatial grid
+     *        index. Uses scratch space of the store, so it must be
+     *        called with the neighbour table locked.
+     *
+     * @param centre: position to measure distances from
+     * @param k: number of neighbours to find
+     * @param buffer: caller-provided output buffer for at least k
+     *        records, filled in order of increasing distance
+     *
+     * @return Number of records written, i.e. the smaller of k and
+     *         the number of neighbours
+     */
+    virtual size_t find_nearest_neighbours (const SafetyDataT& centre,
+					    size_t k,
+					    NodeInformation* buffer) const
+    {
+      FixedMemContents&  FMC = *pContents;
+      uint64_t found = FMC.neighbour_grid.nearest (centre.position_x, centre.position_y, centre.position_z,
+						   std::min ((uint64_t) k, maxNeighbours),
+						   FMC.knn_slots, FMC.knn_distances2);
+      for (uint64_t i = 0; i < found; i++)
+	fill_node_information (FMC.knn_slots[i], buffer[i]);
+      return found;
+    };
+
+    // ---------------------------------------
+
+
+    /**
+     * @brief Publishes the neighbour table as a new snapshot, if it
+     *        has changed since the last publication and at least
+     *        min_period_ms have passed since then
+     *
+     * The snapshot is written into the buffer not published last, so
+     * readers of the current snapshot are not disturbed. Must be
+     * called with the neighbour table locked, by the SRP demon only.
+     *
+     * @return Whether a snapshot has been published
+     */
+    virtual bool publish_neighbour_snapshot (const TimeStampT& now, uint16_t min_period_ms)
+    {
+      FixedMemContents&  FMC = *pContents;
+      if (not FMC.snapshot_dirty)
+	return false;
+      if ((min_period_ms > 0) and (now.milliseconds_passed_since (FMC.last_snapshot_publication) < min_period_ms))
+	return false;
+
+      uint32_t            next  = 1 - FMC.current_snapshot.load (std::memory_order_relaxed);
+      NeighbourSnapshot&  snap  = FMC.snapshots[next];
+      uint64_t            ver   = snap.version.load (std::memory_order_relaxed);
+      
+      snap.version.store (ver + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence (std::memory_order_release);
+
+      uint64_t n = 0;
+      FMC.neighbour_table.for_each ([&] (const NodeIdentifierT&, const NeighbourState& nstate)
+      {
+	NodeInformation& ni             = snap.records[n++];
+	ni.esd                          = FMC.neighbour_ESD[esd_slot (nstate)];
+	ni.last_reception_time          = nstate.last_esd_received;
+	ni.avg_seqno_gap_size_estimate  = nstate.avg_seqno_gap_size;
+      });
+      snap.number_records = n;
+
+      snap.version.store (ver + 2, std::memory_order_release);
+      FMC.current_snapshot.store (next, std::memory_order_release);
+      FMC.snapshot_dirty             = false;
+      FMC.last_snapshot_publication  = now;
+      return true;
+    };
+
+    // ---------------------------------------
+
+
+    /**
+     * @brief Copies the most recently published snapshot of the
+     *        neighbour table into a caller-provided buffer, without
+     *        taking any lock
+     *
+     * A publication in progress is waited for by yielding the
+     * processor, but at most get_snapshot_read_attempts() times, so
+     * that readers do not spin forever when the SRP demon has died
+     * in the middle of a publication.
+     *
+     * @param buffer: output buffer
+     * @param buffer_size: number of records the buffer can hold
+     *
+     * @return Number of records in the snapshot. If this exceeds
+     *         buffer_size, only buffer_size records have been
+     *         written. Empty if no consistent snapshot could be read
+     */
+    virtual std::optional<size_t> read_neighbour_snapshot (NodeInformation* buffer, size_t buffer_size) const
+    {
+      FixedMemContents&  FMC = *pContents;
+      for (uint64_t attempt = 0; attempt < get_snapshot_read_attempts (); attempt++)
+	{
+	  if (attempt > 0)
+	    std::this_thread::yield ();
+	  
+	  const NeighbourSnapshot& snap = FMC.snapshots[FMC.current_snapshot.load (std::memory_order_acquire)];
+	  uint64_t ver = snap.version.load (std::memory_order_acquire);
+	  if (ver & 1)
+	    continue;
+
+	  uint64_t n = std::min<uint64_t> (snap.number_records, maxNeighbours);
+	  for (uint64_t i = 0; (i < n) and (i < buffer_size); i++)
+	    buffer[i] = snap.records[i];
+
+	  std::atomic_thread_fence (std::memory_order_acquire);
+	  if (snap.version.load (std::memory_order_relaxed) == ver)
+	    return n;
+	}
+      return std::nullopt;
+    };
+
+    // ---------------------------------------
+
+
+    /**
+     * @brief Computes the closest point of approach to all
+     *        neighbours in one pass over the kinematic state, and
+     *        collects the k neighbours with the smallest distance at
+     *        closest approach (ties broken by earlier time)
+     *
+     * @param own: own safety data, extrapolated to time now
+     * @param now: time of the query
+     * @param horizon: look-ahead time (in s)
+     * @param max_distance: neighbours farther apart at closest
+     *        approach are not reported
+     * @param k: maximum number of threats to return
+     * @param buffer: caller-provided output buffer for at least k
+     *        records
+     *
+     * @return Number of records written
+     */
+    virtual size_t find_closest_approach_threats (const SafetyDataT& own,
+						  const TimeStampT& now,
+						  double horizon,
+						  double max_distance,
+						  size_t k,
+						  CPAThreat* buffer) const
+    {
+      FixedMemContents&  FMC = *pContents;
+      double*   tcpa   = FMC.cpa_tcpa;
+      double*   d2cpa  = FMC.cpa_d2cpa;
+      uint64_t* best   = FMC.cpa_best;
+      uint64_t  found  = 0;
+      uint64_t  wanted = std::min ((uint64_t) k, maxNeighbours);
+
+      if ((not std::isfinite (max_distance)) or (max_distance < 0))
+	throw SRPStoreException ("find_closest_approach_threats", std::format ("illegal maximum distance {}", max_distance));
+      if ((not std::isfinite (horizon)) or (horizon < 0))
+	throw SRPStoreException ("find_closest_approach_threats", std::format ("illegal horizon {}", horizon));
+      
+      double    max_d2 = max_distance * max_distance;
+      
+      if (wanted == 0)
+	return 0;
+      
+      FMC.neighbour_kinematics.compute (own, timestamp_to_seconds (now), horizon, tcpa, d2cpa);
+
+      auto worse = [&] (uint64_t a, uint64_t b)
+      {
+	return (d2cpa[a] > d2cpa[b]) or ((d2cpa[a] == d2cpa[b]) and (tcpa[a] > tcpa[b]));
+      };
+      
+      for (uint64_t i = 0; i < maxNeighbours; i++)
+	{
+	  if ((FMC.neighbour_kinematics.unused[i] != 0.0) or (not (d2cpa[i] <= max_d2)))
+	    continue;
+	  if ((found == wanted) and (not worse (best[found-1], i)))
+	    continue;
+	  uint64_t pos = (found < wanted) ? found++ : found-1;
+	  while ((pos > 0) and worse (best[pos-1], i))
+	    {
+	      best[pos] = best[pos-1];
+	      pos--;
+	    }
+	  best[pos] = i;
+	}
+
+      for (uint64_t j = 0; j < found; j++)
+	{
+	  fill_node_information (best[j], buffer[j].node);
+	  buffer[j].time_to_cpa     = tcpa[best[j]];
+	  buffer[j].distance_at_cpa = std::sqrt (d2cpa[best[j]]);
+	}
+      return found;
+    };
+
+    
+    // ---------------------------------------
+
+
+    /**
+     * @brief Returns whether the process owning the given
+     *        subscription no longer exists
+     */
+    static inline bool subscription_owner_is_dead (const EventSubscription& sub)
+    {
+      return (sub.owner_pid > 0) and (kill (sub.owner_pid, 0) < 0) and (errno == ESRCH);
+    };
+
+    
+    /**
+     * @brief Takes a free neighbour event subscription and resets its
+     *        queue and reported state. Subscriptions of clients that
+     *        exited without unsubscribing are reclaimed.
+     */
+    virtual bool subscribe_neighbour_events (const NeighbourEventFilter& filter, uint32_t& subscription_id)
+    {
+      FixedMemContents&  FMC = *pContents;
+      for (uint32_t i = 0; i < get_max_event_subscriptions(); i++)
+	{
+	  EventSubscription& sub = FMC.subscriptions[i];
+	  if (sub.in_use and (not subscription_owner_is_dead (sub)))
+	    continue;
+	  sub.filter          = filter;
+	  sub.number_dropped  = 0;
+	  for (uint64_t slot = 0; slot < maxNeighbours; slot++)
+	    {
+	      sub.reported[slot]        = false;
+	      sub.expiry_pending[slot]  = false;
+	    }
+	  sub.number_pending_expiries = 0;
+	  sub.events.reset ();
+	  sub.owner_pid       = getpid ();
+	  sub.in_use          = true;
+	  subscription_id     = i;
+	  return true;
+	}
+      return false;
+    };
+
+    // ---------------------------------------
+
+    virtual void unsubscribe_neighbour_events (uint32_t subscription_id)
+    {
+      get_subscription (subscription_id, "unsubscribe_neighbour_events").in_use = false;
+    };
+
+    // ---------------------------------------
+
+    virtual void set_event_reference_position (const SafetyDataT& own)
+    {
+      FixedMemContents&  FMC = *pContents;
+      FMC.event_reference        = own;
+      FMC.event_reference_valid  = true;
+    };
+
+    // ---------------------------------------
+
+    virtual size_t retrieve_neighbour_events (uint32_t subscription_id,
+					      NeighbourEvent* buffer,
+					      size_t buffer_size,
+					      bool& more_events,
+					      uint16_t waitMS)
+    {
+      EventSubscription& sub = get_subscription (subscription_id, "retrieve_neighbour_events");
+      size_t number_popped   = 0;
+      bool   timed_out;
+      more_events = false;
+      if (buffer_size == 0)
+	return 0;
+      
+      // the queue counts number_popped up after each call of the handler
+      PopHandler handler = [&] (byte* memaddr, size_t)
+      {
+	buffer[number_popped] = *((NeighbourEvent*) memaddr);
+      };
+      
+      if (waitMS > 0)
+	sub.events.popmany_wait (handler, buffer_size, number_popped, timed_out, more_events, waitMS);
+      else
+	sub.events.popmany_nowait (handler, buffer_size, number_popped, timed_out, more_events, defaultShortSharedMemoryLockTimeoutMS);
+      return number_popped;
+    };
+
+    // ---------------------------------------
+
+    virtual uint64_t get_number_dropped_neighbour_events (uint32_t subscription_id) const
+    {
+      return get_subscription (subscription_id, "get_number_dropped_neighbour_events").number_dropped;
+    };
+
     
     // ---------------------------------------
     
@@ -48,8 +48,8 @@ namespace dcp::srp {
    */
   class GlobalStateShm : public GlobalStateBase {
   public:
-    interprocess_mutex neighbour_table_mutex;
-    interprocess_mutex own_sd_mutex;
+    alignas(cacheLineSize) interprocess_mutex neighbour_table_mutex;
+    alignas(cacheLineSize) interprocess_mutex own_sd_mutex;
   };
 
 
@@ -59,9 +59,11 @@ namespace dcp::srp {
    *
    * @tparam maxNeighbours: maximum number of neighbours that can be
    *         stored
+   * @tparam NeighbourIndex: data structure used as neighbour table
+   *         index
    */
-  template <uint64_t maxNeighbours>
-  class FixedMemSRPStoreShm : public FixedMemSRPStoreBase<GlobalStateShm, maxNeighbours>, ShmStructureBase {
+  template <uint64_t maxNeighbours, template <typename, typename, uint64_t> class NeighbourIndex = HashNeighbourIndex>
+  class FixedMemSRPStoreShm : public FixedMemSRPStoreBase<GlobalStateShm, maxNeighbours, NeighbourIndex>, ShmStructureBase {
     
   protected:
 
@@ -69,8 +71,8 @@ namespace dcp::srp {
     /**
      * @brief Shorthand type definitions
      */
-    typedef FixedMemSRPStoreBase<GlobalStateShm, maxNeighbours>  ShmSRPStoreType;
-    typedef FixedMemSRPStoreBase<GlobalStateShm, maxNeighbours>::FixedMemContents  ShmFixedMemContents;
+    typedef FixedMemSRPStoreBase<GlobalStateShm, maxNeighbours, NeighbourIndex>  ShmSRPStoreType;
+    typedef FixedMemSRPStoreBase<GlobalStateShm, maxNeighbours, NeighbourIndex>::FixedMemContents  ShmFixedMemContents;
 
   public:
 
@@ -91,6 +93,10 @@ namespace dcp::srp {
      * @param alpha_gapsize_ewma: alpha value to be used for EWMA estimator
      *        for average sequence number gap size of a neighbour 
      * @param own_node_id: value of ownNodeIdentifier parameter
+     * @param grid_cell_size: edge length (in metres) of a cell of the
+     *        spatial index over neighbour positions
+     * @param useHugePages: whether to map the shared memory segment
+     *        with transparent huge pages (creator only)
      *
      * As a server, allocates shared memory object, and initializes
      * the fixed-memory SRP store there. As a client, attempts to open
@@ -101,9 +107,11 @@ namespace dcp::srp {
     FixedMemSRPStoreShm (const char* area_name,
 			 bool isCreator,
 			 double alpha_gapsize_ewma = defaultValueSrpGapSizeEWMAAlpha,
-			 NodeIdentifierT own_node_id = nullNodeIdentifier
+			 NodeIdentifierT own_node_id = nullNodeIdentifier,
+			 double grid_cell_size = defaultValueSrpSpatialGridCellSize,
+			 bool useHugePages = false
 			 )
-      : ShmStructureBase (area_name, ShmSRPStoreType::get_fixedmem_contents_size(), isCreator)
+      : ShmStructureBase (area_name, ShmSRPStoreType::get_fixedmem_contents_size(), isCreator, useHugePages)
 	//isCreator (isCreator)
     {
       
@@ -111,11 +119,12 @@ namespace dcp::srp {
 	{
 	  ShmSRPStoreType::initialize_srp_store ((byte*) get_memory_address(),
 						 own_node_id,
-						 alpha_gapsize_ewma);
+						 alpha_gapsize_ewma,
+						 grid_cell_size);
 	}
       else
 	{
-	  this->pContents = (ShmFixedMemContents*) get_memory_address();
+	  this->pContents = (ShmFixedMemContents*) align_address ((byte*) get_memory_address(), alignof(ShmFixedMemContents));
 	  if (this->pContents == nullptr)
 	    throw SRPStoreException ("FixedMemSRPStoreShm", "illegal region pointer");
 	}
@@ -22,6 +22,7 @@
 
 #include <functional>
 #include <list>
+#include <optional>
 #include <boost/interprocess/sync/interprocess_mutex.hpp>
 #include <dcp/common/global_types_constants.h>
 #include <dcp/srp/srp_transmissible_types.h>
@@ -38,6 +39,48 @@ namespace dcp::srp {
     TimeStampT          last_reception_time;
     double              avg_seqno_gap_size_estimate;
   } NodeInformation;
+
+
+  /**
+   * @brief Result record of a closest-point-of-approach query
+   */
+  typedef struct CPAThreat {
+    NodeInformation  node;                /*!< The neighbour as reported */
+    double           time_to_cpa;         /*!< Time from the query until closest approach, in s */
+    double           distance_at_cpa;     /*!< Distance at closest approach, in m */
+  } CPAThreat;
+
+
+  /**
+   * @brief Types of neighbour change events
+   */
+  typedef uint8_t NeighbourEventType;
+
+  const NeighbourEventType  netNeighbourAdded      = 1;   /*!< Neighbour became visible to the subscriber */
+  const NeighbourEventType  netNeighbourUpdated    = 2;   /*!< Neighbour moved by at least the minimum position delta */
+  const NeighbourEventType  netNeighbourExpired    = 3;   /*!< Neighbour was removed from the neighbour table */
+  const NeighbourEventType  netNeighbourOutOfRange = 4;   /*!< Neighbour moved beyond the distance threshold */
+
+
+  /**
+   * @brief Filter of a neighbour event subscription, fixed when
+   *        subscribing
+   */
+  typedef struct NeighbourEventFilter {
+    double  max_distance        = 0;   /*!< Only neighbours within this distance (in m) of the own position are reported, zero means no limit */
+    double  min_position_delta  = 0;   /*!< Updates are only reported once a neighbour has moved this far (in m) since its last reported position */
+  } NeighbourEventFilter;
+
+
+  /**
+   * @brief A neighbour change event, carrying the neighbour data
+   *        that caused it
+   */
+  typedef struct NeighbourEvent {
+    NeighbourEventType   type;
+    ExtendedSafetyDataT  esd;
+    TimeStampT           event_time;
+  } NeighbourEvent;
   
 
   
@@ -264,6 +307,17 @@ namespace dcp::srp {
     virtual std::list<NodeIdentifierT> find_nodes_to_scrub (TimeStampT current_time, uint16_t timeoutMS) const = 0;
 
 
+    /**
+     * @brief Returns the oldest last reception time of all neighbours,
+     *        i.e. that of the neighbour to be scrubbed next
+     *
+     * @param oldest: output value, unmodified if there are no neighbours
+     *
+     * @return false if the neighbour table is empty, true otherwise
+     */
+    virtual bool get_oldest_reception_time (TimeStampT& oldest) const = 0;
+
+
     /**
      * @brief Returns a list of NodeInformation records of all node
      *        identifiers whose ExtendSafetyDataT record satisfies a
@@ -276,6 +330,155 @@ namespace dcp::srp {
      */
     virtual std::list<NodeInformation> list_matching_node_information (std::function<bool (const ExtendedSafetyDataT&)> predicate) const = 0;
 
+
+    /**
+     * @brief Collects NodeInformation records of all neighbours whose
+     *        position is within the given distance of the given
+     *        position, into a caller-provided buffer
+     *
+     * @param centre: position to measure (Euclidean) distances from
+     * @param radius: maximum distance
+     * @param buffer: output buffer
+     * @param buffer_size: number of records the buffer can hold
+     *
+     * @return Number of matching neighbours. If this exceeds
+     *         buffer_size, only buffer_size records have been written
+     */
+    virtual size_t find_neighbours_within_radius (const SafetyDataT& centre,
+						  double radius,
+						  NodeInformation* buffer,
+						  size_t buffer_size) const = 0;
+
+
+    /**
+     * @brief Collects NodeInformation records of the k neighbours
+     *        closest to the given position, into a caller-provided
+     *        buffer, in order of increasing distance
+     *
+     * @param centre: position to measure (Euclidean) distances from
+     * @param k: number of neighbours to find
+     * @param buffer: output buffer for at least k records
+     *
+     * @return Number of records written (less than k if there are
+     *         fewer neighbours)
+     */
+    virtual size_t find_nearest_neighbours (const SafetyDataT& centre,
+					    size_t k,
+					    NodeInformation* buffer) const = 0;
+
+
+    /**
+     * @brief Publishes the neighbour table as a snapshot for
+     *        lock-free readers if it has changed and at least
+     *        min_period_ms have passed since the last publication.
+     *        Must be called with the neighbour table locked.
+     *
+     * @return Whether a snapshot has been published
+     */
+    virtual bool publish_neighbour_snapshot (const TimeStampT& now, uint16_t min_period_ms) = 0;
+
+
+    /**
+     * @brief Copies the most recently published snapshot of the
+     *        neighbour table into a caller-provided buffer, without
+     *        locking. Returns the number of records in the
+     *        snapshot, or nothing if no consistent snapshot could be
+     *        read since a publication did not complete
+     */
+    virtual std::optional<size_t> read_neighbour_snapshot (NodeInformation* buffer, size_t buffer_size) const = 0;
+
+    
+    /**
+     * @brief Computes the closest point of approach between the own
+     *        node and every neighbour, and collects the k neighbours
+     *        with the smallest distance at closest approach into a
+     *        caller-provided buffer, in order of increasing distance
+     *
+     * @param own: own safety data, extrapolated to time now
+     * @param now: time of the query
+     * @param horizon: look-ahead time (in s), later approaches are
+     *        not considered. Must be finite and non-negative
+     * @param max_distance: neighbours whose distance at closest
+     *        approach exceeds this are not threats. Must be finite
+     *        and non-negative
+     * @param k: maximum number of threats to return
+     * @param buffer: output buffer for at least k records
+     *
+     * @return Number of records written
+     *
+     * Must be called with the neighbour table locked, the
+     * implementation may use scratch space in the store. Throws
+     * SRPStoreException for an illegal horizon or max_distance.
+     */
+    virtual size_t find_closest_approach_threats (const SafetyDataT& own,
+						  const TimeStampT& now,
+						  double horizon,
+						  double max_distance,
+						  size_t k,
+						  CPAThreat* buffer) const = 0;
+
+
+    /**
+     * @brief Creates a subscription for neighbour change events.
+     *        Must be called with the neighbour table locked.
+     *
+     * @param filter: filter to apply to the events of this subscription
+     * @param subscription_id: output value, identifies the
+     *        subscription in further calls
+     *
+     * @return false if all subscriptions are in use, true otherwise
+     *
+     * Neighbours already in the table are reported as added with
+     * their next update. Subscriptions whose client process no
+     * longer exists are reclaimed.
+     */
+    virtual bool subscribe_neighbour_events (const NeighbourEventFilter& filter, uint32_t& subscription_id) = 0;
+
+
+    /**
+     * @brief Releases a subscription for neighbour change
+     *        events. Must be called with the neighbour table locked.
+     */
+    virtual void unsubscribe_neighbour_events (uint32_t subscription_id) = 0;
+
+
+    /**
+     * @brief Sets the own position against which the distance
+     *        threshold of event subscriptions is evaluated. Must be
+     *        called with the neighbour table locked.
+     *
+     * Until this has been called, the distance threshold is not applied.
+     */
+    virtual void set_event_reference_position (const SafetyDataT& own) = 0;
+
+
+    /**
+     * @brief Retrieves pending events of the given subscription into
+     *        a caller-provided buffer, in the order they occurred. Does
+     *        not need the neighbour table lock.
+     *
+     * @param subscription_id: subscription to retrieve events for
+     * @param buffer: output buffer
+     * @param buffer_size: maximum number of events to retrieve
+     * @param more_events: output value, whether further events are pending
+     * @param waitMS: if non-zero, waits up to this long when no event
+     *        is pending
+     *
+     * @return Number of events retrieved
+     */
+    virtual size_t retrieve_neighbour_events (uint32_t subscription_id,
+					      NeighbourEvent* buffer,
+					      size_t buffer_size,
+					      bool& more_events,
+					      uint16_t waitMS) = 0;
+
+
+    /**
+     * @brief Returns the number of events of the given subscription
+     *        that have been dropped because its event queue was full
+     */
+    virtual uint64_t get_number_dropped_neighbour_events (uint32_t subscription_id) const = 0;
+
   };
 
   
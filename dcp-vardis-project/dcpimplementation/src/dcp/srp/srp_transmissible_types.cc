@@ -18,6 +18,11 @@
  */
 
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
 #include <dcp/srp/srp_transmissible_types.h>
 
 namespace dcp::srp {
@@ -26,12 +31,82 @@ namespace dcp::srp {
   {
     os << "SafetyDataT { x = " << sd.position_x
        << " , y = " << sd.position_y
-       << " , z = " << sd.position_z
-       << " }";
+       << " , z = " << sd.position_z;
+    if (sd.has_velocity)
+      os << " , speed = " << sd.speed
+	 << " , heading = " << sd.heading;
+    if (sd.has_battery)
+      os << " , battery = " << sd.battery_level;
+    if (sd.has_waypoint)
+      os << " , waypoint = (" << sd.waypoint_x
+	 << ", " << sd.waypoint_y
+	 << ", " << sd.waypoint_z << ")";
+    if (sd.application_extensions_length > 0)
+      os << " , applicationExtensionBytes = " << (int) sd.application_extensions_length;
+    os << " }";
     return os;
   }
 
 
+  SafetyDataT SafetyDataT::extrapolated (double seconds) const
+  {
+    SafetyDataT sd = *this;
+    if (has_velocity)
+      {
+	double hdg = heading * M_PI / 180.0;
+	sd.position_x += speed * std::sin (hdg) * seconds;
+	sd.position_y += speed * std::cos (hdg) * seconds;
+      }
+    return sd;
+  }
+
+
+  double SafetyDataT::distance_to (const SafetyDataT& other) const
+  {
+    double dx = position_x - other.position_x;
+    double dy = position_y - other.position_y;
+    double dz = position_z - other.position_z;
+    return std::sqrt (dx*dx + dy*dy + dz*dz);
+  }
+
+
+  bool SafetyDataT::add_application_extension (SRPExtensionType type, const byte* value, uint8_t length)
+  {
+    if (type < firstApplicationExtensionType)
+      return false;
+    if (application_extensions_length + SRPPayloadT::extension_header_size() + length > maxApplicationExtensionsSize)
+      return false;
+    byte* p = application_extensions + application_extensions_length;
+    p[0] = type;
+    p[1] = length;
+    if (length > 0)
+      std::memcpy (p + 2, value, length);
+    application_extensions_length += SRPPayloadT::extension_header_size() + length;
+    return true;
+  }
+
+
+  bool SafetyDataT::find_application_extension (SRPExtensionType type, const byte*& value, uint8_t& length) const
+  {
+    const size_t app_length = std::min<size_t> (application_extensions_length, maxApplicationExtensionsSize);
+    size_t offs = 0;
+    while (offs + SRPPayloadT::extension_header_size() <= app_length)
+      {
+	const byte* p = application_extensions + offs;
+	if (offs + SRPPayloadT::extension_header_size() + p[1] > app_length)
+	  return false;
+	if (p[0] == type)
+	  {
+	    value  = p + 2;
+	    length = p[1];
+	    return true;
+	  }
+	offs += SRPPayloadT::extension_header_size() + p[1];
+      }
+    return false;
+  }
+  
+
   std::ostream& operator<<(std::ostream& os, const ExtendedSafetyDataT& esd)
   {
       os << "ExtendedSafetyDataT { safetyData = " << esd.safetyData
@@ -42,4 +117,263 @@ namespace dcp::srp {
       return os;
   }
   
+
+
+  // -----------------------------------------------------------------
+
+  // NaN is mapped to zero, as converting it to an integer is undefined
+  template <typename T>
+  static inline T quantize (double value, double step)
+  {
+    double q = std::round (value / step);
+    if (std::isnan (q))
+      return 0;
+    q = std::clamp (q, (double) std::numeric_limits<T>::min(), (double) std::numeric_limits<T>::max());
+    return (T) q;
+  }
+  
+  
+  void SRPPayloadT::serialize (AssemblyArea& area) const
+  {
+    area.serialize_byte (version);
+    nodeId.serialize (area);
+    area.serialize_uint32_n (seqno);
+    area.serialize_uint16_n (ageMS);
+    area.serialize_uint32_n ((uint32_t) qx);
+    area.serialize_uint32_n ((uint32_t) qy);
+    area.serialize_uint32_n ((uint32_t) qz);
+    if (has_velocity)
+      {
+	area.serialize_byte (extVelocity);
+	area.serialize_byte ((byte) velocity_size());
+	area.serialize_uint16_n (qspeed);
+	area.serialize_uint16_n (qheading);
+      }
+    if (has_battery)
+      {
+	area.serialize_byte (extBattery);
+	area.serialize_byte ((byte) battery_size());
+	area.serialize_byte (qbattery);
+      }
+    if (has_waypoint)
+      {
+	area.serialize_byte (extWaypoint);
+	area.serialize_byte ((byte) waypoint_size());
+	area.serialize_uint32_n ((uint32_t) qwx);
+	area.serialize_uint32_n ((uint32_t) qwy);
+	area.serialize_uint32_n ((uint32_t) qwz);
+      }
+    const size_t app_length = std::min<size_t> (application_extensions_length, maxApplicationExtensionsSize);
+    if (app_length > 0)
+      area.serialize_byte_block (app_length, application_extensions);
+  }
+
+
+  void SRPPayloadT::deserialize (DisassemblyArea& area)
+  {
+    version = area.deserialize_byte ();
+    if (version != currentVersion)
+      throw DisassemblyAreaException ("SRPPayloadT::deserialize", "unsupported payload version");
+    nodeId.deserialize (area);
+    area.deserialize_uint32_n (seqno);
+    area.deserialize_uint16_n (ageMS);
+    uint32_t ux, uy, uz;
+    area.deserialize_uint32_n (ux);
+    area.deserialize_uint32_n (uy);
+    area.deserialize_uint32_n (uz);
+    qx = (int32_t) ux;
+    qy = (int32_t) uy;
+    qz = (int32_t) uz;
+
+    has_velocity = has_battery = has_waypoint = false;
+    application_extensions_length = 0;
+
+    // extensions extend up to the end of the payload
+    while (area.available() > 0)
+      {
+	if (area.available() < extension_header_size())
+	  throw DisassemblyAreaException ("SRPPayloadT::deserialize", "truncated extension header");
+	SRPExtensionType type   = area.deserialize_byte ();
+	uint8_t          length = area.deserialize_byte ();
+	if (area.available() < length)
+	  throw DisassemblyAreaException ("SRPPayloadT::deserialize", "truncated extension");
+
+	size_t known_size = 0;
+	switch (type)
+	  {
+	  case extVelocity:
+	    known_size = velocity_size ();
+	    break;
+	  case extBattery:
+	    known_size = battery_size ();
+	    break;
+	  case extWaypoint:
+	    known_size = waypoint_size ();
+	    break;
+	  default:
+	    break;
+	  }
+	if (length < known_size)
+	  throw DisassemblyAreaException ("SRPPayloadT::deserialize", "extension too short");
+
+	switch (type)
+	  {
+	  case extVelocity:
+	    area.deserialize_uint16_n (qspeed);
+	    area.deserialize_uint16_n (qheading);
+	    has_velocity = true;
+	    break;
+	  case extBattery:
+	    qbattery    = area.deserialize_byte ();
+	    has_battery = true;
+	    break;
+	  case extWaypoint:
+	    area.deserialize_uint32_n (ux);
+	    area.deserialize_uint32_n (uy);
+	    area.deserialize_uint32_n (uz);
+	    qwx = (int32_t) ux;
+	    qwy = (int32_t) uy;
+	    qwz = (int32_t) uz;
+	    has_waypoint = true;
+	    break;
+	  default:
+	    // application extensions are kept as long as there is space
+	    if (    (type >= firstApplicationExtensionType)
+		and (application_extensions_length + extension_header_size() + length <= maxApplicationExtensionsSize))
+	      {
+		byte* p = application_extensions + application_extensions_length;
+		p[0] = type;
+		p[1] = length;
+		if (length > 0)
+		  area.deserialize_byte_block (length, p + 2);
+		application_extensions_length += extension_header_size() + length;
+		continue;
+	      }
+	    break;
+	  }
+
+	// skip unknown extensions and unknown trailing parts
+	if (length > known_size)
+	  area.view_byte_block (length - known_size);
+      }
+  }
+
+
+  void SRPPayloadT::encode (const SafetyDataT& sd,
+			    NodeIdentifierT node_id,
+			    uint32_t seq,
+			    uint32_t age_ms,
+			    const SRPQuantizationParameters& qp,
+			    size_t budget)
+  {
+    version = currentVersion;
+    nodeId  = node_id;
+    seqno   = seq;
+    ageMS   = (uint16_t) std::min<uint32_t> (age_ms, std::numeric_limits<uint16_t>::max());
+    qx      = quantize<int32_t> (sd.position_x - qp.origin_x, qp.resolution);
+    qy      = quantize<int32_t> (sd.position_y - qp.origin_y, qp.resolution);
+    qz      = quantize<int32_t> (sd.position_z - qp.origin_z, qp.resolution);
+
+    has_velocity = has_battery = has_waypoint = false;
+    application_extensions_length = 0;
+    size_t used = fixed_size();
+    auto fits = [&] (size_t size)
+    {
+      if (used + size > budget)
+	return false;
+      used += size;
+      return true;
+    };
+    
+    // optional extensions with non-finite values are treated as not valid
+    if (sd.has_velocity and std::isfinite (sd.speed) and std::isfinite (sd.heading)
+	and fits (extension_header_size() + velocity_size()))
+      {
+	double hdg = std::fmod (sd.heading, 360.0);
+	if (hdg < 0) hdg += 360.0;
+	has_velocity = true;
+	qspeed       = quantize<uint16_t> (sd.speed, 0.01);
+	qheading     = (uint16_t) ((uint32_t) std::round (hdg * 65536.0 / 360.0) & 0xFFFF);
+      }
+    if (sd.has_battery and std::isfinite (sd.battery_level) and fits (extension_header_size() + battery_size()))
+      {
+	has_battery  = true;
+	qbattery     = (uint8_t) std::clamp (std::round (sd.battery_level * 2), 0.0, 200.0);
+      }
+    if (sd.has_waypoint and std::isfinite (sd.waypoint_x) and std::isfinite (sd.waypoint_y) and std::isfinite (sd.waypoint_z)
+	and fits (extension_header_size() + waypoint_size()))
+      {
+	has_waypoint = true;
+	qwx          = quantize<int32_t> (sd.waypoint_x - qp.origin_x, qp.resolution);
+	qwy          = quantize<int32_t> (sd.waypoint_y - qp.origin_y, qp.resolution);
+	qwz          = quantize<int32_t> (sd.waypoint_z - qp.origin_z, qp.resolution);
+      }
+
+    // application extensions are included record by record, the
+    // length comes from the client and is not trusted
+    const size_t app_length = std::min<size_t> (sd.application_extensions_length, maxApplicationExtensionsSize);
+    size_t offs = 0;
+    while (offs + extension_header_size() <= app_length)
+      {
+	const byte* p    = sd.application_extensions + offs;
+	size_t      size = extension_header_size() + p[1];
+	if ((offs + size <= app_length) and fits (size))
+	  {
+	    std::memcpy (application_extensions + application_extensions_length, p, size);
+	    application_extensions_length += size;
+	  }
+	offs += size;
+      }
+  }
+
+
+  ExtendedSafetyDataT SRPPayloadT::decode (const SRPQuantizationParameters& qp, const TimeStampT& received_at) const
+  {
+    ExtendedSafetyDataT esd;
+    esd.safetyData.position_x    = qp.origin_x + qx * qp.resolution;
+    esd.safetyData.position_y    = qp.origin_y + qy * qp.resolution;
+    esd.safetyData.position_z    = qp.origin_z + qz * qp.resolution;
+    esd.safetyData.has_velocity  = has_velocity;
+    esd.safetyData.speed         = has_velocity ? qspeed * 0.01 : 0;
+    esd.safetyData.heading       = has_velocity ? qheading * 360.0 / 65536.0 : 0;
+    esd.safetyData.has_battery   = has_battery;
+    esd.safetyData.battery_level = has_battery ? qbattery * 0.5 : 0;
+    esd.safetyData.has_waypoint  = has_waypoint;
+    esd.safetyData.waypoint_x    = has_waypoint ? qp.origin_x + qwx * qp.resolution : 0;
+    esd.safetyData.waypoint_y    = has_waypoint ? qp.origin_y + qwy * qp.resolution : 0;
+    esd.safetyData.waypoint_z    = has_waypoint ? qp.origin_z + qwz * qp.resolution : 0;
+    esd.safetyData.application_extensions_length = application_extensions_length;
+    std::memcpy (esd.safetyData.application_extensions, application_extensions, application_extensions_length);
+    esd.nodeId                   = nodeId;
+    esd.timeStamp                = received_at;
+    esd.timeStamp.tStamp        -= std::chrono::milliseconds (ageMS);
+    esd.seqno                    = seqno;
+    return esd;
+  }
+
+
+  std::ostream& operator<<(std::ostream& os, const SRPPayloadT& pld)
+  {
+    os << "SRPPayloadT { version = " << (int) pld.version
+       << " , nodeId = " << pld.nodeId
+       << " , seqno = " << pld.seqno
+       << " , ageMS = " << pld.ageMS
+       << " , qx = " << pld.qx
+       << " , qy = " << pld.qy
+       << " , qz = " << pld.qz;
+    if (pld.has_velocity)
+      os << " , qspeed = " << pld.qspeed
+	 << " , qheading = " << pld.qheading;
+    if (pld.has_battery)
+      os << " , qbattery = " << (int) pld.qbattery;
+    if (pld.has_waypoint)
+      os << " , qwx = " << pld.qwx
+	 << " , qwy = " << pld.qwy
+	 << " , qwz = " << pld.qwz;
+    if (pld.application_extensions_length > 0)
+      os << " , applicationExtensionBytes = " << (int) pld.application_extensions_length;
+    os << " }";
+    return os;
+  }
+  
 }
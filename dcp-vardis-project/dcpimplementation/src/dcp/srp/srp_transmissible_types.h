@@ -20,20 +20,45 @@
 
 #pragma once
 
+#include <algorithm>
+#include <dcp/common/area.h>
 #include <dcp/common/global_types_constants.h>
+#include <dcp/common/transmissible_type.h>
 
 /**
- * @brief This module contains the two key transmissible data types of
- *        the SRP protocol
+ * @brief This module contains the key data types of the SRP protocol
  *
- * Note that for simplicity we do not make use of the serialization
- * framework, and just use these types as is.
+ * SafetyDataT and ExtendedSafetyDataT are the in-memory
+ * representations used by clients and in the neighbour store. On the
+ * wire, SRP uses the compact and extensible SRPPayloadT format
+ * defined below, which uses the serialization framework.
  */
 
 
 namespace dcp::srp {
 
 
+  /**
+   * @brief Type codes of the extensions of an SRP payload. Types from
+   *        firstApplicationExtensionType upwards are defined by
+   *        applications and carried by SRP without interpretation.
+   */
+  typedef uint8_t SRPExtensionType;
+
+  const SRPExtensionType  extVelocity                    = 1;
+  const SRPExtensionType  extBattery                     = 2;
+  const SRPExtensionType  extWaypoint                    = 3;
+  const SRPExtensionType  firstApplicationExtensionType  = 128;
+
+
+  /**
+   * @brief Space in SafetyDataT (and in SRP payloads) for
+   *        application-defined extensions, including their type and
+   *        length bytes
+   */
+  const size_t maxApplicationExtensionsSize = 32;
+
+  
   /**
    * @brief Contains the position of the sender node
    *
@@ -44,6 +69,54 @@ namespace dcp::srp {
     double  position_x;
     double  position_y;
     double  position_z;
+    bool    has_velocity = false;   /*!< Whether speed and heading are valid and to be transmitted */
+    double  speed        = 0;       /*!< Horizontal speed in m/s */
+    double  heading      = 0;       /*!< Heading in degrees, clockwise from the y axis */
+    bool    has_battery  = false;   /*!< Whether battery_level is valid and to be transmitted */
+    double  battery_level = 0;      /*!< Remaining battery charge in percent */
+    bool    has_waypoint = false;   /*!< Whether the waypoint is valid and to be transmitted */
+    double  waypoint_x   = 0;       /*!< Position the node is currently heading for */
+    double  waypoint_y   = 0;
+    double  waypoint_z   = 0;
+    uint8_t application_extensions_length = 0;                        /*!< Bytes used in application_extensions */
+    byte    application_extensions [maxApplicationExtensionsSize];    /*!< Application-defined extensions as type / length / value records */
+
+    /**
+     * @brief Returns the safety data with the position extrapolated
+     *        by the given time, assuming constant horizontal speed and
+     *        heading. Returns an unchanged copy if there is no velocity
+     */
+    SafetyDataT extrapolated (double seconds) const;
+
+    /**
+     * @brief Returns the Euclidean distance between the positions
+     */
+    double distance_to (const SafetyDataT& other) const;
+
+    /**
+     * @brief Appends an application-defined extension. Returns false
+     *        if the type is not an application type or the remaining
+     *        space is too small
+     */
+    bool add_application_extension (SRPExtensionType type, const byte* value, uint8_t length);
+
+    /**
+     * @brief Looks up the first application-defined extension of the
+     *        given type, value points into application_extensions.
+     *        Returns false if there is none
+     */
+    bool find_application_extension (SRPExtensionType type, const byte*& value, uint8_t& length) const;
+
+    /**
+     * @brief Checks that application_extensions_length stays within
+     *        application_extensions. Clients write this field
+     *        directly, so it must be checked before use
+     */
+    inline bool has_valid_application_extensions_length () const
+    {
+      return application_extensions_length <= maxApplicationExtensionsSize;
+    };
+
     friend std::ostream& operator<<(std::ostream& os, const SafetyDataT& sd);
   } SafetyDataT;
   
@@ -61,5 +134,140 @@ namespace dcp::srp {
     friend std::ostream& operator<<(std::ostream& os, const ExtendedSafetyDataT& esd);    
   } ExtendedSafetyDataT;
 
+
+  /**
+   * @brief Parameters for quantizing positions and velocities in
+   *        SRPPayloadT. All nodes must use the same values.
+   */
+  typedef struct SRPQuantizationParameters {
+    double origin_x    = 0;      /*!< Position corresponding to the quantized value zero */
+    double origin_y    = 0;
+    double origin_z    = 0;
+    double resolution  = 0.01;   /*!< Position quantization step, in m */
+  } SRPQuantizationParameters;
+
+
+  /**
+   * @brief The serialized SRP payload
+   *
+   * Positions are transmitted as signed 32-bit multiples of the
+   * position resolution relative to a configured origin (with 1 cm
+   * resolution covering +/- 21000 km). Instead of an absolute
+   * timestamp, which would require synchronized clocks, the payload
+   * carries the age (in ms) of the safety data at transmission time,
+   * from which the receiver reconstructs a timestamp in its own
+   * clock. All fields are in network byte order.
+   *
+   * Layout: version (1 byte), node identifier (6 bytes), sequence
+   * number (4 bytes), age (2 bytes), x/y/z (4 bytes each), followed
+   * by extensions up to the end of the payload. Each extension
+   * consists of a type byte, a length byte and that many value
+   * bytes. Receivers skip extensions of unknown type and ignore
+   * trailing bytes of known extensions, so that extensions can be
+   * added or grown without updating all nodes at once. Payloads of a
+   * different version are rejected. For the same reason SRP registers
+   * with BP for payloads of up to max_wire_size() bytes, which does
+   * not depend on the extensions known to this build, while own
+   * payloads never exceed max_size().
+   *
+   * Known extensions are the velocity (speed in cm/s and heading in
+   * 1/65536 of a full circle, 2 bytes each), the battery level (in
+   * half percent, 1 byte) and a waypoint (quantized like the
+   * position, 4 bytes per coordinate). Application-defined
+   * extensions are carried unchanged.
+   */
+  class SRPPayloadT : public TransmissibleType<1 + NodeIdentifierT::fixed_size() + 4 + 2 + 3*4> {
+  public:
+
+    static const byte currentVersion = 2;   /*!< The earlier format without extensions had 0 or 1 in this byte */
+
+    static constexpr size_t extension_header_size () { return 2; };
+    static constexpr size_t velocity_size () { return 2*sizeof(uint16_t); };
+    static constexpr size_t battery_size () { return sizeof(uint8_t); };
+    static constexpr size_t waypoint_size () { return 3*sizeof(int32_t); };
+    static constexpr size_t max_size ()
+    {
+      return   fixed_size()
+	     + extension_header_size() + velocity_size()
+	     + extension_header_size() + battery_size()
+	     + extension_header_size() + waypoint_size()
+	     + maxApplicationExtensionsSize;
+    };
+    static constexpr size_t max_wire_size () { return 255; };
+
+    byte             version   = currentVersion;
+    NodeIdentifierT  nodeId;
+    uint32_t         seqno     = 0;
+    uint16_t         ageMS     = 0;
+    int32_t          qx        = 0;
+    int32_t          qy        = 0;
+    int32_t          qz        = 0;
+    bool             has_velocity  = false;
+    uint16_t         qspeed    = 0;
+    uint16_t         qheading  = 0;
+    bool             has_battery   = false;
+    uint8_t          qbattery  = 0;
+    bool             has_waypoint  = false;
+    int32_t          qwx       = 0;
+    int32_t          qwy       = 0;
+    int32_t          qwz       = 0;
+    uint8_t          application_extensions_length = 0;
+    byte             application_extensions [maxApplicationExtensionsSize];
+
+
+    virtual size_t total_size () const
+    {
+      return   fixed_size()
+	     + (has_velocity ? extension_header_size() + velocity_size() : 0)
+	     + (has_battery  ? extension_header_size() + battery_size() : 0)
+	     + (has_waypoint ? extension_header_size() + waypoint_size() : 0)
+	     + std::min<size_t> (application_extensions_length, maxApplicationExtensionsSize);
+    };
+
+    void serialize (AssemblyArea& area) const;
+    void deserialize (DisassemblyArea& area);
+
+
+    /**
+     * @brief Fills in the payload from own safety data. Positions
+     *        outside the representable range are clamped to it, a
+     *        NaN position coordinate is transmitted as the origin
+     *        coordinate, and optional extensions with non-finite
+     *        values are left out
+     *
+     * @param sd: own safety data
+     * @param node_id: own node identifier
+     * @param seq: sequence number of this payload
+     * @param age_ms: time since the safety data was set, saturates
+     *        at the largest representable value
+     * @param qp: quantization parameters
+     * @param budget: maximum total size of the payload. Extensions
+     *        are included in the order velocity, battery, waypoint
+     *        and application extensions as long as they fit, a
+     *        budget below fixed_size() is treated as fixed_size()
+     */
+    void encode (const SafetyDataT& sd,
+		 NodeIdentifierT node_id,
+		 uint32_t seq,
+		 uint32_t age_ms,
+		 const SRPQuantizationParameters& qp,
+		 size_t budget = max_size());
+
+
+    /**
+     * @brief Reconstructs an ExtendedSafetyDataT record from the
+     *        payload
+     *
+     * @param qp: quantization parameters
+     * @param received_at: reception time, the timestamp of the
+     *        result is this time minus the transmitted age
+     */
+    ExtendedSafetyDataT decode (const SRPQuantizationParameters& qp, const TimeStampT& received_at) const;
+
+    friend std::ostream& operator<<(std::ostream& os, const SRPPayloadT& pld);
+  };
+
+  static_assert (SRPPayloadT::max_size() <= SRPPayloadT::max_wire_size(), "SRPPayloadT: own payloads must fit into the registered wire size");
+
   
 };  // namespace dcp::srp
@@ -21,6 +21,8 @@
 #include <queue>
 #include <thread>
 #include <chrono>
+#include <dcp/common/area.h>
+#include <dcp/common/realtime.h>
 #include <dcp/bp/bpclient_lib.h>
 #include <dcp/bp/bp_service_primitives.h>
 #include <dcp/srp/srp_transmitter.h>
@@ -34,63 +36,80 @@ namespace dcp::srp {
 
   // -----------------------------------------------------------------
   
+  void transmit_payload (SRPRuntimeData& runtime, DeadReckoningFilter& dr_filter)
+  {
+    if (not runtime.srp_store.get_srp_isactive())
+      return;
+    
+    ScopedOwnSDMutex own_sd_lock (runtime);
+    
+    if (not runtime.srp_store.get_own_safety_data_written_flag ())
+      return;
+    
+    TimeStampT curr_time = TimeStampT::get_current_system_time();
+    TimeStampT past_time = runtime.srp_store.get_own_safety_data_timestamp();
+    
+    // do not generate payload if there has been no new safety
+    // data for a while
+    if (curr_time.milliseconds_passed_since(past_time) >= runtime.srp_config.srp_conf.srpKeepaliveTimeoutMS)
+      {
+	if (runtime.srp_store.get_own_safety_data_written_flag ())
+	  DCPLOG_INFO(log_tx) << "Stop sending own safety data after not being updated for a while.";
+	runtime.srp_store.set_own_safety_data_written_flag (false);
+	return;
+      }
+    
+    SafetyDataT own_sd = runtime.srp_store.get_own_safety_data ();
+    if (runtime.srp_config.srp_conf.srpDeadReckoning)
+      {
+	if (not dr_filter.transmission_needed (own_sd, past_time, curr_time))
+	  return;
+	dr_filter.record_transmission (own_sd, past_time, curr_time);
+      }
+    
+    SRPPayloadT pld;
+    uint32_t    seqno = runtime.srp_store.get_own_sequence_number ();
+    pld.encode (own_sd,
+		runtime.srp_store.get_own_node_identifier (),
+		seqno,
+		curr_time.milliseconds_passed_since (past_time),
+		runtime.srp_config.srp_conf.get_quantization_parameters (),
+		runtime.srp_config.srp_conf.srpPayloadBudget);
+    runtime.srp_store.set_own_sequence_number (seqno + 1);
+
+    byte pld_buffer [sizeof(BPTransmitPayload_Request) + SRPPayloadT::max_size()];
+    BPTransmitPayload_Request*  pldReq_ptr = new (pld_buffer) BPTransmitPayload_Request;
+    MemoryChunkAssemblyArea area ("srp-tx", SRPPayloadT::max_size(), pld_buffer + sizeof(BPTransmitPayload_Request));
+    pld.serialize (area);
+    pldReq_ptr->protocolId = BP_PROTID_SRP;
+    pldReq_ptr->length     = area.used();
+    
+    DcpStatus retval = runtime.pSCS->transmit_payload (BPLengthT(sizeof(BPTransmitPayload_Request) + area.used()), pld_buffer);
+    if (retval != BP_STATUS_OK)
+      {
+	DCPLOG_FATAL(log_tx)
+	  << "transmit payload request failed, status = "
+	  << bp_status_to_string (retval)
+	  << ". Exiting.";
+	runtime.srp_exitFlag = true;
+      }	
+  }
+  
+  // -----------------------------------------------------------------
+  
   void transmitter_thread (SRPRuntimeData& runtime)
   {
     DCPLOG_INFO(log_tx) << "Starting transmit thread.";
 
-    BPShmControlSegment& CS = *runtime.pSCS;
-    uint16_t          sleep_time         = runtime.srp_config.srp_conf.srpGenerationPeriodMS;
-    uint16_t          keepalive_timeout  = runtime.srp_config.srp_conf.srpKeepaliveTimeoutMS;
-    NodeIdentifierT   own_node_id        = runtime.srp_store.get_own_node_identifier ();
+    uint16_t             sleep_time  = runtime.srp_config.srp_conf.srpGenerationPeriodMS;
+    DeadReckoningFilter  dr_filter (runtime.srp_config.srp_conf.srpDeadReckoningThreshold,
+				    runtime.srp_config.srp_conf.srpDeadReckoningMaxIntervalMS);
 
     try {
       while (not runtime.srp_exitFlag)
 	{
-	  std::this_thread::sleep_for (std::chrono::milliseconds (sleep_time));
-	  
-	  if (not runtime.srp_store.get_srp_isactive())
-	    continue;
-	  
-	  ScopedOwnSDMutex own_sd_lock (runtime);
-	  
-	  if (not runtime.srp_store.get_own_safety_data_written_flag ())
-	    continue;
-	  
-	  TimeStampT curr_time = TimeStampT::get_current_system_time();
-	  TimeStampT past_time = runtime.srp_store.get_own_safety_data_timestamp();
-	  
-	  // do not generate payload if there has been no new safety
-	  // data for a while
-	  if (curr_time.milliseconds_passed_since(past_time) >= keepalive_timeout)
-	    {
-	      if (runtime.srp_store.get_own_safety_data_written_flag ())
-		DCPLOG_INFO(log_tx) << "Stop sending own safety data after not being updated for a while.";
-	      runtime.srp_store.set_own_safety_data_written_flag (false);
-	      continue;
-	    }
-	  
-	  byte pld_buffer [sizeof(BPTransmitPayload_Request) + sizeof(ExtendedSafetyDataT) + 16];
-	  BPTransmitPayload_Request*  pldReq_ptr = new (pld_buffer) BPTransmitPayload_Request;
-	  byte* pld_ptr = pld_buffer + sizeof(BPTransmitPayload_Request);
-	  pldReq_ptr->protocolId = BP_PROTID_SRP;
-	  pldReq_ptr->length     = sizeof(ExtendedSafetyDataT);
-	  ExtendedSafetyDataT* pESD = new (pld_ptr) ExtendedSafetyDataT;
-	  pESD->safetyData = runtime.srp_store.get_own_safety_data ();
-	  pESD->nodeId     = own_node_id;
-	  pESD->timeStamp  = TimeStampT::get_current_system_time();
-	  pESD->seqno      = runtime.srp_store.get_own_sequence_number ();
-	  runtime.srp_store.set_own_sequence_number (pESD->seqno + 1);
-	  
-	  DcpStatus retval = CS.transmit_payload (BPLengthT(sizeof(BPTransmitPayload_Request) + sizeof(ExtendedSafetyDataT)), pld_buffer);
-	  if (retval != BP_STATUS_OK)
-	    {
-	      DCPLOG_FATAL(log_tx)
-		<< "transmit payload request failed, status = "
-		<< bp_status_to_string (retval)
-		<< ". Exiting.";
-	      runtime.srp_exitFlag = true;
-	      return;
-	    }	
+	  sleep_for_measured (std::chrono::milliseconds (sleep_time), runtime.metricTxWakeupLatency);
+	  transmit_payload (runtime, dr_filter);
 	}
     }
     catch (DcpException& e)
@@ -24,6 +24,69 @@
 
 namespace dcp::srp {
 
+
+  /**
+   * @brief Decides whether own safety data needs to be transmitted
+   *        when dead reckoning is enabled
+   *
+   * Remembers the last transmitted safety data together with the
+   * time it was written. A transmission is needed when nothing has
+   * been transmitted yet, when the maximum interval has passed since
+   * the last transmission, or when the position extrapolated from the
+   * last transmitted safety data to the write time of the current
+   * safety data deviates from the current position by more than the
+   * threshold. This is what neighbours will see, since they
+   * extrapolate from the same data.
+   */
+  class DeadReckoningFilter {
+  private:
+    double       threshold;
+    uint32_t     max_interval_ms;
+    bool         have_sent = false;
+    SafetyDataT  last_sd;
+    TimeStampT   last_sd_written;
+    TimeStampT   last_sent;
+
+  public:
+    DeadReckoningFilter (double threshold_m, uint32_t max_interval) : threshold (threshold_m), max_interval_ms (max_interval) {};
+
+    /**
+     * @brief Checks whether the current safety data has to be
+     *        transmitted
+     *
+     * @param sd: current own safety data
+     * @param sd_written: time at which sd was written
+     * @param now: current time
+     */
+    inline bool transmission_needed (const SafetyDataT& sd, const TimeStampT& sd_written, const TimeStampT& now) const
+    {
+      if ((not have_sent) or (now.milliseconds_passed_since (last_sent) >= max_interval_ms))
+	return true;
+      double dt = sd_written.milliseconds_passed_since (last_sd_written) / 1000.0;
+      return last_sd.extrapolated (dt).distance_to (sd) > threshold;
+    };
+
+    /**
+     * @brief Records that the given safety data has been transmitted
+     */
+    inline void record_transmission (const SafetyDataT& sd, const TimeStampT& sd_written, const TimeStampT& now)
+    {
+      have_sent       = true;
+      last_sd         = sd;
+      last_sd_written = sd_written;
+      last_sent       = now;
+    };
+  };
+
+  
+  /**
+   * @brief Constructs an SRP payload from the own safety data (if it
+   *        is current and, with dead reckoning, deviates enough) and
+   *        hands it over to BP. Sets the exit flag when BP refuses it.
+   */
+  void transmit_payload (SRPRuntimeData& runtime, DeadReckoningFilter& dr_filter);
+
+  
   /**
    * @brief Start transmitter thread (constructing and transmitting
    *        SRP payloads), run it until exitFlag is set
@@ -18,6 +18,7 @@
  */
 
 
+#include <cmath>
 #include <functional>
 #include <dcp/srp/srp_constants.h>
 #include <dcp/srp/srpclient_lib.h>
@@ -29,12 +30,28 @@ namespace dcp {
   // -----------------------------------------------------------------------------------
 
   SRPClientRuntime::SRPClientRuntime (const SRPClientConfiguration& client_conf)
-    : srp_store (client_conf.shm_conf_store.shmAreaName.c_str(), false)
+    : srp_store (client_conf.shm_conf_store.shmAreaName.c_str(), false),
+      snapshot_buffer (DefaultSRPStoreType::get_max_neighbours ())
   {
   }
 
   // -----------------------------------------------------------------------------------
 
+  SRPClientRuntime::~SRPClientRuntime ()
+  {
+    if (events_subscribed)
+      unsubscribe_neighbour_events ();
+  }
+
+  // -----------------------------------------------------------------------------------
+
+  static inline bool has_finite_position (const SafetyDataT& sd)
+  {
+    return std::isfinite (sd.position_x) and std::isfinite (sd.position_y) and std::isfinite (sd.position_z);
+  }
+
+  // -----------------------------------------------------------------------------------
+
   NodeIdentifierT SRPClientRuntime::get_own_node_identifier () const
   {
     return srp_store.get_own_node_identifier ();
@@ -44,6 +61,9 @@ namespace dcp {
 
   DcpStatus SRPClientRuntime::set_own_safety_data (const SafetyDataT& new_sd)
   {
+    if (not new_sd.has_valid_application_extensions_length ())
+      return SRP_STATUS_ILLEGAL_SAFETY_DATA;
+    
     srp_store.lock_own_safety_data ();
     srp_store.set_own_safety_data (new_sd);
     srp_store.unlock_own_safety_data ();
@@ -54,16 +74,68 @@ namespace dcp {
   
   // -----------------------------------------------------------------------------------
 
-  DcpStatus SRPClientRuntime::get_all_neighbours_node_information (std::list<NodeInformation>& neighbour_list)
+  void SRPClientRuntime::extrapolate_to_now (std::list<NodeInformation>& neighbour_list)
   {
-    std::function<bool (const ExtendedSafetyDataT&)> all_predicate =
-      [] (const srp::ExtendedSafetyDataT&)
+    TimeStampT now = TimeStampT::get_current_system_time ();
+    for (auto& ni : neighbour_list)
       {
-	return true;
-      };
+	if (not ni.esd.safetyData.has_velocity)
+	  continue;
+	double dt = now.milliseconds_passed_since (ni.esd.timeStamp) / 1000.0;
+	ni.esd.safetyData = ni.esd.safetyData.extrapolated (dt);
+      }
+  }
+
+  
+  // -----------------------------------------------------------------------------------
+
+  DcpStatus SRPClientRuntime::get_all_neighbours_node_information (std::list<NodeInformation>& neighbour_list)
+  {
+    neighbour_list.clear ();
+    auto n = srp_store.read_neighbour_snapshot (snapshot_buffer.data(), snapshot_buffer.size());
+    if (not n)
+      return SRP_STATUS_SNAPSHOT_UNAVAILABLE;
+    neighbour_list.assign (snapshot_buffer.begin(), snapshot_buffer.begin() + *n);
+    extrapolate_to_now (neighbour_list);
+    
+    return SRP_STATUS_OK;
+  }
+
+  
+  // -----------------------------------------------------------------------------------
+
+  DcpStatus SRPClientRuntime::get_matching_neighbours_node_information (std::function<bool (const ExtendedSafetyDataT&)> predicate,
+									std::list<NodeInformation>& neighbour_list)
+  {
+    neighbour_list.clear ();
+    auto n = srp_store.read_neighbour_snapshot (snapshot_buffer.data(), snapshot_buffer.size());
+    if (not n)
+      return SRP_STATUS_SNAPSHOT_UNAVAILABLE;
+    for (size_t i = 0; i < *n; i++)
+      if (predicate (snapshot_buffer[i].esd))
+	neighbour_list.push_back (snapshot_buffer[i]);
+    extrapolate_to_now (neighbour_list);
+    
+    return SRP_STATUS_OK;
+  }
+
+  
+  // -----------------------------------------------------------------------------------
+
+  DcpStatus SRPClientRuntime::get_neighbours_within_radius (const SafetyDataT& centre,
+							    double radius,
+							    NodeInformation* buffer,
+							    size_t buffer_size,
+							    size_t& number_found)
+  {
+    number_found = 0;
+    if ((not std::isfinite (radius)) or (radius < 0))
+      return SRP_STATUS_ILLEGAL_DISTANCE;
+    if (not has_finite_position (centre))
+      return SRP_STATUS_ILLEGAL_POSITION;
     
     srp_store.lock_neighbour_table ();
-    neighbour_list = srp_store.list_matching_node_information (all_predicate);
+    number_found = srp_store.find_neighbours_within_radius (centre, radius, buffer, buffer_size);
     srp_store.unlock_neighbour_table ();
     
     return SRP_STATUS_OK;
@@ -72,17 +144,133 @@ namespace dcp {
   
   // -----------------------------------------------------------------------------------
 
-  DcpStatus SRPClientRuntime::get_matching_neighbours_node_information (std::function<bool (const ExtendedSafetyDataT&)> predicate,
-									std::list<NodeInformation>& neighbour_list)
+  DcpStatus SRPClientRuntime::get_closest_approach_threats (double horizon,
+							    double max_distance,
+							    size_t k,
+							    CPAThreat* buffer,
+							    size_t& number_found)
+  {
+    number_found = 0;
+    if ((not std::isfinite (max_distance)) or (max_distance < 0))
+      return SRP_STATUS_ILLEGAL_DISTANCE;
+    if ((not std::isfinite (horizon)) or (horizon < 0))
+      return SRP_STATUS_ILLEGAL_HORIZON;
+    
+    srp_store.lock_own_safety_data ();
+    SafetyDataT own_sd     = srp_store.get_own_safety_data ();
+    TimeStampT  own_sd_ts  = srp_store.get_own_safety_data_timestamp ();
+    srp_store.unlock_own_safety_data ();
+
+    TimeStampT now = TimeStampT::get_current_system_time ();
+    own_sd = own_sd.extrapolated (now.milliseconds_passed_since (own_sd_ts) / 1000.0);
+    
+    srp_store.lock_neighbour_table ();
+    number_found = srp_store.find_closest_approach_threats (own_sd, now, horizon, max_distance, k, buffer);
+    srp_store.unlock_neighbour_table ();
+    
+    return SRP_STATUS_OK;
+  }
+
+  
+  // -----------------------------------------------------------------------------------
+
+  DcpStatus SRPClientRuntime::get_nearest_neighbours (const SafetyDataT& centre,
+						      size_t k,
+						      NodeInformation* buffer,
+						      size_t& number_found)
   {
+    number_found = 0;
+    if (not has_finite_position (centre))
+      return SRP_STATUS_ILLEGAL_POSITION;
+    
     srp_store.lock_neighbour_table ();
-    neighbour_list = srp_store.list_matching_node_information (predicate);
+    number_found = srp_store.find_nearest_neighbours (centre, k, buffer);
     srp_store.unlock_neighbour_table ();
     
     return SRP_STATUS_OK;
   }
   
   
+  // -----------------------------------------------------------------------------------
+
+  DcpStatus SRPClientRuntime::subscribe_neighbour_events (const NeighbourEventFilter& filter)
+  {
+    if (events_subscribed)
+      return SRP_STATUS_ALREADY_SUBSCRIBED;
+    
+    srp_store.lock_neighbour_table ();
+    events_subscribed = srp_store.subscribe_neighbour_events (filter, event_subscription_id);
+    srp_store.unlock_neighbour_table ();
+
+    return events_subscribed ? SRP_STATUS_OK : SRP_STATUS_NO_FREE_SUBSCRIPTION;
+  }
+  
+  
+  // -----------------------------------------------------------------------------------
+
+  DcpStatus SRPClientRuntime::unsubscribe_neighbour_events ()
+  {
+    if (not events_subscribed)
+      return SRP_STATUS_NOT_SUBSCRIBED;
+    
+    srp_store.lock_neighbour_table ();
+    srp_store.unsubscribe_neighbour_events (event_subscription_id);
+    srp_store.unlock_neighbour_table ();
+    events_subscribed = false;
+
+    return SRP_STATUS_OK;
+  }
+  
+  
+  // -----------------------------------------------------------------------------------
+
+  DcpStatus SRPClientRuntime::get_neighbour_events_nowait (NeighbourEvent* buffer,
+							   size_t buffer_size,
+							   size_t& number_retrieved,
+							   bool& more_events)
+  {
+    number_retrieved = 0;
+    more_events      = false;
+    if (not events_subscribed)
+      return SRP_STATUS_NOT_SUBSCRIBED;
+
+    number_retrieved = srp_store.retrieve_neighbour_events (event_subscription_id, buffer, buffer_size, more_events, 0);
+    return SRP_STATUS_OK;
+  }
+  
+  
+  // -----------------------------------------------------------------------------------
+
+  DcpStatus SRPClientRuntime::get_neighbour_events_wait (NeighbourEvent* buffer,
+							 size_t buffer_size,
+							 size_t& number_retrieved,
+							 bool& more_events,
+							 bool& exitFlag)
+  {
+    number_retrieved = 0;
+    more_events      = false;
+    if (not events_subscribed)
+      return SRP_STATUS_NOT_SUBSCRIBED;
+    if (buffer_size == 0)
+      return SRP_STATUS_OK;
+
+    do {
+      number_retrieved = srp_store.retrieve_neighbour_events (event_subscription_id, buffer, buffer_size, more_events, defaultShortSharedMemoryLockTimeoutMS);
+    } while ((number_retrieved == 0) and (not exitFlag));
+    return SRP_STATUS_OK;
+  }
+  
+  
+  // -----------------------------------------------------------------------------------
+
+  uint64_t SRPClientRuntime::get_number_dropped_neighbour_events ()
+  {
+    if (not events_subscribed)
+      return 0;
+    return srp_store.get_number_dropped_neighbour_events (event_subscription_id);
+  }
+  
+  
   // -----------------------------------------------------------------------------------
   
     
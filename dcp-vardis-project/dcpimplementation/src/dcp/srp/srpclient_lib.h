@@ -21,6 +21,7 @@
 #pragma once
 
 #include <list>
+#include <vector>
 #include <dcp/common/command_socket.h>
 #include <dcp/common/exceptions.h>
 #include <dcp/common/services_status.h>
@@ -47,6 +48,9 @@ using dcp::srp::SafetyDataT;
 using dcp::srp::ExtendedSafetyDataT;
 using dcp::srp::DefaultSRPStoreType;
 using dcp::srp::NodeInformation;
+using dcp::srp::CPAThreat;
+using dcp::srp::NeighbourEvent;
+using dcp::srp::NeighbourEventFilter;
 
 namespace dcp {
 
@@ -63,6 +67,29 @@ namespace dcp {
      */
     DefaultSRPStoreType srp_store;
 
+
+    /**
+     * @brief Buffer receiving copies of the published neighbour table
+     *        snapshot
+     */
+    std::vector<NodeInformation> snapshot_buffer;
+
+
+    /**
+     * @brief Whether this client holds a neighbour event
+     *        subscription, and its identifier
+     */
+    bool     events_subscribed = false;
+    uint32_t event_subscription_id = 0;
+
+
+    /**
+     * @brief Replaces the positions of neighbours that report a
+     *        velocity by their positions extrapolated to the current
+     *        time
+     */
+    static void extrapolate_to_now (std::list<NodeInformation>& neighbour_list);
+
     
   public:
 
@@ -79,6 +106,12 @@ namespace dcp {
     SRPClientRuntime (const SRPClientConfiguration& client_conf);
 
 
+    /**
+     * @brief Destructor, releases any neighbour event subscription
+     */
+    ~SRPClientRuntime ();
+
+
     /****************************************************************
      * Queries
      ***************************************************************/
@@ -122,6 +155,10 @@ namespace dcp {
      * keepaliveTimeoutMS) before ceasing. Therefore, this must be
      * regularly refreshed to keep transmission of the own safety data
      * going.
+     *
+     * @return SRP_STATUS_OK, or SRP_STATUS_ILLEGAL_SAFETY_DATA when
+     *         the application extensions length exceeds
+     *         maxApplicationExtensionsSize
      */
     DcpStatus set_own_safety_data (const SafetyDataT& new_sd);
 
@@ -135,8 +172,21 @@ namespace dcp {
      * @brief Return list of NodeInformation records for all currently
      *        registered neighbours
      *
+     * This reads the snapshot of the neighbour table last published
+     * by the SRP demon, without locking, so it does not delay the
+     * processing of received payloads.
+     *
+     * For neighbours reporting speed and heading, the returned
+     * position is extrapolated from the reported one to the time of
+     * the call (dead reckoning), the timestamp remains that of the
+     * reported data.
+     *
      * @param neighbour_list: output value containing list of
      *        NodeInformation records of all current neighbours
+     *
+     * @return SRP_STATUS_OK, or SRP_STATUS_SNAPSHOT_UNAVAILABLE when
+     *         no complete snapshot could be read (e.g. because the SRP
+     *         demon died while publishing one)
      */
     DcpStatus get_all_neighbours_node_information (std::list<NodeInformation>& neighbour_list);
 
@@ -150,9 +200,167 @@ namespace dcp {
      *        in the output list or not
      * @param neighbour_list: output parameter collecting NodeInformation
      *        records for all neighbours for whom the predicate matches
+     *
+     * Like get_all_neighbours_node_information, this reads the last
+     * published snapshot without locking. The predicate is applied
+     * to the reported data, the returned
+     * positions are extrapolated like in
+     * get_all_neighbours_node_information, and the same status codes
+     * are returned.
      */
     DcpStatus get_matching_neighbours_node_information (std::function<bool (const ExtendedSafetyDataT&)> predicate,
 							std::list<NodeInformation>& neighbour_list);
+
+
+    /**
+     * @brief Retrieves NodeInformation records of all neighbours
+     *        within the given distance of the given position, using
+     *        the spatial index of the SRP store. Does not allocate.
+     *
+     * @param centre: position to measure distances from (typically
+     *        the own position)
+     * @param radius: maximum distance (in m)
+     * @param buffer: caller-provided output buffer
+     * @param buffer_size: number of records the buffer can hold
+     * @param number_found: output parameter, number of matching
+     *        neighbours. If this exceeds buffer_size, only
+     *        buffer_size records have been written
+     *
+     * @return SRP_STATUS_OK, SRP_STATUS_ILLEGAL_DISTANCE when radius
+     *         is negative or not finite, or
+     *         SRP_STATUS_ILLEGAL_POSITION when the position of the
+     *         centre is not finite
+     */
+    DcpStatus get_neighbours_within_radius (const SafetyDataT& centre,
+					    double radius,
+					    NodeInformation* buffer,
+					    size_t buffer_size,
+					    size_t& number_found);
+
+
+    /**
+     * @brief Retrieves NodeInformation records of the k neighbours
+     *        nearest to the given position, in order of increasing
+     *        distance, using the spatial index of the SRP
+     *        store. Does not allocate.
+     *
+     * @param centre: position to measure distances from
+     * @param k: number of neighbours to retrieve
+     * @param buffer: caller-provided output buffer for at least k
+     *        records
+     * @param number_found: output parameter, number of records
+     *        written (less than k if there are fewer neighbours)
+     *
+     * @return SRP_STATUS_OK, or SRP_STATUS_ILLEGAL_POSITION when the
+     *         position of the centre is not finite
+     */
+    DcpStatus get_nearest_neighbours (const SafetyDataT& centre,
+				      size_t k,
+				      NodeInformation* buffer,
+				      size_t& number_found);
+
+
+    /**
+     * @brief Computes the closest point of approach between the own
+     *        node (current own safety data) and all neighbours, and
+     *        retrieves the k most threatening neighbours, i.e. those
+     *        with the smallest distance at closest approach. Does not
+     *        allocate.
+     *
+     * Positions are extrapolated to the time of the call with the
+     * reported speed and heading of the own node and the neighbours.
+     *
+     * @param horizon: look-ahead time (in s), closest approaches
+     *        further in the future are not considered
+     * @param max_distance: neighbours whose distance at closest
+     *        approach exceeds this (in m) are not reported
+     * @param k: maximum number of threats to retrieve
+     * @param buffer: caller-provided output buffer for at least k
+     *        records, filled in order of increasing distance at
+     *        closest approach
+     * @param number_found: output parameter, number of records
+     *        written
+     *
+     * @return SRP_STATUS_OK, SRP_STATUS_ILLEGAL_DISTANCE when
+     *         max_distance is negative or not finite, or
+     *         SRP_STATUS_ILLEGAL_HORIZON when horizon is negative or
+     *         not finite
+     */
+    DcpStatus get_closest_approach_threats (double horizon,
+					    double max_distance,
+					    size_t k,
+					    CPAThreat* buffer,
+					    size_t& number_found);
+
+
+    /****************************************************************
+     * Services for neighbour change events
+     ***************************************************************/
+
+
+    /**
+     * @brief Registers this client for neighbour change events
+     *        (neighbour added, updated, expired, or out of range),
+     *        which SRP then queues for the client in shared memory
+     *
+     * @param filter: distance threshold (relative to the own
+     *        position) and minimum position change for reported
+     *        updates, fixed for the lifetime of the subscription
+     *
+     * @return SRP_STATUS_OK, SRP_STATUS_ALREADY_SUBSCRIBED, or
+     *         SRP_STATUS_NO_FREE_SUBSCRIPTION when the maximum number
+     *         of subscribed clients has been reached
+     *
+     * Neighbours already present are reported as added with their
+     * next update. The subscription is released by
+     * unsubscribe_neighbour_events() or the destructor.
+     */
+    DcpStatus subscribe_neighbour_events (const NeighbourEventFilter& filter);
+
+
+    /**
+     * @brief Releases the neighbour event subscription
+     */
+    DcpStatus unsubscribe_neighbour_events ();
+
+
+    /**
+     * @brief Retrieves pending neighbour events, in the order they
+     *        occurred, without waiting
+     *
+     * @param buffer: caller-provided output buffer
+     * @param buffer_size: maximum number of events to retrieve
+     * @param number_retrieved: output value, number of events written
+     * @param more_events: output value, whether further events are
+     *        pending
+     *
+     * @return SRP_STATUS_OK or SRP_STATUS_NOT_SUBSCRIBED
+     */
+    DcpStatus get_neighbour_events_nowait (NeighbourEvent* buffer,
+					   size_t buffer_size,
+					   size_t& number_retrieved,
+					   bool& more_events);
+
+
+    /**
+     * @brief Like get_neighbour_events_nowait() but blocks caller
+     *        until at least one event is available or the exitFlag
+     *        is true
+     */
+    DcpStatus get_neighbour_events_wait (NeighbourEvent* buffer,
+					 size_t buffer_size,
+					 size_t& number_retrieved,
+					 bool& more_events,
+					 bool& exitFlag);
+
+
+    /**
+     * @brief Returns the number of events lost because the event
+     *        queue of this client was full. A client seeing this
+     *        number grow should resynchronize using
+     *        get_all_neighbours_node_information().
+     */
+    uint64_t get_number_dropped_neighbour_events ();
     
   };
   
@@ -18,6 +18,7 @@
  */
 
 
+#include <cstring>
 #include <dcp/vardis/vardis_configuration.h>
 #include <dcp/vardis/vardis_constants.h>
 #include <dcp/vardis/vardis_transmissible_types.h>
@@ -45,6 +46,16 @@ namespace dcp::vardis {
 
       (opt("lockingIndividualContainers").c_str(),              po::value<bool>(&lockingForIndividualContainers)->default_value(defaultValueLockingForIndividualContainers), txt("Locking protocol data for processing individual containers (instead of one lock per received payload)").c_str())
 
+      (opt("compactSummaries").c_str(),               po::value<bool>(&compactSummaries)->default_value(defaultValueCompactSummaries), txt("send summaries as ranges of consecutive variable identifiers").c_str())
+      (opt("summaryDigestRange").c_str(),             po::value<uint16_t>(&summaryDigestRange)->default_value(defaultValueSummaryDigestRange), txt("number of variable identifiers covered by one summary digest (0 = no digests)").c_str())
+      (opt("antiEntropy").c_str(),                    po::value<bool>(&antiEntropy)->default_value(defaultValueAntiEntropy), txt("use Merkle tree anti-entropy instead of summaries").c_str())
+      (opt("antiEntropyLeafRange").c_str(),           po::value<uint16_t>(&antiEntropyLeafRange)->default_value(defaultValueAntiEntropyLeafRange), txt("size of Merkle subtree (power of two) for which explicit summaries are requested").c_str())
+
+      (opt("useEventLoop").c_str(),                   po::value<bool>(&useEventLoop)->default_value(defaultValueUseEventLoop), txt("run payload generation, scrubbing and RTDB polling as timers of one event loop thread").c_str())
+
+      (opt("snapshotFile").c_str(),                   po::value<std::string>(&snapshotFile)->default_value(defaultValueSnapshotFile), txt("file for periodic snapshots of the variable store, restored at startup (empty = no snapshots)").c_str())
+      (opt("snapshotPeriodMS").c_str(),               po::value<uint16_t>(&snapshotPeriodMS)->default_value(defaultValueSnapshotPeriodMS), txt("time between two snapshots of the variable store (in ms)").c_str())
+
       ;
   }
 
@@ -79,6 +90,14 @@ namespace dcp::vardis {
     if (payloadGenerationIntervalMS <= 0) throw ConfigurationException ("VardisConfigurationBlock", "payload generation interval must be strictly positive");
 
     if (queueMaxEntries <= 0) throw ConfigurationException ("VardisConfigurationBlock", "maximum entries in BP queue for Vardis must be strictly positive");
+
+    if (summaryDigestRange > std::numeric_limits<byte>::max()) throw ConfigurationException ("VardisConfigurationBlock", "summaryDigestRange too large");
+    if (    (antiEntropyLeafRange == 0)
+	 || (antiEntropyLeafRange > std::numeric_limits<byte>::max())
+	 || ((antiEntropyLeafRange & (antiEntropyLeafRange - 1)) != 0))
+      throw ConfigurationException ("VardisConfigurationBlock", "antiEntropyLeafRange must be a power of two below 256");
+
+    if ((not snapshotFile.empty()) and (snapshotPeriodMS <= 0)) throw ConfigurationException ("VardisConfigurationBlock", "snapshot period must be strictly positive");
   }
 
   
@@ -93,6 +112,9 @@ namespace dcp::vardis {
        << " , logAutoFlush = " << cfg.logging_conf.logAutoFlush
        << " , minimumSeverityLevel = " << cfg.logging_conf.minimumSeverityLevel
        << " , rotationSize = " << cfg.logging_conf.rotationSize
+       << " , asyncLogging = " << cfg.logging_conf.asyncLogging
+       << " , asyncBufferSize = " << cfg.logging_conf.asyncBufferSize
+       << " , asyncDrainIntervalMS = " << cfg.logging_conf.asyncDrainIntervalMS
 
        << " , commandSocketFile[BP] = " << cfg.bp_cmdsock_conf.commandSocketFile
        << " , commandSocketTimeoutMS[BP] = " << cfg.bp_cmdsock_conf.commandSocketTimeoutMS
@@ -100,6 +122,9 @@ namespace dcp::vardis {
        << " , shmAreaNameBP = " << cfg.bp_shm_conf.shmAreaName
 
        << " , shmAreaNameVarStore = " << cfg.vardis_shm_vardb_conf.shmAreaName
+       << " , shmHugePagesVarStore = " << cfg.vardis_shm_vardb_conf.shmHugePages
+       << " , shmAreaNameMetrics = " << cfg.vardis_metrics_conf.shmAreaName
+       << " , " << cfg.vardis_realtime_conf
       
        << " , maxValueLength = " << cfg.vardis_conf.maxValueLength
        << " , maxDescriptionLength = " << cfg.vardis_conf.maxDescriptionLength
@@ -111,9 +136,37 @@ namespace dcp::vardis {
        << " , payloadGenerationIntervalMS = " << cfg.vardis_conf.payloadGenerationIntervalMS
        << " , queueMaxEntries = " << cfg.vardis_conf.queueMaxEntries
        << " , lockingforindividualcontainers = " << cfg.vardis_conf.lockingForIndividualContainers
+       << " , compactSummaries = " << cfg.vardis_conf.compactSummaries
+       << " , summaryDigestRange = " << cfg.vardis_conf.summaryDigestRange
+       << " , antiEntropy = " << cfg.vardis_conf.antiEntropy
+       << " , antiEntropyLeafRange = " << cfg.vardis_conf.antiEntropyLeafRange
+       << " , useEventLoop = " << cfg.vardis_conf.useEventLoop
+       << " , snapshotFile = " << cfg.vardis_conf.snapshotFile
+       << " , snapshotPeriodMS = " << cfg.vardis_conf.snapshotPeriodMS
     
        << " }";
     return os;
   }
   
+  // ------------------------------------------------------------------------------
+
+  std::string get_protocol_name ()
+  {
+    return std::string ("Variable Dissemination Protocol ") + dcp::dcpVersionNumber;
+  }
+
+  // ------------------------------------------------------------------------------
+
+  bp::BPStaticClientInfo get_bp_client_info (const VardisConfiguration& cfg)
+  {
+    bp::BPStaticClientInfo client_info;
+    client_info.protocolId             =  dcp::BP_PROTID_VARDIS;
+    std::strncpy (client_info.protocolName, get_protocol_name().c_str(), bp::maximumProtocolNameLength);
+    client_info.maxPayloadSize         =  cfg.vardis_conf.maxPayloadSize;
+    client_info.queueingMode           =  bp::BP_QMODE_QUEUE_DROPHEAD;
+    client_info.maxEntries             =  cfg.vardis_conf.queueMaxEntries;
+    client_info.allowMultiplePayloads  =  false;
+    return client_info;
+  }
+  
 };  // namespace dcp::vardis
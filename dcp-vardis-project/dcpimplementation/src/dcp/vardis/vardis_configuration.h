@@ -21,7 +21,10 @@
 #pragma once
 
 #include <iostream>
+#include <string>
 #include <boost/program_options.hpp>
+#include <dcp/common/realtime.h>
+#include <dcp/bp/bp_client_static_info.h>
 #include <dcp/bp/bpclient_configuration.h>
 #include <dcp/vardis/vardis_constants.h>
 
@@ -44,6 +47,13 @@ namespace dcp::vardis {
   const uint16_t   defaultValuePayloadGenerationIntervalMS      =  30;
   const uint16_t   defaultValuePollRTDBServiceIntervalMS        =  25;
   const bool       defaultValueLockingForIndividualContainers   =  false;
+  const bool       defaultValueCompactSummaries                 =  false;
+  const uint16_t   defaultValueSummaryDigestRange               =  0;
+  const bool       defaultValueAntiEntropy                      =  false;
+  const uint16_t   defaultValueAntiEntropyLeafRange             =  8;
+  const bool       defaultValueUseEventLoop                     =  false;
+  const std::string defaultValueSnapshotFile                    =  "";
+  const uint16_t   defaultValueSnapshotPeriodMS                 =  1000;
   
   /**
    * @brief This struct contains the Vardis protocol configuration
@@ -121,6 +131,62 @@ namespace dcp::vardis {
      *        operation per container
      */
     bool lockingForIndividualContainers = defaultValueLockingForIndividualContainers;
+
+
+    /**
+     * @brief Send summaries as ranges of consecutive variable
+     *        identifiers (VarSummRangeT) instead of individual
+     *        VarSummT records
+     */
+    bool compactSummaries = defaultValueCompactSummaries;
+
+
+    /**
+     * @brief Number of consecutive variable identifiers covered by
+     *        one summary digest. Zero disables digests, summary
+     *        ranges then carry sequence numbers. Only relevant when
+     *        compactSummaries is set.
+     */
+    uint16_t summaryDigestRange = defaultValueSummaryDigestRange;
+
+
+    /**
+     * @brief Use Merkle tree based anti-entropy: the root hash of the
+     *        Merkle tree over all (varId, seqno) pairs replaces the
+     *        summaries, and neighbours descend only into subtrees in
+     *        which they differ
+     */
+    bool antiEntropy = defaultValueAntiEntropy;
+
+
+    /**
+     * @brief Number of variable identifiers (a power of two) covered
+     *        by a Merkle subtree at which anti-entropy stops
+     *        descending and requests explicit summary ranges instead
+     */
+    uint16_t antiEntropyLeafRange = defaultValueAntiEntropyLeafRange;
+
+
+    /**
+     * @brief Run payload generation, scrubbing and RTDB request
+     *        polling as timers of one event loop thread instead of
+     *        one sleeping thread each
+     */
+    bool useEventLoop = defaultValueUseEventLoop;
+
+
+    /**
+     * @brief File into which the variable store is periodically
+     *        written, and from which it is restored when the demon
+     *        starts. Empty disables snapshots.
+     */
+    std::string snapshotFile = defaultValueSnapshotFile;
+
+
+    /**
+     * @brief Time between two snapshots of the variable store
+     */
+    uint16_t snapshotPeriodMS = defaultValueSnapshotPeriodMS;
     
     
     /**************************************************
@@ -165,13 +231,15 @@ namespace dcp::vardis {
     VardisConfigurationBlock          vardis_conf;
     CommandSocketConfigurationBlock   vardis_cmdsock_conf;
     SharedMemoryConfigurationBlock    vardis_shm_vardb_conf;
+    SharedMemoryConfigurationBlock    vardis_metrics_conf;
+    RealtimeConfigurationBlock        vardis_realtime_conf;
 
 
     /**
      * @brief Constructor, setting section name in config file and
      *        default names for logfile, command socket towards BP,
-     *        command socket towards Vardis clients, and the shared
-     *        memory area towards BP
+     *        command socket towards Vardis clients, the shared
+     *        memory area towards BP and the metrics area
      */
     VardisConfiguration ()
       : BPClientConfiguration ("BPCommandSocket", "BPSharedMem")
@@ -179,6 +247,8 @@ namespace dcp::vardis {
       , vardis_conf ("Vardis")
       , vardis_cmdsock_conf ("VardisCommandSocket")
       , vardis_shm_vardb_conf ("VardisVariableDatabaseShm", defaultVardisStoreShmName)
+      , vardis_metrics_conf ("VardisMetricsShm", defaultVardisMetricsShmName)
+      , vardis_realtime_conf ("VardisRealtime", {"receiver", "transmitter", "managementCommand", "managementRTDB", "scrubber", "snapshot", "eventLoop"})
     {
       bp_cmdsock_conf.commandSocketFile      = "/tmp/dcp-bp-command-socket";
       bp_shm_conf.shmAreaName                = "shm-bpclient-vardis";
@@ -197,6 +267,8 @@ namespace dcp::vardis {
       vardis_conf.add_options (cfgdesc);
       vardis_cmdsock_conf.add_options (cfgdesc);
       vardis_shm_vardb_conf.add_options (cfgdesc, defaultVardisStoreShmName);
+      vardis_metrics_conf.add_options (cfgdesc, defaultVardisMetricsShmName);
+      vardis_realtime_conf.add_options (cfgdesc);
     };
 
     
@@ -210,6 +282,8 @@ namespace dcp::vardis {
       vardis_conf.validate ();
       vardis_cmdsock_conf.validate ();
       vardis_shm_vardb_conf.validate ();
+      vardis_metrics_conf.validate ();
+      vardis_realtime_conf.validate ();
     };
       
       
@@ -222,5 +296,19 @@ namespace dcp::vardis {
     
   } VardisConfiguration;
 
+
+  /**
+   * @brief Returns the protocol name of Vardis, including the version
+   */
+  std::string get_protocol_name ();
+
+
+  /**
+   * @brief Returns the static client information with which Vardis
+   *        registers with BP, depending on the configured payload
+   *        size and queue length
+   */
+  bp::BPStaticClientInfo get_bp_client_info (const VardisConfiguration& cfg);
+
   
 };  // namespace dcp::vardis
@@ -35,6 +35,7 @@ namespace dcp::vardis {
   const size_t        MAX_maxDescriptionLength      = StringT::max_length();
 
   const std::string   defaultVardisStoreShmName           = "shm-vardis-global-database";
+  const std::string   defaultVardisMetricsShmName         = "shm-vardis-metrics";
   const std::string   defaultVardisCommandSocketFileName  = "/tmp/dcp-vardis-command-socket";
   
 };  // namespace dcp::vardis
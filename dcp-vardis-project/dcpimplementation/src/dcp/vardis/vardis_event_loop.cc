@@ -0,0 +1,101 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+
+#include <dcp/common/event_loop.h>
+#include <dcp/vardis/vardis_event_loop.h>
+#include <dcp/vardis/vardis_logging.h>
+#include <dcp/vardis/vardis_management_rtdb.h>
+#include <dcp/vardis/vardis_scrubber.h>
+#include <dcp/vardis/vardis_snapshot.h>
+#include <dcp/vardis/vardis_transmitter.h>
+
+
+namespace dcp::vardis {
+
+  // -----------------------------------------------------------------
+  
+  void event_loop_thread (VardisRuntimeData& runtime)
+  {
+    DCPLOG_INFO(log_main) << "Starting event loop thread.";
+
+    const VardisConfigurationBlock& conf = runtime.vardis_config.vardis_conf;
+    
+    try {
+      EventLoop loop;
+      loop.set_wakeup_latency_histogram (&runtime.metricEventLoopWakeupLatency);
+
+      loop.add_periodic_timer (conf.payloadGenerationIntervalMS, [&] ()
+      {
+	transmit_payload (runtime);
+      });
+
+      loop.add_periodic_timer (conf.pollRTDBServiceIntervalMS, [&] ()
+      {
+	poll_client_shared_memory (runtime);
+      });
+
+      loop.add_periodic_timer (conf.scrubbingPeriodMS, [&] ()
+      {
+	if (runtime.protocol_data.vardis_store.get_vardis_isactive())
+	  scrub_variables (runtime, TimeStampT::get_current_coarse_time());
+      });
+
+      std::vector<byte> previous_snapshot;
+      if (not conf.snapshotFile.empty())
+	loop.add_periodic_timer (conf.snapshotPeriodMS, [&] ()
+	{
+	  try {
+	    save_store_snapshot (runtime, previous_snapshot);
+	  }
+	  catch (DcpException& e)
+	    {
+	      DCPLOG_WARNING(log_main) << "Cannot write store snapshot: " << e.what();
+	    }
+	});
+
+      loop.run (runtime.vardis_exitFlag);
+
+      if (not conf.snapshotFile.empty())
+	save_store_snapshot (runtime, previous_snapshot);
+    }
+    catch (DcpException& e)
+      {
+	DCPLOG_FATAL(log_main)
+	  << "Caught DCP exception in Vardis event loop. "
+	  << "Exception type: " << e.ename()
+	  << ", module: " << e.modname()
+	  << ", message: " << e.what()
+	  << ". Exiting.";
+	runtime.vardis_exitFlag = true;
+      }
+    catch (std::exception& e)
+      {
+	DCPLOG_FATAL(log_main)
+	  << "Caught other exception in Vardis event loop. "
+	  << "Message: " << e.what()
+	  << ". Exiting.";
+	runtime.vardis_exitFlag = true;
+      }
+    
+    DCPLOG_INFO(log_main) << "Exiting event loop thread.";
+  }
+  
+};  // namespace dcp::vardis
@@ -0,0 +1,38 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+
+#pragma once
+
+#include <dcp/vardis/vardis_runtime_data.h>
+
+namespace dcp::vardis {
+
+  /**
+   * @brief Runs payload generation, scrubbing and RTDB request
+   *        polling (and store snapshots, if configured) as timers
+   *        of one event loop, until exitFlag is set. Replaces
+   *        transmitter_thread, scrubbing_thread,
+   *        management_thread_rtdb and snapshot_thread when
+   *        useEventLoop is configured.
+   */
+  void event_loop_thread (VardisRuntimeData& runtime);
+  
+};  // namespace dcp::vardis
@@ -207,6 +207,7 @@ namespace dcp::vardis {
 	  descr.timeout        =  db_entry.timeout;
 	  descr.tStamp         =  db_entry.tStamp;
 	  descr.isDeleted      =  db_entry.isDeleted;
+	  descr.isStale        =  db_entry.isStale;
 	  PD.vardis_store.read_description (varId, descr.description);
 	  
 	  var_descriptions.push_back (descr);
@@ -265,6 +266,7 @@ namespace dcp::vardis {
 	  var_descr.countCreate  =  db_entry.countCreate;
 	  var_descr.countDelete  =  db_entry.countDelete;
 	  var_descr.isDeleted    =  db_entry.isDeleted;
+	  var_descr.isStale      =  db_entry.isStale;
 	  var_descr.value_length =  PD.vardis_store.size_of_value (varId);
 	  PD.vardis_store.read_value (varId, VAL_BUFFER_SIZE , val_buffer, val_size);
 	}
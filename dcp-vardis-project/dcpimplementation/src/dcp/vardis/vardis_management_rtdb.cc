@@ -20,6 +20,7 @@
 
 #include <chrono>
 #include <thread>
+#include <dcp/common/realtime.h>
 #include <dcp/vardis/vardis_client_protocol_data.h>
 #include <dcp/vardis/vardis_logging.h>
 #include <dcp/vardis/vardis_management_rtdb.h>
@@ -34,7 +35,8 @@ namespace dcp::vardis {
 			     VardisRuntimeData& runtime,
 			     PayloadQueue& requestQueue,
 			     ConfirmQueue& confirmQueue,
-			     CT (*caller_handler) (VardisRuntimeData&, const RT&)
+			     CT (*caller_handler) (VardisRuntimeData&, const RT&),
+			     LatencyHistogram& latency
 			     )
   {
     bool timed_out;
@@ -45,6 +47,8 @@ namespace dcp::vardis {
 	<< "handle_request_queue: got buffer from request queue "
 	<< requestQueue.get_queue_name ()
 	<< " and confirm queue " << confirmQueue.get_queue_name ();
+
+      ScopedLatencyMeasurement request_time (latency);
       
       MemoryChunkDisassemblyArea disass_area ("vd-hrq-dass", len, memaddr);
       
@@ -109,7 +113,8 @@ namespace dcp::vardis {
       handle_request_queue<RTDB_Create_Request, RTDB_Create_Confirm> (runtime,
 								      CS.pqCreateRequest,
 								      CS.pqCreateConfirm,
-								      handler);
+								      handler,
+								      runtime.metricRTDBCreateTime);
     }
 
     // --------------------
@@ -123,7 +128,8 @@ namespace dcp::vardis {
       handle_request_queue<RTDB_Delete_Request, RTDB_Delete_Confirm> (runtime,
 								      CS.pqDeleteRequest,
 								      CS.pqDeleteConfirm,
-								      handler);
+								      handler,
+								      runtime.metricRTDBDeleteTime);
     }
 
     // --------------------
@@ -137,13 +143,27 @@ namespace dcp::vardis {
       handle_request_queue<RTDB_Update_Request, RTDB_Update_Confirm> (runtime,
 								      CS.pqUpdateRequest,
 								      CS.pqUpdateConfirm,
-								      handler);
+								      handler,
+								      runtime.metricRTDBUpdateTime);
     }
 
   }
   
   // ----------------------------------------------------------------------------
   
+  void poll_client_shared_memory (VardisRuntimeData& runtime)
+  {
+    // run over all client protocols / applications, using lock
+    ScopedClientApplicationsMutex ca_mtx (runtime);
+    
+    for (auto& clapp : runtime.clientApplications)
+      {
+	handle_client_shared_memory (runtime, clapp.second);
+      }
+  }
+
+  // ----------------------------------------------------------------------------
+
   void management_thread_rtdb (VardisRuntimeData& runtime)
   {
     DCPLOG_INFO(log_mgmt_rtdb) << "Starting to interact with client via shared memory";
@@ -151,17 +171,8 @@ namespace dcp::vardis {
     try {
       while (not runtime.vardis_exitFlag)
 	{
-	  std::this_thread::sleep_for (std::chrono::milliseconds (runtime.vardis_config.vardis_conf.pollRTDBServiceIntervalMS));
-	  
-	  // run over all client protocols / applications, using lock
-	  {
-	    ScopedClientApplicationsMutex ca_mtx (runtime);
-	    
-	    for (auto& clapp : runtime.clientApplications)
-	      {
-		handle_client_shared_memory (runtime, clapp.second);
-	      }
-	  }
+	  sleep_for_measured (std::chrono::milliseconds (runtime.vardis_config.vardis_conf.pollRTDBServiceIntervalMS), runtime.metricRTDBPollWakeupLatency);
+	  poll_client_shared_memory (runtime);
 	}
     }
     catch (DcpException& e)
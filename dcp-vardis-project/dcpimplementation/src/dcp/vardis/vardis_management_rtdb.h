@@ -24,6 +24,13 @@
 
 namespace dcp::vardis {
 
+  /**
+   * @brief Processes the pending RTDB service requests of all
+   *        registered clients (one polling round)
+   */
+  void poll_client_shared_memory (VardisRuntimeData& runtime);
+
+  
   /**
    * @brief This thread handles the exchange of RTDB services between
    *        a Vardis client and the Vardis demon over a shared memory
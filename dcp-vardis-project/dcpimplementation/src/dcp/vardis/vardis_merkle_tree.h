@@ -0,0 +1,158 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include <dcp/vardis/vardis_transmissible_types.h>
+
+
+/**
+ * @brief This module provides an incrementally maintained Merkle tree
+ *        over the (varId, seqno) pairs of a Vardis database, used for
+ *        anti-entropy between neighbours.
+ *
+ * The tree is a complete binary tree with one leaf per possible
+ * variable identifier, stored in an array in heap order (root at
+ * position 1, children of position p at 2p and 2p+1). A leaf has
+ * hash zero when the variable does not exist or is deleted, and an
+ * inner node has hash zero when both of its children have hash zero,
+ * so that empty subtrees are recognizable without descending into
+ * them. Changing a leaf recomputes only the hashes on its path to the
+ * root.
+ */
+
+
+namespace dcp::vardis {
+
+
+  class VardisMerkleTree {
+  private:
+
+    static constexpr uint32_t fnv_offset_basis = 2166136261u;
+    static constexpr uint32_t fnv_prime        = 16777619u;
+
+    /**
+     * @brief Feeds the bytes of the given value (in network byte
+     *        order) into an FNV-1a hash
+     */
+    template <typename T>
+    static inline uint32_t fnv_feed (uint32_t h, T value)
+    {
+      for (size_t k = sizeof(T); k > 0; k--)
+	h = (h ^ ((byte) (((uint64_t) value) >> (8*(k-1))))) * fnv_prime;
+      return h;
+    }
+
+
+    static constexpr unsigned int compute_depth ()
+    {
+      unsigned int d = 0;
+      while ((((uint64_t) 1) << d) < VarIdT::max_number_identifiers())
+	d++;
+      return d;
+    };
+
+
+    std::vector<uint32_t>  nodes;   /*!< Node hashes in heap order, position 0 unused */
+
+
+    inline size_t position (unsigned int level, uint64_t index) const
+    {
+      if ((level > depth()) or (index >= (((uint64_t) 1) << level)))
+	throw std::out_of_range ("VardisMerkleTree: illegal node");
+      return (((size_t) 1) << level) + index;
+    };
+
+
+  public:
+
+    VardisMerkleTree () : nodes (((size_t) 2) << compute_depth(), 0) {};
+
+
+    /**
+     * @brief Returns the depth of the tree, i.e. the level of the leaves
+     */
+    static constexpr unsigned int depth () { return compute_depth (); };
+
+
+    /**
+     * @brief Returns the number of variable identifiers covered by a
+     *        node at the given level
+     */
+    static constexpr uint64_t span (unsigned int level) { return ((uint64_t) 1) << (depth() - level); };
+
+
+    /**
+     * @brief Returns the number of nodes at the given level
+     */
+    static constexpr uint64_t width (unsigned int level) { return ((uint64_t) 1) << level; };
+
+
+    /**
+     * @brief Returns the (never zero) leaf hash of an existing and
+     *        non-deleted variable with the given seqno
+     */
+    static inline uint32_t leaf_hash (VarIdT varId, VarSeqnoT seqno)
+    {
+      uint32_t h = fnv_feed (fnv_feed (fnv_offset_basis, varId.val), seqno.val);
+      return (h == 0) ? 1 : h;
+    };
+
+
+    /**
+     * @brief Returns the hash of the given node. Throws for illegal
+     *        nodes
+     */
+    inline uint32_t get (unsigned int level, uint64_t index) const { return nodes[position (level, index)]; };
+
+
+    /**
+     * @brief Returns the root hash, which is zero for an empty database
+     */
+    inline uint32_t root () const { return nodes[1]; };
+
+
+    /**
+     * @brief Sets the hash of a leaf (zero for non-existing or deleted
+     *        variables) and recomputes the hashes on its path to the
+     *        root
+     */
+    inline void update_leaf (VarIdT varId, uint32_t leafHash)
+    {
+      size_t pos = position (depth(), varId.val);
+      if (nodes[pos] == leafHash)
+	return;
+
+      nodes[pos] = leafHash;
+      for (pos = pos / 2; pos >= 1; pos = pos / 2)
+	{
+	  uint32_t left  = nodes[2*pos];
+	  uint32_t right = nodes[2*pos+1];
+	  uint32_t h     = fnv_feed (fnv_feed (fnv_offset_basis, left), right);
+	  nodes[pos] = ((left == 0) and (right == 0)) ? 0 : ((h == 0) ? 1 : h);
+	}
+    };
+
+  };
+
+};  // namespace dcp::vardis
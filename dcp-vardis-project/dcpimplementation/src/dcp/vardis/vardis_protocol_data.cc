@@ -18,6 +18,7 @@
  */
 
 
+#include <algorithm>
 #include <dcp/vardis/vardis_logging.h>
 #include <dcp/vardis/vardis_protocol_data.h>
 
@@ -41,6 +42,8 @@ namespace dcp::vardis {
     create.spec.repCnt        =  theEntry.repCnt;
     create.spec.creationTime  =  theEntry.creationTime;
     create.spec.timeout       =  theEntry.timeout;
+    create.spec.prio          =  theEntry.prio;
+    create.spec.minInterval   =  theEntry.minInterval;
     create.spec.descr         =  vardis_store.read_description (theEntry.varId);
     create.update.varId       =  theEntry.varId;
     create.update.seqno       =  theEntry.seqno;
@@ -107,32 +110,127 @@ namespace dcp::vardis {
   // -----------------------------------------------------------------
 
 
+
+  
+  void VardisProtocolData::cacheRecordSizes (VarIdT varId)
+  {
+    size_t valueSize  = vardis_store.size_of_value (varId);
+    size_t descrSize  = vardis_store.size_of_description (varId);
+    uint32_t updateSize = VarUpdateT::fixed_size() + valueSize;
+    uint32_t createSize = VarSpecT::fixed_size() + descrSize + updateSize;
+
+    createQ.resize (varId, createSize);
+    updateQ.resize (varId, updateSize);
+    createRecordSizes[varId.val] = createSize;
+    updateRecordSizes[varId.val] = updateSize;
+  }
+
+  // -----------------------------------------------------------------
+
+  void VardisProtocolData::adoptOwnSeqno (VarIdT varId, DBEntry& theEntry, VarSeqnoT seqno)
+  {
+    if (not theEntry.isStale)
+      return;
+
+    if (theEntry.seqno == seqno)
+      {
+	theEntry.isStale = false;
+	return;
+      }
+
+    // the neighbour holds a version I do not have anymore, announce
+    // the restored value under a seqno past the neighbour's one
+    if (more_recent_seqno (seqno, theEntry.seqno))
+      {
+	DCPLOG_INFO(log_rx) << "adoptOwnSeqno: restored own variable " << varId
+			    << " continues from seqno " << seqno << " instead of " << theEntry.seqno;
+	theEntry.seqno        = (seqno.val + 1) % (VarSeqnoT::modulus());
+	theEntry.countUpdate  = theEntry.repCnt;
+	theEntry.tStamp       = TimeStampT::get_current_coarse_time();
+	theEntry.isStale      = false;
+	updateMerkleLeaf (varId);
+	updateQ.insert (varId);
+      }
+  }
+
+  // -----------------------------------------------------------------
+
+  void VardisProtocolData::rebuildFromStore ()
+  {
+    active_variables.clear ();
+    for (uint64_t id = 0; id < VarIdT::max_number_identifiers(); id++)
+      {
+	VarIdT varId (id);
+	createQ.remove (varId);
+	updateQ.remove (varId);
+	createRecordSizes[id] = 0;
+	updateRecordSizes[id] = 0;
+	if (variableExists (varId))
+	  {
+	    cacheRecordSizes (varId);
+	    if (not vardis_store.get_db_entry_ref(varId).isDeleted)
+	      {
+		active_variables.insert (varId);
+		summaryQ.insert (varId);
+		summaryQ.reschedule (varId);
+	      }
+	  }
+	updateMerkleLeaf (varId);
+      }
+  }
+
+  // -----------------------------------------------------------------
   
   /**
    * This function calculates how many information instruction records referenced
-   * in the given queue and of the given type (cf 'instructionSizeFunction' parameter)
+   * in the given queue and of the given type (cf 'recordSizes' parameter)
    * fit into the number of bytes still available in the VarDis payload
    */
   unsigned int VardisProtocolData::numberFittingRecords(
 							const std::deque<VarIdT>& queue,
 							AssemblyArea& area,
-							std::function<unsigned int (VarIdT)> instructionSizeFunction
+							const RecordSizeTable& recordSizes,
+							std::optional<size_t> queueBytes
 							)
   {
-    // first work out how many records we can add
+    // common case: the entire queue fits
+    if (    queueBytes
+	 && (ICHeaderT::fixed_size() + *queueBytes <= area.available())
+	 && (queue.size() <= ICHeaderT::max_records()))
+      {
+	return queue.size();
+      }
+    
+    // otherwise work out how many records we can add
     unsigned int   numberRecordsToAdd = 0;
-    unsigned int   bytesToBeAdded = ICHeaderT::fixed_size();
+    size_t         bytesToBeAdded = ICHeaderT::fixed_size();
     auto           it = queue.begin();
     while(    (it != queue.end())
-	      && (bytesToBeAdded + instructionSizeFunction(*it) <= area.available())
+	      && (bytesToBeAdded + recordSizes[it->val] <= area.available())
 	      && (numberRecordsToAdd < ICHeaderT::max_records()))
       {
         numberRecordsToAdd++;
-        bytesToBeAdded += instructionSizeFunction(*it);
+        bytesToBeAdded += recordSizes[it->val];
         it++;
       }
     
-    return (std::min(numberRecordsToAdd, (unsigned int) ICHeaderT::max_records()));
+    return numberRecordsToAdd;
+  }
+
+
+  // -----------------------------------------------------------------
+
+  unsigned int VardisProtocolData::numberFittingRecords(
+							size_t numberCandidates,
+							AssemblyArea& area,
+							size_t recordSize
+							)
+  {
+    if (area.available() < ICHeaderT::fixed_size())
+      return 0;
+    
+    size_t fitting = (area.available() - ICHeaderT::fixed_size()) / recordSize;
+    return std::min ({fitting, numberCandidates, (size_t) ICHeaderT::max_records()});
   }
 
 
@@ -141,25 +239,33 @@ namespace dcp::vardis {
 
   /**
    * This serializes an instruction container for VarCreateT's, it generates
-   * an ICHeader and a as many VarCreateT records as possible / available.
+   * an ICHeader and a as many VarCreateT records as possible / available,
+   * taking variables of more important priority classes first.
    */
   void VardisProtocolData::makeICTypeCreateVariables (AssemblyArea& area, unsigned int& containers_added)
   {
-    // check for empty createQ or insufficient size to add at least the first instruction record
-    if (    createQ.empty()
-         || (instructionSizeVarCreate(createQ.queue.front()) + ICHeaderT::fixed_size()) > area.available())
+    if (createQ.empty())
+      {
+	return;
+      }
+
+    // check for insufficient size to add at least the first instruction record
+    if ((instructionSizeVarCreate(createQ.front()) + ICHeaderT::fixed_size()) > area.available())
       {
         return;
       }
     
     // first work out how many records we will add
-    std::function<unsigned int(VarIdT)> instSizeFn = [&] (VarIdT varId) { return instructionSizeVarCreate(varId); };
-    auto numberRecordsToAdd = numberFittingRecords(createQ.queue, area, instSizeFn);
+    auto numberRecordsToAdd = numberFittingRecords(createQ.queue, area, createRecordSizes, createQ.total_bytes());
     
     if (numberRecordsToAdd <= 0)
       {
 	throw VardisTransmitException ("makeICTypeCreateVariables", "numberRecordsToAdd is zero");
       }
+
+    // the createQ is ordered by priority class, so the records to
+    // add are at its front
+    std::deque<VarIdT> candidates (createQ.queue.begin(), createQ.queue.begin() + numberRecordsToAdd);
     
     // initialize and serialize ICHeader
     ICHeaderT   icHeader;
@@ -168,10 +274,11 @@ namespace dcp::vardis {
     icHeader.serialize(area);
     
     // serialize the records
+    TimeStampT  currTime  = TimeStampT::get_current_system_time();
+    createQ.remove (candidates, numberRecordsToAdd);
     for (unsigned int i=0; i<numberRecordsToAdd; i++)
       {
-        VarIdT nextVarId = createQ.front();
-        createQ.pop_front();
+        VarIdT nextVarId = candidates[i];
         DBEntry& nextVar = vardis_store.get_db_entry_ref(nextVarId);
 	
 	if (nextVar.countCreate.val <= 0)
@@ -180,7 +287,11 @@ namespace dcp::vardis {
 	  }
 	
         nextVar.countCreate--;
-	
+
+	// the VarCreateT carries the current seqno and value, so a
+	// pending new version has reached the neighbours now and must
+	// not be coalesced with later values anymore
+	noteVersionTransmitted (nextVar, currTime);
         addVarCreate(nextVarId, nextVar, area);
 	
         if (nextVar.countCreate.val > 0)
@@ -201,17 +312,19 @@ namespace dcp::vardis {
   void VardisProtocolData::makeICTypeSummaries (AssemblyArea& area, unsigned int& containers_added)
   {    
     // check for empty summaryQ, insufficient size to add at least the first instruction record,
-    // or whether summaries function is enabled
+    // or whether summaries function is enabled (and not replaced by summary ranges
+    // or by anti-entropy)
     if (    summaryQ.empty()
 	|| (instructionSizeVarSummary(summaryQ.front()) + ICHeaderT::fixed_size() > area.available())
-	|| (maxSummaries == 0))
+	|| (maxSummaries == 0)
+	|| compactSummaries
+	|| antiEntropy)
       {
         return;
       }
     
     // first work out how many records we will add, cap at vardisMaxSummaries
-    std::function<unsigned int(VarIdT)> instSizeFn = [&] (VarIdT varId) { return instructionSizeVarSummary(varId); };
-    auto numberRecordsToAdd = numberFittingRecords(summaryQ.queue, area, instSizeFn);
+    auto numberRecordsToAdd = numberFittingRecords(summaryQ.size(), area, VarSummT::fixed_size());
     numberRecordsToAdd = std::min(numberRecordsToAdd, (unsigned int) maxSummaries);
     
     if (numberRecordsToAdd <= 0)
@@ -225,15 +338,19 @@ namespace dcp::vardis {
     icHeader.icNumRecords = numberRecordsToAdd;
     icHeader.serialize(area);
     
-    // serialize the records
-    for (unsigned int i=0; i<numberRecordsToAdd; i++)
+    // serialize the records of the variables whose next summary is
+    // due first in the virtual time (and in queue order for equal
+    // times), so that a variable of priority class p is summarized
+    // 2^p times less often than a variable of the most important
+    // class. Then schedule their next summary
+    for (VarIdT nextVarId : summaryQ.take_due (numberRecordsToAdd))
       {
-        VarIdT nextVarId  = summaryQ.front();
-	
-        summaryQ.pop_front();
-        summaryQ.insert(nextVarId);
         DBEntry&   theNextEntry  = vardis_store.get_db_entry_ref(nextVarId);
         addVarSummary(nextVarId, theNextEntry, area);
+
+	summaryVirtualTime        = std::max (summaryVirtualTime, theNextEntry.summaryDue);
+	theNextEntry.summaryDue   = summaryVirtualTime + (((uint64_t) 1) << theNextEntry.prio.val);
+	summaryQ.reschedule (nextVarId);
       }
     
     containers_added += 1;
@@ -241,24 +358,67 @@ namespace dcp::vardis {
   
 
 
+  // -----------------------------------------------------------------
+
+  void VardisProtocolData::noteVersionTransmitted (DBEntry& theEntry, const TimeStampT& currTime)
+  {
+    if (not theEntry.newVersionPending)
+      return;
+
+    auto& vardis_stats = vardis_store.get_vardis_protocol_statistics_ref();
+    uint32_t delay = currTime.milliseconds_passed_since (theEntry.tUpdateQueued);
+    vardis_stats.count_update_tx[theEntry.prio.val]++;
+    vardis_stats.sum_update_delay_ms[theEntry.prio.val] += delay;
+    vardis_stats.max_update_delay_ms[theEntry.prio.val]  = std::max (vardis_stats.max_update_delay_ms[theEntry.prio.val], (unsigned long) delay);
+    theEntry.newVersionPending  = false;
+    theEntry.tLastUpdateTx      = currTime;
+  }
+
+
   // -----------------------------------------------------------------
 
   /**
    * This serializes an instruction container for VarUpdateT's, it generates
    * an ICHeader and a as many VarUpdateT records as possible / available.
    */
-  void VardisProtocolData::makeICTypeUpdates (AssemblyArea& area, unsigned int& containers_added)
+  void VardisProtocolData::makeICTypeUpdates (AssemblyArea& area,
+					      unsigned int& containers_added,
+					      VarPriorityT fromClass,
+					      VarPriorityT toClass)
   {    
-    // check for empty updateQ or insufficient size to add at least the first instruction record
-    if (    updateQ.empty()
-	 || (instructionSizeVarUpdate(updateQ.front()) + ICHeaderT::fixed_size() > area.available()))
+    if (updateQ.empty())
+      {
+	return;
+      }
+
+    // select the variables in the requested priority classes (a
+    // contiguous part of the updateQ, which is ordered by class) whose
+    // new version is not held back by the minimum update interval
+    TimeStampT  currTime  = TimeStampT::get_current_system_time();
+    auto [first, last]    = updateQ.class_range (fromClass.val, toClass.val);
+    std::deque<VarIdT> candidates;
+    for (size_t i = first; i < last; i++)
+      {
+	VarIdT          varId     = updateQ.queue[i];
+	const DBEntry&  theEntry  = vardis_store.get_db_entry_ref(varId);
+	if (   (theEntry.minInterval == 0)
+	    or (not theEntry.newVersionPending)
+	    or (currTime.milliseconds_passed_since (theEntry.tLastUpdateTx) >= theEntry.minInterval.val))
+	  candidates.push_back (varId);
+      }
+    
+    // check for no candidates or insufficient size to add at least the first instruction record
+    if (    candidates.empty()
+	 || (instructionSizeVarUpdate(candidates.front()) + ICHeaderT::fixed_size() > area.available()))
       {
         return;
       }
     
     // first work out how many records we will add
-    std::function<unsigned int(VarIdT)> instSizeFn = [&] (VarIdT varId) { return instructionSizeVarUpdate(varId); };
-    auto numberRecordsToAdd = numberFittingRecords(updateQ.queue, area, instSizeFn);
+    std::optional<size_t> candidateBytes;
+    if (candidates.size() == updateQ.size())
+      candidateBytes = updateQ.total_bytes();
+    auto numberRecordsToAdd = numberFittingRecords(candidates, area, updateRecordSizes, candidateBytes);
     
     if (numberRecordsToAdd <= 0)
       {
@@ -272,10 +432,10 @@ namespace dcp::vardis {
     icHeader.serialize(area);
 
     // serialize required records
+    updateQ.remove (candidates, numberRecordsToAdd);
     for (unsigned int i=0; i<numberRecordsToAdd; i++)
     {
-        VarIdT nextVarId = updateQ.front();
-        updateQ.pop_front();
+        VarIdT nextVarId = candidates[i];
         DBEntry& nextVar = vardis_store.get_db_entry_ref(nextVarId);
 
 	if (nextVar.countUpdate.val <= 0)
@@ -285,6 +445,7 @@ namespace dcp::vardis {
 	
         nextVar.countUpdate--;
 
+        noteVersionTransmitted (nextVar, currTime);
         addVarUpdate(nextVarId, nextVar, area);
 
         if (nextVar.countUpdate.val > 0)
@@ -313,8 +474,7 @@ namespace dcp::vardis {
     }
 
     // first work out how many records we will add
-    std::function<unsigned int(VarIdT)> instSizeFn = [&] (VarIdT varId) { return instructionSizeVarDelete(varId); };
-    auto numberRecordsToAdd = numberFittingRecords(deleteQ.queue, area, instSizeFn);
+    auto numberRecordsToAdd = numberFittingRecords(deleteQ.size(), area, VarDeleteT::fixed_size());
 
     if (numberRecordsToAdd <= 0)
       {
@@ -380,8 +540,7 @@ namespace dcp::vardis {
     }
 
     // first work out how many records we will add
-    std::function<unsigned int(VarIdT)> instSizeFn = [&] (VarIdT varId) { return instructionSizeReqUpdate(varId); };
-    auto numberRecordsToAdd = numberFittingRecords(reqUpdQ.queue, area, instSizeFn);
+    auto numberRecordsToAdd = numberFittingRecords(reqUpdQ.size(), area, VarReqUpdateT::fixed_size());
 
     if (numberRecordsToAdd <= 0)
       {
@@ -425,8 +584,7 @@ namespace dcp::vardis {
     }
 
     // first work out how many records we will add
-    std::function<unsigned int(VarIdT)> instSizeFn = [&] (VarIdT varId) { return instructionSizeReqCreate(varId); };
-    auto numberRecordsToAdd = numberFittingRecords(reqCreateQ.queue, area, instSizeFn);
+    auto numberRecordsToAdd = numberFittingRecords(reqCreateQ.size(), area, VarReqCreateT::fixed_size());
 
     if (numberRecordsToAdd <= 0)
       {
@@ -450,6 +608,300 @@ namespace dcp::vardis {
 
     containers_added += 1;
   }
+
+
+  // -----------------------------------------------------------------
+
+  /**
+   * This collects runs of consecutive varId's from a sorted sequence
+   * of varId's into VarSummRangeT records carrying seqnos. A run ends
+   * at a gap, when the maximum range length is reached, or when the
+   * next seqno would not fit into the area anymore.
+   */
+  size_t VardisProtocolData::collectSummaryRuns (const std::vector<VarIdT>& sorted_varids,
+						 AssemblyArea& area,
+						 size_t& bytes_needed,
+						 unsigned int max_records,
+						 std::vector<VarSummRangeT>& records)
+  {
+    const size_t  max_run_length = std::numeric_limits<byte>::max();
+    size_t        covered        = 0;
+
+    while (    (covered < sorted_varids.size())
+	    && (records.size() < max_records)
+	    && (bytes_needed + VarSummRangeT::seqnos_size(1) <= area.available()))
+      {
+	VarSummRangeT  record;
+	record.firstVarId = sorted_varids[covered];
+	record.mode       = SUMMRANGE_MODE_SEQNOS;
+	record.seqnos.push_back (vardis_store.get_db_entry_ref(record.firstVarId).seqno);
+
+	while (    (covered + record.seqnos.size() < sorted_varids.size())
+		&& (sorted_varids[covered + record.seqnos.size()].val == record.firstVarId.val + record.seqnos.size())
+		&& (record.seqnos.size() < max_run_length)
+		&& (bytes_needed + VarSummRangeT::seqnos_size(record.seqnos.size() + 1) <= area.available()))
+	  {
+	    VarIdT nextVarId = sorted_varids[covered + record.seqnos.size()];
+	    record.seqnos.push_back (vardis_store.get_db_entry_ref(nextVarId).seqno);
+	  }
+
+	record.numVars  =  record.seqnos.size();
+	bytes_needed    += record.total_size();
+	covered         += record.numVars;
+	records.push_back (record);
+      }
+
+    return covered;
+  }
+
+
+  // -----------------------------------------------------------------
+
+  /**
+   * This serializes an instruction container for VarSummRangeT's. It
+   * first serves explicit ranges requested by other nodes, then fills
+   * up with either digests (rotating over the ranges of size
+   * summaryDigestRange) or with seqno ranges (rotating over all
+   * variables in summaryQ). Requested ranges are also served when
+   * compactSummaries is not set, since they are the final step of
+   * Merkle tree anti-entropy.
+   */
+  void VardisProtocolData::makeICTypeSummaryRanges (AssemblyArea& area, unsigned int& containers_added)
+  {
+    // check whether summary ranges are enabled or requested and
+    // whether there is sufficient space to add at least one
+    // instruction record
+    const bool rotating = compactSummaries and not antiEntropy;
+    if (    ((not rotating) and summRangeQ.empty())
+	 || (maxSummaries == 0)
+	 || (summaryQ.empty() and summRangeQ.empty())
+	 || (ICHeaderT::fixed_size() + VarSummRangeT::seqnos_size(1) > area.available()))
+      {
+	return;
+      }
+
+    const unsigned int           max_records  = std::min ((unsigned int) maxSummaries, (unsigned int) ICHeaderT::max_records());
+    size_t                       bytes_needed = ICHeaderT::fixed_size();
+    std::vector<VarSummRangeT>   records;
+
+    // first serve explicit seqno ranges requested by other nodes
+    if (not summRangeQ.empty())
+      {
+	std::vector<VarIdT> requested;
+	for (auto varId : summRangeQ.queue)
+	  if (isSummarizable (varId))
+	    requested.push_back (varId);
+	std::sort (requested.begin(), requested.end());
+
+	auto covered = collectSummaryRuns (requested, area, bytes_needed, max_records, records);
+	for (size_t i = 0; i < covered; i++)
+	  summRangeQ.remove (requested[i]);
+	for (size_t i = covered; i < requested.size(); i++)
+	  if (not isSummarizable (requested[i]))
+	    summRangeQ.remove (requested[i]);
+      }
+
+    if (rotating and (summaryDigestRange > 0))
+      {
+	// rotate through all ranges, skipping those without any variables
+	const uint64_t  numIds     = VarIdT::max_number_identifiers();
+	const uint64_t  numRanges  = (numIds + summaryDigestRange - 1) / summaryDigestRange;
+	uint64_t        rangeIdx   = (summaryDigestCursor.val / summaryDigestRange) % numRanges;
+
+	for (uint64_t i = 0;
+	     (i < numRanges) and (records.size() < max_records) and (bytes_needed + VarSummRangeT::digest_size() <= area.available());
+	     i++)
+	  {
+	    uint64_t  start    = rangeIdx * summaryDigestRange;
+	    byte      numVars  = std::min ((uint64_t) summaryDigestRange, numIds - start);
+	    rangeIdx = (rangeIdx + 1) % numRanges;
+
+	    bool range_empty = true;
+	    for (uint64_t id = start; (id < start + numVars) and range_empty; id++)
+	      range_empty = not isSummarizable (VarIdT (id));
+	    if (range_empty)
+	      continue;
+
+	    VarSummRangeT record;
+	    record.firstVarId  =  VarIdT (start);
+	    record.numVars     =  numVars;
+	    record.mode        =  SUMMRANGE_MODE_DIGEST;
+	    record.digest      =  summaryRangeDigest (record.firstVarId, numVars);
+	    bytes_needed       += record.total_size();
+	    records.push_back (record);
+	  }
+	summaryDigestCursor = VarIdT ((rangeIdx * summaryDigestRange) % numIds);
+      }
+    else if (rotating and (not summaryQ.empty()))
+      {
+	// rotate through all summarizable variables, starting at the cursor
+	std::vector<VarIdT> rotation;
+	auto split = active_variables.lower_bound (summaryRangeCursor);
+	for (auto it = split; it != active_variables.end(); ++it)
+	  if (summaryQ.contains (*it))
+	    rotation.push_back (*it);
+	for (auto it = active_variables.begin(); it != split; ++it)
+	  if (summaryQ.contains (*it))
+	    rotation.push_back (*it);
+
+	auto covered = collectSummaryRuns (rotation, area, bytes_needed, max_records, records);
+	if (covered > 0)
+	  {
+	    uint64_t next = ((uint64_t) rotation[covered-1].val + 1) % VarIdT::max_number_identifiers();
+	    summaryRangeCursor = VarIdT (next);
+	  }
+      }
+
+    if (records.empty())
+      return;
+
+    // initialize and serialize ICHeader
+    ICHeaderT   icHeader;
+    icHeader.icType       = ICTYPE_SUMMARY_RANGES;
+    icHeader.icNumRecords = records.size();
+    icHeader.serialize(area);
+
+    // serialize the records
+    for (const auto& record : records)
+      record.serialize (area);
+
+    containers_added += 1;
+  }
+
+
+  // -----------------------------------------------------------------
+
+  /**
+   * This serializes an instruction container for VarReqSummRangeT's,
+   * it generates an ICHeader and a as many VarReqSummRangeT records
+   * as possible / available.
+   */
+  void VardisProtocolData::makeICTypeRequestSummaryRanges (AssemblyArea& area, unsigned int& containers_added)
+  {
+    // check for empty reqSummRangeQ or insufficient size to add at least the first instruction record
+    if (    reqSummRangeQ.empty()
+	 || (VarReqSummRangeT::fixed_size() + ICHeaderT::fixed_size() > area.available()))
+      {
+	return;
+      }
+
+    // work out how many records we will add
+    size_t numberRecordsToAdd = (area.available() - ICHeaderT::fixed_size()) / VarReqSummRangeT::fixed_size();
+    numberRecordsToAdd = std::min (numberRecordsToAdd, reqSummRangeQ.size());
+    numberRecordsToAdd = std::min (numberRecordsToAdd, (size_t) ICHeaderT::max_records());
+
+    // initialize and serialize ICHeader
+    ICHeaderT   icHeader;
+    icHeader.icType       = ICTYPE_REQUEST_SUMMRANGES;
+    icHeader.icNumRecords = numberRecordsToAdd;
+    icHeader.serialize(area);
+
+    // serialize required records
+    for (size_t i=0; i<numberRecordsToAdd; i++)
+      {
+	reqSummRangeQ.front().serialize (area);
+	reqSummRangeQ.pop_front ();
+      }
+
+    containers_added += 1;
+  }
+
+
+  // -----------------------------------------------------------------
+
+  /**
+   * This serializes an instruction container for VarMerkleNodeT's. The
+   * root hash is always included, followed by the current hashes of
+   * the nodes requested by other nodes.
+   */
+  void VardisProtocolData::makeICTypeMerkleNodes (AssemblyArea& area, unsigned int& containers_added)
+  {
+    // check whether anti-entropy is enabled and whether there is
+    // sufficient space to add at least the root hash
+    if (    (not antiEntropy)
+	 || (VarMerkleNodeT::fixed_size() + ICHeaderT::fixed_size() > area.available()))
+      {
+	return;
+      }
+
+    // age outstanding requests, forget them when patience is exhausted
+    for (auto it = merkleOutstanding.begin(); it != merkleOutstanding.end(); )
+      {
+	if (++(it->second) > merkleRequestPatience)
+	  it = merkleOutstanding.erase (it);
+	else
+	  ++it;
+      }
+
+    // work out how many records we will add
+    size_t numberRecordsToAdd = (area.available() - ICHeaderT::fixed_size()) / VarMerkleNodeT::fixed_size();
+    numberRecordsToAdd = std::min (numberRecordsToAdd, merkleNodeQ.size() + 1);
+    numberRecordsToAdd = std::min (numberRecordsToAdd, (size_t) ICHeaderT::max_records());
+
+    // initialize and serialize ICHeader
+    ICHeaderT   icHeader;
+    icHeader.icType       = ICTYPE_MERKLE_NODES;
+    icHeader.icNumRecords = numberRecordsToAdd;
+    icHeader.serialize(area);
+
+    // serialize root and requested nodes
+    VarMerkleNodeT root;
+    root.level = 0;
+    root.index = 0;
+    root.hash  = merkleTree.root();
+    root.serialize (area);
+
+    for (size_t i=1; i<numberRecordsToAdd; i++)
+      {
+	VarMerkleNodeT node;
+	node.level = merkleNodeQ.front().level;
+	node.index = merkleNodeQ.front().index;
+	node.hash  = merkleTree.get (node.level, node.index.val);
+	node.serialize (area);
+	merkleNodeQ.pop_front ();
+      }
+
+    containers_added += 1;
+  }
+
+
+  // -----------------------------------------------------------------
+
+  /**
+   * This serializes an instruction container for VarReqMerkleNodeT's,
+   * it generates an ICHeader and a as many VarReqMerkleNodeT records
+   * as possible / available.
+   */
+  void VardisProtocolData::makeICTypeRequestMerkleNodes (AssemblyArea& area, unsigned int& containers_added)
+  {
+    // check for empty reqMerkleNodeQ or insufficient size to add at least the first instruction record
+    if (    reqMerkleNodeQ.empty()
+	 || (VarReqMerkleNodeT::fixed_size() + ICHeaderT::fixed_size() > area.available()))
+      {
+	return;
+      }
+
+    // work out how many records we will add
+    size_t numberRecordsToAdd = (area.available() - ICHeaderT::fixed_size()) / VarReqMerkleNodeT::fixed_size();
+    numberRecordsToAdd = std::min (numberRecordsToAdd, reqMerkleNodeQ.size());
+    numberRecordsToAdd = std::min (numberRecordsToAdd, (size_t) ICHeaderT::max_records());
+
+    // initialize and serialize ICHeader
+    ICHeaderT   icHeader;
+    icHeader.icType       = ICTYPE_REQUEST_MERKLENODES;
+    icHeader.icNumRecords = numberRecordsToAdd;
+    icHeader.serialize(area);
+
+    // serialize required records
+    for (size_t i=0; i<numberRecordsToAdd; i++)
+      {
+	reqMerkleNodeQ.front().serialize (area);
+	reqMerkleNodeQ.pop_front ();
+      }
+
+    containers_added += 1;
+  }
+  
   
 
   /**
@@ -492,12 +944,16 @@ namespace dcp::vardis {
 	newEntry.repCnt       =  create.spec.repCnt;
 	newEntry.creationTime =  create.spec.creationTime;
 	newEntry.timeout      =  create.spec.timeout;
+	newEntry.prio         =  create.spec.prio;
+	newEntry.minInterval  =  create.spec.minInterval;
         newEntry.seqno        =  create.update.seqno;
-        newEntry.tStamp       =  TimeStampT::get_current_system_time();
+        newEntry.tStamp       =  TimeStampT::get_current_coarse_time();
         newEntry.countUpdate  =  0;
         newEntry.countCreate  =  create.spec.repCnt;
         newEntry.countDelete  =  0;
         newEntry.isDeleted    =  false;
+        newEntry.tLastUpdateTx  =  newEntry.tStamp;
+        newEntry.summaryDue     =  summaryVirtualTime;
 	if (not variable_exists)
 	  {
 	    vardis_store.allocate_identifier (varId);
@@ -505,7 +961,9 @@ namespace dcp::vardis {
 	vardis_store.set_db_entry (varId, newEntry);
 	vardis_store.update_description (varId, create.spec.descr);
 	vardis_store.update_value (varId, create.update.value);
+	cacheRecordSizes (varId);
 	active_variables.insert (varId);
+	updateMerkleLeaf (varId);
 
         // just to be safe, delete varId from all queues before inserting it
         // into the right ones
@@ -515,13 +973,14 @@ namespace dcp::vardis {
         summaryQ.remove (varId);
         reqUpdQ.remove (varId);
         reqCreateQ.remove (varId);
+        summRangeQ.remove (varId);
 
         // add varId to relevant queues
         createQ.insert (varId);
         summaryQ.insert (varId);
 
 	// maintain statistics
-	auto vardis_stats = vardis_store.get_vardis_protocol_statistics_ref ();
+	auto& vardis_stats = vardis_store.get_vardis_protocol_statistics_ref ();
 	vardis_stats.count_process_var_create++;
     }
   }
@@ -552,6 +1011,7 @@ namespace dcp::vardis {
 	  theEntry.countUpdate  = 0;
 	  theEntry.countCreate  = 0;
 	  theEntry.countDelete  = theEntry.repCnt;
+	  updateMerkleLeaf (varId);
 	  
 	  // remove varId from relevant queues
 	  updateQ.remove (varId);
@@ -559,6 +1019,7 @@ namespace dcp::vardis {
 	  reqUpdQ.remove (varId);
 	  reqCreateQ.remove (varId);
 	  summaryQ.remove (varId);
+	  summRangeQ.remove (varId);
 	  deleteQ.remove (varId);
 
 	  // add it to deleteQ
@@ -606,6 +1067,7 @@ namespace dcp::vardis {
 
     if (producerIsMe(varId))
     {
+        adoptOwnSeqno (varId, theEntry, update.seqno);
         return;
     }
 
@@ -617,6 +1079,7 @@ namespace dcp::vardis {
 
     if (theEntry.seqno == update.seqno)
     {
+        theEntry.isStale = false;
         return;
     }
 
@@ -637,14 +1100,14 @@ namespace dcp::vardis {
 
     // update variable with new value, update relevant queues
     theEntry.seqno        =  update.seqno;
-    theEntry.tStamp       =  TimeStampT::get_current_system_time();
+    theEntry.tStamp       =  TimeStampT::get_current_coarse_time();
     theEntry.countUpdate  =  theEntry.repCnt;
+    theEntry.isStale      =  false;
     vardis_store.update_value (varId, update.value);
+    cacheRecordSizes (varId);
+    updateMerkleLeaf (varId);
 
-    if (not updateQ.contains (varId))
-    {
-        updateQ.insert (varId);
-    }
+    updateQ.insert (varId);
     reqUpdQ.remove (varId);
     
     // maintain statistics
@@ -687,11 +1150,13 @@ namespace dcp::vardis {
     
     if (producerIsMe(varId))
       {
+        adoptOwnSeqno (varId, theEntry, seqno);
         return;
       }
     
     if (theEntry.seqno == seqno)
       {
+        theEntry.isStale = false;
         return;
       }
     
@@ -756,11 +1221,7 @@ namespace dcp::vardis {
       }
     
     theEntry.countUpdate = theEntry.repCnt;
-    
-    if (not updateQ.contains (varId))
-      {
-	updateQ.insert (varId);
-      }
+    updateQ.insert (varId);
 
     // maintain statistics
     vardis_store.get_vardis_protocol_statistics_ref().count_process_var_requpdate++;
@@ -806,6 +1267,207 @@ namespace dcp::vardis {
   }
 
 
+  // ----------------------------------------------------
+
+  /**
+   * Processes a received VarSummRangeT entry. A range carrying seqnos
+   * is processed like the corresponding individual VarSummT
+   * entries. For a range carrying a digest we compare against our own
+   * digest for that range and, if they differ, schedule a request for
+   * explicit summaries of that range.
+   */
+  void VardisProtocolData::process_var_summrange (const VarSummRangeT& summrange)
+  {
+    DCPLOG_TRACE(log_rx) << "process_var_summrange: got summary range " << summrange;
+
+    if (summrange.mode == SUMMRANGE_MODE_SEQNOS)
+      {
+	for (size_t i = 0; i < summrange.seqnos.size(); i++)
+	  {
+	    uint64_t id = (uint64_t) summrange.firstVarId.val + i;
+	    if (id > VarIdT::max_val())
+	      break;
+
+	    VarSummT summ;
+	    summ.varId = VarIdT (id);
+	    summ.seqno = summrange.seqnos[i];
+	    process_var_summary (summ);
+	  }
+      }
+    else
+      {
+	VarReqSummRangeT req;
+	req.firstVarId = summrange.firstVarId;
+	req.numVars    = summrange.numVars;
+	auto pending   = std::find (reqSummRangeQ.begin(), reqSummRangeQ.end(), req);
+	
+	if (summaryRangeDigest (summrange.firstVarId, summrange.numVars) == summrange.digest)
+	  {
+	    // in sync for this range, no need to request explicit summaries anymore
+	    if (pending != reqSummRangeQ.end())
+	      reqSummRangeQ.erase (pending);
+	    return;
+	  }
+
+	DCPLOG_TRACE(log_rx) << "process_var_summrange: digest mismatch for range starting at " << summrange.firstVarId;
+	
+	if (pending == reqSummRangeQ.end())
+	  reqSummRangeQ.push_back (req);
+      }
+
+    // maintain statistics
+    vardis_store.get_vardis_protocol_statistics_ref().count_process_var_summrange++;
+  }
+
+
+  // ----------------------------------------------------
+
+  /**
+   * Processes a received VarReqSummRangeT entry: all our summarizable
+   * variables in the given range are scheduled for inclusion into an
+   * explicit (seqno) summary range.
+   */
+  void VardisProtocolData::process_var_reqsummrange (const VarReqSummRangeT& reqsummrange)
+  {
+    DCPLOG_TRACE(log_rx) << "process_var_reqsummrange: got request " << reqsummrange;
+
+    for (unsigned int i = 0; i < reqsummrange.numVars; i++)
+      {
+	uint64_t id = (uint64_t) reqsummrange.firstVarId.val + i;
+	if (id > VarIdT::max_val())
+	  break;
+	if (isSummarizable (VarIdT (id)))
+	  summRangeQ.insert (VarIdT (id));
+      }
+
+    // maintain statistics
+    vardis_store.get_vardis_protocol_statistics_ref().count_process_var_reqsummrange++;
+  }
+
+
+  // ----------------------------------------------------
+
+  /**
+   * Processes a received VarMerkleNodeT entry. If the hash differs
+   * from our own hash for that node and the sender has any variables
+   * in the subtree, we either request the hashes of its children or,
+   * once the subtree is small enough, explicit summaries for the
+   * variable identifiers it covers -- unless we did so recently. A
+   * matching hash cancels any pending request for that node.
+   */
+  void VardisProtocolData::process_var_merklenode (const VarMerkleNodeT& merklenode)
+  {
+    DCPLOG_TRACE(log_rx) << "process_var_merklenode: got Merkle tree node " << merklenode;
+
+    if (    (not antiEntropy)
+	 || (merklenode.level > VardisMerkleTree::depth())
+	 || (merklenode.index.val >= VardisMerkleTree::width (merklenode.level)))
+      {
+	return;
+      }
+
+    VarReqMerkleNodeT req;
+    req.level     = merklenode.level;
+    req.index     = merklenode.index;
+    auto pending  = std::find (reqMerkleNodeQ.begin(), reqMerkleNodeQ.end(), req);
+    uint64_t pos  = VardisMerkleTree::width (merklenode.level) + merklenode.index.val;
+
+    if (merkleTree.get (merklenode.level, merklenode.index.val) == merklenode.hash)
+      {
+	if (pending != reqMerkleNodeQ.end())
+	  reqMerkleNodeQ.erase (pending);
+	merkleOutstanding.erase (pos);
+	return;
+      }
+
+    // the sender has nothing to offer in this subtree (it will learn
+    // about our variables from our own hashes), or we are already
+    // descending into it
+    if ((merklenode.hash == 0) or merkleOutstanding.contains (pos))
+      return;
+
+    merkleOutstanding[pos] = 0;
+    uint64_t span = VardisMerkleTree::span (merklenode.level);
+    if (span <= antiEntropyLeafRange)
+      {
+	VarReqSummRangeT reqrange;
+	reqrange.firstVarId = VarIdT (merklenode.index.val * span);
+	reqrange.numVars    = span;
+	if (std::find (reqSummRangeQ.begin(), reqSummRangeQ.end(), reqrange) == reqSummRangeQ.end())
+	  reqSummRangeQ.push_back (reqrange);
+      }
+    else if (pending == reqMerkleNodeQ.end())
+      {
+	reqMerkleNodeQ.push_back (req);
+      }
+
+    // maintain statistics
+    vardis_store.get_vardis_protocol_statistics_ref().count_process_var_merklenode++;
+  }
+
+
+  // ----------------------------------------------------
+
+  /**
+   * Processes a received VarReqMerkleNodeT entry: the hashes of both
+   * children of the requested node are scheduled for transmission.
+   */
+  void VardisProtocolData::process_var_reqmerklenode (const VarReqMerkleNodeT& reqmerklenode)
+  {
+    DCPLOG_TRACE(log_rx) << "process_var_reqmerklenode: got request " << reqmerklenode;
+
+    if (    (not antiEntropy)
+	 || (reqmerklenode.level >= VardisMerkleTree::depth())
+	 || (reqmerklenode.index.val >= VardisMerkleTree::width (reqmerklenode.level)))
+      {
+	return;
+      }
+
+    for (uint64_t child = 0; child < 2; child++)
+      {
+	VarReqMerkleNodeT node;
+	node.level = reqmerklenode.level + 1;
+	node.index = VarIdT (2 * (uint64_t) reqmerklenode.index.val + child);
+	if (std::find (merkleNodeQ.begin(), merkleNodeQ.end(), node) == merkleNodeQ.end())
+	  merkleNodeQ.push_back (node);
+      }
+
+    // maintain statistics
+    vardis_store.get_vardis_protocol_statistics_ref().count_process_var_reqmerklenode++;
+  }
+
+
+  // ----------------------------------------------------
+
+  uint32_t VardisProtocolData::summaryRangeDigest (VarIdT firstVarId, byte numVars)
+  {
+    const uint32_t fnv_offset_basis = 2166136261u;
+    const uint32_t fnv_prime        = 16777619u;
+
+    auto fnv_step = [&] (uint32_t h, byte b) { return (h ^ b) * fnv_prime; };
+    
+    uint32_t digest = fnv_offset_basis;
+    for (unsigned int i = 0; i < numVars; i++)
+      {
+	uint64_t id = (uint64_t) firstVarId.val + i;
+	if (id > VarIdT::max_val())
+	  break;
+
+	VarIdT varId (id);
+	if (not isSummarizable (varId))
+	  continue;
+
+	VarSeqnoT seqno = vardis_store.get_db_entry_ref(varId).seqno;
+	for (size_t k = sizeof(varId.val); k > 0; k--)
+	  digest = fnv_step (digest, (byte) (((uint64_t) varId.val) >> (8*(k-1))));
+	for (size_t k = sizeof(seqno.val); k > 0; k--)
+	  digest = fnv_step (digest, (byte) (((uint64_t) seqno.val) >> (8*(k-1))));
+      }
+    
+    return digest;
+  }
+
+
   // ----------------------------------------------------
 
   RTDB_Create_Confirm VardisProtocolData::handle_rtdb_create_request (const RTDB_Create_Request& createReq)
@@ -852,6 +1514,16 @@ namespace dcp::vardis {
 	return RTDB_Create_Confirm (VARDIS_STATUS_ILLEGAL_REPCOUNT, varId);
       }
 
+    if (spec.prio > VarPriorityT::max_val())
+      {
+	return RTDB_Create_Confirm (VARDIS_STATUS_ILLEGAL_PRIORITY, varId);
+      }
+
+    if (spec.minInterval > VarIntervalT::max_val())
+      {
+	return RTDB_Create_Confirm (VARDIS_STATUS_ILLEGAL_INTERVAL, varId);
+      }
+
     DCPLOG_TRACE(log_mgmt_rtdb) << "Processing RTDB-Create request for variable " << spec.varId;
     
     // initialize new database entry and add it
@@ -861,12 +1533,16 @@ namespace dcp::vardis {
     newent.repCnt        =  spec.repCnt;
     newent.creationTime  =  TimeStampT::get_current_system_time();
     newent.timeout       =  spec.timeout;
+    newent.prio          =  spec.prio;
+    newent.minInterval   =  spec.minInterval;
     newent.seqno         =  0;
-    newent.tStamp        =  TimeStampT::get_current_system_time();
+    newent.tStamp        =  TimeStampT::get_current_coarse_time();
     newent.countUpdate   =  0;
     newent.countCreate   =  spec.repCnt;
     newent.countDelete   =  0;
     newent.isDeleted     =  false;
+    newent.tLastUpdateTx =  newent.tStamp;
+    newent.summaryDue    =  summaryVirtualTime;
     if (not variable_exists)
       {
 	vardis_store.allocate_identifier (spec.varId);
@@ -874,7 +1550,9 @@ namespace dcp::vardis {
     vardis_store.set_db_entry (spec.varId, newent);
     vardis_store.update_description (spec.varId, spec.descr);
     vardis_store.update_value (spec.varId, value);
+    cacheRecordSizes (spec.varId);
     active_variables.insert (spec.varId);
+    updateMerkleLeaf (spec.varId);
 
     // clean out varId from all queues, just to be safe
     createQ.remove (spec.varId);
@@ -883,6 +1561,7 @@ namespace dcp::vardis {
     deleteQ.remove (spec.varId);
     reqUpdQ.remove (spec.varId);
     reqCreateQ.remove ( spec.varId);
+    summRangeQ.remove (spec.varId);
 
     // add new variable to relevant queues
     createQ.insert (spec.varId);
@@ -938,20 +1617,39 @@ namespace dcp::vardis {
       return RTDB_Update_Confirm (VARDIS_STATUS_EMPTY_VALUE, varId);
     }
     
-    // update the DB entry
-    theEntry.seqno        = (theEntry.seqno.val + 1) % (VarSeqnoT::modulus());
+    // update the DB entry. For a rate-limited variable whose previous
+    // version has not been transmitted yet, the new value replaces it
+    // under the same seqno (coalescing). A queued re-send of a version
+    // that has been transmitted before does not qualify, neighbours
+    // holding that seqno would not adopt the new value
+    if (    (theEntry.minInterval > 0)
+	 && theEntry.newVersionPending
+	 && updateQ.contains (varId))
+      {
+	vardis_store.get_vardis_protocol_statistics_ref().count_update_coalesced[theEntry.prio.val]++;
+      }
+    else
+      {
+	theEntry.seqno    = (theEntry.seqno.val + 1) % (VarSeqnoT::modulus());
+      }
     theEntry.countUpdate  = theEntry.repCnt;
-    theEntry.tStamp       = TimeStampT::get_current_system_time();
+    theEntry.tStamp       = TimeStampT::get_current_coarse_time();
+    theEntry.isStale      = false;
     vardis_store.update_value (varId, updateReq.value);
+    cacheRecordSizes (varId);
+    updateMerkleLeaf (varId);
 
     DCPLOG_TRACE(log_mgmt_rtdb) << "Handling RTDB-Update request for variable " << varId
 				<< " with new timestamp " << theEntry.tStamp;
     
-    // add varId to updateQ if necessary
-    if (not updateQ.contains (varId))
-    {
-        updateQ.insert (varId);
-    }
+    // add varId to updateQ if necessary, the queueing delay of a new
+    // version is measured from its first RTDB-Update
+    updateQ.insert (varId);
+    if (not theEntry.newVersionPending)
+      {
+	theEntry.newVersionPending  = true;
+	theEntry.tUpdateQueued      = TimeStampT::get_current_system_time();
+      }
 
     // Maintain statistics
     vardis_store.get_vardis_protocol_statistics_ref().count_handle_rtdb_update++;
@@ -1002,6 +1700,7 @@ namespace dcp::vardis {
     updateQ.remove (varId);
     reqUpdQ.remove (varId);
     reqCreateQ.remove (varId);
+    summRangeQ.remove (varId);
 
     deleteQ.insert(varId);
     
@@ -1010,6 +1709,7 @@ namespace dcp::vardis {
     theEntry.countDelete = theEntry.repCnt;
     theEntry.countCreate = 0;
     theEntry.countUpdate = 0;
+    updateMerkleLeaf (varId);
 
     // Maintain statistics
     vardis_store.get_vardis_protocol_statistics_ref().count_handle_rtdb_delete++;
@@ -1049,7 +1749,8 @@ namespace dcp::vardis {
 
     VarValueT the_value = vardis_store.read_value (varId);
     RTDB_Read_Confirm conf (VARDIS_STATUS_OK, varId, the_value.length, the_value.data);
-    conf.tStamp = theEntry.tStamp;
+    conf.tStamp  = theEntry.tStamp;
+    conf.isStale = theEntry.isStale;
 
     // Maintain statistics
     vardis_store.get_vardis_protocol_statistics_ref().count_handle_rtdb_read++;
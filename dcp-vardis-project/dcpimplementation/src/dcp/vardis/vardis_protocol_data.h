@@ -20,13 +20,19 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <functional>
 #include <map>
+#include <optional>
 #include <queue>
 #include <set>
+#include <vector>
 #include <dcp/common/area.h>
+#include <dcp/common/fixedmem_deadline_heap.h>
 #include <dcp/common/global_types_constants.h>
 #include <dcp/vardis/vardis_configuration.h>
+#include <dcp/vardis/vardis_merkle_tree.h>
 #include <dcp/vardis/vardis_protocol_statistics.h>
 #include <dcp/vardis/vardis_rtdb_entry.h>
 #include <dcp/vardis/vardis_service_primitives.h>
@@ -139,6 +145,287 @@ namespace dcp::vardis {
     {
       remove (front ());
     };
+
+
+    /**
+     * @brief Removes the first 'count' varId's of the given list from
+     *        the VarIdQueue, in a single pass over the queue
+     *
+     * @param varIds: list of variable identifiers
+     * @param count: number of leading entries of varIds to remove
+     */
+    inline void remove (const std::deque<VarIdT>& varIds, size_t count)
+    {
+      std::array<bool, VarIdT::max_number_identifiers()> doomed = {};
+      for (size_t i = 0; i < std::min (count, varIds.size()); i++)
+	{
+	  doomed[varIds[i].val] = true;
+	  members.erase (varIds[i]);
+	}
+      std::erase_if (queue, [&] (VarIdT varId) { return doomed[varId.val]; });
+    };
+  };
+
+
+  /**
+   * @brief Per-variable table of serialized record sizes, indexed by
+   *        varId
+   */
+  typedef std::array<uint32_t, VarIdT::max_number_identifiers()> RecordSizeTable;
+
+
+  /**
+   * @brief A VarIdQueue that additionally keeps a running total of
+   *        the serialized sizes of the records of its members, taken
+   *        from a record size table
+   *
+   * The record size table is owned by the using code, which must
+   * report size changes of queued variables through resize().
+   */
+  class SizedVarIdQueue : public VarIdQueue {
+  protected:
+    const RecordSizeTable&  recordSizes;     /*!< Serialized record size per varId */
+    size_t                  bytes     = 0;   /*!< Sum of record sizes of all members */
+  public:
+
+    SizedVarIdQueue () = delete;
+    SizedVarIdQueue (const RecordSizeTable& sizes) : recordSizes (sizes) {};
+
+
+    /**
+     * @brief Returns the total serialized size of the records of all
+     *        members of the queue (without instruction container
+     *        header)
+     */
+    inline size_t total_bytes () const { return bytes; };
+
+
+    inline void remove (VarIdT varId)
+    {
+      if (contains (varId))
+	{
+	  bytes -= recordSizes[varId.val];
+	  VarIdQueue::remove (varId);
+	}
+    };
+
+    
+    inline void remove (const std::deque<VarIdT>& varIds, size_t count)
+    {
+      for (size_t i = 0; i < std::min (count, varIds.size()); i++)
+	if (contains (varIds[i]))
+	  bytes -= recordSizes[varIds[i].val];
+      VarIdQueue::remove (varIds, count);
+    };
+
+    
+    inline void insert (VarIdT varId)
+    {
+      if (not contains (varId))
+	{
+	  bytes += recordSizes[varId.val];
+	  VarIdQueue::insert (varId);
+	}
+    };
+
+    
+    inline void pop_front ()
+    {
+      remove (front ());
+    };
+
+
+    /**
+     * @brief Adjusts the running total when the record size of the
+     *        given variable is about to change to newSize. Must be
+     *        called before the record size table is updated
+     */
+    inline void resize (VarIdT varId, uint32_t newSize)
+    {
+      if (contains (varId))
+	bytes = bytes - recordSizes[varId.val] + newSize;
+    };
+  };
+
+
+  /**
+   * @brief A SizedVarIdQueue whose queue is kept ordered by priority
+   *        class (most important class first), and in insertion order
+   *        within each class
+   *
+   * The priority class of a variable is obtained from the given
+   * lookup function when it is inserted and remembered until it is
+   * removed, so the front of the queue always holds the records that
+   * go first into a payload.
+   */
+  class PrioritizedVarIdQueue : public SizedVarIdQueue {
+  public:
+    typedef std::function<uint8_t (VarIdT)> PriorityLookup;
+
+  protected:
+    PriorityLookup  priorityOf;                                                /*!< Returns the priority class of a variable */
+    std::array<uint8_t, VarIdT::max_number_identifiers()>  memberClass = {};  /*!< Priority class of each member, by varId */
+    std::array<size_t, VarPriorityT::number_classes()>     classSize   = {};  /*!< Number of members per priority class */
+
+  public:
+
+    PrioritizedVarIdQueue () = delete;
+    PrioritizedVarIdQueue (const RecordSizeTable& sizes, PriorityLookup prio)
+      : SizedVarIdQueue (sizes), priorityOf (prio) {};
+
+
+    /**
+     * @brief Returns the index range [first, last) of the queue
+     *        holding the members of priority classes fromClass to
+     *        toClass
+     */
+    inline std::pair<size_t, size_t> class_range (uint8_t fromClass, uint8_t toClass) const
+    {
+      size_t first = 0, last = 0;
+      for (uint8_t c = 0; c < classSize.size(); c++)
+	{
+	  if (c < fromClass)  first += classSize[c];
+	  if (c <= toClass)   last  += classSize[c];
+	}
+      return {first, std::max (first, last)};
+    };
+
+    
+    inline void remove (VarIdT varId)
+    {
+      if (contains (varId))
+	{
+	  classSize[memberClass[varId.val]]--;
+	  SizedVarIdQueue::remove (varId);
+	}
+    };
+
+    
+    inline void remove (const std::deque<VarIdT>& varIds, size_t count)
+    {
+      for (size_t i = 0; i < std::min (count, varIds.size()); i++)
+	if (contains (varIds[i]))
+	  classSize[memberClass[varIds[i].val]]--;
+      SizedVarIdQueue::remove (varIds, count);
+    };
+
+    
+    /**
+     * @brief Adds the variable behind all queued members of its own
+     *        and more important priority classes
+     */
+    inline void insert (VarIdT varId)
+    {
+      if (contains (varId))
+	return;
+
+      uint8_t cls = std::min (priorityOf (varId), VarPriorityT::max_val());
+      size_t  pos = 0;
+      for (uint8_t c = 0; c <= cls; c++)
+	pos += classSize[c];
+
+      bytes += recordSizes[varId.val];
+      members.insert (varId);
+      queue.insert (queue.begin() + pos, varId);
+      memberClass[varId.val] = cls;
+      classSize[cls]++;
+    };
+
+    
+    inline void pop_front ()
+    {
+      remove (front ());
+    };
+  };
+
+
+  /**
+   * @brief A VarIdQueue that additionally keeps its members scheduled
+   *        by a due time, earliest first and in insertion order for
+   *        equal due times
+   *
+   * The due time of a variable is obtained from the given lookup
+   * function when it is inserted or rescheduled. The schedule is an
+   * indexed heap, so the k members due next are found in O(k log n)
+   * time. The queue itself stays in insertion order.
+   */
+  class ScheduledVarIdQueue : public VarIdQueue {
+  public:
+    typedef std::function<uint64_t (VarIdT)> DueTimeLookup;
+
+  protected:
+    typedef std::pair<uint64_t, uint64_t> Deadline;   /*!< Due time and insertion number */
+
+    DueTimeLookup  dueOf;                                                              /*!< Returns the due time of a variable */
+    FixedMemDeadlineHeap<Deadline, VarIdT::max_number_identifiers()>  schedule;        /*!< Scheduled members, by varId */
+    uint64_t       insertions = 0;                                                     /*!< Number of insertions into the schedule so far */
+
+  public:
+
+    ScheduledVarIdQueue () = delete;
+    ScheduledVarIdQueue (DueTimeLookup due) : dueOf (due) {};
+
+    
+    inline void remove (VarIdT varId)
+    {
+      schedule.remove (varId.val);
+      VarIdQueue::remove (varId);
+    };
+
+    
+    inline void remove (const std::deque<VarIdT>& varIds, size_t count)
+    {
+      for (size_t i = 0; i < std::min (count, varIds.size()); i++)
+	schedule.remove (varIds[i].val);
+      VarIdQueue::remove (varIds, count);
+    };
+
+    
+    inline void insert (VarIdT varId)
+    {
+      if (not contains (varId))
+	{
+	  VarIdQueue::insert (varId);
+	  reschedule (varId);
+	}
+    };
+
+    
+    inline void pop_front ()
+    {
+      remove (front ());
+    };
+
+
+    /**
+     * @brief Takes the (at most) count scheduled members with the
+     *        earliest due times out of the schedule and returns them
+     *        in schedule order. They remain members of the queue and
+     *        must be given back with reschedule()
+     */
+    inline std::vector<VarIdT> take_due (size_t count)
+    {
+      std::vector<VarIdT> due;
+      while ((due.size() < count) and (not schedule.is_empty()))
+	{
+	  VarIdT varId = VarIdT (schedule.top_slot());
+	  schedule.remove (varId.val);
+	  due.push_back (varId);
+	}
+      return due;
+    };
+
+
+    /**
+     * @brief Re-reads the due time of a member and schedules it
+     *        behind all members with the same due time. No effect
+     *        for non-members
+     */
+    inline void reschedule (VarIdT varId)
+    {
+      if (contains (varId))
+	schedule.update (varId.val, {dueOf (varId), insertions++});
+    };
   };
 
   
@@ -163,7 +450,10 @@ namespace dcp::vardis {
 	maxDescriptionLength (store_if.get_conf_max_description_length()),
 	maxValueLength (store_if.get_conf_max_value_length()),
 	maxRepetitions (store_if.get_conf_max_repetitions()),
-	vardis_store (store_if)
+	vardis_store (store_if),
+	createQ (createRecordSizes, [this] (VarIdT varId) { return vardis_store.get_db_entry_ref(varId).prio.val; }),
+	updateQ (updateRecordSizes, [this] (VarIdT varId) { return vardis_store.get_db_entry_ref(varId).prio.val; }),
+	summaryQ ([this] (VarIdT varId) { return vardis_store.get_db_entry_ref(varId).summaryDue; })
     {};
 
 
@@ -176,6 +466,29 @@ namespace dcp::vardis {
     size_t           maxDescriptionLength;  /*!< maxDescriptionLength protocol parameter */
     size_t           maxValueLength;        /*!< maxValueLength protocol parameter */
     uint8_t          maxRepetitions;        /*!< maxRepetitions protocol parameter */
+
+
+    /**
+     * The following data members control the use of compact summary
+     * ranges (VarSummRangeT) instead of individual VarSummT records.
+     * They are not part of the variable store and need to be set by
+     * the using code after construction.
+     */
+    bool             compactSummaries    = false;  /*!< Send summary ranges instead of VarSummT records */
+    uint16_t         summaryDigestRange  = 0;      /*!< Number of varIds covered by one digest, 0 disables digests */
+
+
+    /**
+     * The following data members control Merkle tree based
+     * anti-entropy. When enabled, the root hash of the Merkle tree
+     * replaces the summaries, and nodes descend into differing
+     * subtrees until these cover at most antiEntropyLeafRange
+     * variable identifiers, for which explicit summary ranges are
+     * then requested. Like the members above they need to be set by
+     * the using code after construction.
+     */
+    bool             antiEntropy           = false;  /*!< Exchange Merkle tree hashes instead of summaries */
+    uint16_t         antiEntropyLeafRange  = 8;      /*!< Subtree size (power of two) at which descent stops */
     
 
     /**
@@ -195,15 +508,76 @@ namespace dcp::vardis {
     std::set<VarIdT> active_variables;
     
     
+    /**
+     * @brief Cached serialized sizes of the VarCreateT and VarUpdateT
+     *        records of all variables, maintained whenever a value or
+     *        description changes (cf. cacheRecordSizes)
+     */
+    RecordSizeTable  createRecordSizes = {};
+    RecordSizeTable  updateRecordSizes = {};
+    
+    
     /**
      * @brief The Vardis queues
      */
-    VarIdQueue    createQ;     /*!< Queue for VarCreateT instruction records to send */
+    PrioritizedVarIdQueue  createQ;  /*!< Queue for VarCreateT instruction records to send */
     VarIdQueue    deleteQ;     /*!< Queue for VarDeleteT instruction records to send */
-    VarIdQueue    updateQ;     /*!< Queue for VarUpdateT instruction records to send */
-    VarIdQueue    summaryQ;    /*!< Queue for VarSummT instruction records to send */
+    PrioritizedVarIdQueue  updateQ;  /*!< Queue for VarUpdateT instruction records to send */
+    ScheduledVarIdQueue  summaryQ;  /*!< Queue for VarSummT instruction records to send, scheduled by summaryDue */
     VarIdQueue    reqUpdQ;     /*!< Queue for VarReqUpdateT instruction records to send */
     VarIdQueue    reqCreateQ;  /*!< Queue for VarReqCreateT instruction records to send */
+    VarIdQueue    summRangeQ;  /*!< Variables to be reported in explicit (seqno) summary ranges upon request */
+
+
+    /**
+     * @brief Queue of VarReqSummRangeT instruction records to send
+     */
+    std::deque<VarReqSummRangeT>  reqSummRangeQ;
+
+
+    /**
+     * @brief Rotating positions (next varId to start from) for
+     *        generating summary ranges in seqno and digest mode
+     */
+    VarIdT        summaryRangeCursor;
+    VarIdT        summaryDigestCursor;
+
+
+    /**
+     * @brief Virtual time of the weighted summary schedule: a
+     *        variable of priority class p is due for its next
+     *        summary 2^p virtual time units after its last one
+     */
+    uint64_t      summaryVirtualTime = 0;
+
+
+    /**
+     * @brief Merkle tree over the (varId, seqno) pairs of the
+     *        database, kept up to date by all operations changing
+     *        the seqno or existence of a variable
+     */
+    VardisMerkleTree  merkleTree;
+
+
+    /**
+     * @brief Queue of Merkle tree nodes whose hashes other nodes
+     *        requested, and queue of VarReqMerkleNodeT instruction
+     *        records to send
+     */
+    std::deque<VarReqMerkleNodeT>  merkleNodeQ;
+    std::deque<VarReqMerkleNodeT>  reqMerkleNodeQ;
+
+
+    /**
+     * @brief Merkle tree nodes (by heap position) for which we
+     *        recently requested children hashes or explicit
+     *        summaries, with the number of own Merkle containers
+     *        sent since. Such nodes are not requested again before
+     *        merkleRequestPatience containers have been sent, so that
+     *        ongoing descents are not restarted from the root.
+     */
+    std::map<uint64_t, unsigned int>  merkleOutstanding;
+    static constexpr unsigned int     merkleRequestPatience = VardisMerkleTree::depth ();
 
         
     // ====================================================================================
@@ -220,10 +594,7 @@ namespace dcp::vardis {
      */
     inline unsigned int instructionSizeVarCreate(VarIdT varId) const
     {
-      return    VarSpecT::fixed_size()
-	      + vardis_store.size_of_description (varId)
-	      + VarUpdateT::fixed_size()
-	+ vardis_store.size_of_value (varId);
+      return createRecordSizes[varId.val];
     };
 
 
@@ -245,7 +616,7 @@ namespace dcp::vardis {
      */
     inline unsigned int instructionSizeVarUpdate(VarIdT varId) const
     {
-      return VarUpdateT::fixed_size() + vardis_store.size_of_value (varId);
+      return updateRecordSizes[varId.val];
     };
     
 
@@ -289,24 +660,107 @@ namespace dcp::vardis {
     void addVarReqCreate (VarIdT varId, AssemblyArea& area) const;
     void addVarReqUpdate (VarIdT varId, const DBEntry& theEntry, AssemblyArea& area) const;
 
+
+    /**
+     * @brief Checks whether the given variable is to be included in
+     *        summaries and digests (i.e. it exists and is not deleted)
+     */
+    inline bool isSummarizable (VarIdT varId)
+    {
+      return variableExists (varId) and (not vardis_store.get_db_entry_ref (varId).isDeleted);
+    };
+
+
+    /**
+     * @brief Collects runs of consecutive varId's from the given
+     *        sorted sequence into summary range records in mode
+     *        SUMMRANGE_MODE_SEQNOS, as many as fit into the area
+     *
+     * @param sorted_varids: sorted varId's to be summarized
+     * @param area: assembly area the records will be serialized into
+     * @param bytes_needed: in/out parameter with number of bytes that
+     *        the container needs so far
+     * @param max_records: maximum number of records in the container
+     * @param records: output parameter receiving the records
+     * @return Number of varId's from the start of sorted_varids
+     *         covered by the generated records
+     */
+    size_t collectSummaryRuns (const std::vector<VarIdT>& sorted_varids,
+			       AssemblyArea& area,
+			       size_t& bytes_needed,
+			       unsigned int max_records,
+			       std::vector<VarSummRangeT>& records);
+
+    /**
+     * @brief Recomputes the cached VarCreateT / VarUpdateT record
+     *        sizes of the given variable from the variable store,
+     *        needs to be called whenever its value or description
+     *        changes
+     */
+    void cacheRecordSizes (VarIdT varId);
+
+
+    /**
+     * @brief Records that the current version of a variable goes out
+     *        for the first time (in a VarUpdateT or VarCreateT
+     *        record): maintains the per-class update statistics and
+     *        ends the window in which later RTDB-Updates are
+     *        coalesced into this version. No-op if the current
+     *        version has been transmitted before.
+     */
+    void noteVersionTransmitted (DBEntry& theEntry, const TimeStampT& currTime);
+
+
+    /**
+     * @brief Resolves the stale state of a variable I produce that has
+     *        been restored from a store snapshot, given the seqno a
+     *        neighbour reported for it. The snapshot may lag behind
+     *        the version my neighbours have received before the
+     *        restart. In that case the restored value is re-announced
+     *        under a seqno past the neighbour's one, otherwise the
+     *        neighbours would ignore it and keep the lost version.
+     */
+    void adoptOwnSeqno (VarIdT varId, DBEntry& theEntry, VarSeqnoT seqno);
+
+    
     /**
      * @brief This internal method calculates how many information
      *        instruction records referenced in the given queue and of
-     *        the given type (cf 'instructionSizeFunction' parameter)
-     *        fit into the number of bytes still available in the
-     *        VarDis payload
+     *        the given type (cf 'recordSizes' parameter) fit into the
+     *        number of bytes still available in the VarDis payload
      *
      * @param queue: The queue for which to construct an instruction container
      * @param area: assembly area to serialize into
-     * @param instructionSizeFunction: the function to apply to each
-     *        varId in the queue to query its serialized size
+     * @param recordSizes: the cached record size of each varId
+     * @param queueBytes: total record size of all varId's in the
+     *        queue if known, in which case a queue fitting entirely is
+     *        recognized without walking it
      * @return The number of instruction records can still fit into
      *         the remaining payload
      */
     unsigned int numberFittingRecords(
 				      const std::deque<VarIdT>& queue,
 				      AssemblyArea& area,
-				      std::function<unsigned int (VarIdT)> instructionSizeFunction
+				      const RecordSizeTable& recordSizes,
+				      std::optional<size_t> queueBytes = std::nullopt
+				      );
+
+
+    /**
+     * @brief Calculates how many instruction records of the given
+     *        fixed size fit into the number of bytes still available
+     *        in the VarDis payload, capped at the number of candidates
+     *
+     * @param numberCandidates: number of records waiting to be sent
+     * @param area: assembly area to serialize into
+     * @param recordSize: serialized size of one record
+     * @return The number of instruction records can still fit into
+     *         the remaining payload
+     */
+    unsigned int numberFittingRecords(
+				      size_t numberCandidates,
+				      AssemblyArea& area,
+				      size_t recordSize
 				      );
 
   public:
@@ -336,16 +790,81 @@ namespace dcp::vardis {
     void makeICTypeSummaries (AssemblyArea& area, unsigned int& containers_added);
 
 
+    /**
+     * @brief This serializes an instruction container for
+     *        VarSummRangeT's. It first includes explicit (seqno)
+     *        ranges requested by other nodes and then either digest
+     *        ranges (if summaryDigestRange is non-zero) or seqno
+     *        ranges rotating through all summarizable variables. The
+     *        number of records is capped at maxSummaries.
+     *
+     * Only active when compactSummaries is set, in which case
+     * makeICTypeSummaries does nothing.
+     *
+     * @param area: the assembly area to serialize into
+     * @param containers_added: this variable will be incremented when
+     *        an instruction container for VarSummRangeT's is added
+     */
+    void makeICTypeSummaryRanges (AssemblyArea& area, unsigned int& containers_added);
+
+
+    /**
+     * @brief This serializes an instruction container for
+     *        VarReqSummRangeT's, it generates an ICHeader and as many
+     *        VarReqSummRangeT records as possible / available.
+     *
+     * @param area: the assembly area to serialize into
+     * @param containers_added: this variable will be incremented when
+     *        an instruction container for VarReqSummRangeT's is added
+     */
+    void makeICTypeRequestSummaryRanges (AssemblyArea& area, unsigned int& containers_added);
+
+
+    /**
+     * @brief This serializes an instruction container for
+     *        VarMerkleNodeT's: the root hash of the Merkle tree,
+     *        followed by as many nodes requested by other nodes as
+     *        possible. Only active when antiEntropy is set.
+     *
+     * @param area: the assembly area to serialize into
+     * @param containers_added: this variable will be incremented when
+     *        an instruction container for VarMerkleNodeT's is added
+     */
+    void makeICTypeMerkleNodes (AssemblyArea& area, unsigned int& containers_added);
+
+
+    /**
+     * @brief This serializes an instruction container for
+     *        VarReqMerkleNodeT's, it generates an ICHeader and as many
+     *        VarReqMerkleNodeT records as possible / available.
+     *
+     * @param area: the assembly area to serialize into
+     * @param containers_added: this variable will be incremented when
+     *        an instruction container for VarReqMerkleNodeT's is added
+     */
+    void makeICTypeRequestMerkleNodes (AssemblyArea& area, unsigned int& containers_added);
+
+
     /**
      * @brief This serializes an instruction container for
      *        VarUopdateT's, it generates an ICHeader and a as many
      *        VarUpdateT records as possible / available.
      *
+     * Only variables with priority class in the given range are
+     * considered, most important class first. Variables whose new
+     * version would follow the previous one sooner than their
+     * minimum update interval are held back.
+     *
      * @param area: the assembly area to serialize into
      * @param containers_added: this variable will be incremented when
      *        an instruction container for VarUpdates is added
+     * @param fromClass: most important priority class to include
+     * @param toClass: least important priority class to include
      */
-    void makeICTypeUpdates (AssemblyArea& area, unsigned int& containers_added);
+    void makeICTypeUpdates (AssemblyArea& area,
+			    unsigned int& containers_added,
+			    VarPriorityT fromClass = VARDIS_PRIO_CRITICAL,
+			    VarPriorityT toClass = VARDIS_PRIO_LOW);
 
 
     /**
@@ -398,6 +917,49 @@ namespace dcp::vardis {
     void process_var_summary (const VarSummT& summ);
     void process_var_requpdate (const VarReqUpdateT& requpd);
     void process_var_reqcreate (const VarReqCreateT& reqcreate);
+    void process_var_summrange (const VarSummRangeT& summrange);
+    void process_var_reqsummrange (const VarReqSummRangeT& reqsummrange);
+    void process_var_merklenode (const VarMerkleNodeT& merklenode);
+    void process_var_reqmerklenode (const VarReqMerkleNodeT& reqmerklenode);
+
+
+    /**
+     * @brief Recomputes the Merkle tree leaf of the given variable
+     *        from its current state. Must be called whenever the
+     *        seqno or the existence / deletion status of a variable
+     *        changes.
+     *
+     * @param varId: variable identifier
+     */
+    inline void updateMerkleLeaf (VarIdT varId)
+    {
+      merkleTree.update_leaf (varId,
+			      isSummarizable (varId)
+			      ? VardisMerkleTree::leaf_hash (varId, vardis_store.get_db_entry_ref(varId).seqno)
+			      : 0);
+    };
+
+
+    /**
+     * @brief Rebuilds all protocol data derived from the variable
+     *        store (active_variables, cached record sizes, Merkle
+     *        tree) and queues summaries of all existing variables.
+     *        Needs to be called after the store contents has been
+     *        filled in from outside the protocol processing, e.g.
+     *        when restoring a store snapshot.
+     */
+    void rebuildFromStore ();
+
+
+    /**
+     * @brief Computes the digest over the (varId, seqno) pairs of all
+     *        summarizable variables in the given range of variable
+     *        identifiers (FNV-1a, 32 bits)
+     *
+     * @param firstVarId: first variable identifier of the range
+     * @param numVars: number of variable identifiers in the range
+     */
+    uint32_t summaryRangeDigest (VarIdT firstVarId, byte numVars);
     
     // ====================================================================================
     // ====================================================================================
@@ -34,7 +34,19 @@ namespace dcp::vardis {
        << " , count_process_var_summary = " << stats.count_process_var_summary
        << " , count_process_var_requpdate = " << stats.count_process_var_requpdate
        << " , count_process_var_reqcreate = " << stats.count_process_var_reqcreate
-       << " }";
+       << " , count_process_var_summrange = " << stats.count_process_var_summrange
+       << " , count_process_var_reqsummrange = " << stats.count_process_var_reqsummrange
+       << " , count_process_var_merklenode = " << stats.count_process_var_merklenode
+       << " , count_process_var_reqmerklenode = " << stats.count_process_var_reqmerklenode;
+    for (size_t prio = 0; prio < VarPriorityT::number_classes(); prio++)
+      {
+	os << " , class_" << prio << " = { count_update_tx = " << stats.count_update_tx[prio]
+	   << " , sum_update_delay_ms = " << stats.sum_update_delay_ms[prio]
+	   << " , max_update_delay_ms = " << stats.max_update_delay_ms[prio]
+	   << " , count_update_coalesced = " << stats.count_update_coalesced[prio]
+	   << " }";
+      }
+    os << " }";
     return os;
   }
 
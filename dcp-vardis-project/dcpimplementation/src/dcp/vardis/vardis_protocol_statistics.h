@@ -21,6 +21,7 @@
 #pragma once
 
 #include <iostream>
+#include <dcp/vardis/vardis_transmissible_types.h>
 
 /**
  * @brief This module provides a class for collecting runtime Vardis
@@ -57,6 +58,25 @@ namespace dcp::vardis {
     unsigned long count_process_var_summary   = 0;
     unsigned long count_process_var_requpdate = 0;
     unsigned long count_process_var_reqcreate = 0;
+    unsigned long count_process_var_summrange    = 0;
+    unsigned long count_process_var_reqsummrange = 0;
+    unsigned long count_process_var_merklenode    = 0;
+    unsigned long count_process_var_reqmerklenode = 0;
+
+
+    /**
+     * @brief Statistics on updates per priority class
+     *
+     * The queueing delay of an update is the time between the new
+     * version entering the updateQ and its first transmission.
+     * Coalesced updates are RTDB updates that replaced a previous
+     * version not yet transmitted because of the variables minimum
+     * update interval.
+     */
+    unsigned long count_update_tx         [VarPriorityT::number_classes()] = {};
+    unsigned long sum_update_delay_ms     [VarPriorityT::number_classes()] = {};
+    unsigned long max_update_delay_ms     [VarPriorityT::number_classes()] = {};
+    unsigned long count_update_coalesced  [VarPriorityT::number_classes()] = {};
 
 
 
@@ -18,6 +18,7 @@
  */
 
 
+#include <optional>
 #include <queue>
 #include <thread>
 #include <chrono>
@@ -35,140 +36,212 @@ namespace dcp::vardis {
 
   static const uint16_t rx_buffer_length = 4000;
 
+  /**
+   * @brief Maximum number of instruction containers accepted in one
+   *        received payload. Only a bound against malformed payloads:
+   *        a well-behaved sender can include more than one container
+   *        of a type (e.g. the transmitter emits two ICTYPE_UPDATES
+   *        containers, CRITICAL class first, then HIGH to LOW), so
+   *        this must stay well above the number of container types
+   */
+  static const size_t   max_containers_per_payload = 32;
+
   // #############################################################################
 
+  /**
+   * @brief Location of one instruction container in a received
+   *        payload, as found by the validating first pass
+   */
+  struct ICIndexEntry {
+    byte    icType        = 0;        /*!< Type of the container */
+    byte    icNumRecords  = 0;        /*!< Number of records in the container */
+    byte*   records       = nullptr;  /*!< Start of the first record in the received buffer */
+    size_t  length        = 0;        /*!< Total length of all records */
+  };
+
+
+  /**
+   * @brief Index of all instruction containers of a received payload,
+   *        held in a fixed-size array
+   */
+  struct ICIndex {
+    ICIndexEntry  entries [max_containers_per_payload];
+    size_t        numEntries = 0;
+
+    inline bool contains (byte icType) const
+    {
+      for (size_t i = 0; i < numEntries; i++)
+	if (entries[i].icType == icType)
+	  return true;
+      return false;
+    };
+  };
+
   // -----------------------------------------------------------------
 
+  /**
+   * Deserializes a record in place. Records containing a value or
+   * description refer to the received buffer instead of holding a
+   * copy, all other records have fixed size (or, for summary ranges,
+   * re-use the capacity of the record) and do not allocate.
+   */
+  template <typename T>
+  inline void deserializeInPlace (DisassemblyArea& area, T& record) { record.deserialize (area); };
+  inline void deserializeInPlace (DisassemblyArea& area, VarUpdateT& record) { record.deserialize_view (area); };
+  inline void deserializeInPlace (DisassemblyArea& area, VarCreateT& record) { record.deserialize_view (area); };
+
+
+  /**
+   * Returns a per-thread scratch record of the given type, so that
+   * summary ranges keep the capacity of their seqno list across
+   * payloads
+   */
   template <typename T>
-  void extractInstructionContainerElements (DisassemblyArea& area, const ICHeaderT& icHeader, std::deque<T>& result_list)
+  inline T& scratchRecord ()
   {
-    if (icHeader.icNumRecords == 0)
-      {
-	DCPLOG_INFO(log_rx) << "extractInstructionContainerElements: number of records is zero";
-	throw VardisReceiveException ("extractInstructionContainerElements", "number of records is zero");
-      }
-    
-    for (int i=0; i<icHeader.icNumRecords; i++)
-      {
-        T element;
-        element.deserialize (area);
-        result_list.push_back(element);
-      }
+    static thread_local T record;
+    return record;
   };
   
+  
   // -----------------------------------------------------------------
 
-  void process_received_payload (VardisRuntimeData& runtime, DisassemblyArea& area)
+  template <typename T>
+  void skipInstructionContainerElements (DisassemblyArea& area, const ICHeaderT& icHeader)
+  {
+    T& record = scratchRecord<T> ();
+    for (int i=0; i<icHeader.icNumRecords; i++)
+      deserializeInPlace (area, record);
+  };
+
+
+  /**
+   * First pass over a received payload: validates all instruction
+   * containers (types, record counts and record syntax) and enters
+   * their locations into the given index. Throws on malformed
+   * payloads, before any of its contents has been processed.
+   */
+  void indexInstructionContainers (DisassemblyArea& area, ICIndex& index)
   {
-    std::deque<VarSummT>       icSummaries;
-    std::deque<VarUpdateT>     icUpdates;
-    std::deque<VarReqUpdateT>  icRequestVarUpdates;
-    std::deque<VarReqCreateT>  icRequestVarCreates;
-    std::deque<VarCreateT>     icCreateVariables;
-    std::deque<VarDeleteT>     icDeleteVariables;
-
-    // Dispatch on ICType
-    while (area.used() < area.available())
+    index.numEntries = 0;
+    
+    while (area.available() > 0)
       {
 	ICHeaderT icHeader;
 	icHeader.deserialize(area);
+
+	if (icHeader.icNumRecords == 0)
+	  {
+	    DCPLOG_INFO(log_rx) << "indexInstructionContainers: number of records is zero";
+	    throw VardisReceiveException ("indexInstructionContainers", "number of records is zero");
+	  }
+
+	if (index.numEntries >= max_containers_per_payload)
+	  {
+	    throw VardisReceiveException ("indexInstructionContainers",
+					  std::format("more than {} instruction containers", max_containers_per_payload));
+	  }
+
+	ICIndexEntry& entry = index.entries[index.numEntries];
+	entry.icType        = icHeader.icType.val;
+	entry.icNumRecords  = icHeader.icNumRecords;
+	entry.records       = area.view_byte_block (0);
+	size_t start        = area.used();
 	
 	switch(icHeader.icType.val)
 	  {
-	  case ICTYPE_SUMMARIES:
-	    {
-	      extractInstructionContainerElements<VarSummT> (area, icHeader, icSummaries);
-	      break;
-	    }
-	  case ICTYPE_UPDATES:
-	    {
-	      extractInstructionContainerElements<VarUpdateT> (area, icHeader, icUpdates);
-	      break;
-	    }
-	  case ICTYPE_REQUEST_VARUPDATES:
-	    {
-	      extractInstructionContainerElements<VarReqUpdateT> (area, icHeader, icRequestVarUpdates);
-	      break;
-	    }
-	  case ICTYPE_REQUEST_VARCREATES:
-	    {
-	      extractInstructionContainerElements<VarReqCreateT> (area, icHeader, icRequestVarCreates);
-	      break;
-	    }
-	  case ICTYPE_CREATE_VARIABLES:
-	    {
-	      extractInstructionContainerElements<VarCreateT> (area, icHeader, icCreateVariables);
-	      break;
-	    }
-	  case ICTYPE_DELETE_VARIABLES:
-	    {
-	      extractInstructionContainerElements<VarDeleteT> (area, icHeader, icDeleteVariables);
-	      break;
-	    }
+	  case ICTYPE_SUMMARIES:           skipInstructionContainerElements<VarSummT> (area, icHeader); break;
+	  case ICTYPE_UPDATES:             skipInstructionContainerElements<VarUpdateT> (area, icHeader); break;
+	  case ICTYPE_REQUEST_VARUPDATES:  skipInstructionContainerElements<VarReqUpdateT> (area, icHeader); break;
+	  case ICTYPE_REQUEST_VARCREATES:  skipInstructionContainerElements<VarReqCreateT> (area, icHeader); break;
+	  case ICTYPE_CREATE_VARIABLES:    skipInstructionContainerElements<VarCreateT> (area, icHeader); break;
+	  case ICTYPE_DELETE_VARIABLES:    skipInstructionContainerElements<VarDeleteT> (area, icHeader); break;
+	  case ICTYPE_SUMMARY_RANGES:      skipInstructionContainerElements<VarSummRangeT> (area, icHeader); break;
+	  case ICTYPE_REQUEST_SUMMRANGES:  skipInstructionContainerElements<VarReqSummRangeT> (area, icHeader); break;
+	  case ICTYPE_MERKLE_NODES:        skipInstructionContainerElements<VarMerkleNodeT> (area, icHeader); break;
+	  case ICTYPE_REQUEST_MERKLENODES: skipInstructionContainerElements<VarReqMerkleNodeT> (area, icHeader); break;
 	  default:
 	    {
-	      throw VardisReceiveException ("process_received_payload",
+	      throw VardisReceiveException ("indexInstructionContainers",
 					    std::format("wrong instruction container type {}", (int) icHeader.icType.val));
 	    }
 	  }
+
+	entry.length = area.used() - start;
+	index.numEntries++;
       }
+  }
+
+  // -----------------------------------------------------------------
+
+  /**
+   * Second pass for one container type: walks the records of all
+   * indexed containers of this type directly over the received buffer
+   * and hands them to the given protocol data method. When
+   * lockContainers is set, the variable store is locked for the
+   * duration.
+   */
+  template <typename T>
+  void processInstructionContainers (VardisRuntimeData& runtime,
+				     const ICIndex& index,
+				     byte icType,
+				     bool lockContainers,
+				     void (VardisProtocolData::*process) (const T&))
+  {
+    if (not index.contains (icType))
+      return;
 
+    std::optional<ScopedVariableStoreMutex> mtx;
+    if (lockContainers)
+      mtx.emplace (runtime);
+    
+    T& record = scratchRecord<T> ();
+    for (size_t i = 0; i < index.numEntries; i++)
+      {
+	const ICIndexEntry& entry = index.entries[i];
+	if (entry.icType != icType)
+	  continue;
+
+	MemoryChunkDisassemblyArea area ("vd-rx-ic", entry.length, entry.records);
+	for (int k = 0; k < entry.icNumRecords; k++)
+	  {
+	    deserializeInPlace (area, record);
+	    (runtime.protocol_data.*process) (record);
+	  }
+      }
+  }
+  
+  // -----------------------------------------------------------------
 
-    // Now process the received containers in the specified order
-    // (database updates).
+  void process_received_payload (VardisRuntimeData& runtime, DisassemblyArea& area)
+  {
+    // First pass: validate and index the instruction containers
+    ICIndex index;
+    indexInstructionContainers (area, index);
+
+    // Second pass: process the containers in the specified order
+    // (database updates), values are copied only into the variable
+    // store.
     //
     // ISSUE: It is unclear on whether it is better / more efficient to
     // acquire a lock just once and process all containers in one go,
     // or do them separately. The current do-both solution is not
     // really elegant
-    if (runtime.vardis_config.vardis_conf.lockingForIndividualContainers)
-      {
-	{ ScopedVariableStoreMutex mtx (runtime);
-	  for (auto it = icCreateVariables.begin(); it != icCreateVariables.end(); ++it)
-	    runtime.protocol_data.process_var_create (*it);
-	}
-	
-	{ ScopedVariableStoreMutex mtx (runtime);
-	  for (auto it = icDeleteVariables.begin(); it != icDeleteVariables.end(); ++it)
-	    runtime.protocol_data.process_var_delete (*it);
-	}
-	
-	{ ScopedVariableStoreMutex mtx (runtime);
-	  for (auto it = icUpdates.begin(); it != icUpdates.end(); ++it)
-	    runtime.protocol_data.process_var_update (*it);
-	}
-	
-	{ ScopedVariableStoreMutex mtx (runtime);
-	  for (auto it = icSummaries.begin(); it != icSummaries.end(); ++it)
-	    runtime.protocol_data.process_var_summary (*it);
-	}
-	
-	{ ScopedVariableStoreMutex mtx (runtime);
-	  for (auto it = icRequestVarUpdates.begin(); it != icRequestVarUpdates.end(); ++it)
-	    runtime.protocol_data.process_var_requpdate (*it);
-	}
-	
-	{ ScopedVariableStoreMutex mtx (runtime);
-	  for (auto it = icRequestVarCreates.begin(); it != icRequestVarCreates.end(); ++it)
-	    runtime.protocol_data.process_var_reqcreate (*it);
-	}
-      }
-    else
-      {
-	ScopedVariableStoreMutex mtx (runtime);
-	for (auto it = icCreateVariables.begin(); it != icCreateVariables.end(); ++it)
-	  runtime.protocol_data.process_var_create (*it);
-	for (auto it = icDeleteVariables.begin(); it != icDeleteVariables.end(); ++it)
-	  runtime.protocol_data.process_var_delete (*it);
-	for (auto it = icUpdates.begin(); it != icUpdates.end(); ++it)
-	  runtime.protocol_data.process_var_update (*it);
-	for (auto it = icSummaries.begin(); it != icSummaries.end(); ++it)
-	  runtime.protocol_data.process_var_summary (*it);
-	for (auto it = icRequestVarUpdates.begin(); it != icRequestVarUpdates.end(); ++it)
-	  runtime.protocol_data.process_var_requpdate (*it);
-	for (auto it = icRequestVarCreates.begin(); it != icRequestVarCreates.end(); ++it)
-	  runtime.protocol_data.process_var_reqcreate (*it);
-      }
+    bool lockContainers = runtime.vardis_config.vardis_conf.lockingForIndividualContainers;
+    std::optional<ScopedVariableStoreMutex> mtx;
+    if (not lockContainers)
+      mtx.emplace (runtime);
+
+    processInstructionContainers<VarCreateT>        (runtime, index, ICTYPE_CREATE_VARIABLES,    lockContainers, &VardisProtocolData::process_var_create);
+    processInstructionContainers<VarDeleteT>        (runtime, index, ICTYPE_DELETE_VARIABLES,    lockContainers, &VardisProtocolData::process_var_delete);
+    processInstructionContainers<VarUpdateT>        (runtime, index, ICTYPE_UPDATES,             lockContainers, &VardisProtocolData::process_var_update);
+    processInstructionContainers<VarSummT>          (runtime, index, ICTYPE_SUMMARIES,           lockContainers, &VardisProtocolData::process_var_summary);
+    processInstructionContainers<VarReqUpdateT>     (runtime, index, ICTYPE_REQUEST_VARUPDATES,  lockContainers, &VardisProtocolData::process_var_requpdate);
+    processInstructionContainers<VarReqCreateT>     (runtime, index, ICTYPE_REQUEST_VARCREATES,  lockContainers, &VardisProtocolData::process_var_reqcreate);
+    processInstructionContainers<VarSummRangeT>     (runtime, index, ICTYPE_SUMMARY_RANGES,      lockContainers, &VardisProtocolData::process_var_summrange);
+    processInstructionContainers<VarReqSummRangeT>  (runtime, index, ICTYPE_REQUEST_SUMMRANGES,  lockContainers, &VardisProtocolData::process_var_reqsummrange);
+    processInstructionContainers<VarMerkleNodeT>    (runtime, index, ICTYPE_MERKLE_NODES,        lockContainers, &VardisProtocolData::process_var_merklenode);
+    processInstructionContainers<VarReqMerkleNodeT> (runtime, index, ICTYPE_REQUEST_MERKLENODES, lockContainers, &VardisProtocolData::process_var_reqmerklenode);
   }
 
   // -----------------------------------------------------------------
@@ -201,6 +274,8 @@ namespace dcp::vardis {
 		  << "Processing payload of length "
 		  << result_length;
 		MemoryChunkDisassemblyArea area ("vd-rx", (size_t) result_length.val, rx_buffer);
+		ScopedLatencyMeasurement parse_time (runtime.metricRxParseTime);
+		runtime.metricPayloadsReceived.inc ();
 		process_received_payload (runtime, area);
 	      }
 	    else
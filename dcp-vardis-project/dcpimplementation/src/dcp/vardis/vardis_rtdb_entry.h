@@ -49,6 +49,8 @@ namespace dcp::vardis {
     VarRepCntT        repCnt;
     TimeStampT        creationTime;
     VarTimeoutT       timeout;
+    VarPriorityT      prio;
+    VarIntervalT      minInterval;
     
     VarSeqnoT       seqno;                   /*!< Last received sequence number for this variable */
     TimeStampT      tStamp;                  /*!< Timestamp where the last update (or create) instruction has been processed */
@@ -56,6 +58,12 @@ namespace dcp::vardis {
     VarRepCntT      countCreate = 0;         /*!< Repetition counter for VarCreateT instructions */
     VarRepCntT      countDelete = 0;         /*!< Repetition counter for VarDeleteT instructions */
     bool            isDeleted   = false;     /*!< Indicates whether variable is marked as deleted */
+    bool            isStale     = false;     /*!< Restored from a store snapshot and not yet confirmed by a neighbour or the producer */
+
+    TimeStampT      tUpdateQueued;               /*!< Time the current version has been produced by an RTDB-Update */
+    TimeStampT      tLastUpdateTx;               /*!< Time the previous version was transmitted first */
+    bool            newVersionPending = false;   /*!< Current version has been produced by an RTDB-Update and not yet transmitted (re-sends of transmitted versions do not count) */
+    uint64_t        summaryDue       = 0;        /*!< Virtual time at which the next summary is due */
   } DBEntry;
 
 };  // namespace dcp::vardis
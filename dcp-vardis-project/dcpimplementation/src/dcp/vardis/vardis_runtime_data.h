@@ -23,7 +23,9 @@
 #include <map>
 #include <queue>
 #include <mutex>
+#include <optional>
 #include <dcp/common/command_socket.h>
+#include <dcp/common/metrics.h>
 #include <dcp/bp/bpclient_lib.h>
 #include <dcp/vardis/vardis_client_protocol_data.h>
 #include <dcp/vardis/vardis_configuration.h>
@@ -64,26 +66,49 @@ namespace dcp::vardis {
      *        BP demon needs to know about Vardis demon (e.g. name of
      *        protocol, queueing mode), needs to be filled in by caller
      * @param cfg: Vardis configuration data
+     * @param registrar: registrar of a BP instance in the same
+     *        process (dcpmain-stack), nullptr for a separate BP demon
      *
      * Note: Vardis does not allow multiple payloads in one beacon and
      * the demon does not request or process
      * BP-TransmitPayload.confirm primitives
      */
     VardisRuntimeData (const BPStaticClientInfo static_client_info,
-		       const VardisConfiguration cfg)
-      : BPClientRuntime (cfg, static_client_info, false),
+		       const VardisConfiguration cfg,
+		       BPLocalRegistrar* registrar = nullptr)
+      : BPClientRuntime (cfg, static_client_info, false, registrar),
 	variable_store (cfg.vardis_shm_vardb_conf.shmAreaName.c_str(),
 			true,
 			cfg.vardis_conf.maxSummaries,
 			cfg.vardis_conf.maxDescriptionLength,
 			cfg.vardis_conf.maxValueLength,
 			cfg.vardis_conf.maxRepetitions,
-			get_own_node_identifier()),
+			get_own_node_identifier(),
+			cfg.vardis_shm_vardb_conf.shmHugePages),
 	vardisCommandSock(cfg.vardis_cmdsock_conf.commandSocketFile, cfg.vardis_cmdsock_conf.commandSocketTimeoutMS),
 	vardis_config (cfg),
 	vardis_exitFlag (false),
-	protocol_data (variable_store)
+	protocol_data (variable_store),
+	metrics ("Vardis", cfg.vardis_metrics_conf),
+	metricRxParseTime (metrics.histogram ("rx_parse_ns")),
+	metricPayloadBuildTime (metrics.histogram ("payload_build_ns")),
+	metricStoreLockHoldTime (metrics.histogram ("store_lock_hold_ns")),
+	metricRTDBCreateTime (metrics.histogram ("rtdb_create_ns")),
+	metricRTDBUpdateTime (metrics.histogram ("rtdb_update_ns")),
+	metricRTDBDeleteTime (metrics.histogram ("rtdb_delete_ns")),
+	metricPayloadsReceived (metrics.counter ("payloads_received")),
+	metricPayloadsSent (metrics.counter ("payloads_sent")),
+	metricTxWakeupLatency (metrics.histogram ("tx_wakeup_latency_ns")),
+	metricScrubWakeupLatency (metrics.histogram ("scrub_wakeup_latency_ns")),
+	metricRTDBPollWakeupLatency (metrics.histogram ("rtdb_poll_wakeup_latency_ns")),
+	metricEventLoopWakeupLatency (metrics.histogram ("event_loop_wakeup_latency_ns")),
+	metricSnapshotTime (metrics.histogram ("snapshot_ns")),
+	metricSnapshotWakeupLatency (metrics.histogram ("snapshot_wakeup_latency_ns"))
     {
+      protocol_data.compactSummaries      = cfg.vardis_conf.compactSummaries;
+      protocol_data.summaryDigestRange    = cfg.vardis_conf.summaryDigestRange;
+      protocol_data.antiEntropy           = cfg.vardis_conf.antiEntropy;
+      protocol_data.antiEntropyLeafRange  = cfg.vardis_conf.antiEntropyLeafRange;
     };
 
 
@@ -118,6 +143,28 @@ namespace dcp::vardis {
     VardisProtocolData  protocol_data;
 
 
+    /**
+     * @brief Metrics (shared memory area read by dcp-stats). RTDB
+     *        read requests are served by the client library directly
+     *        from the variable store and are not covered.
+     */
+    MetricsRegistry    metrics;
+    LatencyHistogram&  metricRxParseTime;        /*!< Time for processing a received payload, including store updates */
+    LatencyHistogram&  metricPayloadBuildTime;   /*!< Time for constructing a payload */
+    LatencyHistogram&  metricStoreLockHoldTime;  /*!< Time the variable store mutex is held (ScopedVariableStoreMutex) */
+    LatencyHistogram&  metricRTDBCreateTime;     /*!< Time from taking an RTDB-Create request from its queue until its confirm is queued */
+    LatencyHistogram&  metricRTDBUpdateTime;     /*!< Same for RTDB-Update */
+    LatencyHistogram&  metricRTDBDeleteTime;     /*!< Same for RTDB-Delete */
+    MetricCounter&     metricPayloadsReceived;
+    MetricCounter&     metricPayloadsSent;
+    LatencyHistogram&  metricTxWakeupLatency;        /*!< Lateness of the transmitter thread waking up for the next payload */
+    LatencyHistogram&  metricScrubWakeupLatency;     /*!< Same for the scrubbing thread */
+    LatencyHistogram&  metricRTDBPollWakeupLatency;  /*!< Same for the thread polling RTDB requests */
+    LatencyHistogram&  metricEventLoopWakeupLatency; /*!< Lateness of timer callbacks in the event loop thread */
+    LatencyHistogram&  metricSnapshotTime;           /*!< Time for taking and writing a snapshot of the variable store */
+    LatencyHistogram&  metricSnapshotWakeupLatency;  /*!< Lateness of the snapshot thread waking up */
+
+
 
    /**
      * @brief Mutex for access to clientApplications member
@@ -150,16 +197,19 @@ namespace dcp::vardis {
   class ScopedVariableStoreMutex {
   private:
     VardisRuntimeData* ptr = nullptr;
+    std::optional<ScopedLatencyMeasurement> hold_time;
   public:
     ScopedVariableStoreMutex() = delete;
     ScopedVariableStoreMutex (VardisRuntimeData& runtime)
     {
       ptr = &runtime;
       runtime.variable_store.lock();
+      hold_time.emplace (runtime.metricStoreLockHoldTime);
     };
     
     ~ScopedVariableStoreMutex ()
     {
+      hold_time.reset ();
       if (ptr)
 	ptr->variable_store.unlock();
     };
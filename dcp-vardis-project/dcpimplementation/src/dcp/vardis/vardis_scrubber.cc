@@ -21,6 +21,7 @@
 #include <chrono>
 #include <thread>
 #include <dcp/common/debug_helpers.h>
+#include <dcp/common/realtime.h>
 #include <dcp/vardis/vardis_configuration.h>
 #include <dcp/vardis/vardis_logging.h>
 #include <dcp/vardis/vardis_scrubber.h>
@@ -32,75 +33,81 @@ namespace dcp::vardis {
 
   // -----------------------------------------------------------------
   
+  void scrub_variables (VardisRuntimeData& runtime, TimeStampT curr_time)
+  {
+    VardisProtocolData&  PD  = runtime.protocol_data;
+    
+    auto var_it                =  PD.active_variables.begin ();
+    size_t numvars             =  PD.active_variables.size ();
+    const size_t batch_size    =  50;
+
+    while (numvars > 0)
+      {
+	ScopedVariableStoreMutex mtx (runtime);
+	for (size_t i = 0; i<std::min(batch_size, numvars); i++)
+	  {
+	    VarIdT     varId     = *var_it;
+	    DBEntry&   ent       = PD.vardis_store.get_db_entry_ref (varId);
+
+	    --numvars;
+	    ++var_it;
+	    
+	    if (    (ent.isDeleted)
+		 || (ent.timeout == 0)
+		 || (curr_time.milliseconds_passed_since (ent.tStamp) <= ent.timeout))
+	      {
+		continue;
+	      }
+
+	    DCPLOG_INFO(log_scrubbing) << "Marking variable " << varId
+				       << " as deleted after timeout of " << ent.timeout << " milliseconds"
+				       << ", timestamp was " << ent.tStamp
+				       << ", currtime was " << curr_time
+				       << ".";
+	    
+	    // mark varId as deleted
+	    ent.isDeleted    = true;
+	    ent.countUpdate  = 0;
+	    ent.countDelete  = ent.repCnt;
+	    ent.countCreate  = 0;
+	    PD.updateMerkleLeaf (varId);
+
+	    PD.createQ.remove (varId);
+	    PD.deleteQ.remove (varId);
+	    PD.updateQ.remove (varId);
+	    PD.summaryQ.remove (varId);
+	    PD.reqUpdQ.remove (varId);
+	    PD.reqCreateQ.remove (varId);
+	    PD.summRangeQ.remove (varId);
+
+	    PD.deleteQ.insert (varId);
+	  }
+      }
+  }
+  
+  // -----------------------------------------------------------------
+  
   void scrubbing_thread (VardisRuntimeData& runtime)
   {
     DCPLOG_INFO(log_scrubbing) << "Starting scrubbing thread.";
 
-    VardisProtocolData&  PD               = runtime.protocol_data;
-    TimeStampT           last_scrub       = TimeStampT::get_current_system_time();
+    TimeStampT           last_scrub       = TimeStampT::get_current_coarse_time();
     uint16_t             scrubbing_period = runtime.vardis_config.vardis_conf.scrubbingPeriodMS;
     
     try {
       while (not runtime.vardis_exitFlag)
 	{
-	  std::this_thread::sleep_for (std::chrono::milliseconds (100));
+	  sleep_for_measured (std::chrono::milliseconds (100), runtime.metricScrubWakeupLatency);
 
-	  TimeStampT curr_time = TimeStampT::get_current_system_time();
+	  TimeStampT curr_time = TimeStampT::get_current_coarse_time();
 	  if (    (not runtime.protocol_data.vardis_store.get_vardis_isactive())
 	       || (curr_time.milliseconds_passed_since (last_scrub) <= scrubbing_period))
 	    {
 	      continue;
 	    }
 
-	  last_scrub = TimeStampT::get_current_system_time();
-
-	  // now we iterate over the variable store
-
-	  auto var_it                =  PD.active_variables.begin ();
-	  size_t numvars             =  PD.active_variables.size ();
-	  const size_t batch_size    =  50;
-
-	  while (numvars > 0)
-	    {
-	      ScopedVariableStoreMutex mtx (runtime);
-	      for (size_t i = 0; i<std::min(batch_size, numvars); i++)
-		{
-		  VarIdT     varId     = *var_it;
-		  DBEntry&   ent       = PD.vardis_store.get_db_entry_ref (varId);
-
-		  --numvars;
-		  ++var_it;
-		  
-		  if (    (ent.isDeleted)
-		       || (ent.timeout == 0)
-		       || (curr_time.milliseconds_passed_since (ent.tStamp) <= ent.timeout))
-		    {
-		      continue;
-		    }
-
-		  DCPLOG_INFO(log_scrubbing) << "Marking variable " << varId
-					     << " as deleted after timeout of " << ent.timeout << " milliseconds"
-					     << ", timestamp was " << ent.tStamp
-					     << ", currtime was " << curr_time
-					     << ".";
-		  
-		  // mark varId as deleted
-		  ent.isDeleted    = true;
-		  ent.countUpdate  = 0;
-		  ent.countDelete  = ent.repCnt;
-		  ent.countCreate  = 0;
-
-		  PD.createQ.remove (varId);
-		  PD.deleteQ.remove (varId);
-		  PD.updateQ.remove (varId);
-		  PD.summaryQ.remove (varId);
-		  PD.reqUpdQ.remove (varId);
-		  PD.reqCreateQ.remove (varId);
-
-		  PD.deleteQ.insert (varId);
-		}
-	    }
-	  
+	  last_scrub = curr_time;
+	  scrub_variables (runtime, curr_time);
 	}
     }
     catch (DcpException& e)
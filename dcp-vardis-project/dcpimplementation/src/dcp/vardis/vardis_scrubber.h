@@ -25,6 +25,13 @@
 
 namespace dcp::vardis {
 
+  /**
+   * @brief Marks all variables whose timeout has expired at
+   *        curr_time as deleted (one scrubbing run)
+   */
+  void scrub_variables (VardisRuntimeData& runtime, TimeStampT curr_time);
+
+  
   /**
    * @brief This thread handles the scrubbing of the RTDB,
    *        implementing soft-state behaviour for variables
@@ -135,6 +135,7 @@ namespace dcp::vardis {
        << ", description = " << descr.description
        << ", tStamp = " << descr.tStamp
        << ", isDeleted = " << descr.isDeleted
+       << ", isStale = " << descr.isStale
        << " }";
     return os;
   }
@@ -160,6 +161,7 @@ namespace dcp::vardis {
        << ", countCreate = " << (int) descr.countCreate.val
        << ", countDelete = " << (int) descr.countDelete.val
        << ", isDeleted = " << descr.isDeleted
+       << ", isStale = " << descr.isStale
        << ", value_length = " << (int) descr.value_length.val
        << " }";
     return os;
@@ -242,6 +244,7 @@ namespace dcp::vardis {
        << ", varId = " << (int) conf.varId.val
        << ", value = " << conf.value
        << ", tStamp = " << conf.tStamp
+       << ", isStale = " << conf.isStale
        << " }";
     return os;
   }
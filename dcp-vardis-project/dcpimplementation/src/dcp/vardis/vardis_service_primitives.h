@@ -211,6 +211,7 @@ namespace dcp::vardis {
     char               description [MAX_maxDescriptionLength + 1];
     TimeStampT         tStamp;
     bool               isDeleted;
+    bool               isStale;     /*!< Restored from a store snapshot and not yet confirmed by a neighbour or the producer */
 
     friend std::ostream& operator<<(std::ostream& os, const DescribeDatabaseVariableDescription& descr);
   } DescribeDatabaseVariableDescription;
@@ -264,6 +265,7 @@ namespace dcp::vardis {
     VarRepCntT        countCreate;
     VarRepCntT        countDelete;
     bool              isDeleted;
+    bool              isStale;     /*!< Restored from a store snapshot and not yet confirmed by a neighbour or the producer */
     VarLenT           value_length;
 
     friend std::ostream& operator<<(std::ostream& os, const DescribeVariableDescription& descr);
@@ -570,6 +572,7 @@ namespace dcp::vardis {
     VarIdT      varId;
     VarValueT   value;
     TimeStampT  tStamp;
+    bool        isStale = false;   /*!< Value restored from a store snapshot and not yet confirmed */
 
 
     /**
@@ -602,6 +605,7 @@ namespace dcp::vardis {
       varId.serialize (area);
       value.serialize (area);
       tStamp.serialize (area);
+      area.serialize_byte (isStale ? 1 : 0);
     };
 
 
@@ -614,6 +618,7 @@ namespace dcp::vardis {
       varId.deserialize (area);
       value.deserialize (area);
       tStamp.deserialize (area);
+      isStale = (area.deserialize_byte () != 0);
     };
 
 
@@ -626,6 +631,7 @@ namespace dcp::vardis {
       varId.deserialize (area);
       value.deserialize (area, length, data_buffer);
       tStamp.deserialize (area);
+      isStale = (area.deserialize_byte () != 0);
     };
 
 
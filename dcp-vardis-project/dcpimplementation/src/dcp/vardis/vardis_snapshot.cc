@@ -0,0 +1,350 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <format>
+#include <set>
+#include <thread>
+extern "C" {
+#include <fcntl.h>
+#include <unistd.h>
+}
+#include <dcp/common/area.h>
+#include <dcp/common/realtime.h>
+#include <dcp/vardis/vardis_logging.h>
+#include <dcp/vardis/vardis_snapshot.h>
+
+
+namespace dcp::vardis {
+
+  // -----------------------------------------------------------------
+
+  /**
+   * @brief Serialized size of the snapshot header: magic number,
+   *        version, ownNodeIdentifier, number of records, length and
+   *        checksum of the records
+   */
+  static constexpr size_t snapshotHeaderSize = sizeof(uint32_t) + sizeof(uint16_t) + NodeIdentifierT::fixed_size()
+                                               + sizeof(uint16_t) + sizeof(uint32_t) + sizeof(uint64_t);
+
+
+  /**
+   * @brief FNV-1a hash (64 bits) over the given memory block
+   */
+  static uint64_t snapshot_checksum (const byte* data, size_t length)
+  {
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < length; i++)
+      h = (h ^ data[i]) * 1099511628211ull;
+    return h;
+  }
+
+  // -----------------------------------------------------------------
+
+  std::vector<byte> make_store_snapshot (VardisProtocolData& PD)
+  {
+    std::vector<VarCreateT>  records;
+    size_t                   records_size = 0;
+
+    for (auto varId : PD.active_variables)
+      {
+	const DBEntry& theEntry = PD.vardis_store.get_db_entry_ref (varId);
+	if (theEntry.isDeleted) continue;
+
+	VarCreateT create;
+	create.spec.varId         =  theEntry.varId;
+	create.spec.prodId        =  theEntry.prodId;
+	create.spec.repCnt        =  theEntry.repCnt;
+	create.spec.creationTime  =  theEntry.creationTime;
+	create.spec.timeout       =  theEntry.timeout;
+	create.spec.prio          =  theEntry.prio;
+	create.spec.minInterval   =  theEntry.minInterval;
+	create.spec.descr         =  PD.vardis_store.read_description (varId);
+	create.update.varId       =  theEntry.varId;
+	create.update.seqno       =  theEntry.seqno;
+	create.update.value       =  PD.vardis_store.read_value (varId);
+	records_size += create.total_size ();
+	records.push_back (std::move (create));
+      }
+
+    std::vector<byte> snapshot (snapshotHeaderSize + records_size);
+    ByteVectorAssemblyArea area ("snapshot", snapshot.size(), snapshot);
+    area.serialize_uint32_n (snapshotMagic);
+    area.serialize_uint16_n (snapshotVersion);
+    PD.ownNodeIdentifier.serialize (area);
+    area.serialize_uint16_n ((uint16_t) records.size());
+    area.serialize_uint32_n ((uint32_t) records_size);
+    area.serialize_uint64_n (0);   // checksum, filled in below
+    for (const auto& create : records)
+      create.serialize (area);
+
+    uint64_t checksum = snapshot_checksum (snapshot.data() + snapshotHeaderSize, records_size);
+    for (size_t i = 0; i < sizeof(uint64_t); i++)
+      snapshot[snapshotHeaderSize - 1 - i] = (byte) (checksum >> (8*i));
+    
+    return snapshot;
+  }
+  
+  // -----------------------------------------------------------------
+
+  size_t install_store_snapshot (VardisProtocolData& PD, const std::vector<byte>& snapshot, TimeStampT now)
+  {
+    if (snapshot.size() < snapshotHeaderSize)
+      throw VardisStoreException ("install_store_snapshot", std::format ("snapshot truncated, size {}", snapshot.size()));
+
+    ByteVectorDisassemblyArea area ("snapshot", snapshot);
+    uint32_t         magic;
+    uint16_t         version;
+    NodeIdentifierT  nodeId;
+    uint16_t         number_records;
+    uint32_t         records_size;
+    uint64_t         checksum;
+    area.deserialize_uint32_n (magic);
+    area.deserialize_uint16_n (version);
+    nodeId.deserialize (area);
+    area.deserialize_uint16_n (number_records);
+    area.deserialize_uint32_n (records_size);
+    area.deserialize_uint64_n (checksum);
+
+    if (magic != snapshotMagic)
+      throw VardisStoreException ("install_store_snapshot", "not a Vardis store snapshot");
+    if (version != snapshotVersion)
+      throw VardisStoreException ("install_store_snapshot", std::format ("unsupported snapshot version {}", version));
+    if (nodeId != PD.ownNodeIdentifier)
+      throw VardisStoreException ("install_store_snapshot", "snapshot has been taken by another node");
+    if (records_size != snapshot.size() - snapshotHeaderSize)
+      throw VardisStoreException ("install_store_snapshot", std::format ("snapshot truncated, {} of {} bytes", snapshot.size() - snapshotHeaderSize, records_size));
+    if (checksum != snapshot_checksum (snapshot.data() + snapshotHeaderSize, records_size))
+      throw VardisStoreException ("install_store_snapshot", "checksum mismatch");
+    if (PD.vardis_store.get_number_variables () > 0)
+      throw VardisStoreException ("install_store_snapshot", "variable store is not empty");
+
+    // check all records before touching the store
+    std::vector<VarCreateT>  records (number_records);
+    std::set<VarIdT>         varIds;
+    try {
+      for (auto& create : records)
+	create.deserialize (area);
+    }
+    catch (DisassemblyAreaException& e)
+      {
+	throw VardisStoreException ("install_store_snapshot", std::format ("malformed record: {}", e.what()));
+      }
+    if (area.available() > 0)
+      throw VardisStoreException ("install_store_snapshot", "trailing bytes after last record");
+    for (const auto& create : records)
+      {
+	if (    (create.spec.varId != create.update.varId)
+	     || (not varIds.insert (create.spec.varId).second))
+	  throw VardisStoreException ("install_store_snapshot", std::format ("inconsistent record for varId {}", (int) create.spec.varId.val));
+	if (    (create.spec.descr.length == 0)
+	     || (create.spec.descr.length > PD.maxDescriptionLength)
+	     || (create.update.value.length == 0)
+	     || (create.update.value.length > PD.maxValueLength)
+	     || (create.spec.repCnt == 0)
+	     || (create.spec.repCnt > PD.maxRepetitions))
+	  throw VardisStoreException ("install_store_snapshot", std::format ("varId {} exceeds configured limits", (int) create.spec.varId.val));
+      }
+
+    for (const auto& create : records)
+      {
+	DBEntry newEntry;
+	newEntry.varId          =  create.spec.varId;
+	newEntry.prodId         =  create.spec.prodId;
+	newEntry.repCnt         =  create.spec.repCnt;
+	newEntry.creationTime   =  create.spec.creationTime;
+	newEntry.timeout        =  create.spec.timeout;
+	newEntry.prio           =  create.spec.prio;
+	newEntry.minInterval    =  create.spec.minInterval;
+	newEntry.seqno          =  create.update.seqno;
+	newEntry.tStamp         =  now;
+	newEntry.isStale        =  true;
+	newEntry.tUpdateQueued  =  now;
+	newEntry.tLastUpdateTx  =  now;
+	newEntry.summaryDue     =  PD.summaryVirtualTime;
+	PD.vardis_store.allocate_identifier (newEntry.varId);
+	PD.vardis_store.set_db_entry (newEntry.varId, newEntry);
+	PD.vardis_store.update_description (newEntry.varId, create.spec.descr);
+	PD.vardis_store.update_value (newEntry.varId, create.update.value);
+      }
+    PD.rebuildFromStore ();
+
+    return records.size();
+  }
+  
+  // -----------------------------------------------------------------
+
+  void write_snapshot_file (const std::string& filename, const std::vector<byte>& snapshot)
+  {
+    const std::string tmpname = filename + ".tmp";
+
+    int fd = open (tmpname.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+      throw VardisStoreException ("write_snapshot_file", std::format ("cannot open {}: {}", tmpname, strerror (errno)));
+
+    size_t written = 0;
+    while (written < snapshot.size())
+      {
+	ssize_t rv = write (fd, snapshot.data() + written, snapshot.size() - written);
+	if (rv < 0 and errno == EINTR) continue;
+	if (rv < 0)
+	  {
+	    int err = errno;
+	    close (fd);
+	    throw VardisStoreException ("write_snapshot_file", std::format ("cannot write {}: {}", tmpname, strerror (err)));
+	  }
+	written += rv;
+      }
+    if (fsync (fd) < 0)
+      {
+	int err = errno;
+	close (fd);
+	throw VardisStoreException ("write_snapshot_file", std::format ("cannot sync {}: {}", tmpname, strerror (err)));
+      }
+    close (fd);
+
+    if (rename (tmpname.c_str(), filename.c_str()) < 0)
+      throw VardisStoreException ("write_snapshot_file", std::format ("cannot rename {} to {}: {}", tmpname, filename, strerror (errno)));
+
+    // make the rename itself durable
+    std::string dirname = std::filesystem::path (filename).parent_path().string();
+    int dirfd = open (dirname.empty() ? "." : dirname.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dirfd >= 0)
+      {
+	fsync (dirfd);
+	close (dirfd);
+      }
+  }
+
+  // -----------------------------------------------------------------
+
+  std::vector<byte> read_snapshot_file (const std::string& filename)
+  {
+    std::error_code ec;
+    if (not std::filesystem::exists (filename, ec))
+      return std::vector<byte> ();
+
+    std::ifstream ifs (filename, std::ios::binary);
+    if (not ifs)
+      throw VardisStoreException ("read_snapshot_file", std::format ("cannot open {}", filename));
+    std::vector<byte> snapshot ((std::istreambuf_iterator<char> (ifs)), std::istreambuf_iterator<char> ());
+    if (ifs.bad())
+      throw VardisStoreException ("read_snapshot_file", std::format ("cannot read {}", filename));
+    return snapshot;
+  }
+
+  // -----------------------------------------------------------------
+
+  bool save_store_snapshot (VardisRuntimeData& runtime, std::vector<byte>& previous)
+  {
+    ScopedLatencyMeasurement measurement (runtime.metricSnapshotTime);
+    std::vector<byte> snapshot;
+    {
+      ScopedVariableStoreMutex mtx (runtime);
+      snapshot = make_store_snapshot (runtime.protocol_data);
+    }
+
+    if (snapshot == previous)
+      return false;
+
+    write_snapshot_file (runtime.vardis_config.vardis_conf.snapshotFile, snapshot);
+    previous = std::move (snapshot);
+    return true;
+  }
+
+  // -----------------------------------------------------------------
+
+  size_t restore_store_snapshot (VardisRuntimeData& runtime)
+  {
+    const std::string& filename = runtime.vardis_config.vardis_conf.snapshotFile;
+    if (filename.empty())
+      return 0;
+
+    try {
+      std::vector<byte> snapshot = read_snapshot_file (filename);
+      if (snapshot.empty())
+	{
+	  DCPLOG_INFO(log_main) << "No store snapshot in " << filename << ", starting with empty variable store.";
+	  return 0;
+	}
+
+      size_t restored;
+      {
+	ScopedVariableStoreMutex mtx (runtime);
+	restored = install_store_snapshot (runtime.protocol_data, snapshot, TimeStampT::get_current_system_time());
+      }
+      DCPLOG_INFO(log_main) << "Restored " << restored << " variables from store snapshot " << filename
+			    << ", marked as stale until confirmed by neighbours.";
+      return restored;
+    }
+    catch (DcpException& e)
+      {
+	DCPLOG_WARNING(log_main) << "Ignoring store snapshot " << filename
+				 << ": " << e.what()
+				 << ". Starting with empty variable store.";
+	return 0;
+      }
+  }
+
+  // -----------------------------------------------------------------
+
+  void snapshot_thread (VardisRuntimeData& runtime)
+  {
+    DCPLOG_INFO(log_main) << "Starting snapshot thread.";
+
+    TimeStampT         last_snapshot    = TimeStampT::get_current_coarse_time();
+    uint16_t           snapshot_period  = runtime.vardis_config.vardis_conf.snapshotPeriodMS;
+    std::vector<byte>  previous;
+    
+    while (not runtime.vardis_exitFlag)
+      {
+	sleep_for_measured (std::chrono::milliseconds (100), runtime.metricSnapshotWakeupLatency);
+
+	TimeStampT curr_time = TimeStampT::get_current_coarse_time();
+	if (curr_time.milliseconds_passed_since (last_snapshot) <= snapshot_period)
+	  continue;
+
+	last_snapshot = curr_time;
+	try {
+	  save_store_snapshot (runtime, previous);
+	}
+	catch (DcpException& e)
+	  {
+	    DCPLOG_WARNING(log_main) << "Cannot write store snapshot: " << e.what();
+	  }
+      }
+
+    try {
+      save_store_snapshot (runtime, previous);
+    }
+    catch (DcpException& e)
+      {
+	DCPLOG_WARNING(log_main) << "Cannot write final store snapshot: " << e.what();
+      }
+    
+    DCPLOG_INFO(log_main) << "Exiting snapshot thread.";
+  }
+    
+};  // namespace dcp::vardis
@@ -0,0 +1,137 @@
+/**
+ * Copyright (C) 2025 Andreas Willig, University of Canterbury
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <dcp/common/global_types_constants.h>
+#include <dcp/vardis/vardis_protocol_data.h>
+#include <dcp/vardis/vardis_runtime_data.h>
+
+
+/**
+ * @brief This module provides snapshots of the Vardis variable store
+ *        in a file, from which a restarted Vardis demon restores its
+ *        database instead of re-learning all variables from its
+ *        neighbours.
+ *
+ * A snapshot consists of a header (magic number, format version,
+ * ownNodeIdentifier, number of records, length and FNV-1a checksum
+ * of the records) followed by one serialized VarCreateT record per
+ * existing, non-deleted variable. Snapshot files are replaced
+ * atomically (written to a temporary file, synced and renamed), so
+ * that a crash while writing leaves the previous snapshot intact.
+ *
+ * Restored variables keep their seqno but are marked as stale
+ * (DBEntry::isStale) and get a fresh timestamp, so that they are not
+ * scrubbed before neighbours had a chance to refresh them. Their
+ * summaries are queued right away, so that outdated variables are
+ * detected and requested within one summary cycle. Own variables for
+ * which a neighbour reports a more recent seqno are re-announced with
+ * their restored value under a seqno past the reported one.
+ */
+
+
+namespace dcp::vardis {
+
+  /**
+   * @brief Magic number and format version of a snapshot
+   */
+  const uint32_t  snapshotMagic    =  0x56444253;   // "VDBS"
+  const uint16_t  snapshotVersion  =  1;
+
+
+  /**
+   * @brief Serializes all existing, non-deleted variables of the
+   *        variable store into a snapshot. The caller must hold the
+   *        variable store mutex.
+   */
+  std::vector<byte> make_store_snapshot (VardisProtocolData& PD);
+
+
+  /**
+   * @brief Validates the given snapshot and fills the (empty)
+   *        variable store from it, marking all variables as stale,
+   *        then rebuilds the protocol data derived from the store.
+   *        The caller must hold the variable store mutex.
+   *
+   * @param PD: protocol data, whose variable store must not contain
+   *        any variable yet
+   * @param snapshot: the snapshot
+   * @param now: current time, becomes the timestamp of all restored
+   *        variables
+   * @return Number of restored variables
+   *
+   * Throws VardisStoreException when the snapshot is invalid
+   * (e.g. wrong magic number or version, checksum mismatch,
+   * truncated, taken by another node, variables exceeding the
+   * configured maximum lengths), the store is left untouched then.
+   */
+  size_t install_store_snapshot (VardisProtocolData& PD, const std::vector<byte>& snapshot, TimeStampT now);
+
+
+  /**
+   * @brief Atomically replaces the given file with the given
+   *        snapshot. Throws VardisStoreException upon I/O errors.
+   */
+  void write_snapshot_file (const std::string& filename, const std::vector<byte>& snapshot);
+
+
+  /**
+   * @brief Reads a snapshot from the given file. Returns an empty
+   *        snapshot when the file does not exist, throws
+   *        VardisStoreException upon I/O errors.
+   */
+  std::vector<byte> read_snapshot_file (const std::string& filename);
+
+
+  /**
+   * @brief Takes a snapshot of the variable store of the given
+   *        runtime and writes it into the configured snapshot file,
+   *        unless it is identical to the previous snapshot.
+   *
+   * @param runtime: Vardis runtime
+   * @param previous: in/out parameter with the previously written
+   *        snapshot
+   * @return Whether the file has been written
+   */
+  bool save_store_snapshot (VardisRuntimeData& runtime, std::vector<byte>& previous);
+
+
+  /**
+   * @brief Restores the variable store of the given runtime from the
+   *        configured snapshot file, if any. Invalid snapshots are
+   *        logged and ignored, the demon then starts with an empty
+   *        store.
+   *
+   * @return Number of restored variables
+   */
+  size_t restore_store_snapshot (VardisRuntimeData& runtime);
+
+
+  /**
+   * @brief This thread periodically writes snapshots of the variable
+   *        store, and a final one when the demon exits
+   */
+  void snapshot_thread (VardisRuntimeData& runtime);
+  
+};  // namespace dcp::vardis
@@ -85,13 +85,13 @@ namespace dcp::vardis {
    */
   class GlobalStateBase {
   public:
-    std::atomic<bool>  vardis_isActive = true;                     /*!< flag indicating whether Vardis protocol processing is active */
+    alignas(cacheLineSize) std::atomic<bool>  vardis_isActive = true;   /*!< flag indicating whether Vardis protocol processing is active, polled by clients and kept on its own cache line */
     uint16_t                   _conf_max_summaries          = 0;   /*!< Maximum number of VarSummT records included in Vardis payload */
     size_t                     _conf_max_description_length = 0;   /*!< Maximum length of variable description text */
     size_t                     _conf_max_value_length       = 0;   /*!< Maximum length of variable value */
     uint8_t                    _conf_max_repetitions        = 0;   /*!< Maximum allowed repCnt value for variables */
     NodeIdentifierT            _own_node_identifier;               /*!< ownNodeIdentifier */
-    VardisProtocolStatistics   _vardis_stats;                      /*!< Vardis runtime statistics */
+    alignas(cacheLineSize) VardisProtocolStatistics   _vardis_stats;   /*!< Vardis runtime statistics, updated by the demon on every payload */
   };
 
 
@@ -327,7 +327,7 @@ namespace dcp::vardis {
 	throw VSE ("initialize_array_store",
 		   std::format("maximum value length {} is too large", maxvallen));
 
-      pContents = new (memory_start_address) ArrayContents;
+      pContents = new (align_address (memory_start_address, alignof(ArrayContents))) ArrayContents;
 
       for (uint64_t i = 0; i < get_number_buffers(); i++)
 	{
@@ -348,9 +348,10 @@ namespace dcp::vardis {
 
     /**
      * @brief Returns the actual size needed for the ArrayContents
-     *        structure in the given memory block.
+     *        structure in the given memory block, including padding
+     *        for aligning the structure to a cache line boundary.
      */
-    static constexpr size_t get_array_contents_size () { return sizeof(ArrayContents); };
+    static constexpr size_t get_array_contents_size () { return sizeof(ArrayContents) + alignof(ArrayContents) - 1; };
 
 
     // ---------------------------------------
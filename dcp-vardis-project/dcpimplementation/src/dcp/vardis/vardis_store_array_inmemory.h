@@ -119,7 +119,7 @@ namespace dcp::vardis {
     {
       if (isCreator)
 	{
-	  memory_address = new byte [sizeof(InMemoryArrayContents)];
+	  memory_address = new byte [InMemoryArrayType::get_array_contents_size()];
 	  InMemoryArrayType::initialize_array_store (get_memory_address (),
 						     maxsumm,
 						     maxdescrlen,
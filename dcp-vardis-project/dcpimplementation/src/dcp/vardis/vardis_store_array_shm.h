@@ -45,7 +45,7 @@ namespace dcp::vardis {
    */
   class GlobalStateShm : public GlobalStateBase {
   public:
-    interprocess_mutex mutex;
+    alignas(cacheLineSize) interprocess_mutex mutex;
   };
 
 
@@ -100,6 +100,8 @@ namespace dcp::vardis {
      * @param maxvallen: value of maxValueLength configuration parameter
      * @param maxrep: value of maxRepetitions configuration parameter
      * @param own_node_id: value of ownNodeIdentifier parameter
+     * @param useHugePages: whether to map the shared memory segment
+     *        with transparent huge pages (creator only)
      *
      * As a creator, allocates shared memory object, and initializes
      * the array-based variable store there. As a client, attempts to
@@ -113,9 +115,10 @@ namespace dcp::vardis {
 			   size_t maxdescrlen = 0,
 			   size_t maxvallen = 0,
 			   uint8_t maxrep = 0,
-			   NodeIdentifierT own_node_id = nullNodeIdentifier
+			   NodeIdentifierT own_node_id = nullNodeIdentifier,
+			   bool useHugePages = false
 			   )
-      : ShmStructureBase (area_name, ShmArrayType::get_array_contents_size(), isCreator),
+      : ShmStructureBase (area_name, ShmArrayType::get_array_contents_size(), isCreator, useHugePages),
 	isCreator (isCreator)
     {
       if (isCreator)
@@ -129,7 +132,7 @@ namespace dcp::vardis {
 	}
       else
 	{
-	  this->pContents = (ShmArrayContents*) get_memory_address();
+	  this->pContents = (ShmArrayContents*) align_address ((byte*) get_memory_address(), alignof(ShmArrayContents));
 	  if (this->pContents == nullptr)
 	    throw VardisStoreException ("ArrayVariableStoreShm",
 					"illegal region pointer");
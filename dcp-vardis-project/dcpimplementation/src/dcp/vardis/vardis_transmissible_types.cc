@@ -52,6 +52,18 @@ namespace dcp::vardis {
     return os;
   }
 
+  std::ostream& operator<< (std::ostream& os, const VarPriorityT& vp)
+  {
+    os << (int) vp.val;
+    return os;
+  }
+
+  std::ostream& operator<< (std::ostream& os, const VarIntervalT& vi)
+  {
+    os << (int) vi.val;
+    return os;
+  }
+
   // ------------------------------------------
   
   std::ostream& operator<<(std::ostream& os, const VarValueT& vv)
@@ -68,6 +80,32 @@ namespace dcp::vardis {
     return os;
   }
 
+  std::ostream& operator<<(std::ostream& os, const VarSummRangeT& vsr)
+  {
+    os << "VarSummRangeT { firstVarId = " << vsr.firstVarId
+       << " , numVars = " << (int) vsr.numVars;
+    if (vsr.mode == SUMMRANGE_MODE_DIGEST)
+      os << " , digest = " << vsr.digest;
+    else
+      {
+	os << " , seqnos = [";
+	for (const auto& seqno : vsr.seqnos)
+	  os << " " << seqno;
+	os << " ]";
+      }
+    os << " }";
+    return os;
+  }
+
+  std::ostream& operator<<(std::ostream& os, const VarMerkleNodeT& vmn)
+  {
+    os << "VarMerkleNodeT { level = " << (int) vmn.level
+       << " , index = " << vmn.index
+       << " , hash = " << vmn.hash
+       << " }";
+    return os;
+  }
+
   std::ostream& operator<<(std::ostream& os, const VarUpdateT& vu)
   {
     os << "VarUpdateT { varId = " << vu.varId
@@ -84,6 +122,8 @@ namespace dcp::vardis {
        << " , repCnt = " << vs.repCnt
        << " , creationTime = " << vs.creationTime
        << " , timeout = " << vs.timeout
+       << " , prio = " << vs.prio
+       << " , minInterval = " << vs.minInterval
        << " , descr = " << vs.descr
        << " }";
     return os;
@@ -118,6 +158,22 @@ namespace dcp::vardis {
     return os;
   }
 
+  std::ostream& operator<<(std::ostream& os, const VarReqSummRangeT& vrsr)
+  {
+    os << "VarReqSummRangeT { firstVarId = " << vrsr.firstVarId
+       << " , numVars = " << (int) vrsr.numVars
+       << " }";
+    return os;
+  }
+
+  std::ostream& operator<<(std::ostream& os, const VarReqMerkleNodeT& vrmn)
+  {
+    os << "VarReqMerkleNodeT { level = " << (int) vrmn.level
+       << " , index = " << vrmn.index
+       << " }";
+    return os;
+  }
+
   std::ostream& operator<<(std::ostream& os, const ICHeaderT& ich)
   {
     os << "ICHeaderT { icType = " << vardis_instruction_container_to_string (ich.icType)
@@ -136,6 +192,10 @@ namespace dcp::vardis {
       case  ICTYPE_REQUEST_VARCREATES:  return "ICTYPE_REQUEST_VARCREATES";
       case  ICTYPE_CREATE_VARIABLES:    return "ICTYPE_CREATE_VARIABLES";
       case  ICTYPE_DELETE_VARIABLES:    return "ICTYPE_DELETE_VARIABLES";
+      case  ICTYPE_SUMMARY_RANGES:      return "ICTYPE_SUMMARY_RANGES";
+      case  ICTYPE_REQUEST_SUMMRANGES:  return "ICTYPE_REQUEST_SUMMRANGES";
+      case  ICTYPE_MERKLE_NODES:        return "ICTYPE_MERKLE_NODES";
+      case  ICTYPE_REQUEST_MERKLENODES: return "ICTYPE_REQUEST_MERKLENODES";
       
       default:
 	throw std::invalid_argument(std::format("vardis_instruction_container_to_string: illegal instruction container code {}", (int) ic.val));
@@ -135,6 +135,59 @@ namespace dcp::vardis {
     
     friend std::ostream& operator<< (std::ostream& os, const VarTimeoutT& vt);
   };
+
+
+  /**
+   * @brief The known variable priority classes
+   */
+  const uint8_t  VARDIS_PRIO_CRITICAL  =  0;   /*!< Safety-relevant variables, updates go first into a payload */
+  const uint8_t  VARDIS_PRIO_HIGH      =  1;
+  const uint8_t  VARDIS_PRIO_NORMAL    =  2;   /*!< Default priority class */
+  const uint8_t  VARDIS_PRIO_LOW       =  3;   /*!< Background / bulk telemetry */
+
+
+  /**
+   * @brief Variable priority class, with VARDIS_PRIO_CRITICAL being
+   *        the most and VARDIS_PRIO_LOW being the least important
+   *        class
+   *
+   * The priority class determines the order in which pending
+   * creates and updates are included into payloads, and how often a
+   * variable is included into summaries.
+   */
+  class VarPriorityT : public TransmissibleIntegral<byte> {
+  public:
+
+    static constexpr uint8_t max_val () { return 3; };
+    static constexpr size_t  number_classes () { return max_val() + 1; };
+    
+    VarPriorityT () : TransmissibleIntegral<byte>(VARDIS_PRIO_NORMAL) {};
+    VarPriorityT (const VarPriorityT& other) : TransmissibleIntegral<byte> (other) {};
+    VarPriorityT (uint8_t p) : TransmissibleIntegral<byte>(p) {};
+
+    VarPriorityT& operator= (const VarPriorityT& other) { val = other.val; return *this; };
+    
+    friend std::ostream& operator<< (std::ostream& os, const VarPriorityT& vp);
+  };
+
+
+  /**
+   * @brief Minimum interval between two transmitted updates of a
+   *        variable (in milliseconds), zero means no rate limitation
+   */
+  class VarIntervalT : public TransmissibleIntegral<uint16_t> {
+  public:
+
+    static constexpr uint16_t max_val () { return 65000; };
+    
+    VarIntervalT () : TransmissibleIntegral<uint16_t>(0) {};
+    VarIntervalT (const VarIntervalT& other) : TransmissibleIntegral<uint16_t> (other) {};
+    VarIntervalT (uint16_t i) : TransmissibleIntegral<uint16_t>(i) {};
+
+    VarIntervalT& operator= (const VarIntervalT& other) { val = other.val; return *this; };
+    
+    friend std::ostream& operator<< (std::ostream& os, const VarIntervalT& vi);
+  };
   
   
   // -----------------------------------------
@@ -251,6 +304,17 @@ namespace dcp::vardis {
 	area.deserialize_byte_block (len.val, data_buffer);
     };
 
+
+    /**
+     * @brief Deserialization as a view into the memory of the given
+     *        area, without allocating or copying the value
+     */
+    virtual void deserialize_view (DisassemblyArea& area)
+    {
+      len.deserialize (area);
+      set_view (len.val, area.view_byte_block (len.val));
+    };
+
     
     friend std::ostream& operator<<(std::ostream& os, const VarValueT& vv);
   };
@@ -301,8 +365,185 @@ namespace dcp::vardis {
     
     friend std::ostream& operator<<(std::ostream& os, const VarSummT& vs);
   };
-  
-  
+
+
+
+  // -----------------------------------------
+
+
+  /**
+   * @brief The known modes of a summary range record
+   */
+  const byte  SUMMRANGE_MODE_SEQNOS  =  1;    /*!< Record carries one seqno per variable in the range */
+  const byte  SUMMRANGE_MODE_DIGEST  =  2;    /*!< Record carries a digest over the range */
+
+
+  /**
+   * @brief Type representing a compact summary for a range of
+   *        consecutive variable identifiers
+   *
+   * A summary range covers the numVars variable identifiers starting
+   * at firstVarId. In mode SUMMRANGE_MODE_SEQNOS all these variables
+   * exist at the sender and the record carries their sequence numbers
+   * in order, without repeating the variable identifiers. In mode
+   * SUMMRANGE_MODE_DIGEST the record carries a 32-bit digest over the
+   * (varId, seqno) pairs of all non-deleted variables the sender has
+   * in the range, so that a receiver can check with a single record
+   * whether it is in sync for the entire range.
+   */
+  class VarSummRangeT : public TransmissibleType<VarIdT::fixed_size() + 2*sizeof(byte)> {
+  public:
+    VarIdT                  firstVarId;
+    byte                    numVars = 0;
+    byte                    mode    = SUMMRANGE_MODE_SEQNOS;
+    std::vector<VarSeqnoT>  seqnos;          /*!< Only used in mode SUMMRANGE_MODE_SEQNOS */
+    uint32_t                digest  = 0;     /*!< Only used in mode SUMMRANGE_MODE_DIGEST */
+
+
+    /**
+     * @brief Returns the serialized size of a range record in mode
+     *        SUMMRANGE_MODE_SEQNOS covering the given number of
+     *        variables
+     */
+    static constexpr size_t seqnos_size (size_t nvars) { return fixed_size() + nvars * VarSeqnoT::fixed_size(); };
+
+
+    /**
+     * @brief Returns the serialized size of a range record in mode
+     *        SUMMRANGE_MODE_DIGEST
+     */
+    static constexpr size_t digest_size () { return fixed_size() + sizeof(uint32_t); };
+
+
+    virtual size_t total_size () const
+    {
+      return (mode == SUMMRANGE_MODE_DIGEST) ? digest_size() : seqnos_size (numVars);
+    };
+
+
+    /**
+     * @brief Equality test, all fields relevant for the mode must agree
+     */
+    inline bool operator== (const VarSummRangeT& other) const
+    {
+      if ((firstVarId != other.firstVarId) or (numVars != other.numVars) or (mode != other.mode))
+	return false;
+      if (mode == SUMMRANGE_MODE_DIGEST)
+	return digest == other.digest;
+      return seqnos == other.seqnos;
+    };
+
+
+    /**
+     * @brief Serialization into given area
+     *
+     * Throws if mode is unknown or if in mode SUMMRANGE_MODE_SEQNOS
+     * the number of seqnos does not match numVars
+     */
+    virtual void serialize (AssemblyArea& area) const
+    {
+      if (numVars == 0)
+	throw AssemblyAreaException ("VarSummRangeT::serialize", "empty range");
+      if ((mode == SUMMRANGE_MODE_SEQNOS) and (seqnos.size() != numVars))
+	throw AssemblyAreaException ("VarSummRangeT::serialize", "number of seqnos does not match range");
+
+      firstVarId.serialize (area);
+      area.serialize_byte (numVars);
+      area.serialize_byte (mode);
+
+      switch (mode)
+	{
+	case SUMMRANGE_MODE_SEQNOS:
+	  for (const auto& seqno : seqnos)
+	    seqno.serialize (area);
+	  break;
+	case SUMMRANGE_MODE_DIGEST:
+	  area.serialize_uint32_n (digest);
+	  break;
+	default:
+	  throw AssemblyAreaException ("VarSummRangeT::serialize", std::format ("unknown mode {}", (int) mode));
+	}
+    };
+
+
+    /**
+     * @brief Deserialization from given area
+     *
+     * Throws if the range is empty or the mode is unknown
+     */
+    virtual void deserialize (DisassemblyArea& area)
+    {
+      firstVarId.deserialize (area);
+      numVars = area.deserialize_byte ();
+      mode    = area.deserialize_byte ();
+
+      if (numVars == 0)
+	throw DisassemblyAreaException ("VarSummRangeT::deserialize", "empty range");
+
+      switch (mode)
+	{
+	case SUMMRANGE_MODE_SEQNOS:
+	  seqnos.resize (numVars);
+	  for (auto& seqno : seqnos)
+	    seqno.deserialize (area);
+	  break;
+	case SUMMRANGE_MODE_DIGEST:
+	  area.deserialize_uint32_n (digest);
+	  break;
+	default:
+	  throw DisassemblyAreaException ("VarSummRangeT::deserialize", std::format ("unknown mode {}", (int) mode));
+	}
+    };
+
+
+    friend std::ostream& operator<<(std::ostream& os, const VarSummRangeT& vsr);
+  };
+
+
+
+  // -----------------------------------------
+
+
+  /**
+   * @brief Type representing the hash of one node of the Merkle tree
+   *        over the (varId, seqno) pairs of a node's database
+   *
+   * The tree is a complete binary tree whose leaves are the variable
+   * identifiers. A node is identified by its level (0 is the root)
+   * and its index within that level, so that a node at level l with
+   * index i covers the variable identifiers [i*2^(d-l), (i+1)*2^(d-l)),
+   * where d is the depth of the tree. Subtrees without any existing
+   * and non-deleted variables have hash zero.
+   */
+  class VarMerkleNodeT : public TransmissibleType<sizeof(byte) + VarIdT::fixed_size() + sizeof(uint32_t)> {
+  public:
+    byte      level  = 0;
+    VarIdT    index;
+    uint32_t  hash   = 0;
+
+    inline bool operator== (const VarMerkleNodeT& other) const
+    {
+      return (level == other.level) and (index == other.index) and (hash == other.hash);
+    };
+
+    virtual void serialize (AssemblyArea& area) const
+    {
+      area.serialize_byte (level);
+      index.serialize (area);
+      area.serialize_uint32_n (hash);
+    };
+
+    virtual void deserialize (DisassemblyArea& area)
+    {
+      level = area.deserialize_byte ();
+      index.deserialize (area);
+      area.deserialize_uint32_n (hash);
+    };
+
+    friend std::ostream& operator<<(std::ostream& os, const VarMerkleNodeT& vmn);
+  };
+
+
 
   // -----------------------------------------
 
@@ -355,6 +596,18 @@ namespace dcp::vardis {
       value.deserialize (area);
     };
 
+
+    /**
+     * @brief Deserialization with the value being a view into the
+     *        memory of the given area
+     */
+    virtual void deserialize_view (DisassemblyArea& area)
+    {
+      varId.deserialize (area);
+      seqno.deserialize (area);
+      value.deserialize_view (area);
+    };
+
     
     friend std::ostream& operator<<(std::ostream& os, const VarUpdateT& vu);
   };
@@ -375,13 +628,17 @@ namespace dcp::vardis {
 					    + VarRepCntT::fixed_size()
 					    + StringT::fixed_size()
 					    + TimeStampT::fixed_size()
-					    + VarTimeoutT::fixed_size()> {
+					    + VarTimeoutT::fixed_size()
+					    + VarPriorityT::fixed_size()
+					    + VarIntervalT::fixed_size()> {
   public:
     VarIdT            varId;
     NodeIdentifierT   prodId;
     VarRepCntT        repCnt;
     TimeStampT        creationTime;
     VarTimeoutT       timeout;
+    VarPriorityT      prio;
+    VarIntervalT      minInterval;
     StringT           descr;
     
     virtual size_t total_size () const { return fixed_size() + descr.length; };
@@ -398,6 +655,8 @@ namespace dcp::vardis {
 	      and (descr == other.descr)
 	      and (creationTime == other.creationTime)
 	      and (timeout == other.timeout)
+	      and (prio == other.prio)
+	      and (minInterval == other.minInterval)
 	      );
     };
 
@@ -412,6 +671,8 @@ namespace dcp::vardis {
       repCnt.serialize (area);
       creationTime.serialize (area);
       timeout.serialize(area);
+      prio.serialize (area);
+      minInterval.serialize (area);
       descr.serialize (area);
     };
 
@@ -420,16 +681,38 @@ namespace dcp::vardis {
      * @brief Deserialization from given area
      */
     virtual void deserialize (DisassemblyArea& area)
+    {
+      deserialize_fixed_fields (area);
+      descr.deserialize (area);
+    };
+
+
+    /**
+     * @brief Deserialization with the description being a view into
+     *        the memory of the given area
+     */
+    virtual void deserialize_view (DisassemblyArea& area)
+    {
+      deserialize_fixed_fields (area);
+      descr.deserialize_view (area);
+    };
+
+    friend std::ostream& operator<<(std::ostream& os, const VarSpecT& vs);
+
+  private:
+
+    void deserialize_fixed_fields (DisassemblyArea& area)
     {
       varId.deserialize (area);
       prodId.deserialize (area);
       repCnt.deserialize (area);
       creationTime.deserialize (area);
       timeout.deserialize (area);
-      descr.deserialize (area);
+      prio.deserialize (area);
+      minInterval.deserialize (area);
+      if (prio.val > VarPriorityT::max_val())
+	throw DisassemblyAreaException ("VarSpecT::deserialize", std::format ("illegal priority class {}", (int) prio.val));
     };
-
-    friend std::ostream& operator<<(std::ostream& os, const VarSpecT& vs);
   };
   
   
@@ -479,6 +762,17 @@ namespace dcp::vardis {
       update.deserialize (area);
     };
 
+
+    /**
+     * @brief Deserialization with description and value being views
+     *        into the memory of the given area
+     */
+    virtual void deserialize_view (DisassemblyArea& area)
+    {
+      spec.deserialize_view (area);
+      update.deserialize_view (area);
+    };
+
     
     friend std::ostream& operator<<(std::ostream& os, const VarCreateT& vc);
   };
@@ -539,7 +833,82 @@ namespace dcp::vardis {
     virtual void deserialize (DisassemblyArea& area) { varId.deserialize (area); };
     friend std::ostream& operator<<(std::ostream& os, const VarReqCreateT& vrc);
   };
+
+
+  // -----------------------------------------
+
+
+  /**
+   * @brief Type representing a request for explicit summaries of a
+   *        range of variable identifiers
+   *
+   * Generated by a receiver of a VarSummRangeT digest which does not
+   * match its own digest for that range. Any node receiving it
+   * responds with VarSummRangeT records in mode
+   * SUMMRANGE_MODE_SEQNOS for its variables in the range.
+   */
+  class VarReqSummRangeT : public TransmissibleType<VarIdT::fixed_size() + sizeof(byte)> {
+  public:
+    VarIdT  firstVarId;
+    byte    numVars = 0;
+
+    inline bool operator== (const VarReqSummRangeT& other) const
+    {
+      return (firstVarId == other.firstVarId) and (numVars == other.numVars);
+    };
+
+    virtual void serialize (AssemblyArea& area) const
+    {
+      firstVarId.serialize (area);
+      area.serialize_byte (numVars);
+    };
+
+    virtual void deserialize (DisassemblyArea& area)
+    {
+      firstVarId.deserialize (area);
+      numVars = area.deserialize_byte ();
+    };
+
+    friend std::ostream& operator<<(std::ostream& os, const VarReqSummRangeT& vrsr);
+  };
+
+  
   
+  // -----------------------------------------
+
+
+  /**
+   * @brief Type representing a request for the hashes of the two
+   *        children of a Merkle tree node
+   *
+   * Generated by a receiver of a VarMerkleNodeT whose hash differs
+   * from its own hash for that node.
+   */
+  class VarReqMerkleNodeT : public TransmissibleType<sizeof(byte) + VarIdT::fixed_size()> {
+  public:
+    byte    level = 0;
+    VarIdT  index;
+
+    inline bool operator== (const VarReqMerkleNodeT& other) const
+    {
+      return (level == other.level) and (index == other.index);
+    };
+
+    virtual void serialize (AssemblyArea& area) const
+    {
+      area.serialize_byte (level);
+      index.serialize (area);
+    };
+
+    virtual void deserialize (DisassemblyArea& area)
+    {
+      level = area.deserialize_byte ();
+      index.deserialize (area);
+    };
+
+    friend std::ostream& operator<<(std::ostream& os, const VarReqMerkleNodeT& vrmn);
+  };
+
   
   
   // -----------------------------------------
@@ -584,6 +953,10 @@ namespace dcp::vardis {
   const byte  ICTYPE_REQUEST_VARCREATES  =  4;
   const byte  ICTYPE_CREATE_VARIABLES    =  5;
   const byte  ICTYPE_DELETE_VARIABLES    =  6;
+  const byte  ICTYPE_SUMMARY_RANGES      =  7;
+  const byte  ICTYPE_REQUEST_SUMMRANGES  =  8;
+  const byte  ICTYPE_MERKLE_NODES        =  9;
+  const byte  ICTYPE_REQUEST_MERKLENODES = 10;
 
 
   /**
@@ -23,6 +23,7 @@
 #include <chrono>
 #include <dcp/common/area.h>
 #include <dcp/common/debug_helpers.h>
+#include <dcp/common/realtime.h>
 #include <dcp/common/services_status.h>
 #include <dcp/bp/bpclient_lib.h>
 #include <dcp/bp/bp_service_primitives.h>
@@ -40,25 +41,38 @@ namespace dcp::vardis {
   void construct_payload (VardisRuntimeData& runtime, AssemblyArea& area, unsigned int& containers_added)
   {
     VardisProtocolData& pd         = runtime.protocol_data;
+
+    // Updates of critical variables go first, so that they are not
+    // displaced by creates, summaries or bulk updates in a full payload
     try {
       if (runtime.vardis_config.vardis_conf.lockingForIndividualContainers)
 	{
+	  { ScopedVariableStoreMutex mtx (runtime);  pd.makeICTypeUpdates (area, containers_added, VARDIS_PRIO_CRITICAL, VARDIS_PRIO_CRITICAL); }
 	  { ScopedVariableStoreMutex mtx (runtime);  pd.makeICTypeCreateVariables (area, containers_added); }
 	  { ScopedVariableStoreMutex mtx (runtime);  pd.makeICTypeDeleteVariables (area, containers_added); }
 	  { ScopedVariableStoreMutex mtx (runtime);  pd.makeICTypeRequestVarCreates (area, containers_added); }
 	  { ScopedVariableStoreMutex mtx (runtime);  pd.makeICTypeSummaries (area, containers_added); }
-	  { ScopedVariableStoreMutex mtx (runtime);  pd.makeICTypeUpdates (area, containers_added); }
+	  { ScopedVariableStoreMutex mtx (runtime);  pd.makeICTypeSummaryRanges (area, containers_added); }
+	  { ScopedVariableStoreMutex mtx (runtime);  pd.makeICTypeMerkleNodes (area, containers_added); }
+	  { ScopedVariableStoreMutex mtx (runtime);  pd.makeICTypeUpdates (area, containers_added, VARDIS_PRIO_HIGH, VARDIS_PRIO_LOW); }
 	  { ScopedVariableStoreMutex mtx (runtime);  pd.makeICTypeRequestVarUpdates (area, containers_added); }
+	  { ScopedVariableStoreMutex mtx (runtime);  pd.makeICTypeRequestSummaryRanges (area, containers_added); }
+	  { ScopedVariableStoreMutex mtx (runtime);  pd.makeICTypeRequestMerkleNodes (area, containers_added); }
 	}
       else
 	{
 	  ScopedVariableStoreMutex mtx (runtime);
+	  pd.makeICTypeUpdates (area, containers_added, VARDIS_PRIO_CRITICAL, VARDIS_PRIO_CRITICAL);
 	  pd.makeICTypeCreateVariables (area, containers_added);
 	  pd.makeICTypeDeleteVariables (area, containers_added);
 	  pd.makeICTypeRequestVarCreates (area, containers_added);
 	  pd.makeICTypeSummaries (area, containers_added);
-	  pd.makeICTypeUpdates (area, containers_added);
+	  pd.makeICTypeSummaryRanges (area, containers_added);
+	  pd.makeICTypeMerkleNodes (area, containers_added);
+	  pd.makeICTypeUpdates (area, containers_added, VARDIS_PRIO_HIGH, VARDIS_PRIO_LOW);
 	  pd.makeICTypeRequestVarUpdates (area, containers_added);
+	  pd.makeICTypeRequestSummaryRanges (area, containers_added);
+	  pd.makeICTypeRequestMerkleNodes (area, containers_added);
 	}
     }
     catch (DcpException& e) {
@@ -85,46 +99,57 @@ namespace dcp::vardis {
   
   // -----------------------------------------------------------------
   
+  void transmit_payload (VardisRuntimeData& runtime)
+  {
+    if (not runtime.protocol_data.vardis_store.get_vardis_isactive())
+      return;
+    
+    BPShmControlSegment& CS = *(runtime.pSCS);
+    
+    PushHandler handler = [&] (byte* memaddr, size_t bufferSize)
+    {
+      BPTransmitPayload_Request*  pldReq_ptr = new (memaddr) BPTransmitPayload_Request;
+      byte* area_ptr = memaddr + sizeof(BPTransmitPayload_Request);
+      MemoryChunkAssemblyArea area ("vd-tx", std::min((size_t) runtime.vardis_config.vardis_conf.maxPayloadSize, bufferSize), area_ptr);
+      unsigned int containers_added = 0;
+      
+      {
+	ScopedLatencyMeasurement build_time (runtime.metricPayloadBuildTime);
+	construct_payload (runtime, area, containers_added);
+      }
+      
+      if (containers_added == 0)
+	return (size_t) 0;
+
+      runtime.metricPayloadsSent.inc ();
+      
+      pldReq_ptr->protocolId = BP_PROTID_VARDIS;
+      pldReq_ptr->length     = area.used();
+      
+      return (area.used() + sizeof(BPTransmitPayload_Request));
+    };
+    
+    bool timed_out;
+    
+    CS.queue.push_wait (handler, timed_out);
+    if (timed_out)
+      {
+	DCPLOG_FATAL(log_tx) << "Shared memory timeout. Exiting.";
+	runtime.vardis_exitFlag = true;
+      }
+  }
+  
+  // -----------------------------------------------------------------
+  
   void transmitter_thread (VardisRuntimeData& runtime)
   {
     DCPLOG_INFO(log_tx) << "Starting transmit thread.";
 
-    BPShmControlSegment& CS = *(runtime.pSCS);
-
     try {
       while (not runtime.vardis_exitFlag)
 	{
-	  std::this_thread::sleep_for (std::chrono::milliseconds (runtime.vardis_config.vardis_conf.payloadGenerationIntervalMS));
-	  
-	  if (not runtime.protocol_data.vardis_store.get_vardis_isactive())
-	    continue;
-	  
-	  PushHandler handler = [&] (byte* memaddr, size_t bufferSize)
-	  {
-	    BPTransmitPayload_Request*  pldReq_ptr = new (memaddr) BPTransmitPayload_Request;
-	    byte* area_ptr = memaddr + sizeof(BPTransmitPayload_Request);
-	    MemoryChunkAssemblyArea area ("vd-tx", std::min((size_t) runtime.vardis_config.vardis_conf.maxPayloadSize, bufferSize), area_ptr);
-	    unsigned int containers_added = 0;
-	    
-	    construct_payload (runtime, area, containers_added);
-	    
-	    if (containers_added == 0)
-	      return (size_t) 0;
-	    
-	    pldReq_ptr->protocolId = BP_PROTID_VARDIS;
-	    pldReq_ptr->length     = area.used();
-	    
-	    return (area.used() + sizeof(BPTransmitPayload_Request));
-	  };
-	  
-	  bool timed_out;
-	  
-	  CS.queue.push_wait (handler, timed_out);
-	  if (timed_out)
-	    {
-	      DCPLOG_FATAL(log_tx) << "Shared memory timeout. Exiting.";
-	      runtime.vardis_exitFlag = true;
-	    }
+	  sleep_for_measured (std::chrono::milliseconds (runtime.vardis_config.vardis_conf.payloadGenerationIntervalMS), runtime.metricTxWakeupLatency);
+	  transmit_payload (runtime);
 	}
     }
     catch (DcpException& e)
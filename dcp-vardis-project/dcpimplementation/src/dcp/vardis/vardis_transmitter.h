@@ -24,6 +24,14 @@
 
 namespace dcp::vardis {
 
+  /**
+   * @brief Constructs one Vardis payload (if there is anything to
+   *        send) and hands it over to BP. Sets the exit flag when BP
+   *        does not take it within the shared memory timeout.
+   */
+  void transmit_payload (VardisRuntimeData& runtime);
+
+  
   /**
    * @brief Start transmitter thread (constructing and transmitting
    *        Vardis payloads), run it until exitFlag is set
@@ -294,6 +294,24 @@ namespace dcp {
 			   TimeStampT& responseTimeStamp,
 			   size_t value_bufsize,
 			   byte* value_buffer);
+
+
+    /**
+     * @brief Read a variable, additionally reporting whether its
+     *        value is stale
+     *
+     * Like the preceding rtdb_read, with the additional output
+     * parameter responseIsStale indicating that the value has been
+     * restored from a store snapshot at startup and not yet been
+     * confirmed by a neighbour or the producer.
+     */
+    DcpStatus rtdb_read   (VarIdT varId,
+			   VarIdT& responseVarId,
+			   VarLenT& responseVarLen,
+			   TimeStampT& responseTimeStamp,
+			   bool& responseIsStale,
+			   size_t value_bufsize,
+			   byte* value_buffer);
     
   };
   
@@ -137,6 +137,20 @@ namespace dcp {
 					      TimeStampT& responseTimeStamp,
 					      size_t value_bufsize,
 					      byte* value_buffer)
+  {
+    bool responseIsStale;
+    return rtdb_read (varId, responseVarId, responseVarLen, responseTimeStamp, responseIsStale, value_bufsize, value_buffer);
+  }
+
+  // --------------------------------------
+
+  DcpStatus VardisClientRuntime::rtdb_read   (VarIdT varId,
+					      VarIdT& responseVarId,
+					      VarLenT& responseVarLen,
+					      TimeStampT& responseTimeStamp,
+					      bool& responseIsStale,
+					      size_t value_bufsize,
+					      byte* value_buffer)
   {
     if ((value_buffer == nullptr) or (value_bufsize < dcp::vardis::MAX_maxValueLength))
       throw VardisClientLibException ("rtdb_read", "illegal buffer information");
@@ -158,6 +172,7 @@ namespace dcp {
 	  }
 	variable_store.read_value (varId, value_bufsize, value_buffer, responseVarLen);
 	responseTimeStamp = entry.tStamp;
+	responseIsStale   = entry.isStale;
 	responseVarId = entry.varId;
 	variable_store.get_vardis_protocol_statistics_ref().count_handle_rtdb_read++;
       }
@@ -4,3 +4,4 @@ alias do-clean='rm -rf ../_build/*'
 alias do-exec-bp='../_build/dcp-bp'
 alias do-exec-srp='../_build/dcp-srp'
 alias do-test='cd ../_build/ && ctest && cd ../src/'
+alias do-bench='cmake --build ../_build --target dcp-bench-json'
@@ -1,7 +1,188 @@
+#include <cstring>
+#include <format>
+#include <map>
+#include <memory>
 #include <gtest/gtest.h>
+#include <unistd.h>
+#include <dcp/common/exceptions.h>
+#include <dcp/bp/bp_client_protocol_data.h>
+#include <dcp/bp/bp_configuration.h>
+#include <dcp/bp/bp_local_registrar.h>
+#include <dcp/bp/bp_management_command.h>
+#include <dcp/bp/bp_runtime_data.h>
+#include <dcp/bp/bp_service_primitives.h>
 #include <dcp/bp/bp_shm_control_segment.h>
+#include <dcp/bp/bpclient_lib.h>
+
+using namespace dcp;
+using namespace dcp::bp;
 
 
 TEST (BPShmTest, initialTest) {
 }
 
+
+namespace {
+
+  /**
+   * @brief Stands in for the BP runtime data: keeps in-process client
+   *        protocols the way BPRuntimeRegistrar does
+   */
+  class TestRegistrar : public BPLocalRegistrar {
+  public:
+    std::map<BPProtocolIdT, BPClientProtocolData> clients;
+    NodeIdentifierT nodeId;
+
+    virtual DcpStatus register_local_protocol (const BPStaticClientInfo& static_info,
+					       bool gen_pld_confirms,
+					       BPShmControlSegment*& pSCS,
+					       NodeIdentifierT& ownNodeIdentifier)
+    {
+      if (clients.contains (static_info.protocolId))
+	return BP_STATUS_PROTOCOL_ALREADY_REGISTERED;
+      clients[static_info.protocolId] = BPClientProtocolData (static_info, gen_pld_confirms);
+      pSCS              = clients[static_info.protocolId].pSCS;
+      ownNodeIdentifier = nodeId;
+      return BP_STATUS_OK;
+    };
+
+    virtual DcpStatus deregister_local_protocol (BPProtocolIdT protocolId)
+    {
+      return (clients.erase (protocolId) == 1) ? BP_STATUS_OK : BP_STATUS_UNKNOWN_PROTOCOL;
+    };
+  };
+
+};
+
+
+TEST (BPShmTest, InProcessClient) {
+  TestRegistrar          registrar;
+  BPClientConfiguration  cfg;
+  BPStaticClientInfo     sci;
+  byte                   mac [6] = {1, 2, 3, 4, 5, 6};
+  registrar.nodeId    = NodeIdentifierT (mac);
+  sci.protocolId      = BP_PROTID_SRP;
+  std::strcpy (sci.protocolName, "in-process test");
+  sci.maxPayloadSize  = 100;
+  sci.queueingMode    = BP_QMODE_ONCE;
+
+  {
+    BPClientRuntime rt (cfg, sci, false, &registrar);
+    ASSERT_TRUE (rt.isRegistered ());
+    ASSERT_EQ (registrar.clients.size(), 1);
+    EXPECT_TRUE (registrar.clients[sci.protocolId].is_local ());
+    EXPECT_EQ (rt.pSCS, registrar.clients[sci.protocolId].pSCS);
+    EXPECT_FALSE (rt.pSSB);
+    EXPECT_EQ (rt.get_own_node_identifier (), registrar.nodeId);
+
+    EXPECT_THROW (BPClientRuntime (cfg, sci, false, &registrar), BPClientLibException);
+
+    // transmitted payloads land in the buffer BP reads from
+    byte payload [10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    EXPECT_EQ (rt.transmit_payload (10, payload), BP_STATUS_OK);
+    EXPECT_EQ (rt.pSCS->buffer.stored_elements (), 1);
+
+    // received payloads handed over by BP reach the client
+    bool timed_out, is_full, more_payloads;
+    rt.pSCS->pqReceivePayloadIndication.push_nowait ([&] (byte* memaddr, size_t)
+    {
+      BPReceivePayload_Indication ind;
+      ind.length = 10;
+      std::memcpy (memaddr, &ind, sizeof(ind));
+      std::memcpy (memaddr + sizeof(ind), payload, 10);
+      return sizeof(ind) + 10;
+    }, timed_out, is_full);
+    BPLengthT result_length;
+    byte      result [100];
+    EXPECT_EQ (rt.receive_payload_nowait (result_length, result, more_payloads), BP_STATUS_OK);
+    EXPECT_EQ (result_length, 10);
+    EXPECT_EQ (std::memcmp (result, payload, 10), 0);
+    EXPECT_FALSE (more_payloads);
+  }
+
+  // the destructor deregisters directly with the registrar
+  EXPECT_TRUE (registrar.clients.empty ());
+}
+
+
+namespace {
+
+  /**
+   * @brief Provides BP runtime data on the loopback interface, with
+   *        a private metrics area and without opening the command
+   *        socket
+   */
+  class BPRegistrarTest : public ::testing::Test {
+  protected:
+    BPConfiguration                 cfg;
+    std::unique_ptr<BPRuntimeData>  runtime;
+    BPStaticClientInfo              sci;
+
+    BPRegistrarTest ()
+    {
+      cfg.bp_conf.interfaceName           = "lo";
+      cfg.cmdsock_conf.commandSocketFile  = std::format ("/tmp/dcp-bp-registrar-test-{}", getpid());
+      cfg.metrics_conf.shmAreaName        = std::format ("dcp-bp-registrar-test-metrics-{}", getpid());
+      runtime = std::make_unique<BPRuntimeData> (cfg);
+
+      sci.protocolId      = BP_PROTID_SRP;
+      std::strcpy (sci.protocolName, "in-process test");
+      sci.maxPayloadSize  = 100;
+      sci.queueingMode    = BP_QMODE_ONCE;
+    };
+  };
+
+};
+
+
+TEST_F (BPRegistrarTest, RegisterAndDeregister) {
+  BPRuntimeRegistrar  registrar (*runtime);
+  BPClientConfiguration  client_cfg;
+
+  {
+    BPClientRuntime rt (client_cfg, sci, false, &registrar);
+    ASSERT_TRUE (rt.isRegistered ());
+    ASSERT_TRUE (runtime->clientProtocols.contains (sci.protocolId));
+    EXPECT_TRUE (runtime->clientProtocols[sci.protocolId].is_local ());
+    EXPECT_EQ (rt.pSCS, runtime->clientProtocols[sci.protocolId].pSCS);
+    EXPECT_EQ (rt.get_own_node_identifier (), runtime->ownNodeIdentifier);
+
+    BPShmControlSegment*  pSCS = nullptr;
+    NodeIdentifierT       nodeId;
+    EXPECT_EQ (registrar.register_local_protocol (sci, false, pSCS, nodeId), BP_STATUS_PROTOCOL_ALREADY_REGISTERED);
+    EXPECT_EQ (pSCS, nullptr);
+  }
+
+  // the client runtime deregisters in its destructor
+  EXPECT_TRUE (runtime->clientProtocols.empty ());
+  EXPECT_EQ (registrar.deregister_local_protocol (sci.protocolId), BP_STATUS_UNKNOWN_PROTOCOL);
+}
+
+
+TEST_F (BPRegistrarTest, RejectsIllegalClientInfo) {
+  BPRuntimeRegistrar    registrar (*runtime);
+  BPShmControlSegment*  pSCS = nullptr;
+  NodeIdentifierT       nodeId;
+
+  BPStaticClientInfo bad = sci;
+  bad.maxPayloadSize = 0;
+  EXPECT_EQ (registrar.register_local_protocol (bad, false, pSCS, nodeId), BP_STATUS_ILLEGAL_MAX_PAYLOAD_SIZE);
+
+  bad = sci;
+  bad.maxPayloadSize = cfg.bp_conf.maxBeaconSize;
+  EXPECT_EQ (registrar.register_local_protocol (bad, false, pSCS, nodeId), BP_STATUS_ILLEGAL_MAX_PAYLOAD_SIZE);
+
+  bad = sci;
+  bad.queueingMode = BP_QMODE_QUEUE_DROPHEAD;
+  bad.maxEntries   = 0;
+  EXPECT_EQ (registrar.register_local_protocol (bad, false, pSCS, nodeId), BP_STATUS_ILLEGAL_DROPPING_QUEUE_SIZE);
+
+  EXPECT_TRUE (runtime->clientProtocols.empty ());
+  EXPECT_EQ (pSCS, nullptr);
+
+  // the same checks apply to client protocols registering through the command socket
+  EXPECT_EQ (add_client_protocol (*runtime, bad, false, nullptr), BP_STATUS_ILLEGAL_DROPPING_QUEUE_SIZE);
+  EXPECT_EQ (add_client_protocol (*runtime, sci, false, nullptr), BP_STATUS_OK);
+  EXPECT_EQ (remove_client_protocol (*runtime, sci.protocolId), BP_STATUS_OK);
+  EXPECT_EQ (remove_client_protocol (*runtime, sci.protocolId), BP_STATUS_UNKNOWN_PROTOCOL);
+}
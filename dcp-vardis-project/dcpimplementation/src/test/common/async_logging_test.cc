@@ -0,0 +1,286 @@
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/basic_sink_backend.hpp>
+#include <boost/log/utility/setup/common_attributes.hpp>
+#include <dcp/common/async_logging.h>
+#include <dcp/common/logging_helpers.h>
+
+namespace logging  = boost::log;
+namespace sinks    = boost::log::sinks;
+namespace keywords = boost::log::keywords;
+
+using dcp::byte;
+using dcp::LogRingBuffer;
+
+
+/**
+ * @brief Sink backend keeping all messages with their channel
+ */
+class CollectingBackend : public sinks::basic_sink_backend<sinks::synchronized_feeding> {
+public:
+  std::mutex                                         mutex;
+  std::vector<std::pair<std::string, std::string>>   messages;
+  std::vector<boost::posix_time::ptime>              timestamps;
+
+  void consume (const logging::record_view& rec)
+  {
+    std::lock_guard<std::mutex> lock (mutex);
+    messages.push_back ({ *logging::extract<std::string> ("Channel", rec),
+			  *logging::extract<std::string> ("Message", rec) });
+    timestamps.push_back (*logging::extract<boost::posix_time::ptime> ("TimeStamp", rec));
+  };
+};
+
+
+class AsyncLoggingTest : public ::testing::Test {
+protected:
+  boost::shared_ptr<CollectingBackend>                              backend;
+  boost::shared_ptr<sinks::synchronous_sink<CollectingBackend>>    sink;
+
+  void SetUp () override
+  {
+    logging::add_common_attributes ();
+    backend = boost::make_shared<CollectingBackend> ();
+    sink    = boost::make_shared<sinks::synchronous_sink<CollectingBackend>> (backend);
+    logging::core::get()->add_sink (sink);
+    dcp::minimumSeverityLevel = trivial::trace;
+  };
+
+  void TearDown () override
+  {
+    dcp::stop_async_logging ();
+    logging::core::get()->reset_filter ();
+    logging::core::get()->remove_sink (sink);
+  };
+};
+
+
+/**
+ * @brief Trivially copyable type with its own output operator,
+ *        captured in binary form
+ */
+typedef struct Point {
+  int x, y;
+} Point;
+
+std::ostream& operator<< (std::ostream& os, const Point& p)
+{
+  return os << "(" << p.x << "," << p.y << ")";
+}
+
+
+logger_type log_test_a (keywords::channel = "A");
+logger_type log_test_b (keywords::channel = "B");
+
+
+TEST (LogRingBufferTest, PushDrainWrapAndDrop) {
+  LogRingBuffer ring (dcp::minimumAsyncLogBufferSize);
+  std::vector<byte> rec (300);
+  uint64_t pushed = 0, drained = 0;
+
+  // many rounds with a record size not dividing the capacity, so the
+  // write position wraps around at all kinds of offsets
+  for (int round = 0; round < 100; round++)
+    {
+      while (true)
+	{
+	  for (auto& b : rec) b = (byte) (pushed & 0xFF);
+	  if (not ring.push (rec.data(), rec.size()))
+	    break;
+	  pushed++;
+	}
+      ring.drain ([&] (const byte* p, size_t len)
+      {
+	EXPECT_EQ (len, rec.size());
+	EXPECT_EQ (p[0], (byte) (drained & 0xFF));
+	EXPECT_EQ (p[len-1], (byte) (drained & 0xFF));
+	drained++;
+      });
+      EXPECT_TRUE (ring.is_empty ());
+    }
+  EXPECT_EQ (pushed, drained);
+  EXPECT_EQ (ring.get_number_dropped (), 100);
+}
+
+
+TEST_F (AsyncLoggingTest, SynchronousFormatting) {
+  std::string  s = "str";
+  Point        p {3, -4};
+  DCPLOG_INFO(log_test_a) << "int " << 42 << " double " << 2.5 << " " << s << " " << p << " " << 'c' << " " << (const char*) nullptr;
+
+  ASSERT_EQ (backend->messages.size(), 1);
+  EXPECT_EQ (backend->messages[0].first,  "A");
+  EXPECT_EQ (backend->messages[0].second, "int 42 double 2.5 str (3,-4) c (null)");
+}
+
+
+TEST_F (AsyncLoggingTest, PointersAreNotDereferencedLate) {
+  dcp::start_async_logging (dcp::minimumAsyncLogBufferSize, 1);
+  std::string  name = "node";
+  byte         nodeName [5] = {'n', 'o', 'd', 'e', 0};
+  Point        p {1, 2};
+  const void*  addr = &p;
+  DCPLOG_INFO(log_test_a) << (byte*) nodeName << " " << (signed char*) name.data() << " " << &p << " " << (byte*) nullptr;
+
+  // changed before the record gets formatted
+  name = "xxxx";
+  nodeName[0] = 'x';
+
+  std::ostringstream expected;
+  expected << "node node " << addr << " (null)";
+  dcp::stop_async_logging ();
+  ASSERT_EQ (backend->messages.size(), 1);
+  EXPECT_EQ (backend->messages[0].second, expected.str());
+}
+
+
+TEST_F (AsyncLoggingTest, DisabledLevelsSkipArguments) {
+  int evaluations = 0;
+  auto arg = [&] () { evaluations++; return 1; };
+
+  dcp::minimumSeverityLevel = trivial::warning;
+  DCPLOG_TRACE(log_test_a) << arg ();
+  DCPLOG_INFO(log_test_a) << arg ();
+  if (evaluations == 0)
+    DCPLOG_WARNING(log_test_a) << arg ();
+  else
+    DCPLOG_ERROR(log_test_a) << "wrong branch";
+
+  EXPECT_EQ (evaluations, 1);
+  ASSERT_EQ (backend->messages.size(), 1);
+  EXPECT_EQ (backend->messages[0].second, "1");
+}
+
+
+TEST_F (AsyncLoggingTest, LongRecordsAreTruncated) {
+  std::string long_string (2 * dcp::maxLogRecordSize, 'x');
+  DCPLOG_INFO(log_test_a) << long_string << 17;
+
+  ASSERT_EQ (backend->messages.size(), 1);
+  const std::string& msg = backend->messages[0].second;
+  EXPECT_LT (msg.size(), dcp::maxLogRecordSize);
+  EXPECT_EQ (msg.substr (msg.size() - 6), " [...]");
+}
+
+
+TEST_F (AsyncLoggingTest, AsynchronousFromManyThreads) {
+  const int numberThreads = 4;
+  const int numberRecords = 2000;
+
+  dcp::start_async_logging (64 * 1024, 5);
+  EXPECT_TRUE (dcp::async_logging_active ());
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < numberThreads; t++)
+    threads.emplace_back ([t] ()
+    {
+      for (int i = 0; i < numberRecords; i++)
+	{
+	  DCPLOG_INFO((t % 2) ? log_test_b : log_test_a) << t << " " << i;
+	  if ((i % 256) == 0)
+	    std::this_thread::sleep_for (std::chrono::milliseconds (1));
+	}
+    });
+  for (auto& th : threads)
+    th.join ();
+  dcp::stop_async_logging ();
+  EXPECT_FALSE (dcp::async_logging_active ());
+
+  // every record arrives on its channel, in order per thread, unless
+  // dropped (which is then reported)
+  std::map<int, int> next;
+  uint64_t received = 0;
+  for (auto& [chan, msg] : backend->messages)
+    {
+      if (chan == "LOG")
+	continue;
+      std::istringstream is (msg);
+      int t, i;
+      is >> t >> i;
+      EXPECT_EQ (chan, (t % 2) ? "B" : "A");
+      EXPECT_GT (i + 1, next[t]);
+      next[t] = i + 1;
+      received++;
+    }
+  EXPECT_EQ (received + dcp::get_async_logging_dropped (), (uint64_t) numberThreads * numberRecords);
+
+  // time stamps are those of the log statements, in local time like
+  // the ones of synchronous records
+  auto now = boost::posix_time::microsec_clock::local_time ();
+  for (auto& ts : backend->timestamps)
+    EXPECT_LT ((now - ts).total_seconds(), 10);
+
+  // after stopping, records are written immediately again
+  size_t before = backend->messages.size ();
+  DCPLOG_INFO(log_test_a) << "sync";
+  EXPECT_EQ (backend->messages.size (), before + 1);
+}
+
+
+TEST_F (AsyncLoggingTest, NoRecordsLostWhileStoppingAndStarting) {
+  const int numberThreads = 4;
+  const int numberRecords = 20000;
+
+  // producers keep logging while asynchronous logging is repeatedly
+  // stopped and started, so that some records are pushed after the
+  // final drain of stop()
+  std::atomic<bool> done (false);
+  dcp::start_async_logging (1024 * 1024, 1);
+  uint64_t droppedBefore = dcp::get_async_logging_dropped ();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < numberThreads; t++)
+    threads.emplace_back ([t] ()
+    {
+      for (int i = 0; i < numberRecords; i++)
+	DCPLOG_INFO(log_test_a) << t << " " << i;
+    });
+  std::thread toggler ([&done] ()
+  {
+    while (not done)
+      {
+	dcp::stop_async_logging ();
+	dcp::start_async_logging (1024 * 1024, 1);
+      }
+  });
+  for (auto& th : threads)
+    th.join ();
+  done = true;
+  toggler.join ();
+  dcp::stop_async_logging ();
+
+  uint64_t received = 0;
+  for (auto& [chan, msg] : backend->messages)
+    if (chan == "A")
+      received++;
+  EXPECT_EQ (received + dcp::get_async_logging_dropped () - droppedBefore, (uint64_t) numberThreads * numberRecords);
+}
+
+
+TEST_F (AsyncLoggingTest, DropsReportedThroughChannelFilter) {
+  // as in the demons, only the protocol's own channels pass
+  logging::core::get()->set_filter (logging::expressions::attr<std::string> ("Channel") == "A");
+
+  // the drain thread does not run before stopping, so the ring
+  // overflows
+  dcp::start_async_logging (dcp::minimumAsyncLogBufferSize, 60000, &log_test_a);
+  uint64_t droppedBefore = dcp::get_async_logging_dropped ();
+  std::string filler (200, 'x');
+  for (size_t i = 0; i < dcp::minimumAsyncLogBufferSize / filler.size(); i++)
+    DCPLOG_INFO(log_test_a) << filler;
+  EXPECT_GT (dcp::get_async_logging_dropped (), droppedBefore);
+  dcp::stop_async_logging ();
+
+  ASSERT_FALSE (backend->messages.empty ());
+  EXPECT_EQ (backend->messages.back().first, "A");
+  EXPECT_TRUE (backend->messages.back().second.starts_with ("asynchronous logging dropped"));
+}
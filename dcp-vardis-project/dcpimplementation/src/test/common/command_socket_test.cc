@@ -1,4 +1,10 @@
+extern "C" {
+#include <sys/socket.h>
+#include <unistd.h>
+}
 #include <cstdint>
+#include <thread>
+#include <vector>
 #include <gtest/gtest.h>
 #include <dcp/common/command_socket.h>
 #include <dcp/common/exceptions.h>
@@ -106,3 +112,108 @@ TEST (CmdSockTest, ClientServerTest) {
   
   EXPECT_EQ (reads, 60);
 }
+
+
+/**********************************************************************
+ * Tests pipelined requests over one connection, reuse of the
+ * persistent client connection, and that a client which never reads
+ * its responses or sends an incomplete request does not block the
+ * others.
+ *********************************************************************/
+
+using dcp::CommandFrameLengthT;
+
+void csclient_pipelined (int startval, int numvals)
+{
+  CommandSocket cs (testsocketname, 200);
+  int sock = cs.open_client ();
+
+  // send all requests at once, then read all responses
+  std::vector<byte> requests;
+  for (int i=0; i<numvals; i++)
+    {
+      CommandFrameLengthT len = sizeof(int);
+      int theval = startval + i;
+      requests.insert (requests.end(), (byte*) &len, (byte*) &len + sizeof(len));
+      requests.insert (requests.end(), (byte*) &theval, (byte*) &theval + sizeof(theval));
+    }
+  EXPECT_EQ (write (sock, requests.data(), requests.size()), (ssize_t) requests.size());
+
+  for (int i=0; i<numvals; i++)
+    {
+      CommandFrameLengthT len = 0;
+      TestServiceConfirm  conf;
+      EXPECT_EQ (recv (sock, &len, sizeof(len), MSG_WAITALL), (ssize_t) sizeof(len));
+      EXPECT_EQ (len, sizeof(TestServiceConfirm));
+      EXPECT_EQ (recv (sock, &conf, sizeof(conf), MSG_WAITALL), (ssize_t) sizeof(conf));
+      EXPECT_EQ (conf.theval, startval + i);
+    }
+  close (sock);
+}
+
+
+void csclient_persistent (int startval, int numvals)
+{
+  CommandSocket cs (testsocketname, 200);
+  byte buffer [100];
+  int  first_sock = -1;
+  
+  for (int i=0; i<numvals; i++)
+    {
+      ScopedClientSocket cl_sock (cs);
+      if (i == 0)
+	first_sock = cl_sock();
+      EXPECT_EQ (cl_sock(), first_sock);
+      int theval = startval + i;
+      int nbytes = cl_sock.sendRequestAndReadResponseBlock<int> (theval, buffer, 100);
+      EXPECT_EQ (nbytes, sizeof(TestServiceConfirm));
+      EXPECT_EQ (((TestServiceConfirm*) buffer)->theval, theval);
+    }
+}
+
+
+TEST (CmdSockTest, PipelinedAndStalledClientsTest) {
+  CommandSocket cs (testsocketname, 200);
+  cs.open_owner(log_null);
+
+  // a client that sends a request but never reads the response,
+  // and one that sends only part of a request
+  CommandSocket cs_stalled (testsocketname, 200);
+  int stalled_sock = cs_stalled.open_client ();
+  CommandFrameLengthT len = sizeof(int);
+  int theval = 1;
+  EXPECT_EQ (write (stalled_sock, &len, sizeof(len)), (ssize_t) sizeof(len));
+  EXPECT_EQ (write (stalled_sock, &theval, sizeof(theval)), (ssize_t) sizeof(theval));
+  int partial_sock = cs_stalled.open_client ();
+  EXPECT_EQ (write (partial_sock, &len, sizeof(len)), (ssize_t) sizeof(len));
+  
+  std::thread thr_client_one (csclient_pipelined, 100, 20);
+  std::thread thr_client_two (csclient_persistent, 200, 20);
+
+  int rbytes = -1;
+  int reads  = 0;
+  byte buffer [100];
+  do {
+    bool exitFlag = false;
+    DcpServiceType serv_t;
+    rbytes = cs.start_read_command (log_null, buffer, 100, serv_t, exitFlag);
+    EXPECT_FALSE (exitFlag);
+    if (rbytes == sizeof(int))
+      {
+	TestServiceConfirm conf;
+	conf.theval = *((int*) buffer);
+	conf.status_code = BP_STATUS_OK;
+	cs.send_raw_data (log_null, (byte*) &conf, sizeof(TestServiceConfirm), exitFlag);
+	cs.stop_read_command (log_null, exitFlag);
+	EXPECT_FALSE (exitFlag);
+	reads++;
+      }
+  } while (rbytes > 0);
+
+  thr_client_one.join ();
+  thr_client_two.join ();
+  close (stalled_sock);
+  close (partial_sock);
+  
+  EXPECT_EQ (reads, 41);
+}
@@ -0,0 +1,86 @@
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <gtest/gtest.h>
+#include <dcp/common/fixedmem_deadline_heap.h>
+
+using dcp::FixedMemDeadlineHeap;
+using dcp::DeadlineHeapException;
+
+
+const uint64_t heapSize   = 200;
+const uint64_t iterations = 20000;
+
+
+TEST (DeadlineHeapTest, randomOperationsMatchMap) {
+  std::mt19937 generator;
+  std::uniform_int_distribution<uint64_t> slot_distr (0, heapSize-1);
+  std::uniform_int_distribution<int> deadline_distr (0, 10000);
+  std::uniform_int_distribution<int> op_distr (0, 3);
+
+  auto heap = std::make_unique<FixedMemDeadlineHeap<int, heapSize>> ();
+  std::map<uint64_t, int> reference;
+
+  for (uint64_t i=0; i<iterations; i++)
+    {
+      uint64_t slot = slot_distr (generator);
+      if (op_distr (generator) < 3)
+	{
+	  int deadline = deadline_distr (generator);
+	  heap->update (slot, deadline);
+	  reference[slot] = deadline;
+	}
+      else
+	{
+	  heap->remove (slot);
+	  reference.erase (slot);
+	}
+      EXPECT_EQ (heap->size (), reference.size());
+      EXPECT_EQ (heap->contains (slot), reference.contains (slot));
+
+      if (reference.empty())
+	{
+	  EXPECT_TRUE (heap->is_empty ());
+	  EXPECT_THROW (heap->top_deadline (), DeadlineHeapException);
+	  continue;
+	}
+      
+      int earliest = reference.begin()->second;
+      for (const auto& [s, d] : reference)
+	earliest = std::min (earliest, d);
+      EXPECT_EQ (heap->top_deadline (), earliest);
+      EXPECT_EQ (reference[heap->top_slot ()], earliest);
+    }
+  EXPECT_TRUE (heap->is_consistent ());
+  EXPECT_THROW (heap->update (heapSize, 0), DeadlineHeapException);
+}
+
+
+TEST (DeadlineHeapTest, for_each_due_test) {
+  auto heap = std::make_unique<FixedMemDeadlineHeap<int, heapSize>> ();
+
+  for (uint64_t slot=0; slot<heapSize; slot++)
+    heap->update (slot, (int) ((slot * 37) % heapSize));
+  EXPECT_TRUE (heap->is_consistent ());
+
+  for (int cutoff : {-1, 0, 17, 99, 199, 500})
+    {
+      std::set<uint64_t> due;
+      uint64_t evaluations = 0;
+      heap->for_each_due ([&] (int deadline) { evaluations++; return deadline <= cutoff; },
+			  [&] (uint64_t slot) { EXPECT_TRUE (due.insert(slot).second); });
+      
+      uint64_t expected = 0;
+      for (uint64_t slot=0; slot<heapSize; slot++)
+	if (heap->get_deadline (slot) <= cutoff)
+	  {
+	    expected++;
+	    EXPECT_TRUE (due.contains (slot));
+	  }
+      EXPECT_EQ (due.size(), expected);
+
+      // only due entries and their children are looked at
+      EXPECT_LE (evaluations, 2*expected+1);
+    }
+}
@@ -0,0 +1,122 @@
+#include <chrono>
+#include <thread>
+#include <gtest/gtest.h>
+#include <dcp/common/event_loop.h>
+#include <dcp/common/exceptions.h>
+
+using dcp::EventLoop;
+using dcp::EventLoopException;
+using namespace std::chrono;
+
+
+static void run_for (EventLoop& loop, milliseconds duration)
+{
+  auto end = steady_clock::now() + duration;
+  while (steady_clock::now() < end)
+    loop.run_once (duration_cast<milliseconds>(end - steady_clock::now()).count() + 1);
+}
+
+
+TEST (EventLoopTest, PeriodicTimer) {
+  EventLoop loop;
+  int fast = 0, slow = 0;
+  loop.add_periodic_timer (10, [&] () { fast++; });
+  loop.add_periodic_timer (50, [&] () { slow++; });
+  run_for (loop, milliseconds (205));
+
+  // timer delays on a loaded machine only make the counts smaller
+  EXPECT_LE (fast, 20);
+  EXPECT_GE (fast, 5);
+  EXPECT_LE (slow, 4);
+  EXPECT_GE (slow, 1);
+
+  EXPECT_THROW (loop.add_periodic_timer (0, [] () {}), EventLoopException);
+}
+
+
+TEST (EventLoopTest, RearmingTimer) {
+  EventLoop loop;
+  std::vector<uint32_t> delays = {5, 20, 0};
+  size_t calls = 0;
+  auto start = steady_clock::now();
+  steady_clock::time_point last_call;
+  loop.add_timer (0, [&] ()
+  {
+    last_call = steady_clock::now();
+    return delays[calls++];
+  });
+  EXPECT_EQ (loop.size(), 1);
+  run_for (loop, milliseconds (100));
+
+  // returning zero removed the timer after the third call
+  EXPECT_EQ (calls, 3);
+  EXPECT_EQ (loop.size(), 0);
+  EXPECT_GE (last_call - start, milliseconds (25));
+}
+
+
+TEST (EventLoopTest, StopFromOtherThread) {
+  EventLoop loop;
+  int ticks = 0;
+  loop.add_periodic_timer (5, [&] () { ticks++; });
+
+  // stop() from another thread ends run() long before the exit
+  // flag check interval
+  std::thread stopper ([&] ()
+  {
+    std::this_thread::sleep_for (milliseconds (30));
+    loop.stop ();
+  });
+  bool exitFlag = false;
+  auto start = steady_clock::now();
+  loop.run (exitFlag, 1000);
+  stopper.join ();
+  EXPECT_LT (steady_clock::now() - start, milliseconds (1000));
+  EXPECT_GE (ticks, 1);
+}
+
+
+TEST (EventLoopTest, ReusedDescriptorWithinOneRound) {
+  EventLoop loop;
+  EventLoop::EventId ids [2];
+  int first = -1, stale_calls = 0;
+
+  // both timers expire in the same round, whichever handler runs
+  // first replaces the other timer by a new one, which gets the
+  // descriptor number just closed; the pending event of the old
+  // timer must not reach the new registration
+  for (int k = 0; k < 2; k++)
+    ids[k] = loop.add_timer (0, [&, k] ()
+    {
+      EXPECT_EQ (first, -1);
+      first = k;
+      loop.remove (ids[1-k]);
+      loop.add_timer (0, [&] () { stale_calls++; return 0; });
+      return 1000;
+    });
+  std::this_thread::sleep_for (milliseconds (5));
+
+  EXPECT_EQ (loop.run_once (100), 1);
+  EXPECT_NE (first, -1);
+  EXPECT_EQ (stale_calls, 0);
+  EXPECT_EQ (loop.size(), 2);
+}
+
+
+TEST (EventLoopTest, ExitFlagAndRemovalFromCallback) {
+  EventLoop loop;
+  bool exitFlag = false;
+  int ticks = 0, removed_ticks = 0;
+  EventLoop::EventId other = loop.add_periodic_timer (5, [&] () { removed_ticks++; });
+  loop.add_periodic_timer (5, [&] ()
+  {
+    // removing another entry (possibly ready in the same round) is allowed
+    loop.remove (other);
+    if (++ticks == 3)
+      exitFlag = true;
+  });
+  loop.run (exitFlag, 1000);
+  EXPECT_EQ (ticks, 3);
+  EXPECT_LE (removed_ticks, 1);
+  EXPECT_EQ (loop.size(), 1);
+}
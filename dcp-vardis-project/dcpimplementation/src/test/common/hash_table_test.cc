@@ -0,0 +1,84 @@
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <random>
+#include <gtest/gtest.h>
+#include <dcp/common/fixedmem_hash_table.h>
+#include <dcp/common/global_types_constants.h>
+
+using dcp::FixedMemHashTable;
+using dcp::HashTableException;
+using dcp::NodeIdentifierT;
+
+
+const uint64_t tableSize  = 300;
+const uint64_t iterations = 20000;
+
+
+TEST (HashTableTest, randomOperationsMatchMap) {
+  std::mt19937 generator;
+  std::uniform_int_distribution<int> key_distr (0, 400);
+  std::uniform_int_distribution<int> op_distr (0, 2);
+
+  auto table = std::make_unique<FixedMemHashTable<int, std::string, tableSize>> ();
+  std::map<int, std::string> reference;
+
+  for (uint64_t i=0; i<iterations; i++)
+    {
+      int key = key_distr (generator);
+      if (op_distr (generator) < 2)
+	{
+	  std::string str (std::format ("str-{}-{}", key, i));
+	  table->insert (key, str);
+	  if ((reference.size() < tableSize) or reference.contains (key))
+	    reference[key] = str;
+	}
+      else
+	{
+	  table->remove (key);
+	  reference.erase (key);
+	}
+      EXPECT_EQ (table->get_number_elements (), reference.size());
+      EXPECT_EQ (table->is_member (key), reference.contains (key));
+      if (reference.contains (key))
+	EXPECT_EQ (table->lookup_data_ref (key), reference[key]);
+      else
+	EXPECT_THROW (table->lookup_data_ref (key), HashTableException);
+    }
+  EXPECT_TRUE (table->is_consistent ());
+
+  uint64_t cnt = 0;
+  table->for_each ([&] (int key, const std::string& data)
+  {
+    cnt++;
+    EXPECT_EQ (reference[key], data);
+  });
+  EXPECT_EQ (cnt, reference.size());
+
+  table->clear ();
+  EXPECT_EQ (table->get_number_elements (), 0);
+  EXPECT_TRUE (table->is_consistent ());
+}
+
+
+TEST (HashTableTest, find_matching_data_test) {
+  auto table = std::make_unique<FixedMemHashTable<NodeIdentifierT, int, tableSize>> ();
+
+  for (int i=0; i<200; i++)
+    {
+      NodeIdentifierT nodeId;
+      nodeId.nodeId[4] = (dcp::byte) (i / 256);
+      nodeId.nodeId[5] = (dcp::byte) (i % 256);
+      table->insert (nodeId, i);
+    }
+  EXPECT_TRUE (table->is_consistent ());
+
+  std::function<bool (NodeIdentifierT, const int&)> pred = [] (NodeIdentifierT, const int& data) { return (data % 3) == 0; };
+  std::function<int (NodeIdentifierT, const int&)> transf = [] (NodeIdentifierT, const int& data) { return data; };
+  std::list<int> result;
+  table->find_matching_data<int> (pred, transf, result);
+  EXPECT_EQ (result.size(), 67);
+  for (int data : result)
+    EXPECT_EQ (data % 3, 0);
+}
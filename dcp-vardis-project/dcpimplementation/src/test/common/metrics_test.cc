@@ -0,0 +1,138 @@
+#include <format>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+extern "C" {
+#include <unistd.h>
+}
+#include <dcp/common/exceptions.h>
+#include <dcp/common/metrics.h>
+
+using dcp::HistogramSnapshot;
+using dcp::LatencyHistogram;
+using dcp::MetricsException;
+using dcp::MetricsReader;
+using dcp::MetricsRegistry;
+using dcp::SharedMemoryConfigurationBlock;
+
+
+TEST (MetricsTest, BucketBoundaries) {
+  // every value lies within its bucket, buckets are contiguous and
+  // the relative bucket width is at most 1/8
+  uint64_t expected_lower = 0;
+  for (size_t idx = 0; idx < HistogramSnapshot::numberBuckets; idx++)
+    {
+      uint64_t lower = HistogramSnapshot::bucket_lower (idx);
+      uint64_t upper = HistogramSnapshot::bucket_upper (idx);
+      EXPECT_EQ (lower, expected_lower);
+      EXPECT_LE (upper - lower, lower / 8);
+      EXPECT_EQ (HistogramSnapshot::bucket_index (lower), idx);
+      EXPECT_EQ (HistogramSnapshot::bucket_index (upper), idx);
+      expected_lower = upper + 1;
+    }
+  EXPECT_EQ (expected_lower, (uint64_t) 1 << HistogramSnapshot::maxExponent);
+  EXPECT_EQ (HistogramSnapshot::bucket_index (UINT64_MAX), HistogramSnapshot::numberBuckets - 1);
+}
+
+
+TEST (MetricsTest, HistogramStatistics) {
+  LatencyHistogram hist;
+  EXPECT_EQ (hist.snapshot().percentile (0.5), 0);
+
+  for (uint64_t v = 1; v <= 1000; v++)
+    hist.record (v * 1000);
+  HistogramSnapshot snap = hist.snapshot ();
+
+  EXPECT_EQ (snap.count, 1000);
+  EXPECT_EQ (snap.max, 1000000);
+  EXPECT_DOUBLE_EQ (snap.mean(), 500500.0);
+  for (double p : {0.5, 0.9, 0.99})
+    {
+      double exact = p * 1000000;
+      EXPECT_GE ((double) snap.percentile (p), exact);
+      EXPECT_LE ((double) snap.percentile (p), exact * 1.125 + 1);
+    }
+  EXPECT_EQ (snap.percentile (1.0), 1000000);
+  EXPECT_EQ (snap.percentile (0.0), snap.percentile (0.001));
+
+  hist.record (std::chrono::microseconds (2000));
+  EXPECT_EQ (hist.snapshot().max, 2000000);
+}
+
+
+TEST (MetricsTest, RegistryReturnsSameMetricForSameName) {
+  MetricsRegistry reg ("test");
+  auto& c1 = reg.counter ("c");
+  auto& c2 = reg.counter ("c");
+  EXPECT_EQ (&c1, &c2);
+  c1.inc (3);
+  EXPECT_EQ (c2.get(), 3);
+
+  EXPECT_THROW (reg.counter (""), MetricsException);
+  EXPECT_THROW (reg.counter (std::string (dcp::maxMetricNameLength + 1, 'x')), MetricsException);
+  for (size_t i = 1; i < dcp::maxMetricCounters; i++)
+    reg.counter (std::format ("c{}", i));
+  EXPECT_THROW (reg.counter ("one-too-many"), MetricsException);
+  EXPECT_EQ (reg.get_area().get_number_counters(), dcp::maxMetricCounters);
+}
+
+
+TEST (MetricsTest, SharedMemoryReader) {
+  SharedMemoryConfigurationBlock cfg ("metrics", std::format ("dcp-metrics-test-{}", getpid()));
+  MetricsRegistry reg ("Tester", cfg);
+  EXPECT_TRUE (reg.is_shared ());
+
+  reg.counter ("packets").inc (7);
+  reg.gauge ("queue").set (-2);
+  reg.histogram ("latency_ns").record (1500);
+
+  MetricsReader reader (cfg.shmAreaName);
+  const dcp::MetricsArea& area = reader.get_area ();
+  EXPECT_STREQ (area.owner, "Tester");
+  ASSERT_EQ (area.get_number_counters(), 1);
+  EXPECT_STREQ (area.counters[0].name, "packets");
+  EXPECT_EQ (area.counters[0].metric.get(), 7);
+  ASSERT_EQ (area.get_number_gauges(), 1);
+  EXPECT_EQ (area.gauges[0].metric.get(), -2);
+  ASSERT_EQ (area.get_number_histograms(), 1);
+  EXPECT_EQ (area.histograms[0].metric.snapshot().count, 1);
+
+  // updates after attaching are visible, later registrations as well
+  reg.counter ("packets").inc ();
+  reg.counter ("errors");
+  EXPECT_EQ (area.counters[0].metric.get(), 8);
+  EXPECT_EQ (area.get_number_counters(), 2);
+
+  EXPECT_THROW (MetricsReader ("dcp-metrics-test-does-not-exist"), MetricsException);
+}
+
+
+TEST (MetricsTest, ConcurrentUpdates) {
+  MetricsRegistry reg ("test");
+  auto& counter = reg.counter ("c");
+  auto& hist    = reg.histogram ("h");
+  const int numberThreads = 4;
+  const int numberUpdates = 20000;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < numberThreads; t++)
+    threads.emplace_back ([&, t] ()
+    {
+      for (int i = 0; i < numberUpdates; i++)
+	{
+	  counter.inc ();
+	  hist.record ((uint64_t) (t * numberUpdates + i));
+	}
+    });
+  for (auto& th : threads)
+    th.join ();
+
+  HistogramSnapshot snap = hist.snapshot ();
+  EXPECT_EQ (counter.get(), numberThreads * numberUpdates);
+  EXPECT_EQ (snap.count, numberThreads * numberUpdates);
+  EXPECT_EQ (snap.max, numberThreads * numberUpdates - 1);
+  uint64_t total = 0;
+  for (auto b : snap.buckets)
+    total += b;
+  EXPECT_EQ (total, snap.count);
+}
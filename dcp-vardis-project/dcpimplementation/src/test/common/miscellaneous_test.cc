@@ -1,6 +1,9 @@
+#include <chrono>
 #include <cstdint>
 #include <exception>
+#include <thread>
 #include <gtest/gtest.h>
+#include <dcp/common/global_types_constants.h>
 #include <dcp/common/memblock.h>
 #include <dcp/common/services_status.h>
 
@@ -87,6 +90,8 @@ TEST (CommonMiscTest, StatusCodeConversions) {
       case VARDIS_STATUS_VALUE_TOO_LONG:
       case VARDIS_STATUS_EMPTY_VALUE:
       case VARDIS_STATUS_ILLEGAL_REPCOUNT:
+      case VARDIS_STATUS_ILLEGAL_PRIORITY:
+      case VARDIS_STATUS_ILLEGAL_INTERVAL:
       case VARDIS_STATUS_VARIABLE_DOES_NOT_EXIST:
       case VARDIS_STATUS_NOT_PRODUCER:
       case VARDIS_STATUS_VARIABLE_IS_DELETED:
@@ -103,6 +108,14 @@ TEST (CommonMiscTest, StatusCodeConversions) {
 	}
 
       case SRP_STATUS_OK:
+      case SRP_STATUS_NO_FREE_SUBSCRIPTION:
+      case SRP_STATUS_ALREADY_SUBSCRIBED:
+      case SRP_STATUS_NOT_SUBSCRIBED:
+      case SRP_STATUS_ILLEGAL_DISTANCE:
+      case SRP_STATUS_ILLEGAL_HORIZON:
+      case SRP_STATUS_ILLEGAL_SAFETY_DATA:
+      case SRP_STATUS_ILLEGAL_POSITION:
+      case SRP_STATUS_SNAPSHOT_UNAVAILABLE:
       	{
 	  EXPECT_THROW (bp_status_to_string (i), std::exception);
 	  EXPECT_THROW (vardis_status_to_string (i), std::exception);
@@ -161,3 +174,31 @@ TEST (CommonMiscTest, MemBlock) {
 
   EXPECT_EQ (mb3, mb4);
 }
+
+
+
+TEST (CommonMiscTest, CoarseTimeStamps) {
+  using namespace std::chrono;
+  auto tick = CoarseClock::resolution ();
+  EXPECT_GT (tick.count(), 0);
+  EXPECT_LE (tick, milliseconds (10));
+
+  // a coarse reading never lies ahead of a later precise one, and
+  // lags behind an earlier one by about a tick (more when timer
+  // interrupts are delayed, so the bound is generous)
+  for (int i = 0; i < 1000; i++)
+    {
+      TimeStampT before = TimeStampT::get_current_system_time ();
+      TimeStampT coarse = TimeStampT::get_current_coarse_time ();
+      TimeStampT after  = TimeStampT::get_current_system_time ();
+      EXPECT_TRUE (after >= coarse);
+      EXPECT_LE (before.tStamp - coarse.tStamp, 25 * tick);
+    }
+
+  // ages between coarse readings are accurate to about one tick
+  TimeStampT start = TimeStampT::get_current_coarse_time ();
+  std::this_thread::sleep_for (milliseconds (50));
+  uint32_t age = TimeStampT::get_current_coarse_time().milliseconds_passed_since (start);
+  EXPECT_GE (age + duration_cast<milliseconds>(tick).count(), 50);
+  EXPECT_LT (age, 200);
+}
@@ -0,0 +1,122 @@
+#include <chrono>
+#include <format>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+extern "C" {
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+}
+#include <dcp/common/exceptions.h>
+#include <dcp/common/metrics.h>
+#include <dcp/common/realtime.h>
+#include <dcp/common/sharedmem_structure_base.h>
+
+using dcp::ConfigurationException;
+using dcp::LatencyHistogram;
+using dcp::RealtimeConfigurationBlock;
+using dcp::SchedulingException;
+using dcp::ShmStructureBase;
+using dcp::ThreadSchedulingParameters;
+
+
+TEST (RealtimeTest, ParseCpuList) {
+  EXPECT_EQ (dcp::parse_cpu_list (""), std::vector<int> ());
+  EXPECT_EQ (dcp::parse_cpu_list ("3"), std::vector<int> ({3}));
+  EXPECT_EQ (dcp::parse_cpu_list ("0,2-4, 7"), std::vector<int> ({0, 2, 3, 4, 7}));
+  for (auto bad : {"a", "1-", "3-1", "-1", "1,,2", "1-2-3", "1 x"})
+    EXPECT_THROW (dcp::parse_cpu_list (bad), ConfigurationException) << bad;
+}
+
+
+TEST (RealtimeTest, ConfigurationBlock) {
+  RealtimeConfigurationBlock cfg ("Realtime", {"transmitter", "receiver"});
+  po::options_description desc;
+  cfg.add_options (desc);
+  EXPECT_NE (desc.find_nothrow ("Realtime.transmitterPolicy", false), nullptr);
+  EXPECT_NE (desc.find_nothrow ("Realtime.receiverCpus", false), nullptr);
+  EXPECT_NE (desc.find_nothrow ("Realtime.lockMemory", false), nullptr);
+
+  // options are stored into the per-thread parameters
+  po::variables_map vm;
+  const char* argv[] = {"test", "--Realtime.transmitterPolicy=fifo", "--Realtime.transmitterPriority=40", "--Realtime.receiverCpus=0"};
+  po::store (po::parse_command_line (4, argv, desc), vm);
+  po::notify (vm);
+  EXPECT_EQ (cfg.get_thread_parameters("transmitter").policy, "fifo");
+  EXPECT_EQ (cfg.get_thread_parameters("transmitter").priority, 40);
+  EXPECT_EQ (cfg.get_thread_parameters("receiver").cpus, "0");
+  EXPECT_NO_THROW (cfg.validate ());
+  EXPECT_THROW (cfg.get_thread_parameters ("scrubber"), SchedulingException);
+
+  cfg.threads["transmitter"].priority = 0;
+  EXPECT_THROW (cfg.validate (), ConfigurationException);
+  cfg.threads["transmitter"] = ThreadSchedulingParameters ();
+  cfg.threads["transmitter"].policy = "deadline";
+  EXPECT_THROW (cfg.validate (), ConfigurationException);
+  cfg.threads["transmitter"] = ThreadSchedulingParameters ();
+  cfg.threads["transmitter"].nice = 20;
+  EXPECT_THROW (cfg.validate (), ConfigurationException);
+  cfg.threads["transmitter"] = ThreadSchedulingParameters ();
+  cfg.threads["transmitter"].cpus = "1-x";
+  EXPECT_THROW (cfg.validate (), ConfigurationException);
+}
+
+
+TEST (RealtimeTest, ThreadScheduling) {
+  // runs in a separate thread so that the test process is unaffected
+  std::thread th ([] ()
+  {
+    int cpu = sched_getcpu ();
+    ThreadSchedulingParameters params;
+    params.policy = "other";
+    params.nice   = 5;
+    params.cpus = std::to_string (cpu);
+    EXPECT_NO_THROW (dcp::set_thread_scheduling (params));
+    EXPECT_EQ (dcp::describe_thread_scheduling (), std::format ("SCHED_OTHER nice 5, cpus {}", cpu));
+
+    // lowering the nice value again needs privileges, a real-time
+    // policy as well; both must either work or throw
+    params.policy   = "fifo";
+    params.priority = 10;
+    try {
+      dcp::set_thread_scheduling (params);
+      EXPECT_TRUE (dcp::describe_thread_scheduling().starts_with ("SCHED_FIFO priority 10"));
+    }
+    catch (SchedulingException&) {}
+  });
+  th.join ();
+}
+
+
+TEST (RealtimeTest, DefaultsInheritScheduling) {
+  std::thread th ([] ()
+  {
+    ASSERT_EQ (setpriority (PRIO_PROCESS, gettid (), 3), 0);
+    std::string before = dcp::describe_thread_scheduling ();
+    EXPECT_NO_THROW (dcp::set_thread_scheduling (ThreadSchedulingParameters ()));
+    EXPECT_EQ (dcp::describe_thread_scheduling (), before);
+  });
+  th.join ();
+}
+
+
+TEST (RealtimeTest, WakeupLatency) {
+  LatencyHistogram hist;
+  auto start = std::chrono::steady_clock::now ();
+  for (int i = 0; i < 5; i++)
+    dcp::sleep_for_measured (std::chrono::milliseconds (2), hist);
+  auto elapsed = std::chrono::steady_clock::now () - start;
+  auto snap = hist.snapshot ();
+  EXPECT_EQ (snap.count, 5);
+  EXPECT_GE (elapsed, std::chrono::milliseconds (10));
+  EXPECT_LE (std::chrono::nanoseconds (snap.sum), elapsed - std::chrono::milliseconds (10));
+}
+
+
+TEST (RealtimeTest, PrefaultSharedMemory) {
+  size_t before = dcp::prefault_shared_memory ();
+  std::string name = std::format ("dcp-realtime-test-{}", getpid());
+  ShmStructureBase area (name.c_str(), 1 << 20, true);
+  EXPECT_GE (dcp::prefault_shared_memory (), before + (1 << 20));
+}
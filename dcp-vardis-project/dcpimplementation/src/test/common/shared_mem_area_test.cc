@@ -227,6 +227,30 @@ public:
 	}
       
   };
+
+
+  void consumer_thread_batched (size_t batch_size)
+  {
+      int read_counter = 0;
+
+      while (read_counter < number_values)
+	{
+	  size_t number_popped;
+	  bool   timed_out;
+	  bool   further_entries;
+	  PopHandler handler = [&] (byte* memaddr, size_t len)
+	  {
+	    EXPECT_EQ (len, sizeof(int));
+	    EXPECT_EQ (* ((int*) memaddr), read_counter++);
+	  };
+
+	  rbQueue.popmany_wait (handler, batch_size, number_popped, timed_out, further_entries, 1000);
+	  EXPECT_FALSE(timed_out);
+	  EXPECT_GE(number_popped, 1);
+	  EXPECT_LE(number_popped, batch_size);
+	}
+      EXPECT_EQ(read_counter, number_values);
+  };
   
 };
 
@@ -287,3 +311,48 @@ TEST (ShmTest, ShmRingBufferTest_ConcurrentCircular1Nowait) {
 }
 
 
+TEST (ShmTest, ShmRingBufferTest_ConcurrentCircular20Batched) {
+
+  auto shmAreaPtr            = std::make_shared<ShmStructureBase> (shm_area_name, sizeof(TestControlSegment<20>), true);
+  auto shmAreaPtrProducer    = std::make_shared<ShmStructureBase> (shm_area_name, 0, false);
+  new (shmAreaPtr->get_memory_address()) TestControlSegment<20>;
+  TestControlSegment<20>* pCSCons = ((TestControlSegment<20>*) shmAreaPtr->get_memory_address());
+  TestControlSegment<20>* pCSProd = ((TestControlSegment<20>*) shmAreaPtrProducer->get_memory_address());
+
+  std::thread thread_prod ([&] () {pCSProd->producer_thread(); });
+  std::thread thread_cons ([&] () {pCSCons->consumer_thread_batched (8);});
+  
+  thread_prod.join();
+  thread_cons.join();  
+}
+
+
+TEST (ShmTest, ShmHugePagesAndAlignment) {
+
+  auto shmAreaPtr            = std::make_shared<ShmStructureBase> (shm_area_name, sizeof(TestControlSegment<20>), true, true);
+  auto shmAreaPtrProducer    = std::make_shared<ShmStructureBase> (shm_area_name, 0, false);
+
+  // both sides see a whole number of huge pages, whether or not the
+  // kernel actually grants them, and the attaching side follows the
+  // creator's advice
+  EXPECT_EQ ((shmAreaPtr->get_structure_size() + dcp::shmSegmentHeaderSize) % dcp::hugePageSize, 0);
+  EXPECT_GE (shmAreaPtr->get_structure_size(), sizeof(TestControlSegment<20>));
+  EXPECT_EQ (shmAreaPtrProducer->get_structure_size(), shmAreaPtr->get_structure_size());
+  EXPECT_EQ (shmAreaPtrProducer->get_thp_advised(), shmAreaPtr->get_thp_advised());
+  EXPECT_EQ (((uintptr_t) shmAreaPtr->get_memory_address()) % dcp::cacheLineSize, 0);
+  shmAreaPtrProducer.reset ();
+  shmAreaPtr.reset ();
+
+  // a segment that merely happens to be a whole number of huge pages
+  // is not advised by an attaching process
+  shmAreaPtr          = std::make_shared<ShmStructureBase> (shm_area_name, dcp::hugePageSize - dcp::shmSegmentHeaderSize, true);
+  shmAreaPtrProducer  = std::make_shared<ShmStructureBase> (shm_area_name, 0, false);
+  EXPECT_FALSE (shmAreaPtr->get_thp_advised());
+  EXPECT_FALSE (shmAreaPtrProducer->get_thp_advised());
+
+  dcp::byte buffer [2*dcp::cacheLineSize];
+  dcp::byte* aligned = dcp::align_address (buffer + 1, dcp::cacheLineSize);
+  EXPECT_EQ (((uintptr_t) aligned) % dcp::cacheLineSize, 0);
+  EXPECT_LT (aligned - (buffer + 1), (ptrdiff_t) dcp::cacheLineSize);
+  EXPECT_EQ (dcp::align_address (aligned, dcp::cacheLineSize), aligned);
+}
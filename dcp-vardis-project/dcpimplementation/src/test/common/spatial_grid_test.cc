@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include <dcp/common/fixedmem_spatial_grid.h>
+
+using dcp::FixedMemSpatialGrid;
+using dcp::SpatialGridException;
+
+const uint64_t gridEntries = 200;
+const uint64_t gridBuckets = 64;
+const uint64_t iterations  = 200;
+
+typedef FixedMemSpatialGrid<gridEntries, gridBuckets> TestGrid;
+
+struct Pos { bool used = false; double x = 0, y = 0, z = 0; };
+
+
+double dist2 (const Pos& p, double x, double y, double z)
+{
+  return (p.x-x)*(p.x-x) + (p.y-y)*(p.y-y) + (p.z-z)*(p.z-z);
+}
+
+
+TEST (SpatialGridTest, constructionAndMembership) {
+  EXPECT_THROW (TestGrid (0), SpatialGridException);
+  EXPECT_THROW (TestGrid (-1), SpatialGridException);
+
+  TestGrid grid (10);
+  EXPECT_EQ (grid.size(), 0);
+  grid.update (3, 1, 2, 3);
+  grid.update (3, 100, 2, 3);
+  EXPECT_TRUE (grid.contains (3));
+  EXPECT_EQ (grid.size(), 1);
+  grid.remove (3);
+  grid.remove (3);
+  EXPECT_FALSE (grid.contains (3));
+  EXPECT_EQ (grid.size(), 0);
+  EXPECT_THROW (grid.update (gridEntries, 0, 0, 0), SpatialGridException);
+}
+
+
+TEST (SpatialGridTest, queriesMatchBruteForce) {
+  std::mt19937 generator;
+  std::uniform_real_distribution<double> coord (-500, 500);
+  std::uniform_real_distribution<double> radius (0, 300);
+  std::uniform_int_distribution<uint64_t> slot (0, gridEntries-1);
+
+  TestGrid grid (25);
+  std::vector<Pos> positions (gridEntries);
+
+  for (uint64_t i=0; i<iterations; i++)
+    {
+      // random moves, insertions and removals
+      for (int j=0; j<20; j++)
+	{
+	  uint64_t s = slot (generator);
+	  if ((j % 5) == 0)
+	    {
+	      grid.remove (s);
+	      positions[s].used = false;
+	    }
+	  else
+	    {
+	      positions[s] = Pos {true, coord(generator), coord(generator), coord(generator) / 10};
+	      grid.update (s, positions[s].x, positions[s].y, positions[s].z);
+	    }
+	}
+
+      double qx = coord (generator), qy = coord (generator), qz = 0;
+
+      // radius query
+      double r = radius (generator);
+      std::vector<uint64_t> expected, actual;
+      for (uint64_t s=0; s<gridEntries; s++)
+	if (positions[s].used and dist2 (positions[s], qx, qy, qz) <= r*r)
+	  expected.push_back (s);
+      grid.for_each_within (qx, qy, qz, r, [&] (uint64_t s, double) { actual.push_back (s); });
+      std::sort (actual.begin(), actual.end());
+      EXPECT_EQ (actual, expected);
+
+      // k nearest neighbours, compared by distance to be robust
+      // against ties
+      std::vector<double> all_d2;
+      for (uint64_t s=0; s<gridEntries; s++)
+	if (positions[s].used)
+	  all_d2.push_back (dist2 (positions[s], qx, qy, qz));
+      std::sort (all_d2.begin(), all_d2.end());
+
+      const uint64_t k = 7;
+      uint64_t slots [k];
+      double   d2 [k];
+      uint64_t found = grid.nearest (qx, qy, qz, k, slots, d2);
+      EXPECT_EQ (found, std::min (k, (uint64_t) all_d2.size()));
+      for (uint64_t j=0; j<found; j++)
+	{
+	  EXPECT_TRUE (grid.contains (slots[j]));
+	  EXPECT_DOUBLE_EQ (d2[j], all_d2[j]);
+	}
+    }
+}
+
+
+TEST (SpatialGridTest, extremeQueryParameters) {
+  TestGrid grid (10);
+  grid.update (0, 0, 0, 0);
+  grid.update (1, 450, -300, 20);
+  grid.update (2, -1e6, 1e6, 0);
+
+  auto count_within = [&] (double x, double y, double z, double radius)
+  {
+    uint64_t n = 0;
+    grid.for_each_within (x, y, z, radius, [&] (uint64_t, double) { n++; });
+    return n;
+  };
+
+  // huge and infinite radii report all entries
+  EXPECT_EQ (count_within (0, 0, 0, 1e19), 3);
+  EXPECT_EQ (count_within (0, 0, 0, 1e300), 3);
+  EXPECT_EQ (count_within (5, 5, 5, std::numeric_limits<double>::infinity()), 3);
+
+  // illegal radii and positions report nothing
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  EXPECT_EQ (count_within (0, 0, 0, -1), 0);
+  EXPECT_EQ (count_within (0, 0, 0, nan), 0);
+  EXPECT_EQ (count_within (nan, 0, 0, 100), 0);
+  EXPECT_EQ (count_within (0, std::numeric_limits<double>::infinity(), 0, 100), 0);
+
+  // positions far outside the representable cell range
+  EXPECT_EQ (count_within (1e300, -1e300, 0, 1), 0);
+  grid.update (3, 1e300, -1e300, 0);
+  EXPECT_EQ (count_within (1e300, -1e300, 0, 1), 1);
+  EXPECT_EQ (grid.size(), 4);
+
+  uint64_t slots [4];
+  double   distances2 [4];
+  EXPECT_EQ (grid.nearest (0, 0, 0, 4, slots, distances2), 4);
+  EXPECT_EQ (slots[0], 0);
+  EXPECT_EQ (slots[3], 3);
+}
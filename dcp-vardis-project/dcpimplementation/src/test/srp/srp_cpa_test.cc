@@ -0,0 +1,123 @@
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <random>
+#include <gtest/gtest.h>
+#include "srp_store_test_helpers.h"
+
+namespace dcp::srp {
+
+  class SRPCPATest : public SRPStoreTest {};
+
+  
+  // ------------------------------------------------------------
+  
+  TEST_F(SRPCPATest, KernelMatchesScalarReference) {
+    std::mt19937 generator;
+    std::uniform_real_distribution<double> pos (-1000, 1000);
+    std::uniform_real_distribution<double> spd (0, 30);
+    std::uniform_real_distribution<double> hdg (0, 360);
+
+    TimeStampT now = TimeStampT::get_current_system_time ();
+    auto kin = std::make_unique<CPAKinematics<testSlots>> ();
+    SafetyDataT own = make_esd (0, 0, 0, 0, 0, 10, 45, now).safetyData;
+
+    for (uint64_t i = 0; i < testSlots; i += 2)
+      kin->update (i, make_esd (i, 0, pos(generator), pos(generator), pos(generator) / 10, spd(generator), hdg(generator), now));
+
+    double tcpa [testSlots], d2cpa [testSlots];
+    kin->compute (own, timestamp_to_seconds (now), 60, tcpa, d2cpa);
+
+    for (uint64_t i = 0; i < testSlots; i++)
+      {
+	if (i % 2)
+	  {
+	    EXPECT_TRUE (std::isinf (d2cpa[i]));
+	    continue;
+	  }
+	// sample the trajectories to find the closest approach
+	double best_d2 = INFINITY;
+	for (int step = 0; step <= 60000; step++)
+	  {
+	    double t = step / 1000.0;
+	    SafetyDataT a = own.extrapolated (t);
+	    SafetyDataT b = own;
+	    b.position_x = kin->x[i] + kin->vx[i] * t;
+	    b.position_y = kin->y[i] + kin->vy[i] * t;
+	    b.position_z = kin->z[i];
+	    best_d2 = std::min (best_d2, std::pow (a.distance_to (b), 2));
+	  }
+	EXPECT_GE (tcpa[i], 0);
+	EXPECT_LE (tcpa[i], 60);
+	EXPECT_NEAR (std::sqrt (d2cpa[i]), std::sqrt (best_d2), 0.05);
+      }
+  }
+
+  
+  // ------------------------------------------------------------
+  
+  TEST_F(SRPCPATest, StoreReturnsTopThreats) {
+    TimeStampT now = TimeStampT::get_current_system_time ();
+    SafetyDataT own = make_esd (0, 0, 0, 0, 0, 0, 0, now).safetyData;
+
+    // head-on collision course: passes at 0 m after 10 s
+    store.insert_esd_entry (make_esd (1, 0, 0, 100, 0, 10, 180, now));
+    // passes at 20 m distance after 10 s
+    store.insert_esd_entry (make_esd (2, 0, 20, 100, 0, 10, 180, now));
+    // close but moving away: closest now, at 30 m
+    store.insert_esd_entry (make_esd (3, 0, -30, 0, 0, 5, 270, now));
+    // far and stationary
+    store.insert_esd_entry (make_esd (4, 0, 500, 500, 0, 0, 0, now));
+
+    CPAThreat threats [4];
+    size_t found = store.find_closest_approach_threats (own, now, 60, 100, 4, threats);
+    ASSERT_EQ (found, 3);
+    EXPECT_EQ (threats[0].node.esd.nodeId, test_node_id (1));
+    EXPECT_NEAR (threats[0].distance_at_cpa, 0, 1e-6);
+    EXPECT_NEAR (threats[0].time_to_cpa, 10, 1e-6);
+    EXPECT_EQ (threats[1].node.esd.nodeId, test_node_id (2));
+    EXPECT_NEAR (threats[1].distance_at_cpa, 20, 1e-6);
+    EXPECT_EQ (threats[2].node.esd.nodeId, test_node_id (3));
+    EXPECT_NEAR (threats[2].time_to_cpa, 0, 1e-6);
+
+    // a short horizon makes the approaching nodes less threatening
+    found = store.find_closest_approach_threats (own, now, 5, 1000, 1, threats);
+    ASSERT_EQ (found, 1);
+    EXPECT_EQ (threats[0].node.esd.nodeId, test_node_id (3));
+
+    // removed neighbours are no longer considered
+    store.remove_esd_entry (threats[0].node.esd.nodeId);
+    found = store.find_closest_approach_threats (own, now, 60, 100, 4, threats);
+    EXPECT_EQ (found, 2);
+
+    // a distance whose square overflows returns all neighbours, but no unused slots
+    found = store.find_closest_approach_threats (own, now, 60, std::numeric_limits<double>::max(), 4, threats);
+    EXPECT_EQ (found, 3);
+  }
+
+  
+  // ------------------------------------------------------------
+  
+  TEST_F(SRPCPATest, RejectsIllegalDistance) {
+    TimeStampT now = TimeStampT::get_current_system_time ();
+    SafetyDataT own = make_esd (0, 0, 0, 0, 0, 0, 0, now).safetyData;
+    CPAThreat threats [4];
+    EXPECT_THROW (store.find_closest_approach_threats (own, now, 60, -1, 4, threats), SRPStoreException);
+    EXPECT_THROW (store.find_closest_approach_threats (own, now, 60, NAN, 4, threats), SRPStoreException);
+    EXPECT_THROW (store.find_closest_approach_threats (own, now, 60, INFINITY, 4, threats), SRPStoreException);
+  }
+
+  // ------------------------------------------------------------
+  
+  TEST_F(SRPCPATest, RejectsIllegalHorizon) {
+    TimeStampT now = TimeStampT::get_current_system_time ();
+    SafetyDataT own = make_esd (0, 0, 0, 0, 0, 0, 0, now).safetyData;
+    CPAThreat threats [4];
+    EXPECT_THROW (store.find_closest_approach_threats (own, now, -1, 100, 4, threats), SRPStoreException);
+    EXPECT_THROW (store.find_closest_approach_threats (own, now, NAN, 100, 4, threats), SRPStoreException);
+    EXPECT_THROW (store.find_closest_approach_threats (own, now, INFINITY, 100, 4, threats), SRPStoreException);
+    EXPECT_NO_THROW (store.find_closest_approach_threats (own, now, 0, 100, 4, threats));
+  }
+
+};  // namespace dcp::srp
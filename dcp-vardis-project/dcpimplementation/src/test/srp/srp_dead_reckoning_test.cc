@@ -0,0 +1,70 @@
+#include <chrono>
+#include <gtest/gtest.h>
+#include <dcp/srp/srp_transmitter.h>
+
+namespace dcp::srp {
+
+  TimeStampT at_ms (const TimeStampT& base, int ms)
+  {
+    TimeStampT ts = base;
+    ts.tStamp += std::chrono::milliseconds (ms);
+    return ts;
+  }
+
+  
+  // ------------------------------------------------------------
+  
+  TEST(SRPDeadReckoningTest, Extrapolation) {
+    SafetyDataT sd;
+    sd.position_x = 10;
+    sd.position_y = 20;
+    sd.position_z = 30;
+
+    SafetyDataT still = sd.extrapolated (5.0);
+    EXPECT_DOUBLE_EQ (still.distance_to (sd), 0);
+
+    sd.has_velocity = true;
+    sd.speed        = 2;
+    sd.heading      = 90;
+    SafetyDataT moved = sd.extrapolated (5.0);
+    EXPECT_NEAR (moved.position_x, 20, 1e-9);
+    EXPECT_NEAR (moved.position_y, 20, 1e-9);
+    EXPECT_NEAR (moved.position_z, 30, 1e-9);
+    EXPECT_NEAR (moved.distance_to (sd), 10, 1e-9);
+  }
+
+  
+  // ------------------------------------------------------------
+  
+  TEST(SRPDeadReckoningTest, Suppression) {
+    DeadReckoningFilter filter (1.0, 1000);
+    TimeStampT t0 = TimeStampT::get_current_system_time ();
+
+    SafetyDataT sd;
+    sd.position_x   = 0;
+    sd.position_y   = 0;
+    sd.position_z   = 0;
+    sd.has_velocity = true;
+    sd.speed        = 10;
+    sd.heading      = 0;
+
+    // first record is always transmitted
+    EXPECT_TRUE (filter.transmission_needed (sd, t0, t0));
+    filter.record_transmission (sd, t0, t0);
+
+    // moving as predicted: suppressed
+    SafetyDataT sd2 = sd;
+    sd2.position_y = 5;
+    EXPECT_FALSE (filter.transmission_needed (sd2, at_ms (t0, 500), at_ms (t0, 500)));
+
+    // deviating from prediction: transmitted
+    sd2.position_x = 2;
+    EXPECT_TRUE (filter.transmission_needed (sd2, at_ms (t0, 500), at_ms (t0, 500)));
+
+    // maximum interval elapsed: transmitted even if predicted well
+    sd2.position_x = 0;
+    sd2.position_y = 10;
+    EXPECT_TRUE (filter.transmission_needed (sd2, at_ms (t0, 1000), at_ms (t0, 1000)));
+  }
+
+};  // namespace dcp::srp
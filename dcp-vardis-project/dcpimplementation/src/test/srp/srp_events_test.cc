@@ -0,0 +1,153 @@
+#include <vector>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include "srp_store_test_helpers.h"
+
+namespace dcp::srp {
+
+  class SRPEventsTest : public SRPStoreTest {
+  protected:
+    std::vector<NeighbourEvent>  events;
+    
+    SRPEventsTest ()
+      : events (TestSRPStore::get_event_queue_length ())
+    {};
+
+    size_t retrieve (uint32_t subscription_id)
+    {
+      bool more_events;
+      return store.retrieve_neighbour_events (subscription_id, events.data(), events.size(), more_events, 0);
+    };
+  };
+
+  
+  // ------------------------------------------------------------
+  
+  TEST_F(SRPEventsTest, AddUpdateExpire) {
+    uint32_t sub;
+    ASSERT_TRUE (store.subscribe_neighbour_events (NeighbourEventFilter {0, 5}, sub));
+    EXPECT_EQ (retrieve (sub), 0);
+
+    store.insert_esd_entry (make_esd (1, 1, 0));
+    store.insert_esd_entry (make_esd (1, 2, 3));    // below minimum delta
+    store.insert_esd_entry (make_esd (1, 3, 6));
+    store.remove_esd_entry (test_node_id (1));
+
+    ASSERT_EQ (retrieve (sub), 3);
+    EXPECT_EQ (events[0].type, netNeighbourAdded);
+    EXPECT_EQ (events[1].type, netNeighbourUpdated);
+    EXPECT_EQ (events[1].esd.seqno, 3);
+    EXPECT_EQ (events[2].type, netNeighbourExpired);
+    EXPECT_EQ (events[2].esd.nodeId, test_node_id (1));
+    EXPECT_EQ (retrieve (sub), 0);
+  }
+
+  
+  // ------------------------------------------------------------
+  
+  TEST_F(SRPEventsTest, DistanceThreshold) {
+    uint32_t sub_near, sub_all;
+    ASSERT_TRUE (store.subscribe_neighbour_events (NeighbourEventFilter {100, 0}, sub_near));
+    ASSERT_TRUE (store.subscribe_neighbour_events (NeighbourEventFilter {}, sub_all));
+    EXPECT_NE (sub_near, sub_all);
+
+    SafetyDataT own;
+    own.position_x = own.position_y = own.position_z = 0;
+    store.set_event_reference_position (own);
+
+    store.insert_esd_entry (make_esd (1, 1, 50));
+    store.insert_esd_entry (make_esd (2, 1, 500));
+    store.insert_esd_entry (make_esd (1, 2, 150));  // leaves range
+    store.remove_esd_entry (test_node_id (1));
+
+    ASSERT_EQ (retrieve (sub_near), 2);
+    EXPECT_EQ (events[0].type, netNeighbourAdded);
+    EXPECT_EQ (events[1].type, netNeighbourOutOfRange);
+
+    ASSERT_EQ (retrieve (sub_all), 4);
+    EXPECT_EQ (events[0].type, netNeighbourAdded);
+    EXPECT_EQ (events[1].type, netNeighbourAdded);
+    EXPECT_EQ (events[2].type, netNeighbourUpdated);
+    EXPECT_EQ (events[3].type, netNeighbourExpired);
+  }
+
+  
+  // ------------------------------------------------------------
+  
+  TEST_F(SRPEventsTest, OverflowAndSubscriptionLimit) {
+    uint32_t sub;
+    ASSERT_TRUE (store.subscribe_neighbour_events (NeighbourEventFilter {}, sub));
+
+    uint64_t n = TestSRPStore::get_event_queue_length () + 10;
+    for (uint32_t seqno = 0; seqno < n; seqno++)
+      store.insert_esd_entry (make_esd (1, seqno, seqno));
+    EXPECT_EQ (store.get_number_dropped_neighbour_events (sub), 10);
+    EXPECT_EQ (retrieve (sub), TestSRPStore::get_event_queue_length ());
+
+    uint32_t other;
+    for (uint64_t i = 1; i < TestSRPStore::get_max_event_subscriptions (); i++)
+      EXPECT_TRUE (store.subscribe_neighbour_events (NeighbourEventFilter {}, other));
+    EXPECT_FALSE (store.subscribe_neighbour_events (NeighbourEventFilter {}, other));
+
+    store.unsubscribe_neighbour_events (sub);
+    EXPECT_THROW (retrieve (sub), SRPStoreException);
+    EXPECT_TRUE (store.subscribe_neighbour_events (NeighbourEventFilter {}, other));
+    EXPECT_EQ (other, sub);
+    EXPECT_EQ (retrieve (other), 0);
+  }
+
+  
+  // ------------------------------------------------------------
+  
+  TEST_F(SRPEventsTest, ExpiryKeptPendingWhenQueueFull) {
+    uint32_t sub;
+    ASSERT_TRUE (store.subscribe_neighbour_events (NeighbourEventFilter {}, sub));
+
+    uint64_t n = TestSRPStore::get_event_queue_length ();
+    for (uint32_t seqno = 0; seqno < n; seqno++)
+      store.insert_esd_entry (make_esd (1, seqno, seqno));
+    store.remove_esd_entry (test_node_id (1));
+    EXPECT_EQ (store.get_number_dropped_neighbour_events (sub), 0);
+    EXPECT_EQ (retrieve (sub), n);
+
+    // the next event of the subscription queues the pending expiry first
+    store.insert_esd_entry (make_esd (2, 0, 0));
+    ASSERT_EQ (retrieve (sub), 2);
+    EXPECT_EQ (events[0].type, netNeighbourExpired);
+    EXPECT_EQ (events[0].esd.nodeId, test_node_id (1));
+    EXPECT_EQ (events[1].type, netNeighbourAdded);
+    EXPECT_EQ (events[1].esd.nodeId, test_node_id (2));
+    EXPECT_EQ (store.get_number_dropped_neighbour_events (sub), 0);
+  }
+
+  
+  // ------------------------------------------------------------
+  
+  TEST(SRPEventsSharedTest, ReclaimsSubscriptionsOfExitedClients) {
+    size_t size   = TestSRPStore::get_fixedmem_contents_size ();
+    void*  memory = mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    ASSERT_NE (memory, MAP_FAILED);
+    TestSRPStore store;
+    store.initialize_srp_store ((byte*) memory, nullNodeIdentifier, 0.95, 50);
+
+    uint32_t sub;
+    for (uint64_t i = 1; i < TestSRPStore::get_max_event_subscriptions (); i++)
+      ASSERT_TRUE (store.subscribe_neighbour_events (NeighbourEventFilter {}, sub));
+
+    // a child process takes the last subscription and exits without unsubscribing
+    pid_t child = fork ();
+    ASSERT_GE (child, 0);
+    if (child == 0)
+      _exit (store.subscribe_neighbour_events (NeighbourEventFilter {}, sub) ? 0 : 1);
+    int status;
+    ASSERT_EQ (waitpid (child, &status, 0), child);
+    ASSERT_TRUE (WIFEXITED (status) and (WEXITSTATUS (status) == 0));
+
+    EXPECT_TRUE (store.subscribe_neighbour_events (NeighbourEventFilter {}, sub));
+    EXPECT_FALSE (store.subscribe_neighbour_events (NeighbourEventFilter {}, sub));
+    munmap (memory, size);
+  }
+
+};  // namespace dcp::srp
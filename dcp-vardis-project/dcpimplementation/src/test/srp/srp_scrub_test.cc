@@ -0,0 +1,49 @@
+#include <chrono>
+#include <set>
+#include <thread>
+#include <gtest/gtest.h>
+#include "srp_store_test_helpers.h"
+
+namespace dcp::srp {
+
+  class SRPScrubTest : public SRPStoreTest {};
+
+  
+  // ------------------------------------------------------------
+  
+  TEST_F(SRPScrubTest, OnlyExpiredNeighboursAreFound) {
+    TimeStampT oldest;
+
+    EXPECT_FALSE (store.get_oldest_reception_time (oldest));
+    
+    for (int i = 0; i < 20; i++)
+      store.insert_esd_entry (make_esd (i, 1));
+    TimeStampT first_round = TimeStampT::get_current_system_time ();
+    std::this_thread::sleep_for (std::chrono::milliseconds (60));
+
+    // refresh the even neighbours
+    for (int i = 0; i < 20; i += 2)
+      store.insert_esd_entry (make_esd (i, 2));
+    TimeStampT now = TimeStampT::get_current_system_time ();
+
+    EXPECT_TRUE (store.get_oldest_reception_time (oldest));
+    // reception times come from the coarse clock, which lags by a
+    // few ticks at most
+    uint32_t tickMS = std::chrono::duration_cast<std::chrono::milliseconds> (dcp::CoarseClock::resolution()).count();
+    EXPECT_LE (first_round.milliseconds_passed_since (oldest), 1 + 5 * tickMS);
+
+    std::list<NodeIdentifierT> expired = store.find_nodes_to_scrub (now, 40);
+    std::set<NodeIdentifierT>  expired_set (expired.begin(), expired.end());
+    EXPECT_EQ (expired.size(), 10);
+    for (int i = 1; i < 20; i += 2)
+      EXPECT_TRUE (expired_set.contains (test_node_id (i)));
+
+    for (const auto& nodeId : expired)
+      store.remove_esd_entry (nodeId);
+    EXPECT_EQ (store.find_nodes_to_scrub (now, 40).size(), 0);
+    EXPECT_EQ (store.find_nodes_to_scrub (now, 0).size(), 10);
+    EXPECT_TRUE (store.get_oldest_reception_time (oldest));
+    EXPECT_TRUE (oldest >= first_round);
+  }
+
+};  // namespace dcp::srp
@@ -0,0 +1,119 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "srp_store_test_helpers.h"
+
+namespace dcp::srp {
+
+  class SRPSnapshotTest : public SRPStoreTest {};
+
+
+  /**
+   * Store in which a publication can be left incomplete, as if the
+   * SRP demon died in the middle of it
+   */
+  class InterruptedPublicationStore : public TestSRPStore {
+  public:
+    void start_publication ()
+    {
+      FixedMemContents& FMC = *pContents;
+      FMC.snapshots[FMC.current_snapshot.load()].version++;
+    };
+  };
+
+  
+  // ------------------------------------------------------------
+  
+  TEST_F(SRPSnapshotTest, PublishAndRead) {
+    std::vector<NodeInformation> buffer (testSlots);
+    TimeStampT now = TimeStampT::get_current_system_time ();
+
+    EXPECT_EQ (store.read_neighbour_snapshot (buffer.data(), buffer.size()), 0);
+    EXPECT_FALSE (store.publish_neighbour_snapshot (now, 0));
+
+    for (int i = 0; i < 10; i++)
+      store.insert_esd_entry (make_esd (i, 1, i, 1));
+
+    // not visible before publication
+    EXPECT_EQ (store.read_neighbour_snapshot (buffer.data(), buffer.size()), 0);
+    EXPECT_TRUE (store.publish_neighbour_snapshot (now, 0));
+    EXPECT_EQ (store.read_neighbour_snapshot (buffer.data(), buffer.size()), 10);
+    EXPECT_EQ (store.read_neighbour_snapshot (buffer.data(), 3), 10);
+
+    // rate limiting holds back changes
+    store.remove_esd_entry (test_node_id (0));
+    EXPECT_FALSE (store.publish_neighbour_snapshot (now, 1000));
+    EXPECT_EQ (store.read_neighbour_snapshot (buffer.data(), buffer.size()), 10);
+    EXPECT_TRUE (store.publish_neighbour_snapshot (now, 0));
+    EXPECT_EQ (store.read_neighbour_snapshot (buffer.data(), buffer.size()), 9);
+  }
+
+  
+  // ------------------------------------------------------------
+  
+  TEST_F(SRPSnapshotTest, ConcurrentReadersSeeConsistentSnapshots) {
+    TimeStampT now = TimeStampT::get_current_system_time ();
+    std::atomic<bool> done = false;
+    std::atomic<uint64_t> inconsistent = 0;
+    std::atomic<uint64_t> reads = 0;
+
+    // every publication contains all neighbours with the same seqno
+    for (int i = 0; i < (int) testSlots; i++)
+      store.insert_esd_entry (make_esd (i, 0, i, 0));
+    store.publish_neighbour_snapshot (now, 0);
+    
+    std::thread reader ([&] ()
+    {
+      std::vector<NodeInformation> buffer (testSlots);
+      while (not done)
+	{
+	  size_t n = store.read_neighbour_snapshot (buffer.data(), buffer.size()).value_or (0);
+	  reads++;
+	  if (n != testSlots)
+	    inconsistent++;
+	  for (size_t i = 1; i < n; i++)
+	    if ((buffer[i].esd.seqno != buffer[0].esd.seqno) or (buffer[i].esd.safetyData.position_y != buffer[0].esd.seqno))
+	      inconsistent++;
+	}
+    });
+
+    for (uint32_t round = 1; round < 2000; round++)
+      {
+	for (int i = 0; i < (int) testSlots; i++)
+	  store.insert_esd_entry (make_esd (i, round, i, round));
+	store.publish_neighbour_snapshot (now, 0);
+      }
+    done = true;
+    reader.join ();
+
+    EXPECT_GT (reads, 0);
+    EXPECT_EQ (inconsistent, 0);
+  }
+
+
+  // ------------------------------------------------------------
+  
+  TEST_F(SRPSnapshotTest, IncompletePublicationIsNotWaitedForForever) {
+    auto memory = std::make_unique<byte[]> (InterruptedPublicationStore::get_fixedmem_contents_size ());
+    InterruptedPublicationStore istore;
+    istore.initialize_srp_store (memory.get(), nullNodeIdentifier, 0.95, 50);
+    
+    std::vector<NodeInformation> buffer (testSlots);
+    TimeStampT now = TimeStampT::get_current_system_time ();
+    for (int i = 0; i < 5; i++)
+      istore.insert_esd_entry (make_esd (i, 1, i, 1));
+    EXPECT_TRUE (istore.publish_neighbour_snapshot (now, 0));
+    EXPECT_EQ (istore.read_neighbour_snapshot (buffer.data(), buffer.size()), 5);
+
+    // the version of the current snapshot stays odd
+    istore.start_publication ();
+    EXPECT_FALSE (istore.read_neighbour_snapshot (buffer.data(), buffer.size()).has_value ());
+
+    // a restarted demon publishes into the other buffer
+    istore.insert_esd_entry (make_esd (5, 1, 5, 1));
+    EXPECT_TRUE (istore.publish_neighbour_snapshot (now, 0));
+    EXPECT_EQ (istore.read_neighbour_snapshot (buffer.data(), buffer.size()), 6);
+  }
+
+};  // namespace dcp::srp
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <memory>
+#include <gtest/gtest.h>
+#include <dcp/srp/srp_store_fixedmem.h>
+
+/**
+ * Common setup of the SRP store tests: a small store type, a
+ * generator for neighbour records and a fixture holding an
+ * initialized store in private memory.
+ */
+
+namespace dcp::srp {
+
+  const uint64_t testSlots = 50;
+
+  typedef FixedMemSRPStoreBase<GlobalStateBase, testSlots>  TestSRPStore;
+
+
+  /**
+   * Node identifier of test neighbour id, never the null identifier
+   */
+  inline NodeIdentifierT test_node_id (int id)
+  {
+    NodeIdentifierT nodeId;
+    nodeId.nodeId[5] = (byte) (id + 1);
+    return nodeId;
+  }
+
+
+  /**
+   * ExtendedSafetyDataT record of test neighbour id with the given
+   * sequence number, position and velocity
+   */
+  inline ExtendedSafetyDataT make_esd (int id,
+				       uint32_t seqno,
+				       double x        = 0,
+				       double y        = 0,
+				       double z        = 0,
+				       double speed    = 0,
+				       double heading  = 0,
+				       const TimeStampT& ts = TimeStampT::get_current_system_time ())
+  {
+    ExtendedSafetyDataT esd;
+    esd.safetyData.position_x   = x;
+    esd.safetyData.position_y   = y;
+    esd.safetyData.position_z   = z;
+    esd.safetyData.has_velocity = true;
+    esd.safetyData.speed        = speed;
+    esd.safetyData.heading      = heading;
+    esd.nodeId                  = test_node_id (id);
+    esd.timeStamp               = ts;
+    esd.seqno                   = seqno;
+    return esd;
+  }
+
+
+  /**
+   * Fixture providing an initialized TestSRPStore
+   */
+  class SRPStoreTest : public ::testing::Test {
+  protected:
+    std::unique_ptr<byte[]>  memory;
+    TestSRPStore             store;
+
+    SRPStoreTest ()
+      : memory (std::make_unique<byte[]> (TestSRPStore::get_fixedmem_contents_size ()))
+    {
+      store.initialize_srp_store (memory.get(), nullNodeIdentifier, 0.95, 50);
+    };
+  };
+
+};  // namespace dcp::srp
@@ -0,0 +1,323 @@
+#include <cstdint>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <dcp/common/area.h>
+#include <dcp/srp/srp_configuration.h>
+#include <dcp/srp/srp_transmissible_types.h>
+
+namespace dcp::srp {
+
+  // ------------------------------------------------------------
+  
+  TEST(SRPTTTest, SRPPayload_RoundTrip) {
+    SRPQuantizationParameters qp;
+    qp.origin_x   = 1000;
+    qp.origin_y   = -2000;
+    qp.origin_z   = 0;
+    qp.resolution = 0.01;
+
+    SafetyDataT sd;
+    sd.position_x = 1234.567;
+    sd.position_y = -1987.654;
+    sd.position_z = 12.34;
+
+    SRPPayloadT pld;
+    pld.encode (sd, NodeIdentifierT ("01:02:03:04:05:06"), 77, 250, qp);
+    EXPECT_EQ (pld.total_size(), SRPPayloadT::fixed_size());
+    EXPECT_LE (2 * pld.total_size(), sizeof(ExtendedSafetyDataT));
+
+    byte buffer [SRPPayloadT::max_size()];
+    MemoryChunkAssemblyArea  aa ("srp-tx", sizeof(buffer), buffer);
+    pld.serialize (aa);
+    EXPECT_EQ (aa.used(), pld.total_size());
+
+    SRPPayloadT pld2;
+    MemoryChunkDisassemblyArea da ("srp-rx", aa.used(), buffer);
+    pld2.deserialize (da);
+    EXPECT_EQ (da.used(), aa.used());
+
+    TimeStampT now = TimeStampT::get_current_system_time ();
+    ExtendedSafetyDataT esd = pld2.decode (qp, now);
+    EXPECT_NEAR (esd.safetyData.position_x, sd.position_x, qp.resolution / 2);
+    EXPECT_NEAR (esd.safetyData.position_y, sd.position_y, qp.resolution / 2);
+    EXPECT_NEAR (esd.safetyData.position_z, sd.position_z, qp.resolution / 2);
+    EXPECT_FALSE (esd.safetyData.has_velocity);
+    EXPECT_EQ (esd.nodeId, NodeIdentifierT ("01:02:03:04:05:06"));
+    EXPECT_EQ (esd.seqno, 77);
+    EXPECT_EQ (now.milliseconds_passed_since (esd.timeStamp), 250);
+  }
+
+  
+  // ------------------------------------------------------------
+  
+  TEST(SRPTTTest, SRPPayload_VelocityAndClamping) {
+    SRPQuantizationParameters qp;
+
+    SafetyDataT sd;
+    sd.position_x   = 1e12;
+    sd.position_y   = -1e12;
+    sd.position_z   = 0;
+    sd.has_velocity = true;
+    sd.speed        = 13.89;
+    sd.heading      = -90;
+
+    SRPPayloadT pld;
+    pld.encode (sd, NodeIdentifierT (), 1, 100000, qp);
+    EXPECT_EQ (pld.total_size(), SRPPayloadT::fixed_size() + SRPPayloadT::extension_header_size() + SRPPayloadT::velocity_size());
+    EXPECT_EQ (pld.ageMS, UINT16_MAX);
+    EXPECT_EQ (pld.qx, INT32_MAX);
+    EXPECT_EQ (pld.qy, INT32_MIN);
+
+    byte buffer [SRPPayloadT::max_size()];
+    MemoryChunkAssemblyArea  aa ("srp-tx", sizeof(buffer), buffer);
+    pld.serialize (aa);
+    EXPECT_EQ (aa.used(), pld.total_size());
+
+    SRPPayloadT pld2;
+    MemoryChunkDisassemblyArea da ("srp-rx", aa.used(), buffer);
+    pld2.deserialize (da);
+    ExtendedSafetyDataT esd = pld2.decode (qp, TimeStampT::get_current_system_time ());
+    EXPECT_TRUE (esd.safetyData.has_velocity);
+    EXPECT_NEAR (esd.safetyData.speed, 13.89, 0.005);
+    EXPECT_NEAR (esd.safetyData.heading, 270, 0.01);
+
+    // truncated extensions and unknown versions are rejected
+    MemoryChunkDisassemblyArea da_short ("srp-rx", aa.used() - 1, buffer);
+    EXPECT_THROW (pld2.deserialize (da_short), DisassemblyAreaException);
+    buffer[0] = 0x80;
+    MemoryChunkDisassemblyArea da_flags ("srp-rx", aa.used(), buffer);
+    EXPECT_THROW (pld2.deserialize (da_flags), DisassemblyAreaException);
+  }
+
+
+  // ------------------------------------------------------------
+  
+  TEST(SRPTTTest, SRPPayload_NonFiniteValues) {
+    SRPQuantizationParameters qp;
+
+    SafetyDataT sd;
+    sd.position_x    = NAN;
+    sd.position_y    = INFINITY;
+    sd.position_z    = -INFINITY;
+    sd.has_velocity  = true;
+    sd.speed         = NAN;
+    sd.has_battery   = true;
+    sd.battery_level = NAN;
+    sd.has_waypoint  = true;
+    sd.waypoint_x    = 1;
+    sd.waypoint_y    = INFINITY;
+
+    SRPPayloadT pld;
+    pld.encode (sd, NodeIdentifierT (), 1, 0, qp);
+    EXPECT_EQ (pld.qx, 0);
+    EXPECT_EQ (pld.qy, INT32_MAX);
+    EXPECT_EQ (pld.qz, INT32_MIN);
+    EXPECT_FALSE (pld.has_velocity);
+    EXPECT_FALSE (pld.has_battery);
+    EXPECT_FALSE (pld.has_waypoint);
+    EXPECT_EQ (pld.total_size(), SRPPayloadT::fixed_size());
+
+    sd.speed         = 2;
+    sd.heading       = NAN;
+    sd.battery_level = 50;
+    pld.encode (sd, NodeIdentifierT (), 1, 0, qp);
+    EXPECT_FALSE (pld.has_velocity);
+    EXPECT_TRUE (pld.has_battery);
+    EXPECT_EQ (pld.qbattery, 100);
+  }
+
+
+  // ------------------------------------------------------------
+
+  TEST(SRPTTTest, SRPPayload_Extensions) {
+    SRPQuantizationParameters qp;
+    qp.origin_x = 100;
+
+    SafetyDataT sd;
+    sd.position_x    = 150;
+    sd.has_velocity  = true;
+    sd.speed         = 5;
+    sd.heading       = 45;
+    sd.has_battery   = true;
+    sd.battery_level = 73.4;
+    sd.has_waypoint  = true;
+    sd.waypoint_x    = 200.5;
+    sd.waypoint_y    = -20.25;
+    sd.waypoint_z    = 3;
+
+    byte app_value [3] = {1, 2, 3};
+    EXPECT_FALSE (sd.add_application_extension (extBattery, app_value, 3));
+    EXPECT_TRUE (sd.add_application_extension (200, app_value, 3));
+    EXPECT_TRUE (sd.add_application_extension (201, nullptr, 0));
+    EXPECT_FALSE (sd.add_application_extension (202, app_value, maxApplicationExtensionsSize));
+
+    SRPPayloadT pld;
+    pld.encode (sd, NodeIdentifierT (), 1, 0, qp);
+    EXPECT_EQ (pld.total_size(), SRPPayloadT::fixed_size() + 3*SRPPayloadT::extension_header_size()
+	       + SRPPayloadT::velocity_size() + SRPPayloadT::battery_size() + SRPPayloadT::waypoint_size() + 7);
+
+    // append an extension of unknown type, it must be skipped
+    byte buffer [SRPPayloadT::max_size() + 8];
+    MemoryChunkAssemblyArea  aa ("srp-tx", sizeof(buffer), buffer);
+    pld.serialize (aa);
+    aa.serialize_byte (17);
+    aa.serialize_byte (2);
+    aa.serialize_byte (0xAA);
+    aa.serialize_byte (0xBB);
+
+    SRPPayloadT pld2;
+    MemoryChunkDisassemblyArea da ("srp-rx", aa.used(), buffer);
+    pld2.deserialize (da);
+    EXPECT_EQ (da.used(), aa.used());
+    EXPECT_EQ (pld2.total_size(), pld.total_size());
+
+    ExtendedSafetyDataT esd = pld2.decode (qp, TimeStampT::get_current_system_time ());
+    EXPECT_TRUE (esd.safetyData.has_velocity);
+    EXPECT_TRUE (esd.safetyData.has_battery);
+    EXPECT_NEAR (esd.safetyData.battery_level, 73.4, 0.25);
+    EXPECT_TRUE (esd.safetyData.has_waypoint);
+    EXPECT_NEAR (esd.safetyData.waypoint_x, 200.5, qp.resolution / 2);
+    EXPECT_NEAR (esd.safetyData.waypoint_y, -20.25, qp.resolution / 2);
+    EXPECT_NEAR (esd.safetyData.waypoint_z, 3, qp.resolution / 2);
+
+    const byte* value;
+    uint8_t     length;
+    EXPECT_TRUE (esd.safetyData.find_application_extension (200, value, length));
+    EXPECT_EQ (length, 3);
+    EXPECT_EQ (value[2], 3);
+    EXPECT_TRUE (esd.safetyData.find_application_extension (201, value, length));
+    EXPECT_EQ (length, 0);
+    EXPECT_FALSE (esd.safetyData.find_application_extension (202, value, length));
+
+    // a known extension shorter than its defined size is rejected
+    buffer[SRPPayloadT::fixed_size() + 1] = 1;
+    MemoryChunkDisassemblyArea da_bad ("srp-rx", aa.used(), buffer);
+    EXPECT_THROW (pld2.deserialize (da_bad), DisassemblyAreaException);
+  }
+
+
+  // ------------------------------------------------------------
+
+  TEST(SRPTTTest, SRPPayload_Budget) {
+    SRPQuantizationParameters qp;
+
+    SafetyDataT sd;
+    sd.has_velocity  = true;
+    sd.has_battery   = true;
+    sd.has_waypoint  = true;
+    byte app_value [4] = {0};
+    sd.add_application_extension (130, app_value, 4);
+
+    // extensions that do not fit into the budget are left out
+    SRPPayloadT pld;
+    size_t budget = SRPPayloadT::fixed_size() + SRPPayloadT::extension_header_size() + SRPPayloadT::velocity_size() + 6;
+    pld.encode (sd, NodeIdentifierT (), 1, 0, qp, budget);
+    EXPECT_TRUE (pld.has_velocity);
+    EXPECT_TRUE (pld.has_battery);
+    EXPECT_FALSE (pld.has_waypoint);
+    EXPECT_EQ (pld.application_extensions_length, 0);
+    EXPECT_LE (pld.total_size(), budget);
+
+    pld.encode (sd, NodeIdentifierT (), 1, 0, qp, SRPPayloadT::fixed_size());
+    EXPECT_EQ (pld.total_size(), SRPPayloadT::fixed_size());
+
+    pld.encode (sd, NodeIdentifierT (), 1, 0, qp);
+    EXPECT_TRUE (pld.has_waypoint);
+    EXPECT_EQ (pld.application_extensions_length, 6);
+    EXPECT_LE (pld.total_size(), SRPPayloadT::max_size());
+  }
+
+
+  // ------------------------------------------------------------
+
+  TEST(SRPTTTest, SRPPayload_LongerThanMaxSize) {
+    SRPQuantizationParameters qp;
+
+    SafetyDataT sd;
+    sd.position_x    = 12.5;
+    sd.has_velocity  = true;
+    sd.speed         = 3;
+    byte app_value [2] = {7, 8};
+    sd.add_application_extension (210, app_value, 2);
+
+    SRPPayloadT pld;
+    pld.encode (sd, NodeIdentifierT (), 1, 0, qp);
+
+    // a newer node may send more or larger extensions than this build
+    // knows, up to the registered wire size
+    byte buffer [SRPPayloadT::max_wire_size()];
+    MemoryChunkAssemblyArea  aa ("srp-tx", sizeof(buffer), buffer);
+    pld.serialize (aa);
+    while (aa.used() + SRPPayloadT::extension_header_size() + 60 <= sizeof(buffer))
+      {
+	aa.serialize_byte (40);
+	aa.serialize_byte (60);
+	for (int i = 0; i < 60; i++)
+	  aa.serialize_byte (0x55);
+      }
+    EXPECT_GT (aa.used(), SRPPayloadT::max_size());
+
+    SRPPayloadT pld2;
+    MemoryChunkDisassemblyArea da ("srp-rx", aa.used(), buffer);
+    pld2.deserialize (da);
+    EXPECT_EQ (da.used(), aa.used());
+    EXPECT_EQ (pld2.total_size(), pld.total_size());
+
+    ExtendedSafetyDataT esd = pld2.decode (qp, TimeStampT::get_current_system_time ());
+    EXPECT_NEAR (esd.safetyData.position_x, 12.5, qp.resolution / 2);
+    EXPECT_TRUE (esd.safetyData.has_velocity);
+    const byte* value;
+    uint8_t     length;
+    EXPECT_TRUE (esd.safetyData.find_application_extension (210, value, length));
+    EXPECT_EQ (length, 2);
+
+    // SRP registers with BP for the wire size, not for its own maximum
+    EXPECT_EQ (get_bp_client_info().maxPayloadSize.val, SRPPayloadT::max_wire_size());
+  }
+
+
+  // ------------------------------------------------------------
+
+  TEST(SRPTTTest, SRPPayload_ApplicationExtensionsLengthTooLarge) {
+    SRPQuantizationParameters qp;
+
+    // the bytes following application_extensions must never be encoded
+    struct {
+      SafetyDataT sd;
+      byte        guard [256];
+    } guarded;
+    std::memset (guarded.sd.application_extensions, 0, sizeof(guarded.sd.application_extensions));
+    std::memset (guarded.guard, 0xEE, sizeof(guarded.guard));
+    byte app_value [2] = {7, 8};
+    guarded.sd.position_x = 0;
+    guarded.sd.position_y = 0;
+    guarded.sd.position_z = 0;
+    EXPECT_TRUE (guarded.sd.add_application_extension (210, app_value, 2));
+    EXPECT_TRUE (guarded.sd.has_valid_application_extensions_length ());
+
+    // a client writes a length beyond the array
+    guarded.sd.application_extensions_length = 200;
+    EXPECT_FALSE (guarded.sd.has_valid_application_extensions_length ());
+
+    SRPPayloadT pld;
+    pld.encode (guarded.sd, NodeIdentifierT (), 1, 0, qp, SRPPayloadT::max_wire_size());
+    EXPECT_LE (pld.application_extensions_length, maxApplicationExtensionsSize);
+    EXPECT_LE (pld.total_size(), SRPPayloadT::max_size());
+
+    // also a payload with a corrupted length is serialized within bounds
+    pld.application_extensions_length = 200;
+    EXPECT_LE (pld.total_size(), SRPPayloadT::max_size());
+    byte buffer [SRPPayloadT::max_wire_size()];
+    MemoryChunkAssemblyArea  aa ("srp-tx", sizeof(buffer), buffer);
+    pld.serialize (aa);
+    EXPECT_EQ (aa.used(), SRPPayloadT::fixed_size() + maxApplicationExtensionsSize);
+    for (size_t i = 0; i < aa.used(); i++)
+      EXPECT_NE (buffer[i], 0xEE);
+
+    const byte* value;
+    uint8_t     length;
+    EXPECT_TRUE (guarded.sd.find_application_extension (210, value, length));
+    EXPECT_FALSE (guarded.sd.find_application_extension (211, value, length));
+  }
+
+};  // namespace dcp::srp
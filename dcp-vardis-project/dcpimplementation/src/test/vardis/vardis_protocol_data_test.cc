@@ -537,5 +537,632 @@ namespace dcp::vardis {
   }
   
   // ------------------------------------------------------------
+
+  /**
+   * Creates the given variables with node addr1 as producer and
+   * returns after all creates have been processed
+   */
+  void create_test_variables (VardisProtocolData& protData, std::vector<uint8_t> varIds)
+  {
+    for (auto vid : varIds)
+      {
+	double dval = vid;
+	RTDB_Create_Request cr_req;
+	cr_req.spec.varId   = vid;
+	cr_req.spec.prodId  = addr1;
+	cr_req.spec.repCnt  = 1;
+	cr_req.spec.descr   = StringT ("hello");
+	cr_req.value        = VarValueT (sizeof(double), (byte*) &dval);
+	EXPECT_EQ (protData.handle_rtdb_create_request (cr_req).status_code, VARDIS_STATUS_OK);
+      }
+  }
+
+  
+  TEST(VardisProtDataTest, summaryRangesSeqnos) {
+    ArrayVariableStoreShm<256,128> vstore1 ("shm-vardis-protocol-data-test", true, 20, 32, 32, 5, addr1);
+    ArrayVariableStoreShm<256,128> vstore2 ("shm-vardis-protocol-data-test2", true, 20, 32, 32, 5, addr2);
+    VardisProtocolData protData1 (vstore1);
+    VardisProtocolData protData2 (vstore2);
+    protData1.compactSummaries = true;
+    protData1.vardis_store.set_vardis_isactive (true);
+    protData2.vardis_store.set_vardis_isactive (true);
+
+    create_test_variables (protData1, {3, 4, 5, 6, 20, 21});
+
+    // plain summaries are suppressed, two runs are generated instead
+    byte buffer [1000];
+    MemoryChunkAssemblyArea  ass_area ("ass_area", 1000, buffer);
+    unsigned int containers_added = 0;
+    protData1.makeICTypeSummaries (ass_area, containers_added);
+    EXPECT_EQ (containers_added, 0);
+    protData1.makeICTypeSummaryRanges (ass_area, containers_added);
+    EXPECT_EQ (containers_added, 1);
+    EXPECT_EQ (ass_area.used(), ICHeaderT::fixed_size() + VarSummRangeT::seqnos_size(4) + VarSummRangeT::seqnos_size(2));
+
+    MemoryChunkDisassemblyArea  disass_area ("disass_area", ass_area.used(), buffer);
+    ICHeaderT icHeader;
+    icHeader.deserialize (disass_area);
+    EXPECT_EQ (icHeader.icType, ICTYPE_SUMMARY_RANGES);
+    EXPECT_EQ (icHeader.icNumRecords, 2);
+    for (int i = 0; i < icHeader.icNumRecords; i++)
+      {
+	VarSummRangeT summrange;
+	summrange.deserialize (disass_area);
+	protData2.process_var_summrange (summrange);
+      }
+
+    // receiver does not know any of the variables and requests them
+    EXPECT_EQ (protData2.reqCreateQ.size(), 6);
+    EXPECT_TRUE (protData2.reqCreateQ.contains (3));
+    EXPECT_TRUE (protData2.reqCreateQ.contains (21));
+  }
+
+
+  // ------------------------------------------------------------
+
+  TEST(VardisProtDataTest, summaryRangesDigest) {
+    ArrayVariableStoreShm<256,128> vstore1 ("shm-vardis-protocol-data-test", true, 20, 32, 32, 5, addr1);
+    ArrayVariableStoreShm<256,128> vstore2 ("shm-vardis-protocol-data-test2", true, 20, 32, 32, 5, addr2);
+    VardisProtocolData protData1 (vstore1);
+    VardisProtocolData protData2 (vstore2);
+    protData1.compactSummaries = true;
+    protData1.summaryDigestRange = 64;
+    protData2.compactSummaries = true;
+    protData2.summaryDigestRange = 64;
+    protData1.vardis_store.set_vardis_isactive (true);
+    protData2.vardis_store.set_vardis_isactive (true);
+
+    create_test_variables (protData1, {3, 4, 70, 200});
+
+    // one digest record per non-empty range
+    byte buffer [1000];
+    MemoryChunkAssemblyArea  ass_area ("ass_area", 1000, buffer);
+    unsigned int containers_added = 0;
+    protData1.makeICTypeSummaryRanges (ass_area, containers_added);
+    EXPECT_EQ (containers_added, 1);
+    EXPECT_EQ (ass_area.used(), ICHeaderT::fixed_size() + 3*VarSummRangeT::digest_size());
+
+    MemoryChunkDisassemblyArea  disass_area ("disass_area", ass_area.used(), buffer);
+    ICHeaderT icHeader;
+    icHeader.deserialize (disass_area);
+    EXPECT_EQ (icHeader.icNumRecords, 3);
+    std::vector<VarSummRangeT> digests;
+    for (int i = 0; i < icHeader.icNumRecords; i++)
+      {
+	VarSummRangeT summrange;
+	summrange.deserialize (disass_area);
+	EXPECT_EQ (summrange.mode, SUMMRANGE_MODE_DIGEST);
+	digests.push_back (summrange);
+	protData2.process_var_summrange (summrange);
+      }
+
+    // a node in sync does not request anything
+    EXPECT_EQ (protData1.summaryRangeDigest (0, 64), digests[0].digest);
+    protData1.process_var_summrange (digests[0]);
+    EXPECT_TRUE (protData1.reqSummRangeQ.empty());
+    
+    // empty receiver requests all three ranges, sender answers with explicit seqnos
+    EXPECT_EQ (protData2.reqSummRangeQ.size(), 3);
+    MemoryChunkAssemblyArea  req_area ("req_area", 1000);
+    containers_added = 0;
+    protData2.makeICTypeRequestSummaryRanges (req_area, containers_added);
+    EXPECT_EQ (containers_added, 1);
+    EXPECT_TRUE (protData2.reqSummRangeQ.empty());
+
+    MemoryChunkDisassemblyArea  req_disass ("req_disass", req_area.used(), req_area.get_buffer_ptr());
+    icHeader.deserialize (req_disass);
+    EXPECT_EQ (icHeader.icType, ICTYPE_REQUEST_SUMMRANGES);
+    for (int i = 0; i < icHeader.icNumRecords; i++)
+      {
+	VarReqSummRangeT req;
+	req.deserialize (req_disass);
+	protData1.process_var_reqsummrange (req);
+      }
+    EXPECT_EQ (protData1.summRangeQ.size(), 4);
+
+    MemoryChunkAssemblyArea  expl_area ("expl_area", 1000);
+    containers_added = 0;
+    protData1.makeICTypeSummaryRanges (expl_area, containers_added);
+    EXPECT_TRUE (protData1.summRangeQ.empty());
+    MemoryChunkDisassemblyArea  expl_disass ("expl_disass", expl_area.used(), expl_area.get_buffer_ptr());
+    icHeader.deserialize (expl_disass);
+    for (int i = 0; i < icHeader.icNumRecords; i++)
+      {
+	VarSummRangeT summrange;
+	summrange.deserialize (expl_disass);
+	protData2.process_var_summrange (summrange);
+      }
+    EXPECT_EQ (protData2.reqCreateQ.size(), 4);
+  }
+  
+  // ------------------------------------------------------------
+
+  TEST(VardisProtDataTest, merkleTreeMaintenance) {
+    ArrayVariableStoreShm<256,128> vstore ("shm-vardis-protocol-data-test", true, 20, 32, 32, 5, addr1);
+    VardisProtocolData protData (vstore);
+    protData.vardis_store.set_vardis_isactive (true);
+
+    EXPECT_EQ (protData.merkleTree.root(), 0);
+    create_test_variables (protData, {10});
+    uint32_t root_after_create = protData.merkleTree.root();
+    EXPECT_NE (root_after_create, 0);
+    EXPECT_NE (protData.merkleTree.get (VardisMerkleTree::depth(), 10), 0);
+    EXPECT_EQ (protData.merkleTree.get (VardisMerkleTree::depth(), 11), 0);
+    EXPECT_EQ (protData.merkleTree.get (1, 1), 0);
+
+    double dval = 2.71;
+    RTDB_Update_Request upd_req;
+    upd_req.varId = 10;
+    upd_req.value = VarValueT (sizeof(double), (byte*) &dval);
+    EXPECT_EQ (protData.handle_rtdb_update_request (upd_req).status_code, VARDIS_STATUS_OK);
+    EXPECT_NE (protData.merkleTree.root(), root_after_create);
+
+    RTDB_Delete_Request del_req;
+    del_req.varId = 10;
+    EXPECT_EQ (protData.handle_rtdb_delete_request (del_req).status_code, VARDIS_STATUS_OK);
+    EXPECT_EQ (protData.merkleTree.root(), 0);
+  }
+
+
+  // ------------------------------------------------------------
+
+  /**
+   * Lets the sender generate Merkle tree and summary range related
+   * containers plus creates / create requests, and lets the receiver
+   * process them. Returns number of bytes generated.
+   */
+  size_t anti_entropy_exchange (VardisProtocolData& sender, VardisProtocolData& receiver)
+  {
+    MemoryChunkAssemblyArea  ass_area ("ass_area", 1000);
+    unsigned int containers_added = 0;
+    sender.makeICTypeCreateVariables (ass_area, containers_added);
+    sender.makeICTypeRequestVarCreates (ass_area, containers_added);
+    sender.makeICTypeSummaries (ass_area, containers_added);
+    sender.makeICTypeSummaryRanges (ass_area, containers_added);
+    sender.makeICTypeMerkleNodes (ass_area, containers_added);
+    sender.makeICTypeRequestSummaryRanges (ass_area, containers_added);
+    sender.makeICTypeRequestMerkleNodes (ass_area, containers_added);
+
+    MemoryChunkDisassemblyArea  disass_area ("disass_area", ass_area.used(), ass_area.get_buffer_ptr());
+    while (disass_area.available() > 0)
+      {
+	ICHeaderT icHeader;
+	icHeader.deserialize (disass_area);
+	for (int i = 0; i < icHeader.icNumRecords; i++)
+	  {
+	    switch (icHeader.icType.val)
+	      {
+	      case ICTYPE_CREATE_VARIABLES:    { VarCreateT r;        r.deserialize (disass_area); receiver.process_var_create (r); break; }
+	      case ICTYPE_REQUEST_VARCREATES:  { VarReqCreateT r;     r.deserialize (disass_area); receiver.process_var_reqcreate (r); break; }
+	      case ICTYPE_SUMMARY_RANGES:      { VarSummRangeT r;     r.deserialize (disass_area); receiver.process_var_summrange (r); break; }
+	      case ICTYPE_MERKLE_NODES:        { VarMerkleNodeT r;    r.deserialize (disass_area); receiver.process_var_merklenode (r); break; }
+	      case ICTYPE_REQUEST_SUMMRANGES:  { VarReqSummRangeT r;  r.deserialize (disass_area); receiver.process_var_reqsummrange (r); break; }
+	      case ICTYPE_REQUEST_MERKLENODES: { VarReqMerkleNodeT r; r.deserialize (disass_area); receiver.process_var_reqmerklenode (r); break; }
+	      default: ADD_FAILURE() << "unexpected container " << icHeader; return ass_area.used();
+	      }
+	  }
+      }
+    return ass_area.used();
+  }
+  
+
+  TEST(VardisProtDataTest, merkleAntiEntropy) {
+    ArrayVariableStoreShm<256,128> vstore1 ("shm-vardis-protocol-data-test", true, 20, 32, 32, 5, addr1);
+    ArrayVariableStoreShm<256,128> vstore2 ("shm-vardis-protocol-data-test2", true, 20, 32, 32, 5, addr2);
+    VardisProtocolData protData1 (vstore1);
+    VardisProtocolData protData2 (vstore2);
+    protData1.antiEntropy = true;
+    protData2.antiEntropy = true;
+    protData1.vardis_store.set_vardis_isactive (true);
+    protData2.vardis_store.set_vardis_isactive (true);
+
+    // both nodes know the same larger set of variables
+    std::vector<uint8_t> varIds;
+    for (uint8_t vid = 0; vid < 200; vid++)
+      varIds.push_back (vid);
+    create_test_variables (protData1, varIds);
+    while (not protData1.createQ.empty())
+      anti_entropy_exchange (protData1, protData2);
+    while (not protData2.createQ.empty())
+      anti_entropy_exchange (protData2, protData1);
+    EXPECT_EQ (protData1.merkleTree.root(), protData2.merkleTree.root());
+
+    // nodes in sync only exchange the root hash
+    EXPECT_EQ (anti_entropy_exchange (protData1, protData2), ICHeaderT::fixed_size() + VarMerkleNodeT::fixed_size());
+    EXPECT_EQ (anti_entropy_exchange (protData2, protData1), ICHeaderT::fixed_size() + VarMerkleNodeT::fixed_size());
+    EXPECT_TRUE (protData2.reqMerkleNodeQ.empty());
+
+    // a single update (that node 2 missed) is found by descending the tree
+    double dval = 1.41;
+    RTDB_Update_Request upd_req;
+    upd_req.varId = 77;
+    upd_req.value = VarValueT (sizeof(double), (byte*) &dval);
+    EXPECT_EQ (protData1.handle_rtdb_update_request (upd_req).status_code, VARDIS_STATUS_OK);
+    protData1.updateQ.remove (77);
+
+    size_t total_bytes = 0;
+    int    rounds      = 0;
+    while (protData2.reqUpdQ.empty() and (rounds++ < 20))
+      {
+	total_bytes += anti_entropy_exchange (protData1, protData2);
+	total_bytes += anti_entropy_exchange (protData2, protData1);
+      }
+    EXPECT_TRUE (protData2.reqUpdQ.contains (77));
+    EXPECT_EQ (protData2.reqUpdQ.size(), 1);
+    EXPECT_LT (total_bytes, 200 * VarSummT::fixed_size());
+  }
+  
+  // ------------------------------------------------------------
+    
+  TEST(VardisProtDataTest, priorityClasses) {
+    ArrayVariableStoreShm<256,128> vstore ("shm-vardis-protocol-data-test", true, 20, 32, 32, 5, addr1);
+    VardisProtocolData protData (vstore);
+    protData.vardis_store.set_vardis_isactive (true);
+
+    // illegal priority class is rejected
+    double dval = 1.0;
+    RTDB_Create_Request cr_req;
+    cr_req.spec.varId   = 1;
+    cr_req.spec.prodId  = addr1;
+    cr_req.spec.repCnt  = 1;
+    cr_req.spec.prio    = VarPriorityT::max_val() + 1;
+    cr_req.spec.descr   = StringT ("hello");
+    cr_req.value        = VarValueT (sizeof(double), (byte*) &dval);
+    EXPECT_EQ (protData.handle_rtdb_create_request (cr_req).status_code, VARDIS_STATUS_ILLEGAL_PRIORITY);
+
+    // variable 1 is low priority, variable 2 is critical and rate-limited
+    cr_req.spec.prio    = VARDIS_PRIO_LOW;
+    EXPECT_EQ (protData.handle_rtdb_create_request (cr_req).status_code, VARDIS_STATUS_OK);
+    cr_req.spec.varId       = 2;
+    cr_req.spec.prio        = VARDIS_PRIO_CRITICAL;
+    cr_req.spec.minInterval = 60000;
+    EXPECT_EQ (protData.handle_rtdb_create_request (cr_req).status_code, VARDIS_STATUS_OK);
+
+    // creates are ordered by priority class
+    MemoryChunkAssemblyArea  cr_area ("cr_area", 1000);
+    unsigned int containers_added = 0;
+    protData.makeICTypeCreateVariables (cr_area, containers_added);
+    MemoryChunkDisassemblyArea  cr_disass ("cr_disass", cr_area.used(), cr_area.get_buffer_ptr());
+    ICHeaderT icHeader;
+    icHeader.deserialize (cr_disass);
+    EXPECT_EQ (icHeader.icNumRecords, 2);
+    VarCreateT create;
+    create.deserialize (cr_disass);
+    EXPECT_EQ (create.spec.varId, 2);
+    EXPECT_EQ (create.spec.prio, VARDIS_PRIO_CRITICAL);
+    EXPECT_EQ (create.spec.minInterval, 60000);
+
+    // a second update of the rate-limited variable before the first
+    // one got transmitted replaces it under the same seqno
+    RTDB_Update_Request upd_req;
+    upd_req.value = VarValueT (sizeof(double), (byte*) &dval);
+    upd_req.varId = 1;
+    EXPECT_EQ (protData.handle_rtdb_update_request (upd_req).status_code, VARDIS_STATUS_OK);
+    upd_req.varId = 2;
+    EXPECT_EQ (protData.handle_rtdb_update_request (upd_req).status_code, VARDIS_STATUS_OK);
+    EXPECT_EQ (protData.handle_rtdb_update_request (upd_req).status_code, VARDIS_STATUS_OK);
+    EXPECT_EQ (protData.vardis_store.get_db_entry_ref(2).seqno, 1);
+    EXPECT_EQ (protData.vardis_store.get_vardis_protocol_statistics_ref().count_update_coalesced[VARDIS_PRIO_CRITICAL], 1);
+
+    // variable 2 is held back by its minimum update interval, and the
+    // critical class alone yields nothing
+    MemoryChunkAssemblyArea  upd_area ("upd_area", 1000);
+    containers_added = 0;
+    protData.makeICTypeUpdates (upd_area, containers_added, VARDIS_PRIO_CRITICAL, VARDIS_PRIO_CRITICAL);
+    EXPECT_EQ (containers_added, 0);
+    protData.makeICTypeUpdates (upd_area, containers_added);
+    EXPECT_EQ (containers_added, 1);
+    EXPECT_FALSE (protData.updateQ.contains (1));
+    EXPECT_TRUE (protData.updateQ.contains (2));
+    EXPECT_EQ (protData.vardis_store.get_vardis_protocol_statistics_ref().count_update_tx[VARDIS_PRIO_LOW], 1);
+    EXPECT_EQ (protData.vardis_store.get_vardis_protocol_statistics_ref().count_update_tx[VARDIS_PRIO_CRITICAL], 0);
+
+    // once the interval has passed, the critical update goes out
+    protData.vardis_store.get_db_entry_ref(2).minInterval = 0;
+    MemoryChunkAssemblyArea  upd_area2 ("upd_area2", 1000);
+    containers_added = 0;
+    protData.makeICTypeUpdates (upd_area2, containers_added, VARDIS_PRIO_CRITICAL, VARDIS_PRIO_CRITICAL);
+    EXPECT_EQ (containers_added, 1);
+    EXPECT_TRUE (protData.updateQ.empty());
+    EXPECT_EQ (protData.vardis_store.get_vardis_protocol_statistics_ref().count_update_tx[VARDIS_PRIO_CRITICAL], 1);
+  }
+
+
+  // ------------------------------------------------------------
+
+  TEST(VardisProtDataTest, noCoalescingWithResentVersion) {
+    ArrayVariableStoreShm<256,128> vstore ("shm-vardis-protocol-data-test", true, 20, 32, 32, 5, addr1);
+    VardisProtocolData protData (vstore);
+    protData.vardis_store.set_vardis_isactive (true);
+    auto& stats = protData.vardis_store.get_vardis_protocol_statistics_ref();
+
+    double dval = 1.0;
+    RTDB_Create_Request cr_req;
+    cr_req.spec.varId       = 1;
+    cr_req.spec.prodId      = addr1;
+    cr_req.spec.repCnt      = 1;
+    cr_req.spec.prio        = VARDIS_PRIO_CRITICAL;
+    cr_req.spec.minInterval = 60000;
+    cr_req.spec.descr       = StringT ("hello");
+    cr_req.value            = VarValueT (sizeof(double), (byte*) &dval);
+    EXPECT_EQ (protData.handle_rtdb_create_request (cr_req).status_code, VARDIS_STATUS_OK);
+    DBEntry& theEntry = protData.vardis_store.get_db_entry_ref(1);
+
+    // transmit version 1, bypassing the minimum update interval once
+    RTDB_Update_Request upd_req;
+    upd_req.varId = 1;
+    upd_req.value = VarValueT (sizeof(double), (byte*) &dval);
+    EXPECT_EQ (protData.handle_rtdb_update_request (upd_req).status_code, VARDIS_STATUS_OK);
+    EXPECT_EQ (theEntry.seqno, 1);
+    theEntry.minInterval = 0;
+    MemoryChunkAssemblyArea  area1 ("area1", 1000);
+    unsigned int containers_added = 0;
+    protData.makeICTypeUpdates (area1, containers_added);
+    EXPECT_EQ (containers_added, 1);
+    EXPECT_TRUE (protData.updateQ.empty());
+    EXPECT_EQ (stats.count_update_tx[VARDIS_PRIO_CRITICAL], 1);
+    theEntry.minInterval = 60000;
+
+    // a neighbour requests version 1 again: the answer is neither held
+    // back by the minimum update interval nor counted as first
+    // transmission
+    VarReqUpdateT requpd;
+    requpd.updSpec.varId = 1;
+    requpd.updSpec.seqno = 0;
+    protData.process_var_requpdate (requpd);
+    MemoryChunkAssemblyArea  area2 ("area2", 1000);
+    containers_added = 0;
+    protData.makeICTypeUpdates (area2, containers_added);
+    EXPECT_EQ (containers_added, 1);
+    EXPECT_EQ (stats.count_update_tx[VARDIS_PRIO_CRITICAL], 1);
+
+    // a new value while the re-send of version 1 is queued gets a
+    // new seqno instead of being coalesced into version 1
+    protData.process_var_requpdate (requpd);
+    EXPECT_TRUE (protData.updateQ.contains (1));
+    EXPECT_EQ (protData.handle_rtdb_update_request (upd_req).status_code, VARDIS_STATUS_OK);
+    EXPECT_EQ (theEntry.seqno, 2);
+    EXPECT_EQ (stats.count_update_coalesced[VARDIS_PRIO_CRITICAL], 0);
+
+    // a further value before version 2 went out is coalesced
+    EXPECT_EQ (protData.handle_rtdb_update_request (upd_req).status_code, VARDIS_STATUS_OK);
+    EXPECT_EQ (theEntry.seqno, 2);
+    EXPECT_EQ (stats.count_update_coalesced[VARDIS_PRIO_CRITICAL], 1);
+  }
+
+
+  // ------------------------------------------------------------
+
+  /**
+   * Lets the sender generate create and update containers and lets
+   * the receiver process them
+   */
+  void create_update_exchange (VardisProtocolData& sender, VardisProtocolData& receiver)
+  {
+    MemoryChunkAssemblyArea  ass_area ("ass_area", 1000);
+    unsigned int containers_added = 0;
+    sender.makeICTypeCreateVariables (ass_area, containers_added);
+    sender.makeICTypeUpdates (ass_area, containers_added);
+
+    MemoryChunkDisassemblyArea  disass_area ("disass_area", ass_area.used(), ass_area.get_buffer_ptr());
+    while (disass_area.available() > 0)
+      {
+	ICHeaderT icHeader;
+	icHeader.deserialize (disass_area);
+	for (int i = 0; i < icHeader.icNumRecords; i++)
+	  {
+	    switch (icHeader.icType.val)
+	      {
+	      case ICTYPE_CREATE_VARIABLES:  { VarCreateT r;  r.deserialize (disass_area); receiver.process_var_create (r); break; }
+	      case ICTYPE_UPDATES:           { VarUpdateT r;  r.deserialize (disass_area); receiver.process_var_update (r); break; }
+	      default: ADD_FAILURE() << "unexpected container " << icHeader; return;
+	      }
+	  }
+      }
+  }
+
+
+  TEST(VardisProtDataTest, noCoalescingWithVersionSentInCreate) {
+    ArrayVariableStoreShm<256,128> vstore1 ("shm-vardis-protocol-data-test", true, 20, 32, 32, 5, addr1);
+    ArrayVariableStoreShm<256,128> vstore2 ("shm-vardis-protocol-data-test2", true, 20, 32, 32, 5, addr2);
+    VardisProtocolData protData1 (vstore1);
+    VardisProtocolData protData2 (vstore2);
+    protData1.vardis_store.set_vardis_isactive (true);
+    protData2.vardis_store.set_vardis_isactive (true);
+
+    double dval = 1.0;
+    RTDB_Create_Request cr_req;
+    cr_req.spec.varId       = 1;
+    cr_req.spec.prodId      = addr1;
+    cr_req.spec.repCnt      = 1;
+    cr_req.spec.prio        = VARDIS_PRIO_CRITICAL;
+    cr_req.spec.minInterval = 60000;
+    cr_req.spec.descr       = StringT ("hello");
+    cr_req.value            = VarValueT (sizeof(double), (byte*) &dval);
+    EXPECT_EQ (protData1.handle_rtdb_create_request (cr_req).status_code, VARDIS_STATUS_OK);
+    DBEntry& theEntry = protData1.vardis_store.get_db_entry_ref(1);
+
+    // version 1 is produced before the create goes out, the VarCreateT
+    // carries it while the VarUpdateT is held back by the interval
+    dval = 2.0;
+    RTDB_Update_Request upd_req;
+    upd_req.varId = 1;
+    upd_req.value = VarValueT (sizeof(double), (byte*) &dval);
+    EXPECT_EQ (protData1.handle_rtdb_update_request (upd_req).status_code, VARDIS_STATUS_OK);
+    EXPECT_EQ (theEntry.seqno, 1);
+    create_update_exchange (protData1, protData2);
+    EXPECT_EQ (protData2.vardis_store.get_db_entry_ref(1).seqno, 1);
+    EXPECT_FALSE (theEntry.newVersionPending);
+
+    // the next value gets a new seqno instead of being coalesced into
+    // the version the neighbour already holds
+    dval = 3.0;
+    upd_req.value = VarValueT (sizeof(double), (byte*) &dval);
+    EXPECT_EQ (protData1.handle_rtdb_update_request (upd_req).status_code, VARDIS_STATUS_OK);
+    EXPECT_EQ (theEntry.seqno, 2);
+    dval = 4.0;
+    upd_req.value = VarValueT (sizeof(double), (byte*) &dval);
+    EXPECT_EQ (protData1.handle_rtdb_update_request (upd_req).status_code, VARDIS_STATUS_OK);
+    EXPECT_EQ (theEntry.seqno, 2);
+
+    // once the interval has passed, the receiver converges
+    theEntry.minInterval = 0;
+    while (not protData1.updateQ.empty())
+      create_update_exchange (protData1, protData2);
+    RTDB_Read_Request read_req;
+    read_req.varId = 1;
+    RTDB_Read_Confirm read_conf = protData2.handle_rtdb_read_request (read_req);
+    EXPECT_EQ (read_conf.status_code, VARDIS_STATUS_OK);
+    EXPECT_EQ (protData2.vardis_store.get_db_entry_ref(1).seqno, 2);
+    ASSERT_EQ (read_conf.value.length, sizeof(double));
+    EXPECT_EQ (*((double*) read_conf.value.data), 4.0);
+  }
+
+
+  // ------------------------------------------------------------
+
+  TEST(VardisProtDataTest, queuesOrderedByPriorityClass) {
+    RecordSizeTable  sizes = {};
+    uint8_t          prio [4] = {0, VARDIS_PRIO_LOW, VARDIS_PRIO_CRITICAL, VARDIS_PRIO_LOW};
+    PrioritizedVarIdQueue  q (sizes, [&] (VarIdT varId) { return prio[varId.val]; });
+    for (auto v : {1, 2, 3})
+      sizes[v] = 10 * v;
+
+    // the critical variable goes ahead of both low priority ones,
+    // which stay in insertion order
+    q.insert (1);
+    q.insert (2);
+    q.insert (3);
+    q.insert (2);
+    EXPECT_EQ (q.size(), 3);
+    EXPECT_EQ (q.total_bytes(), 60);
+    EXPECT_EQ (q.queue[0], 2);
+    EXPECT_EQ (q.queue[1], 1);
+    EXPECT_EQ (q.queue[2], 3);
+    EXPECT_EQ (q.class_range (VARDIS_PRIO_CRITICAL, VARDIS_PRIO_CRITICAL), std::make_pair ((size_t) 0, (size_t) 1));
+    EXPECT_EQ (q.class_range (VARDIS_PRIO_LOW, VARDIS_PRIO_LOW), std::make_pair ((size_t) 1, (size_t) 3));
+
+    // removal keeps the class ranges consistent
+    q.pop_front ();
+    EXPECT_EQ (q.class_range (VARDIS_PRIO_CRITICAL, VARDIS_PRIO_CRITICAL), std::make_pair ((size_t) 0, (size_t) 0));
+    q.remove (std::deque<VarIdT> {3}, 1);
+    EXPECT_EQ (q.class_range (VARDIS_PRIO_LOW, VARDIS_PRIO_LOW), std::make_pair ((size_t) 0, (size_t) 1));
+    q.insert (2);
+    EXPECT_EQ (q.queue[0], 2);
+    EXPECT_EQ (q.queue[1], 1);
+    EXPECT_EQ (q.total_bytes(), 30);
+  }
+
+
+  // ------------------------------------------------------------
+
+  TEST(VardisProtDataTest, queueScheduledByDueTime) {
+    uint64_t due [5] = {0, 7, 3, 7, 1};
+    ScheduledVarIdQueue  q ([&] (VarIdT varId) { return due[varId.val]; });
+    for (auto v : {1, 2, 3, 4})
+      q.insert (v);
+    q.remove (4);
+    EXPECT_EQ (q.size(), 3);
+
+    // earliest due time first, insertion order for equal times, and
+    // every member at most once
+    auto taken = q.take_due (5);
+    ASSERT_EQ (taken.size(), 3);
+    EXPECT_EQ (taken[0], 2);
+    EXPECT_EQ (taken[1], 1);
+    EXPECT_EQ (taken[2], 3);
+    EXPECT_TRUE (q.take_due (1).empty());
+    EXPECT_EQ (q.size(), 3);
+
+    // rescheduled members go behind members with the same due time,
+    // non-members are not scheduled
+    due[1] = 9;
+    due[2] = 7;
+    for (auto v : {3, 2, 1, 4})
+      q.reschedule (v);
+    taken = q.take_due (2);
+    ASSERT_EQ (taken.size(), 2);
+    EXPECT_EQ (taken[0], 3);
+    EXPECT_EQ (taken[1], 2);
+  }
+
+
+  // ------------------------------------------------------------
+
+  TEST(VardisProtDataTest, weightedSummaries) {
+    ArrayVariableStoreShm<256,128> vstore ("shm-vardis-protocol-data-test", true, 20, 32, 32, 5, addr1);
+    VardisProtocolData protData (vstore);
+    protData.vardis_store.set_vardis_isactive (true);
+    protData.maxSummaries = 1;
+
+    create_test_variables (protData, {1, 2});
+    protData.vardis_store.get_db_entry_ref(1).prio = VARDIS_PRIO_CRITICAL;
+    protData.vardis_store.get_db_entry_ref(2).prio = VARDIS_PRIO_LOW;
+
+    // over 18 single-summary rounds the critical variable is
+    // summarized eight times as often as the low priority one
+    unsigned int count [2] = {0, 0};
+    for (int round = 0; round < 18; round++)
+      {
+	MemoryChunkAssemblyArea  ass_area ("ass_area", 1000);
+	unsigned int containers_added = 0;
+	protData.makeICTypeSummaries (ass_area, containers_added);
+	MemoryChunkDisassemblyArea  disass_area ("disass_area", ass_area.used(), ass_area.get_buffer_ptr());
+	ICHeaderT icHeader;
+	icHeader.deserialize (disass_area);
+	EXPECT_EQ (icHeader.icNumRecords, 1);
+	VarSummT summ;
+	summ.deserialize (disass_area);
+	count[summ.varId.val - 1]++;
+      }
+    EXPECT_EQ (count[0], 16);
+    EXPECT_EQ (count[1], 2);
+  }
+  
+  // ------------------------------------------------------------
+    
+  TEST(VardisProtDataTest, recordSizeCache) {
+    ArrayVariableStoreShm<256,128> vstore ("shm-vardis-protocol-data-test", true, 20, 32, 32, 5, addr1);
+    VardisProtocolData protData (vstore);
+    protData.vardis_store.set_vardis_isactive (true);
+
+    // queue totals follow the cached record sizes
+    create_test_variables (protData, {1, 2, 3});
+    size_t createSize = VarSpecT::fixed_size() + 5 + VarUpdateT::fixed_size() + sizeof(double);
+    EXPECT_EQ (protData.createQ.total_bytes(), 3 * createSize);
+    EXPECT_EQ (protData.updateQ.total_bytes(), 0);
+
+    // a value change of a queued variable adjusts the totals
+    byte longval [20] = {};
+    RTDB_Update_Request upd_req;
+    upd_req.varId = 2;
+    upd_req.value = VarValueT (sizeof(longval), longval);
+    EXPECT_EQ (protData.handle_rtdb_update_request (upd_req).status_code, VARDIS_STATUS_OK);
+    EXPECT_EQ (protData.createQ.total_bytes(), 3 * createSize + sizeof(longval) - sizeof(double));
+    EXPECT_EQ (protData.updateQ.total_bytes(), VarUpdateT::fixed_size() + sizeof(longval));
+
+    // only as many creates as fit are serialized, the totals shrink accordingly
+    MemoryChunkAssemblyArea  ass_area ("ass_area", ICHeaderT::fixed_size() + 2 * createSize + 10);
+    unsigned int containers_added = 0;
+    protData.makeICTypeCreateVariables (ass_area, containers_added);
+    EXPECT_EQ (containers_added, 1);
+    EXPECT_EQ (ass_area.used(), ICHeaderT::fixed_size() + createSize);
+    EXPECT_EQ (protData.createQ.size(), 2);
+    EXPECT_EQ (protData.createQ.queue.front(), 2);
+    EXPECT_EQ (protData.createQ.total_bytes(), 2 * createSize + sizeof(longval) - sizeof(double));
+
+    // everything fits into a large area
+    MemoryChunkAssemblyArea  big_area ("big_area", 1000);
+    containers_added = 0;
+    protData.makeICTypeCreateVariables (big_area, containers_added);
+    protData.makeICTypeUpdates (big_area, containers_added);
+    EXPECT_EQ (containers_added, 2);
+    EXPECT_TRUE (protData.createQ.empty());
+    EXPECT_TRUE (protData.updateQ.empty());
+    EXPECT_EQ (protData.createQ.total_bytes(), 0);
+    EXPECT_EQ (protData.updateQ.total_bytes(), 0);
+  }
+
+  // ------------------------------------------------------------
     
 }
@@ -0,0 +1,264 @@
+#include <cstdint>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <dcp/vardis/vardis_protocol_data.h>
+#include <dcp/vardis/vardis_snapshot.h>
+#include <dcp/vardis/vardis_store_array_shm.h>
+
+namespace dcp::vardis {
+
+  NodeIdentifierT snapAddr1 ("01:02:03:04:05:06");
+  NodeIdentifierT snapAddr2 ("11:12:13:14:15:16");
+
+  typedef ArrayVariableStoreShm<256,128> SnapshotTestStore;
+
+  // ------------------------------------------------------------
+
+  /**
+   * @brief Creates variable 10 produced by myself (snapAddr1) and
+   *        variable 20 produced by snapAddr2, updates variable 10
+   *        twice and deletes variable 30
+   */
+  void fill_protocol_data (VardisProtocolData& protData)
+  {
+    double dval  = 3.14;
+    double ddval = 6.28;
+    
+    RTDB_Create_Request cr_req;
+    cr_req.spec.varId   = 10;
+    cr_req.spec.prodId  = snapAddr1;
+    cr_req.spec.repCnt  = 3;
+    cr_req.spec.descr   = StringT ("own");
+    cr_req.value        = VarValueT (sizeof(double), (byte*) &dval);
+    ASSERT_EQ (protData.handle_rtdb_create_request (cr_req).status_code, VARDIS_STATUS_OK);
+
+    RTDB_Update_Request upd_req;
+    upd_req.varId = 10;
+    upd_req.value = VarValueT (sizeof(double), (byte*) &ddval);
+    ASSERT_EQ (protData.handle_rtdb_update_request (upd_req).status_code, VARDIS_STATUS_OK);
+    ASSERT_EQ (protData.handle_rtdb_update_request (upd_req).status_code, VARDIS_STATUS_OK);
+
+    VarCreateT create;
+    create.spec.varId      = 20;
+    create.spec.prodId     = snapAddr2;
+    create.spec.repCnt     = 4;
+    create.spec.timeout    = 5000;
+    create.spec.descr      = StringT ("remote");
+    create.update.varId    = 20;
+    create.update.seqno    = 7;
+    create.update.value    = VarValueT (3, (byte*) "abc");
+    protData.process_var_create (create);
+    ASSERT_TRUE (protData.variableExists (20));
+
+    cr_req.spec.varId   = 30;
+    cr_req.spec.descr   = StringT ("deleted");
+    ASSERT_EQ (protData.handle_rtdb_create_request (cr_req).status_code, VARDIS_STATUS_OK);
+    RTDB_Delete_Request del_req;
+    del_req.varId = 30;
+    ASSERT_EQ (protData.handle_rtdb_delete_request (del_req).status_code, VARDIS_STATUS_OK);
+  }
+  
+  // ------------------------------------------------------------
+
+  TEST(VardisSnapshotTest, RoundTrip) {
+    SnapshotTestStore vstore1 ("shm-vardis-snapshot-test-1", true, 20, 32, 32, 5, snapAddr1);
+    VardisProtocolData protData1 (vstore1);
+    protData1.vardis_store.set_vardis_isactive (true);
+    fill_protocol_data (protData1);
+
+    std::vector<byte> snapshot = make_store_snapshot (protData1);
+    EXPECT_EQ (make_store_snapshot (protData1), snapshot);
+
+    SnapshotTestStore vstore2 ("shm-vardis-snapshot-test-2", true, 20, 32, 32, 5, snapAddr1);
+    VardisProtocolData protData2 (vstore2);
+    TimeStampT now = TimeStampT::get_current_system_time ();
+    EXPECT_EQ (install_store_snapshot (protData2, snapshot, now), 2);
+
+    // deleted variables are not restored
+    EXPECT_FALSE (protData2.variableExists (30));
+    
+    for (VarIdT varId : {VarIdT (10), VarIdT (20)})
+      {
+	const DBEntry& ent1 = vstore1.get_db_entry_ref (varId);
+	const DBEntry& ent2 = vstore2.get_db_entry_ref (varId);
+	EXPECT_TRUE (protData2.variableExists (varId));
+	EXPECT_EQ (ent2.prodId, ent1.prodId);
+	EXPECT_EQ (ent2.repCnt, ent1.repCnt);
+	EXPECT_EQ (ent2.timeout, ent1.timeout);
+	EXPECT_EQ (ent2.seqno, ent1.seqno);
+	EXPECT_TRUE (ent2.creationTime == ent1.creationTime);
+	EXPECT_TRUE (ent2.tStamp == now);
+	EXPECT_TRUE (ent2.isStale);
+	EXPECT_FALSE (ent2.isDeleted);
+	EXPECT_EQ (ent2.countCreate, 0);
+	EXPECT_EQ (ent2.countUpdate, 0);
+	EXPECT_EQ (vstore2.read_value (varId), vstore1.read_value (varId));
+	EXPECT_EQ (vstore2.read_description (varId), vstore1.read_description (varId));
+
+	// derived protocol state is rebuilt, summaries are queued
+	EXPECT_TRUE (protData2.active_variables.contains (varId));
+	EXPECT_TRUE (protData2.summaryQ.contains (varId));
+	EXPECT_FALSE (protData2.createQ.contains (varId));
+	EXPECT_FALSE (protData2.updateQ.contains (varId));
+	EXPECT_EQ (protData2.createRecordSizes[varId.val], protData1.createRecordSizes[varId.val]);
+	EXPECT_EQ (protData2.updateRecordSizes[varId.val], protData1.updateRecordSizes[varId.val]);
+      }
+    EXPECT_EQ (vstore2.get_db_entry_ref(10).seqno, 2);
+    EXPECT_EQ (protData2.merkleTree.root (), protData1.merkleTree.root ());
+
+    // a snapshot of the restored store is the same
+    EXPECT_EQ (make_store_snapshot (protData2), snapshot);
+  }
+
+  // ------------------------------------------------------------
+
+  TEST(VardisSnapshotTest, InvalidSnapshots) {
+    SnapshotTestStore vstore1 ("shm-vardis-snapshot-test-1", true, 20, 32, 32, 5, snapAddr1);
+    VardisProtocolData protData1 (vstore1);
+    protData1.vardis_store.set_vardis_isactive (true);
+    fill_protocol_data (protData1);
+    const std::vector<byte> snapshot = make_store_snapshot (protData1);
+    TimeStampT now = TimeStampT::get_current_system_time ();
+
+    SnapshotTestStore vstore2 ("shm-vardis-snapshot-test-2", true, 20, 32, 32, 5, snapAddr1);
+    VardisProtocolData protData2 (vstore2);
+
+    // corrupted record
+    std::vector<byte> corrupted = snapshot;
+    corrupted.back() ^= 0x01;
+    EXPECT_THROW (install_store_snapshot (protData2, corrupted, now), VardisStoreException);
+
+    // wrong magic number
+    corrupted = snapshot;
+    corrupted[0] ^= 0x01;
+    EXPECT_THROW (install_store_snapshot (protData2, corrupted, now), VardisStoreException);
+
+    // truncated
+    corrupted = snapshot;
+    corrupted.pop_back ();
+    EXPECT_THROW (install_store_snapshot (protData2, corrupted, now), VardisStoreException);
+    corrupted.resize (5);
+    EXPECT_THROW (install_store_snapshot (protData2, corrupted, now), VardisStoreException);
+    EXPECT_THROW (install_store_snapshot (protData2, std::vector<byte> (), now), VardisStoreException);
+
+    // none of these has touched the store
+    EXPECT_EQ (vstore2.get_number_variables (), 0);
+    EXPECT_TRUE (protData2.active_variables.empty ());
+    
+    // taken by another node
+    SnapshotTestStore vstore3 ("shm-vardis-snapshot-test-3", true, 20, 32, 32, 5, snapAddr2);
+    VardisProtocolData protData3 (vstore3);
+    EXPECT_THROW (install_store_snapshot (protData3, snapshot, now), VardisStoreException);
+    EXPECT_EQ (vstore3.get_number_variables (), 0);
+
+    // exceeding a (now smaller) maximum value length
+    SnapshotTestStore vstore4 ("shm-vardis-snapshot-test-4", true, 20, 32, 4, 5, snapAddr1);
+    VardisProtocolData protData4 (vstore4);
+    EXPECT_THROW (install_store_snapshot (protData4, snapshot, now), VardisStoreException);
+    EXPECT_EQ (vstore4.get_number_variables (), 0);
+
+    // store not empty
+    EXPECT_THROW (install_store_snapshot (protData1, snapshot, now), VardisStoreException);
+    
+    EXPECT_EQ (install_store_snapshot (protData2, snapshot, now), 2);
+  }
+
+  // ------------------------------------------------------------
+
+  TEST(VardisSnapshotTest, StaleVariables) {
+    SnapshotTestStore vstore1 ("shm-vardis-snapshot-test-1", true, 20, 32, 32, 5, snapAddr1);
+    VardisProtocolData protData1 (vstore1);
+    protData1.vardis_store.set_vardis_isactive (true);
+    fill_protocol_data (protData1);
+    const std::vector<byte> snapshot = make_store_snapshot (protData1);
+
+    SnapshotTestStore vstore2 ("shm-vardis-snapshot-test-2", true, 20, 32, 32, 5, snapAddr1);
+    VardisProtocolData protData2 (vstore2);
+    protData2.vardis_store.set_vardis_isactive (true);
+    install_store_snapshot (protData2, snapshot, TimeStampT::get_current_system_time ());
+    EXPECT_FALSE (protData2.updateQ.contains (10));
+
+    // reading a restored variable reports it as stale, also after
+    // passing the confirm through its serialized form
+    RTDB_Read_Request read_req;
+    read_req.varId = 20;
+    RTDB_Read_Confirm read_conf = protData2.handle_rtdb_read_request (read_req);
+    EXPECT_EQ (read_conf.status_code, VARDIS_STATUS_OK);
+    EXPECT_TRUE (read_conf.isStale);
+    byte buffer [256];
+    MemoryChunkAssemblyArea aa ("read-conf", sizeof(buffer), buffer);
+    read_conf.serialize (aa);
+    RTDB_Read_Confirm read_conf2;
+    MemoryChunkDisassemblyArea da ("read-conf", aa.used(), buffer);
+    read_conf2.deserialize (da);
+    EXPECT_TRUE (read_conf2.isStale);
+    EXPECT_EQ (da.used(), aa.used());
+
+    // a neighbour knows a more recent version of my own variable
+    // than the snapshot, I re-announce the restored value under a
+    // seqno past the neighbour's one
+    VarSummT summ;
+    summ.varId = 10;
+    summ.seqno = 5;
+    protData2.process_var_summary (summ);
+    EXPECT_EQ (vstore2.get_db_entry_ref(10).seqno, 6);
+    EXPECT_FALSE (vstore2.get_db_entry_ref(10).isStale);
+    EXPECT_TRUE (protData2.updateQ.contains (10));
+    EXPECT_EQ (vstore2.get_db_entry_ref(10).countUpdate, vstore2.get_db_entry_ref(10).repCnt);
+    EXPECT_EQ (vstore2.read_value (10), vstore1.read_value (10));
+
+    // once not stale anymore, reported seqnos of my own variables
+    // are ignored
+    summ.seqno = 9;
+    protData2.process_var_summary (summ);
+    EXPECT_EQ (vstore2.get_db_entry_ref(10).seqno, 6);
+
+    double dval = 1.0;
+    RTDB_Update_Request upd_req;
+    upd_req.varId = 10;
+    upd_req.value = VarValueT (sizeof(double), (byte*) &dval);
+    EXPECT_EQ (protData2.handle_rtdb_update_request (upd_req).status_code, VARDIS_STATUS_OK);
+    EXPECT_EQ (vstore2.get_db_entry_ref(10).seqno, 7);
+    
+    // a remote variable stays stale until a neighbour confirms its
+    // seqno or sends a more recent version
+    summ.varId = 20;
+    summ.seqno = 8;
+    protData2.process_var_summary (summ);
+    EXPECT_TRUE (vstore2.get_db_entry_ref(20).isStale);
+    EXPECT_TRUE (protData2.reqUpdQ.contains (20));
+    summ.seqno = 7;
+    protData2.process_var_summary (summ);
+    EXPECT_FALSE (vstore2.get_db_entry_ref(20).isStale);
+    EXPECT_FALSE (protData2.handle_rtdb_read_request (read_req).isStale);
+    read_req.varId = 10;
+    EXPECT_FALSE (protData2.handle_rtdb_read_request (read_req).isStale);
+  }
+
+  // ------------------------------------------------------------
+
+  TEST(VardisSnapshotTest, SnapshotFiles) {
+    SnapshotTestStore vstore1 ("shm-vardis-snapshot-test-1", true, 20, 32, 32, 5, snapAddr1);
+    VardisProtocolData protData1 (vstore1);
+    protData1.vardis_store.set_vardis_isactive (true);
+    fill_protocol_data (protData1);
+    const std::vector<byte> snapshot = make_store_snapshot (protData1);
+
+    std::string filename = (std::filesystem::temp_directory_path() / "vardis-snapshot-test.bin").string();
+    std::filesystem::remove (filename);
+    EXPECT_TRUE (read_snapshot_file (filename).empty ());
+
+    write_snapshot_file (filename, snapshot);
+    EXPECT_EQ (read_snapshot_file (filename), snapshot);
+    EXPECT_FALSE (std::filesystem::exists (filename + ".tmp"));
+
+    // replacing an existing snapshot
+    std::vector<byte> other (snapshot.begin(), snapshot.begin() + 10);
+    write_snapshot_file (filename, other);
+    EXPECT_EQ (read_snapshot_file (filename), other);
+    std::filesystem::remove (filename);
+
+    EXPECT_THROW (write_snapshot_file ("/nonexistent-directory/snapshot", snapshot), VardisStoreException);
+  }
+
+};  // namespace dcp::vardis
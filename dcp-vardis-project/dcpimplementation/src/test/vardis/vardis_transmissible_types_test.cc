@@ -74,7 +74,7 @@ namespace dcp::vardis {
     EXPECT_EQ (spec.repCnt, 20);
     EXPECT_NE (spec.descr.data, descr.data);
     EXPECT_EQ (spec.descr, descr);
-    EXPECT_EQ (spec.fixed_size(), VarIdT::fixed_size() + NodeIdentifierT::fixed_size() + VarRepCntT::fixed_size() + TimeStampT::fixed_size() + VarTimeoutT::fixed_size() + VarLenT::fixed_size());
+    EXPECT_EQ (spec.fixed_size(), VarIdT::fixed_size() + NodeIdentifierT::fixed_size() + VarRepCntT::fixed_size() + TimeStampT::fixed_size() + VarTimeoutT::fixed_size() + VarPriorityT::fixed_size() + VarIntervalT::fixed_size() + VarLenT::fixed_size());
     EXPECT_EQ (spec.total_size(), spec.fixed_size() + descr.length);
 
     EXPECT_EQ (VarCreateT::fixed_size(), VarSpecT::fixed_size() + VarUpdateT::fixed_size());
@@ -216,5 +216,136 @@ namespace dcp::vardis {
   }
 
   // ------------------------------------------------------------
+
+  TEST(VardisTTTest, VardisTransmissibleTest_SummaryRanges) {
+
+    byte buffer [1000];
+    MemoryChunkAssemblyArea      ass_area ("ass_area", 1000, buffer);
+
+    VarSummRangeT aseqrange;
+    aseqrange.firstVarId = VarIdT (17);
+    aseqrange.numVars    = 3;
+    aseqrange.mode       = SUMMRANGE_MODE_SEQNOS;
+    aseqrange.seqnos     = { VarSeqnoT (1), VarSeqnoT (200), VarSeqnoT (33) };
+    EXPECT_EQ (aseqrange.total_size(), VarIdT::fixed_size() + 2 + 3*VarSeqnoT::fixed_size());
+    aseqrange.serialize (ass_area);
+    EXPECT_EQ (ass_area.used(), aseqrange.total_size());
+
+    VarSummRangeT adigrange;
+    adigrange.firstVarId = VarIdT (64);
+    adigrange.numVars    = 64;
+    adigrange.mode       = SUMMRANGE_MODE_DIGEST;
+    adigrange.digest     = 0xDEADBEEF;
+    EXPECT_EQ (adigrange.total_size(), VarIdT::fixed_size() + 2 + sizeof(uint32_t));
+    adigrange.serialize (ass_area);
+
+    VarReqSummRangeT areq;
+    areq.firstVarId = VarIdT (128);
+    areq.numVars    = 32;
+    areq.serialize (ass_area);
+
+    // inconsistent number of seqnos must not be serialized
+    VarSummRangeT badrange = aseqrange;
+    badrange.numVars = 4;
+    EXPECT_ANY_THROW (badrange.serialize (ass_area));
+
+    MemoryChunkDisassemblyArea   disass_area ("disass_area", ass_area.used(), buffer);
+    VarSummRangeT dseqrange;
+    dseqrange.deserialize (disass_area);
+    EXPECT_EQ (aseqrange, dseqrange);
+    VarSummRangeT ddigrange;
+    ddigrange.deserialize (disass_area);
+    EXPECT_EQ (adigrange, ddigrange);
+    VarReqSummRangeT dreq;
+    dreq.deserialize (disass_area);
+    EXPECT_EQ (areq, dreq);
+    EXPECT_EQ (disass_area.available(), 0);
+
+    // unknown mode and empty ranges are rejected
+    byte badbuf [] = { 10, 2, 99, 1, 2 };
+    MemoryChunkDisassemblyArea   bad_area ("bad_area", sizeof(badbuf), badbuf);
+    VarSummRangeT dbad;
+    EXPECT_ANY_THROW (dbad.deserialize (bad_area));
+    byte emptybuf [] = { 10, 0, SUMMRANGE_MODE_SEQNOS };
+    MemoryChunkDisassemblyArea   empty_area ("empty_area", sizeof(emptybuf), emptybuf);
+    VarSummRangeT dempty;
+    EXPECT_ANY_THROW (dempty.deserialize (empty_area));
+  }
+
+  // ------------------------------------------------------------
+
+  TEST(VardisTTTest, VardisTransmissibleTest_MerkleNodes) {
+
+    byte buffer [1000];
+    MemoryChunkAssemblyArea      ass_area ("ass_area", 1000, buffer);
+
+    VarMerkleNodeT anode;
+    anode.level = 5;
+    anode.index = VarIdT (17);
+    anode.hash  = 0x01020304;
+    anode.serialize (ass_area);
+
+    VarReqMerkleNodeT areq;
+    areq.level = 3;
+    areq.index = VarIdT (6);
+    areq.serialize (ass_area);
+    EXPECT_EQ (ass_area.used(), VarMerkleNodeT::fixed_size() + VarReqMerkleNodeT::fixed_size());
+
+    MemoryChunkDisassemblyArea   disass_area ("disass_area", ass_area.used(), buffer);
+    VarMerkleNodeT dnode;
+    dnode.deserialize (disass_area);
+    EXPECT_EQ (anode, dnode);
+    VarReqMerkleNodeT dreq;
+    dreq.deserialize (disass_area);
+    EXPECT_EQ (areq, dreq);
+    EXPECT_EQ (disass_area.available(), 0);
+  }
+
+  // ------------------------------------------------------------
+    
+  TEST(VardisTTTest, VardisTransmissibleTest_InPlaceDeserialization) {
+
+    byte buffer [1000];
+    MemoryChunkAssemblyArea      ass_area ("ass_area", 1000, buffer);
+    double d0 = 2.71;
+    VarCreateT acreate;
+    acreate.spec.varId   = VarIdT (12);
+    acreate.spec.repCnt  = VarRepCntT (3);
+    acreate.spec.prio    = VARDIS_PRIO_HIGH;
+    acreate.spec.descr   = StringT ("hello");
+    acreate.update.varId = VarIdT (12);
+    acreate.update.seqno = VarSeqnoT (7);
+    acreate.update.value = VarValueT (VarLenT(sizeof(double)), (byte*) &d0);
+    acreate.serialize (ass_area);
+    acreate.update.serialize (ass_area);
+
+    // description and value refer into the buffer and are not owned
+    MemoryChunkDisassemblyArea   disass_area ("disass_area", ass_area.used(), buffer);
+    VarCreateT dcreate;
+    dcreate.deserialize_view (disass_area);
+    EXPECT_FALSE (dcreate.spec.descr.do_delete);
+    EXPECT_FALSE (dcreate.update.value.do_delete);
+    EXPECT_GE (dcreate.spec.descr.data, buffer);
+    EXPECT_LT (dcreate.update.value.data, buffer + ass_area.used());
+    EXPECT_EQ (dcreate.spec.prio, VARDIS_PRIO_HIGH);
+    EXPECT_EQ (dcreate.spec.descr.to_str(), "hello");
+    EXPECT_EQ (dcreate.update.seqno, 7);
+    EXPECT_EQ (dcreate.update.value.length, sizeof(double));
+    EXPECT_EQ (0, std::memcmp (dcreate.update.value.data, &d0, sizeof(double)));
+    EXPECT_EQ (dcreate.total_size(), acreate.total_size());
+
+    // a view record can be re-used for the next record
+    dcreate.update.deserialize_view (disass_area);
+    EXPECT_EQ (dcreate.update.varId, 12);
+    EXPECT_EQ (disass_area.available(), 0);
+
+    // copying a view yields an owned copy
+    VarValueT copy (dcreate.update.value);
+    EXPECT_TRUE (copy.do_delete);
+    EXPECT_NE (copy.data, dcreate.update.value.data);
+    EXPECT_EQ (copy, acreate.update.value);
+  }
+
+  // ------------------------------------------------------------
     
 }